@@ -0,0 +1,172 @@
+#include "JobSystem.hpp"
+#include "Scene.hpp"
+#include "SceneCuller.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 视锥剔除基准：逐对象标量测试 vs BVH（单线程/多线程），以及移动物体后的增量refit
+
+namespace {
+    bool IsBoxVisible(const Frustum& frustum, const AABB& box) {
+        for (const auto& plane : frustum.planes) {
+            float x = plane[0] >= 0.0f ? box.max.x : box.min.x;
+            float y = plane[1] >= 0.0f ? box.max.y : box.min.y;
+            float z = plane[2] >= 0.0f ? box.max.z : box.min.z;
+            if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f) return false;
+        }
+        return true;
+    }
+
+    // 右手坐标系透视投影 * 观察矩阵（看向-Z方向），Vulkan深度0..1
+    Mat4 MakeViewProjection(float yaw, float fovY, float aspect, float nearPlane, float farPlane) {
+        float f = 1.0f / std::tan(fovY * 0.5f);
+        Mat4 projection{};
+        projection.m[0] = f / aspect;
+        projection.m[5] = -f;
+        projection.m[10] = farPlane / (nearPlane - farPlane);
+        projection.m[11] = -1.0f;
+        projection.m[14] = nearPlane * farPlane / (nearPlane - farPlane);
+
+        Transform camera;
+        camera.rotation = Quat::FromAxisAngle(Vec3{0.0f, 1.0f, 0.0f}, -yaw);
+        Mat4 view = camera.ToMatrix();
+
+        Mat4 result;
+        MultiplyMat4(projection, view, result);
+        return result;
+    }
+
+    template<typename Func>
+    double MeasureMilliseconds(int iterations, Func&& func) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            func(i);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+    void RunBenchmark(uint32_t objectCount, JobSystem& jobSystem) {
+        std::mt19937 random(4321);
+        float extent = std::cbrt(static_cast<float>(objectCount)) * 4.0f;
+        std::uniform_real_distribution<float> position(-extent, extent);
+        std::uniform_real_distribution<float> size(0.2f, 1.5f);
+
+        Scene scene;
+        std::vector<NodeHandle> handles(objectCount);
+        for (uint32_t i = 0; i < objectCount; i++) {
+            Transform transform;
+            transform.position = Vec3{position(random), position(random), position(random)};
+            handles[i] = scene.CreateNode(INVALID_NODE, transform);
+            float half = size(random);
+            AABB bounds;
+            bounds.min = Vec3{-half, -half, -half};
+            bounds.max = Vec3{half, half, half};
+            scene.SetLocalBounds(handles[i], bounds);
+        }
+        scene.UpdateWorldMatrices();
+
+        SceneCuller culler(&scene, &jobSystem);
+        double buildTime = MeasureMilliseconds(1, [&](int) { culler.Update(); });
+
+        const int iterations = 20;
+        std::vector<Mat4> cameras(iterations);
+        for (int i = 0; i < iterations; i++) {
+            cameras[i] = MakeViewProjection(i * 0.3f, 1.0f, 16.0f / 9.0f, 0.1f, extent * 1.5f);
+        }
+
+        const AABB* worldBounds = scene.GetWorldBounds();
+        std::vector<uint32_t> bruteVisible;
+        double bruteTime = MeasureMilliseconds(iterations, [&](int i) {
+            Frustum frustum = Frustum::FromViewProjection(cameras[i]);
+            bruteVisible.clear();
+            for (uint32_t index = 0; index < scene.GetNodeCount(); index++) {
+                if (IsBoxVisible(frustum, worldBounds[index])) bruteVisible.push_back(index);
+            }
+        });
+
+        std::vector<uint32_t> visible;
+        double singleTime = MeasureMilliseconds(iterations, [&](int i) {
+            culler.GetBvh().Cull(Frustum::FromViewProjection(cameras[i]), visible);
+        });
+        double parallelTime = MeasureMilliseconds(iterations, [&](int i) {
+            culler.Cull(cameras[i], visible);
+        });
+
+        // 5%的物体移动后refit
+        std::vector<uint32_t> moving(objectCount / 20);
+        for (auto& index : moving) {
+            index = std::uniform_int_distribution<uint32_t>(0, objectCount - 1)(random);
+        }
+        std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+        double refitTime = 0.0;
+        for (int i = 0; i < iterations; i++) {
+            for (uint32_t index : moving) {
+                Mat4 local = scene.GetLocalMatrix(handles[index]);
+                local.m[12] += step(random);
+                local.m[13] += step(random);
+                local.m[14] += step(random);
+                scene.SetLocalMatrix(handles[index], local);
+            }
+            scene.UpdateWorldMatrices();
+            refitTime += MeasureMilliseconds(1, [&](int) { culler.Update(); });
+        }
+        refitTime /= iterations;
+
+        // 校验：BVH结果与逐对象测试一致（BVH只会多出包围盒保守导致的对象，不应漏掉）
+        uint32_t mismatches = 0;
+        for (int i = 0; i < iterations; i++) {
+            Frustum frustum = Frustum::FromViewProjection(cameras[i]);
+            culler.Cull(cameras[i], visible);
+            bruteVisible.clear();
+            for (uint32_t index = 0; index < scene.GetNodeCount(); index++) {
+                if (IsBoxVisible(frustum, worldBounds[index])) bruteVisible.push_back(index);
+            }
+            std::sort(visible.begin(), visible.end());
+            if (visible != bruteVisible) mismatches++;
+        }
+
+        std::cout << objectCount << " objects, " << culler.GetBvh().GetNodeCount() << " BVH nodes, "
+                  << jobSystem.GetWorkerCount() + 1 << " threads\n"
+                  << "  BVH build:                   " << buildTime << " ms\n"
+                  << "  brute force (scalar):        " << bruteTime << " ms\n"
+                  << "  BVH cull (1 thread):         " << singleTime << " ms\n"
+                  << "  BVH cull (parallel):         " << parallelTime << " ms\n"
+                  << "  refit (5% moved):            " << refitTime << " ms (" << culler.GetRebuildCount() - 1 << " rebuilds)\n"
+                  << "  visible (last frame):        " << visible.size() << "\n"
+                  << "  mismatching frames:          " << mismatches << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+    }
+    if (counts.empty()) {
+        counts = {10000, 100000, 1000000};
+    }
+
+    JobSystem jobSystem;
+    jobSystem.Initialize();
+
+#if defined(__AVX__)
+    std::cout << "box test kernel: AVX (8 boxes per leaf test)" << std::endl;
+#elif defined(__SSE2__) || defined(_M_X64)
+    std::cout << "box test kernel: SSE (4 boxes per test)" << std::endl;
+#else
+    std::cout << "box test kernel: scalar" << std::endl;
+#endif
+
+    for (uint32_t count : counts) {
+        if (count > 0) {
+            RunBenchmark(count, jobSystem);
+        }
+    }
+    return 0;
+}
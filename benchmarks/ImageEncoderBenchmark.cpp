@@ -0,0 +1,70 @@
+#include "ImageEncoder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// 回读转换基准：1080p BGRA -> I420（SSE2与标量）、BGRA -> RGBA、PNG编码，输出每帧毫秒数与吞吐
+
+namespace {
+    template <typename Function>
+    double MeasureMilliseconds(uint32_t iterations, Function function) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            function();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+    void Report(const char* name, double milliseconds, size_t bytes) {
+        std::cout << name << ": " << milliseconds << " ms/frame, "
+                  << (bytes / (1024.0 * 1024.0)) / (milliseconds / 1000.0) << " MB/s" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t width = 1920, height = 1080;
+    uint32_t iterations = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 100u;
+
+    std::mt19937 random(42);
+    std::vector<uint8_t> source(static_cast<size_t>(width) * height * 4);
+    for (uint8_t& value : source) {
+        value = static_cast<uint8_t>(random());
+    }
+    size_t sourceBytes = source.size();
+
+    // SIMD路径须与标量实现逐字节一致（含奇数尺寸的边缘处理）
+    const uint32_t checkSizes[][2] = {{width, height}, {37, 21}, {1, 1}, {8, 3}};
+    for (const auto& size : checkSizes) {
+        std::vector<uint8_t> fast(ImageEncoder::GetI420Size(size[0], size[1]));
+        std::vector<uint8_t> reference(fast.size());
+        ImageEncoder::BgraToI420(source.data(), size[0], size[1], fast.data());
+        ImageEncoder::BgraToI420Reference(source.data(), size[0], size[1], reference.data());
+        if (fast != reference) {
+            std::cerr << "I420 mismatch at " << size[0] << "x" << size[1] << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> yuv(ImageEncoder::GetI420Size(width, height));
+    std::vector<uint8_t> rgba(source.size());
+    std::cout << width << "x" << height << ", " << iterations << " iterations" << std::endl;
+    Report("BgraToI420 (reference)", MeasureMilliseconds(iterations, [&]() {
+        ImageEncoder::BgraToI420Reference(source.data(), width, height, yuv.data());
+    }), sourceBytes);
+    Report("BgraToI420", MeasureMilliseconds(iterations, [&]() {
+        ImageEncoder::BgraToI420(source.data(), width, height, yuv.data());
+    }), sourceBytes);
+    Report("BgraToRgba", MeasureMilliseconds(iterations, [&]() {
+        ImageEncoder::BgraToRgba(source.data(), rgba.data(), static_cast<size_t>(width) * height);
+    }), sourceBytes);
+    Report("EncodePng", MeasureMilliseconds(std::max(1u, iterations / 10), [&]() {
+        std::vector<uint8_t> png = ImageEncoder::EncodePng(source.data(), width, height);
+        rgba[0] = png[0];
+    }), sourceBytes);
+    return 0;
+}
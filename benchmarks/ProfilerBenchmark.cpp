@@ -0,0 +1,75 @@
+#include "Profiler.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 区段分析器开销基准：每个区段写入开始+结束两个事件
+
+namespace {
+    volatile uint64_t sink = 0;
+
+    double MeasureNanosecondsPerZone(uint32_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            ProfileZone zone("BenchmarkZone");
+            sink = sink + i;
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+    double MeasureBaseline(uint32_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            sink = sink + i;
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 10000000u;
+#ifndef VGE_PROFILER
+    std::cout << "profiler compiled out (VGE_ENABLE_PROFILER=OFF), measuring the raw recording path" << std::endl;
+#endif
+
+    Profiler::SetThreadName("Benchmark");
+    MeasureNanosecondsPerZone(iterations / 10);     // 预热并注册线程缓冲
+
+    double baseline = MeasureBaseline(iterations);
+    double enabled = MeasureNanosecondsPerZone(iterations);
+    Profiler::SetEnabled(false);
+    double disabled = MeasureNanosecondsPerZone(iterations);
+    Profiler::SetEnabled(true);
+
+    std::cout << "loop baseline:       " << baseline << " ns/iteration" << std::endl;
+    std::cout << "zone (enabled):      " << enabled - baseline << " ns/zone, "
+              << (enabled - baseline) * 0.5 << " ns/event" << std::endl;
+    std::cout << "zone (disabled):     " << disabled - baseline << " ns/zone" << std::endl;
+
+    // 多个线程同时记录，各自写入自己的缓冲
+    uint32_t threadCount = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<double> results(threadCount);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; t++) {
+        threads.emplace_back([t, iterations, &results]() {
+            std::string name = "Worker " + std::to_string(t);
+            Profiler::SetThreadName(name.c_str());
+            results[t] = MeasureNanosecondsPerZone(iterations / 4);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    double worst = 0.0;
+    for (double result : results) worst = std::max(worst, result);
+    std::cout << threadCount << " threads:           " << worst - baseline << " ns/zone (slowest thread)" << std::endl;
+
+    auto exportStart = std::chrono::steady_clock::now();
+    bool exported = Profiler::ExportChromeTrace("profiler_benchmark_trace.json");
+    std::chrono::duration<double, std::milli> exportTime = std::chrono::steady_clock::now() - exportStart;
+    std::cout << "chrome trace export: " << (exported ? "ok" : "failed") << ", " << exportTime.count() << " ms" << std::endl;
+    return 0;
+}
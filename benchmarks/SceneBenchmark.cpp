@@ -0,0 +1,181 @@
+#include "JobSystem.hpp"
+#include "Scene.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// 场景世界矩阵更新基准：对比指针式场景图与SoA层级（单线程/多线程，全量/增量）
+
+namespace {
+    // 传统指针式场景图，作为对照
+    struct PointerNode {
+        Mat4 local;
+        Mat4 world;
+        std::vector<PointerNode*> children;
+    };
+
+    void UpdatePointerNode(PointerNode* node, const Mat4& parentWorld) {
+        MultiplyMat4(parentWorld, node->local, node->world);
+        for (PointerNode* child : node->children) {
+            UpdatePointerNode(child, node->world);
+        }
+    }
+
+    Transform RandomTransform(std::mt19937& random) {
+        std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        Transform transform;
+        transform.position = Vec3{offset(random), offset(random), offset(random)};
+        transform.rotation = Quat::FromAxisAngle(Vec3{offset(random), offset(random), offset(random)}, angle(random));
+        return transform;
+    }
+
+    template<typename Func>
+    double MeasureMilliseconds(int iterations, Func&& func) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            func(i);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+    void RunBenchmark(uint32_t nodeCount, JobSystem& jobSystem) {
+        std::mt19937 random(1234);
+
+        // 随机递归树：每个节点的父节点从之前的节点中选取，深度约为ln(n)
+        std::vector<uint32_t> parentOf(nodeCount, INVALID_NODE);
+        std::vector<Transform> transforms(nodeCount);
+        uint32_t rootCount = std::max(1u, nodeCount / 1000);
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            if (i >= rootCount) {
+                parentOf[i] = std::uniform_int_distribution<uint32_t>(0, i - 1)(random);
+            }
+            transforms[i] = RandomTransform(random);
+        }
+
+        Scene scene;
+        std::vector<NodeHandle> handles(nodeCount);
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            handles[i] = scene.CreateNode(parentOf[i] != INVALID_NODE ? handles[parentOf[i]] : INVALID_NODE, transforms[i]);
+        }
+        scene.UpdateWorldMatrices();
+
+        std::vector<std::unique_ptr<PointerNode>> pointerNodes(nodeCount);
+        std::vector<PointerNode*> pointerRoots;
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            pointerNodes[i] = std::make_unique<PointerNode>();
+            pointerNodes[i]->local = transforms[i].ToMatrix();
+            if (parentOf[i] != INVALID_NODE) {
+                pointerNodes[parentOf[i]]->children.push_back(pointerNodes[i].get());
+            } else {
+                pointerRoots.push_back(pointerNodes[i].get());
+            }
+        }
+
+        const int iterations = nodeCount >= 1000000 ? 5 : 20;
+        Mat4 identity = Mat4::Identity();
+
+        double pointerTime = MeasureMilliseconds(iterations, [&](int) {
+            for (PointerNode* root : pointerRoots) {
+                UpdatePointerNode(root, identity);
+            }
+        });
+
+        // 全部标记为脏
+        auto markAll = [&]() {
+            for (uint32_t i = 0; i < nodeCount; i++) {
+                scene.SetLocalMatrix(handles[i], scene.GetLocalMatrix(handles[i]));
+            }
+        };
+
+        scene.SetJobSystem(nullptr);
+        double fullSingle = 0.0;
+        for (int i = 0; i < iterations; i++) {
+            markAll();
+            fullSingle += MeasureMilliseconds(1, [&](int) { scene.UpdateWorldMatrices(); });
+        }
+        fullSingle /= iterations;
+
+        scene.SetJobSystem(&jobSystem);
+        double fullParallel = 0.0;
+        for (int i = 0; i < iterations; i++) {
+            markAll();
+            fullParallel += MeasureMilliseconds(1, [&](int) { scene.UpdateWorldMatrices(); });
+        }
+        fullParallel /= iterations;
+
+        // 1%的节点移动
+        std::vector<uint32_t> moving(nodeCount / 100);
+        for (auto& index : moving) {
+            index = std::uniform_int_distribution<uint32_t>(0, nodeCount - 1)(random);
+        }
+        double incremental = 0.0;
+        for (int i = 0; i < iterations; i++) {
+            for (uint32_t index : moving) {
+                scene.SetLocalTransform(handles[index], RandomTransform(random));
+            }
+            incremental += MeasureMilliseconds(1, [&](int) { scene.UpdateWorldMatrices(); });
+        }
+        incremental /= iterations;
+        uint32_t changedNodes = scene.GetChangedCount();
+
+        double idle = MeasureMilliseconds(iterations, [&](int) { scene.UpdateWorldMatrices(); });
+
+        // 校验：SoA结果与指针式结果一致
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            scene.SetLocalTransform(handles[i], transforms[i]);
+        }
+        scene.UpdateWorldMatrices();
+        float maxError = 0.0f;
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            const Mat4& a = scene.GetWorldMatrix(handles[i]);
+            const Mat4& b = pointerNodes[i]->world;
+            for (int k = 0; k < 16; k++) {
+                float scale = std::max(1.0f, std::fabs(b.m[k]));
+                maxError = std::max(maxError, std::fabs(a.m[k] - b.m[k]) / scale);
+            }
+        }
+
+        std::cout << nodeCount << " nodes, " << scene.GetLevelCount() << " levels, "
+                  << jobSystem.GetWorkerCount() + 1 << " threads\n"
+                  << "  pointer graph full update:   " << pointerTime << " ms\n"
+                  << "  SoA full update (1 thread):  " << fullSingle << " ms\n"
+                  << "  SoA full update (parallel):  " << fullParallel << " ms\n"
+                  << "  SoA incremental (1% moved):  " << incremental << " ms (" << changedNodes << " nodes updated)\n"
+                  << "  SoA no changes:              " << idle << " ms\n"
+                  << "  max relative error:          " << maxError << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+    }
+    if (counts.empty()) {
+        counts = {100000, 1000000};
+    }
+
+    JobSystem jobSystem;
+    jobSystem.Initialize();
+
+#if defined(__AVX__)
+    std::cout << "matrix kernel: AVX" << std::endl;
+#elif defined(__SSE2__) || defined(_M_X64)
+    std::cout << "matrix kernel: SSE" << std::endl;
+#else
+    std::cout << "matrix kernel: scalar" << std::endl;
+#endif
+
+    for (uint32_t count : counts) {
+        if (count > 0) {
+            RunBenchmark(count, jobSystem);
+        }
+    }
+    return 0;
+}
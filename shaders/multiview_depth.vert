@@ -0,0 +1,28 @@
+#version 450
+#extension GL_EXT_multiview : require
+#extension GL_GOOGLE_include_directive : require
+#include "vertex_decode.glsl"
+
+// 多视图仅深度绘制（点光源立方体阴影、级联阴影）：
+// 一次录制覆盖所有视图，gl_ViewIndex选择视图矩阵，顶点只拉取一次
+// 视图数据与MultiviewPass::ViewData一致（std140）
+
+layout(set = 0, binding = 0) uniform Views {
+    mat4 viewProjection[6];
+    vec4 viewPosition[6];
+    uint viewCount;
+} views;
+
+layout(push_constant) uniform Object {
+    mat4 model;
+    vec4 positionOffset;    // 量化位置的解码参数（MeshInfo::dequantization）
+    vec4 positionScale;
+} object;
+
+// 烘焙网格的位置：SNORM16X4
+layout(location = VERTEX_LOCATION_POSITION) in vec4 inPosition;
+
+void main() {
+    vec3 position = DecodePosition(inPosition, object.positionOffset.xyz, object.positionScale.xyz);
+    gl_Position = views.viewProjection[gl_ViewIndex] * (object.model * vec4(position, 1.0));
+}
@@ -0,0 +1,46 @@
+// 量化顶点属性的解码，与src/VertexFormat.hpp中的VertexFormat一致
+// 使用方式：
+//   #extension GL_GOOGLE_include_directive : require
+//   #include "vertex_decode.glsl"
+// 输入location即VertexSemantic，声明的类型取决于格式：
+//   位置  SNORM16X4/HALF4 -> vec4   DecodePosition(inPosition, offset, scale)，offset/scale为网格的VertexDequantization
+//   法线  OCT16           -> vec2   DecodeOctahedral(inNormal)
+//         SNORM8X4        -> vec4   normalize(inNormal.xyz)
+//   切线  OCT16_SIGN      -> ivec2  DecodeTangent(inTangent)，w为副切线符号
+//         SNORM8X4        -> vec4   vec4(normalize(inTangent.xyz), inTangent.w < 0.0 ? -1.0 : 1.0)
+//   UV    UNORM16X2/HALF2 -> vec2   DecodeUv(inUv, offset, scale)
+// 未量化的FLOAT格式直接使用
+
+#define VERTEX_LOCATION_POSITION 0
+#define VERTEX_LOCATION_NORMAL 1
+#define VERTEX_LOCATION_TANGENT 2
+#define VERTEX_LOCATION_UV 3
+
+vec3 DecodePosition(vec4 stored, vec3 offset, vec3 scale) {
+    return offset + stored.xyz * scale;
+}
+
+vec2 DecodeUv(vec2 stored, vec2 offset, vec2 scale) {
+    return offset + stored * scale;
+}
+
+// 八面体编码的单位向量：下半球的折叠在一步中展开
+vec3 DecodeOctahedral(vec2 encoded) {
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -fold : fold;
+    n.y += n.y >= 0.0 ? -fold : fold;
+    return normalize(n);
+}
+
+// x的高15位与y为八面体坐标，x的最低位为副切线符号（1为负）；算术右移保留x的符号
+vec4 DecodeTangent(ivec2 stored) {
+    vec2 encoded = vec2(float(stored.x >> 1) / 16383.0, float(stored.y) / 32767.0);
+    float bitangentSign = (stored.x & 1) != 0 ? -1.0 : 1.0;
+    return vec4(DecodeOctahedral(clamp(encoded, -1.0, 1.0)), bitangentSign);
+}
+
+// 由法线与切线重建副切线
+vec3 DecodeBitangent(vec3 normal, vec4 tangent) {
+    return cross(normal, tangent.xyz) * tangent.w;
+}
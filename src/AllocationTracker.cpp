@@ -0,0 +1,140 @@
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef VGE_TRACK_ALLOCATIONS
+
+namespace {
+    std::atomic<bool> active{false};
+    std::atomic<uint64_t> allocationCount{0};
+    std::atomic<uint64_t> allocationBytes{0};
+    // 零初始化的线程局部变量，读取时不会触发分配
+    thread_local bool trackedThread = false;
+
+    void Record(size_t size) {
+        if (trackedThread && active.load(std::memory_order_relaxed)) {
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+            allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        }
+    }
+
+    void* Allocate(size_t size) {
+        Record(size);
+        if (size == 0) size = 1;
+        while (true) {
+            if (void* pointer = std::malloc(size)) return pointer;
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) return nullptr;
+            handler();
+        }
+    }
+
+    void* AllocateAligned(size_t size, std::align_val_t alignment) {
+        Record(size);
+        size_t align = static_cast<size_t>(alignment);
+        // aligned_alloc要求大小为对齐的整数倍
+        size = (std::max<size_t>(size, 1) + align - 1) & ~(align - 1);
+        while (true) {
+#ifdef _WIN32
+            if (void* pointer = _aligned_malloc(size, align)) return pointer;
+#else
+            if (void* pointer = std::aligned_alloc(align, size)) return pointer;
+#endif
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) return nullptr;
+            handler();
+        }
+    }
+
+    void FreeAligned(void* pointer) {
+#ifdef _WIN32
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+}
+
+bool AllocationTracker::IsEnabled() {
+    return true;
+}
+
+void AllocationTracker::TrackCurrentThread() {
+    trackedThread = true;
+}
+
+void AllocationTracker::Begin() {
+    trackedThread = true;
+    allocationCount.store(0, std::memory_order_relaxed);
+    allocationBytes.store(0, std::memory_order_relaxed);
+    active.store(true, std::memory_order_release);
+}
+
+AllocationTracker::Counters AllocationTracker::End() {
+    active.store(false, std::memory_order_release);
+    Counters counters;
+    counters.allocations = allocationCount.load(std::memory_order_relaxed);
+    counters.bytes = allocationBytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+// 全局替换：抛出版本失败时抛bad_alloc，nothrow版本返回nullptr
+void* operator new(size_t size) {
+    if (void* pointer = Allocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    if (void* pointer = Allocate(size)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* pointer = AllocateAligned(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* pointer = AllocateAligned(size, alignment)) return pointer;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateAligned(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pointer); }
+
+#else
+
+bool AllocationTracker::IsEnabled() {
+    return false;
+}
+
+void AllocationTracker::TrackCurrentThread() {}
+
+void AllocationTracker::Begin() {}
+
+AllocationTracker::Counters AllocationTracker::End() {
+    return Counters{};
+}
+
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+
+// 堆分配计数：CMake选项VGE_TRACK_ALLOCATIONS开启时替换全局operator new/delete，
+// 统计Begin与End之间发生在受跟踪线程（Begin的调用线程与JobSystem工作线程）上的分配；
+// 编码、纹理加载、日志等后台线程不计入。关闭时全部为空操作，IsEnabled返回false
+namespace AllocationTracker {
+    struct Counters {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+    };
+
+    bool IsEnabled();
+    // 把当前线程加入跟踪（工作线程启动时调用）
+    void TrackCurrentThread();
+    // 清零并开始计数，调用线程自动加入跟踪
+    void Begin();
+    // 停止计数，返回Begin以来的分配
+    Counters End();
+}
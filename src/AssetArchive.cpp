@@ -0,0 +1,512 @@
+#include "AssetArchive.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef VGE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+    const char ARCHIVE_MAGIC[4] = {'V', 'G', 'E', 'A'};
+
+    uint32_t NextPowerOfTwo(uint32_t value) {
+        uint32_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // 负载完全位于映射内（按减法比较，offset + storedSize溢出时也不会误判），未压缩负载的存储大小即解压后大小
+    bool IsPayloadValid(const ArchiveEntry& entry, size_t mappedSize) {
+        if (entry.offset > mappedSize || entry.storedSize > mappedSize - entry.offset) {
+            return false;
+        }
+        return entry.compression != AssetCompression::None || entry.storedSize == entry.size;
+    }
+}
+
+AssetArchive::AssetArchive() {}
+
+AssetArchive::~AssetArchive() {
+    Close();
+}
+
+bool AssetArchive::Open(const std::string& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    mappedData = static_cast<const uint8_t*>(view);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(ArchiveHeader))) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    fileDescriptor = fd;
+    mappedSize = static_cast<size_t>(fileStat.st_size);
+    mappedData = static_cast<const uint8_t*>(view);
+#endif
+
+    header = reinterpret_cast<const ArchiveHeader*>(mappedData);
+    if (mappedSize < sizeof(ArchiveHeader) ||
+        std::memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+        header->version != VERSION ||
+        header->fileSize != mappedSize ||
+        (header->tableCapacity & (header->tableCapacity - 1)) != 0 ||
+        header->tableOffset + static_cast<uint64_t>(header->tableCapacity) * sizeof(ArchiveEntry) > mappedSize ||
+        header->namesOffset + header->namesSize > mappedSize) {
+        std::cerr << "invalid asset archive: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    table = reinterpret_cast<const ArchiveEntry*>(mappedData + header->tableOffset);
+    names = reinterpret_cast<const char*>(mappedData + header->namesOffset);
+
+    // Find、GetName与GetStoredData直接读取映射内存，挂载时确认每个槽位的名称和负载都在范围内
+    for (uint32_t slot = 0; slot < header->tableCapacity; slot++) {
+        const ArchiveEntry& entry = table[slot];
+        if (entry.nameHash == 0) continue;
+        if (static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > header->namesSize) {
+            std::cerr << "invalid asset archive: " << path << " (name of slot " << slot << " out of range)" << std::endl;
+            Close();
+            return false;
+        }
+        if (!IsPayloadValid(entry, mappedSize)) {
+            std::cerr << "invalid asset archive: " << path << " (payload of slot " << slot << " out of range)" << std::endl;
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetArchive::Close() {
+    if (mappedData == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(mappedData);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+    ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+
+    mappedData = nullptr;
+    mappedSize = 0;
+    header = nullptr;
+    table = nullptr;
+    names = nullptr;
+}
+
+uint64_t AssetArchive::HashName(const std::string& name) {
+    // FNV-1a 64位，0保留给空槽位
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+const ArchiveEntry* AssetArchive::Find(const std::string& name) const {
+    if (table == nullptr || header->tableCapacity == 0) {
+        return nullptr;
+    }
+
+    uint64_t hash = HashName(name);
+    uint32_t mask = header->tableCapacity - 1;
+    uint32_t slot = static_cast<uint32_t>(hash) & mask;
+
+    // 线性探测直到遇到空槽位
+    for (uint32_t probe = 0; probe < header->tableCapacity; probe++) {
+        const ArchiveEntry& entry = table[slot];
+        if (entry.nameHash == 0) {
+            return nullptr;
+        }
+        if (entry.nameHash == hash && entry.nameLength == name.size() &&
+            std::memcmp(names + entry.nameOffset, name.data(), name.size()) == 0) {
+            return &entry;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+std::string AssetArchive::GetName(const ArchiveEntry& entry) const {
+    return std::string(names + entry.nameOffset, entry.nameLength);
+}
+
+uint32_t AssetArchive::GetEntryCount() const {
+    return header != nullptr ? header->entryCount : 0;
+}
+
+bool AssetArchive::Read(const ArchiveEntry& entry, void* dst, size_t dstSize) const {
+    if (dstSize < entry.size || !IsPayloadValid(entry, mappedSize)) {
+        return false;
+    }
+
+    if (entry.compression == AssetCompression::None) {
+        std::memcpy(dst, mappedData + entry.offset, entry.size);
+        return true;
+    }
+    return AssetCompressionCodec::Decompress(entry.compression, mappedData + entry.offset, entry.storedSize,
+                                             dst, entry.size);
+}
+
+bool AssetArchive::Read(const std::string& name, std::vector<char>& data) const {
+    const ArchiveEntry* entry = Find(name);
+    if (entry == nullptr) {
+        return false;
+    }
+    data.resize(entry->size);
+    return Read(*entry, data.data(), data.size());
+}
+
+void AssetArchiveWriter::AddEntry(const std::string& name, AssetType type, const void* data, size_t size,
+                                  AssetCompression compression, uint32_t alignment) {
+    PendingEntry entry;
+    entry.name = name;
+    entry.type = type;
+    entry.alignment = std::max(alignment, 16u);
+    entry.size = size;
+    entry.compression = AssetCompression::None;
+
+    // 压缩无收益时保存原始数据
+    if (compression != AssetCompression::None &&
+        AssetCompressionCodec::Compress(compression, data, size, entry.stored) &&
+        entry.stored.size() < size) {
+        entry.compression = compression;
+    } else {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        entry.stored.assign(bytes, bytes + size);
+    }
+
+    pending.push_back(std::move(entry));
+}
+
+bool AssetArchiveWriter::Write(const std::string& path) const {
+    uint32_t capacity = NextPowerOfTwo(std::max<uint32_t>(static_cast<uint32_t>(pending.size()) * 2, 16));
+    std::vector<ArchiveEntry> table(capacity);
+    std::memset(table.data(), 0, table.size() * sizeof(ArchiveEntry));
+
+    std::string namesBlob;
+    for (const auto& entry : pending) {
+        namesBlob += entry.name;
+    }
+
+    ArchiveHeader header{};
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.version = AssetArchive::VERSION;
+    header.entryCount = static_cast<uint32_t>(pending.size());
+    header.tableCapacity = capacity;
+    header.tableOffset = sizeof(ArchiveHeader);
+    header.namesOffset = header.tableOffset + static_cast<uint64_t>(capacity) * sizeof(ArchiveEntry);
+    header.namesSize = namesBlob.size();
+
+    uint64_t cursor = header.namesOffset + header.namesSize;
+    uint32_t nameOffset = 0;
+    std::vector<uint64_t> payloadOffsets;
+    for (const auto& entry : pending) {
+        cursor = AlignUp(cursor, entry.alignment);
+        payloadOffsets.push_back(cursor);
+
+        ArchiveEntry record{};
+        record.nameHash = AssetArchive::HashName(entry.name);
+        record.offset = cursor;
+        record.storedSize = entry.stored.size();
+        record.size = entry.size;
+        record.nameOffset = nameOffset;
+        record.nameLength = static_cast<uint32_t>(entry.name.size());
+        record.type = entry.type;
+        record.compression = entry.compression;
+
+        uint32_t slot = static_cast<uint32_t>(record.nameHash) & (capacity - 1);
+        while (table[slot].nameHash != 0) {
+            if (table[slot].nameHash == record.nameHash && table[slot].nameLength == record.nameLength &&
+                namesBlob.compare(table[slot].nameOffset, table[slot].nameLength, entry.name) == 0) {
+                std::cerr << "duplicate asset name in archive: " << entry.name << std::endl;
+                return false;
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+        table[slot] = record;
+
+        nameOffset += record.nameLength;
+        cursor += entry.stored.size();
+    }
+    header.fileSize = cursor;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "failed to create asset archive: " << path << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(ArchiveEntry));
+    file.write(namesBlob.data(), namesBlob.size());
+
+    uint64_t written = header.namesOffset + header.namesSize;
+    const char padding[256] = {};
+    for (size_t i = 0; i < pending.size(); i++) {
+        while (written < payloadOffsets[i]) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(sizeof(padding), payloadOffsets[i] - written));
+            file.write(padding, count);
+            written += count;
+        }
+        file.write(reinterpret_cast<const char*>(pending[i].stored.data()), pending[i].stored.size());
+        written += pending[i].stored.size();
+    }
+    return static_cast<bool>(file);
+}
+
+namespace AssetCompressionCodec {
+
+    bool IsAvailable(AssetCompression compression) {
+        switch (compression) {
+            case AssetCompression::None:
+            case AssetCompression::LZ4:
+                return true;
+            case AssetCompression::Zstd:
+#ifdef VGE_HAS_ZSTD
+                return true;
+#else
+                return false;
+#endif
+        }
+        return false;
+    }
+
+    bool Compress(AssetCompression compression, const void* src, size_t size, std::vector<uint8_t>& dst) {
+        switch (compression) {
+            case AssetCompression::None:
+                dst.assign(static_cast<const uint8_t*>(src), static_cast<const uint8_t*>(src) + size);
+                return true;
+            case AssetCompression::LZ4:
+                CompressLZ4(static_cast<const uint8_t*>(src), size, dst);
+                return true;
+            case AssetCompression::Zstd:
+#ifdef VGE_HAS_ZSTD
+            {
+                dst.resize(ZSTD_compressBound(size));
+                size_t result = ZSTD_compress(dst.data(), dst.size(), src, size, 19);
+                if (ZSTD_isError(result)) return false;
+                dst.resize(result);
+                return true;
+            }
+#else
+                return false;
+#endif
+        }
+        return false;
+    }
+
+    bool Decompress(AssetCompression compression, const void* src, size_t srcSize, void* dst, size_t dstSize) {
+        switch (compression) {
+            case AssetCompression::None:
+                if (srcSize != dstSize) return false;
+                std::memcpy(dst, src, dstSize);
+                return true;
+            case AssetCompression::LZ4:
+                return DecompressLZ4(static_cast<const uint8_t*>(src), srcSize, static_cast<uint8_t*>(dst), dstSize);
+            case AssetCompression::Zstd:
+#ifdef VGE_HAS_ZSTD
+            {
+                size_t result = ZSTD_decompress(dst, dstSize, src, srcSize);
+                return !ZSTD_isError(result) && result == dstSize;
+            }
+#else
+                std::cerr << "zstd-compressed asset but engine was built without zstd" << std::endl;
+                return false;
+#endif
+        }
+        return false;
+    }
+
+    namespace {
+        const size_t LZ4_MIN_MATCH = 4;
+        const size_t LZ4_LAST_LITERALS = 5;
+        const size_t LZ4_MF_LIMIT = 12;
+        const int LZ4_HASH_BITS = 14;
+
+        inline uint32_t Read32(const uint8_t* p) {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint32_t HashSequence(uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+        }
+
+        void WriteLength(std::vector<uint8_t>& dst, size_t length) {
+            while (length >= 255) {
+                dst.push_back(255);
+                length -= 255;
+            }
+            dst.push_back(static_cast<uint8_t>(length));
+        }
+
+        void EmitSequence(std::vector<uint8_t>& dst, const uint8_t* literals, size_t literalLength,
+                          size_t offset, size_t matchLength) {
+            size_t matchCode = matchLength >= LZ4_MIN_MATCH ? matchLength - LZ4_MIN_MATCH : 0;
+            uint8_t token = static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) |
+                                                 (matchLength > 0 ? std::min<size_t>(matchCode, 15) : 0));
+            dst.push_back(token);
+            if (literalLength >= 15) WriteLength(dst, literalLength - 15);
+            dst.insert(dst.end(), literals, literals + literalLength);
+
+            if (matchLength > 0) {
+                dst.push_back(static_cast<uint8_t>(offset & 0xFF));
+                dst.push_back(static_cast<uint8_t>(offset >> 8));
+                if (matchCode >= 15) WriteLength(dst, matchCode - 15);
+            }
+        }
+    }
+
+    size_t CompressLZ4(const uint8_t* src, size_t size, std::vector<uint8_t>& dst) {
+        dst.clear();
+        dst.reserve(size + size / 255 + 16);
+
+        std::vector<uint32_t> hashTable(1u << LZ4_HASH_BITS, 0xFFFFFFFFu);
+        size_t anchor = 0;
+        size_t position = 0;
+
+        if (size > LZ4_MF_LIMIT) {
+            const size_t matchStartLimit = size - LZ4_MF_LIMIT;
+            const size_t matchEndLimit = size - LZ4_LAST_LITERALS;
+
+            while (position < matchStartLimit) {
+                uint32_t sequence = Read32(src + position);
+                uint32_t hash = HashSequence(sequence);
+                uint32_t candidate = hashTable[hash];
+                hashTable[hash] = static_cast<uint32_t>(position);
+
+                if (candidate != 0xFFFFFFFFu && position - candidate <= 0xFFFF && Read32(src + candidate) == sequence) {
+                    size_t matchLength = LZ4_MIN_MATCH;
+                    while (position + matchLength < matchEndLimit && src[candidate + matchLength] == src[position + matchLength]) {
+                        matchLength++;
+                    }
+
+                    EmitSequence(dst, src + anchor, position - anchor, position - candidate, matchLength);
+                    position += matchLength;
+                    anchor = position;
+                } else {
+                    position++;
+                }
+            }
+        }
+
+        // 最后一段只有字面量
+        EmitSequence(dst, src + anchor, size - anchor, 0, 0);
+        return dst.size();
+    }
+
+    bool DecompressLZ4(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+        const uint8_t* ip = src;
+        const uint8_t* const ipEnd = src + srcSize;
+        uint8_t* op = dst;
+        uint8_t* const opEnd = dst + dstSize;
+
+        while (ip < ipEnd) {
+            uint8_t token = *ip++;
+
+            size_t literalLength = token >> 4;
+            if (literalLength == 15) {
+                uint8_t extra;
+                do {
+                    if (ip >= ipEnd) return false;
+                    extra = *ip++;
+                    literalLength += extra;
+                } while (extra == 255);
+            }
+            if (literalLength > static_cast<size_t>(ipEnd - ip) || literalLength > static_cast<size_t>(opEnd - op)) {
+                return false;
+            }
+            std::memcpy(op, ip, literalLength);
+            ip += literalLength;
+            op += literalLength;
+
+            if (ip >= ipEnd) break;
+
+            if (ipEnd - ip < 2) return false;
+            size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+            size_t matchLength = token & 0xF;
+            if (matchLength == 15) {
+                uint8_t extra;
+                do {
+                    if (ip >= ipEnd) return false;
+                    extra = *ip++;
+                    matchLength += extra;
+                } while (extra == 255);
+            }
+            matchLength += LZ4_MIN_MATCH;
+            if (matchLength > static_cast<size_t>(opEnd - op)) return false;
+
+            // 重叠拷贝需逐字节进行
+            const uint8_t* match = op - offset;
+            for (size_t i = 0; i < matchLength; i++) {
+                op[i] = match[i];
+            }
+            op += matchLength;
+        }
+        return op == opEnd;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 打包资源档案：头部 + 名称哈希开放寻址表 + 对齐的负载数据
+// 运行时整体映射到内存，按名称O(1)查找，负载直接从映射拷贝到暂存内存
+
+enum class AssetType : uint8_t {
+    Raw = 0,
+    Mesh = 1,
+    Texture = 2,
+    Shader = 3,
+    Pipeline = 4,
+};
+
+enum class AssetCompression : uint8_t {
+    None = 0,
+    LZ4 = 1,
+    Zstd = 2,
+};
+
+#pragma pack(push, 1)
+struct ArchiveHeader {
+    char magic[4];              // "VGEA"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t tableCapacity;     // 2的幂
+    uint64_t tableOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+    uint64_t fileSize;
+};
+
+struct ArchiveEntry {
+    uint64_t nameHash;          // 0表示空槽位
+    uint64_t offset;            // 相对文件开头
+    uint64_t storedSize;
+    uint64_t size;              // 解压后大小
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    AssetType type;
+    AssetCompression compression;
+    uint16_t reserved;
+    uint32_t reserved2;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ArchiveHeader) == 48, "ArchiveHeader layout mismatch");
+static_assert(sizeof(ArchiveEntry) == 48, "ArchiveEntry layout mismatch");
+
+class AssetArchive {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t DEFAULT_ALIGNMENT = 256;
+
+    AssetArchive();
+    ~AssetArchive();
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return mappedData != nullptr; }
+
+    // O(1)名称查找，未找到返回nullptr
+    const ArchiveEntry* Find(const std::string& name) const;
+    std::string GetName(const ArchiveEntry& entry) const;
+    uint32_t GetEntryCount() const;
+
+    // 映射中的原始（可能压缩的）负载，Open已确认其位于映射内；未压缩时长度为entry.size
+    const uint8_t* GetStoredData(const ArchiveEntry& entry) const { return mappedData + entry.offset; }
+
+    // 将负载解压/拷贝到dst（通常是暂存缓冲区的映射地址），dstSize需不小于entry.size
+    bool Read(const ArchiveEntry& entry, void* dst, size_t dstSize) const;
+    bool Read(const std::string& name, std::vector<char>& data) const;
+
+    static uint64_t HashName(const std::string& name);
+
+private:
+    const uint8_t* mappedData = nullptr;
+    size_t mappedSize = 0;
+    const ArchiveHeader* header = nullptr;
+    const ArchiveEntry* table = nullptr;
+    const char* names = nullptr;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+};
+
+// 构建档案（资源烘焙工具使用）
+class AssetArchiveWriter {
+public:
+    void AddEntry(const std::string& name, AssetType type, const void* data, size_t size,
+                  AssetCompression compression = AssetCompression::None,
+                  uint32_t alignment = AssetArchive::DEFAULT_ALIGNMENT);
+    bool Write(const std::string& path) const;
+    size_t GetEntryCount() const { return pending.size(); }
+
+private:
+    struct PendingEntry {
+        std::string name;
+        AssetType type;
+        AssetCompression compression;
+        uint32_t alignment;
+        uint64_t size;
+        std::vector<uint8_t> stored;
+    };
+    std::vector<PendingEntry> pending;
+};
+
+// 负载压缩编解码：LZ4块格式内置实现，zstd在找到libzstd时可用
+namespace AssetCompressionCodec {
+    bool Compress(AssetCompression compression, const void* src, size_t size, std::vector<uint8_t>& dst);
+    bool Decompress(AssetCompression compression, const void* src, size_t srcSize, void* dst, size_t dstSize);
+    bool IsAvailable(AssetCompression compression);
+
+    size_t CompressLZ4(const uint8_t* src, size_t size, std::vector<uint8_t>& dst);
+    bool DecompressLZ4(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+}
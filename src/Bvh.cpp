@@ -0,0 +1,474 @@
+#include "Bvh.hpp"
+#include "FrameAllocator.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <numeric>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VGE_BVH_AVX 1
+#define VGE_BVH_SSE 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define VGE_BVH_SSE 1
+#endif
+
+namespace {
+    const uint32_t LEAF_BIT = 0x80000000u;
+    const uint32_t EMPTY_CHILD = 0xFFFFFFFFu;
+    const uint32_t NO_PARENT = 0xFFFFFFFFu;
+
+    // 空槽位使用反向的有限大包围盒，任何平面测试都在外侧（避免0*inf产生NaN）
+    const float EMPTY_MIN = 1e30f;
+    const float EMPTY_MAX = -1e30f;
+
+    // 项目数超过该值时多线程遍历
+    const uint32_t PARALLEL_THRESHOLD = 4096;
+
+    // 测试4个盒子，返回与视锥相交的位掩码，insideMask为完全在视锥内的位掩码
+    int TestBoxes4(const float* minX, const float* minY, const float* minZ,
+                   const float* maxX, const float* maxY, const float* maxZ,
+                   const Frustum& frustum, int& insideMask) {
+#if defined(VGE_BVH_SSE)
+        __m128 boxMinX = _mm_loadu_ps(minX), boxMinY = _mm_loadu_ps(minY), boxMinZ = _mm_loadu_ps(minZ);
+        __m128 boxMaxX = _mm_loadu_ps(maxX), boxMaxY = _mm_loadu_ps(maxY), boxMaxZ = _mm_loadu_ps(maxZ);
+        __m128 zero = _mm_setzero_ps();
+        __m128 outside = zero;
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+        for (const auto& plane : frustum.planes) {
+            __m128 a = _mm_set1_ps(plane[0]), b = _mm_set1_ps(plane[1]), c = _mm_set1_ps(plane[2]), d = _mm_set1_ps(plane[3]);
+            // 正顶点（沿法线最远的角）在外侧则整个盒子在外侧
+            __m128 px = plane[0] >= 0.0f ? boxMaxX : boxMinX;
+            __m128 py = plane[1] >= 0.0f ? boxMaxY : boxMinY;
+            __m128 pz = plane[2] >= 0.0f ? boxMaxZ : boxMinZ;
+            __m128 nx = plane[0] >= 0.0f ? boxMinX : boxMaxX;
+            __m128 ny = plane[1] >= 0.0f ? boxMinY : boxMaxY;
+            __m128 nz = plane[2] >= 0.0f ? boxMinZ : boxMaxZ;
+            __m128 positive = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, px), _mm_mul_ps(b, py)), _mm_add_ps(_mm_mul_ps(c, pz), d));
+            __m128 negative = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, nx), _mm_mul_ps(b, ny)), _mm_add_ps(_mm_mul_ps(c, nz), d));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(positive, zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(negative, zero));
+        }
+
+        int visibleMask = ~_mm_movemask_ps(outside) & 0xF;
+        insideMask = _mm_movemask_ps(inside) & visibleMask;
+        return visibleMask;
+#else
+        int visibleMask = 0;
+        insideMask = 0;
+        for (int i = 0; i < 4; i++) {
+            bool isOutside = false;
+            bool isInside = true;
+            for (const auto& plane : frustum.planes) {
+                float positive = plane[0] * (plane[0] >= 0.0f ? maxX[i] : minX[i]) +
+                                 plane[1] * (plane[1] >= 0.0f ? maxY[i] : minY[i]) +
+                                 plane[2] * (plane[2] >= 0.0f ? maxZ[i] : minZ[i]) + plane[3];
+                float negative = plane[0] * (plane[0] >= 0.0f ? minX[i] : maxX[i]) +
+                                 plane[1] * (plane[1] >= 0.0f ? minY[i] : maxY[i]) +
+                                 plane[2] * (plane[2] >= 0.0f ? minZ[i] : maxZ[i]) + plane[3];
+                isOutside = isOutside || positive < 0.0f;
+                isInside = isInside && negative >= 0.0f;
+            }
+            if (!isOutside) {
+                visibleMask |= 1 << i;
+                if (isInside) insideMask |= 1 << i;
+            }
+        }
+        return visibleMask;
+#endif
+    }
+
+    // 测试8个盒子（叶子），只需要相交掩码
+    int TestBoxes8(const float* minX, const float* minY, const float* minZ,
+                   const float* maxX, const float* maxY, const float* maxZ,
+                   const Frustum& frustum) {
+#if defined(VGE_BVH_AVX)
+        __m256 boxMinX = _mm256_loadu_ps(minX), boxMinY = _mm256_loadu_ps(minY), boxMinZ = _mm256_loadu_ps(minZ);
+        __m256 boxMaxX = _mm256_loadu_ps(maxX), boxMaxY = _mm256_loadu_ps(maxY), boxMaxZ = _mm256_loadu_ps(maxZ);
+        __m256 zero = _mm256_setzero_ps();
+        __m256 outside = zero;
+
+        for (const auto& plane : frustum.planes) {
+            __m256 px = plane[0] >= 0.0f ? boxMaxX : boxMinX;
+            __m256 py = plane[1] >= 0.0f ? boxMaxY : boxMinY;
+            __m256 pz = plane[2] >= 0.0f ? boxMaxZ : boxMinZ;
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[0]), px), _mm256_mul_ps(_mm256_set1_ps(plane[1]), py)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane[2]), pz), _mm256_set1_ps(plane[3])));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, zero, _CMP_LT_OQ));
+        }
+        return ~_mm256_movemask_ps(outside) & 0xFF;
+#else
+        int insideLow = 0;
+        int insideHigh = 0;
+        int low = TestBoxes4(minX, minY, minZ, maxX, maxY, maxZ, frustum, insideLow);
+        int high = TestBoxes4(minX + 4, minY + 4, minZ + 4, maxX + 4, maxY + 4, maxZ + 4, frustum, insideHigh);
+        return low | (high << 4);
+#endif
+    }
+
+    int CountTrailingZeros(uint32_t value) {
+        int count = 0;
+        while ((value & 1u) == 0) {
+            value >>= 1;
+            count++;
+        }
+        return count;
+    }
+}
+
+void Bvh::Clear() {
+    nodes.clear();
+    leaves.clear();
+    slotMinX.clear();
+    slotMinY.clear();
+    slotMinZ.clear();
+    slotMaxX.clear();
+    slotMaxY.clear();
+    slotMaxZ.clear();
+    slotItems.clear();
+    itemSlots.clear();
+    leafDirty.clear();
+    nodeDirty.clear();
+    anyDirty = false;
+    itemCount = 0;
+    buildCost = 0.0f;
+    currentCost = 0.0f;
+}
+
+void Bvh::Build(const uint32_t* itemIds, const AABB* itemBounds, uint32_t count) {
+    Clear();
+    itemCount = count;
+    if (count == 0) return;
+
+    std::vector<Vec3> centroids(count);
+    uint32_t maxId = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        centroids[i] = Vec3{(itemBounds[i].min.x + itemBounds[i].max.x) * 0.5f,
+                            (itemBounds[i].min.y + itemBounds[i].max.y) * 0.5f,
+                            (itemBounds[i].min.z + itemBounds[i].max.z) * 0.5f};
+        maxId = std::max(maxId, itemIds[i]);
+    }
+    itemSlots.assign(static_cast<size_t>(maxId) + 1, EMPTY_CHILD);
+
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    nodes.reserve(count / LEAF_SIZE + 1);
+    BuildNode(order, 0, count, itemIds, itemBounds, centroids, NO_PARENT, 0);
+
+    leafDirty.assign(leaves.size(), 0);
+    nodeDirty.assign(nodes.size(), 0);
+    buildCost = ComputeCost();
+    currentCost = buildCost;
+}
+
+uint32_t Bvh::BuildNode(std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                        const uint32_t* itemIds, const AABB* itemBounds, const std::vector<Vec3>& centroids,
+                        uint32_t parent, uint32_t parentSlot) {
+    uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes[nodeIndex].parent = parent;
+    nodes[nodeIndex].parentSlot = parentSlot;
+
+    // 反复沿质心范围最大的轴在中位数处切分最大的组，直到得到4组
+    std::vector<std::pair<uint32_t, uint32_t>> groups = {{begin, end}};
+    while (groups.size() < 4) {
+        size_t largest = 0;
+        for (size_t g = 1; g < groups.size(); g++) {
+            if (groups[g].second - groups[g].first > groups[largest].second - groups[largest].first) {
+                largest = g;
+            }
+        }
+        uint32_t groupBegin = groups[largest].first;
+        uint32_t groupEnd = groups[largest].second;
+        if (groupEnd - groupBegin <= LEAF_SIZE) break;
+
+        Vec3 low{1e30f, 1e30f, 1e30f};
+        Vec3 high{-1e30f, -1e30f, -1e30f};
+        for (uint32_t i = groupBegin; i < groupEnd; i++) {
+            const Vec3& c = centroids[order[i]];
+            low = Vec3{std::min(low.x, c.x), std::min(low.y, c.y), std::min(low.z, c.z)};
+            high = Vec3{std::max(high.x, c.x), std::max(high.y, c.y), std::max(high.z, c.z)};
+        }
+        float extentX = high.x - low.x, extentY = high.y - low.y, extentZ = high.z - low.z;
+        int axis = extentX >= extentY && extentX >= extentZ ? 0 : (extentY >= extentZ ? 1 : 2);
+
+        uint32_t middle = groupBegin + (groupEnd - groupBegin) / 2;
+        std::nth_element(order.begin() + groupBegin, order.begin() + middle, order.begin() + groupEnd,
+                         [&centroids, axis](uint32_t a, uint32_t b) {
+                             const Vec3& ca = centroids[a];
+                             const Vec3& cb = centroids[b];
+                             return axis == 0 ? ca.x < cb.x : (axis == 1 ? ca.y < cb.y : ca.z < cb.z);
+                         });
+        groups[largest] = {groupBegin, middle};
+        groups.insert(groups.begin() + largest + 1, {middle, groupEnd});
+    }
+
+    for (uint32_t slot = 0; slot < 4; slot++) {
+        if (slot >= groups.size()) {
+            nodes[nodeIndex].children[slot] = EMPTY_CHILD;
+            SetChildBounds(nodeIndex, slot, AABB{});
+            continue;
+        }
+
+        uint32_t groupBegin = groups[slot].first;
+        uint32_t groupEnd = groups[slot].second;
+        uint32_t child;
+        AABB bounds;
+        if (groupEnd - groupBegin <= LEAF_SIZE) {
+            uint32_t leaf = BuildLeaf(order, groupBegin, groupEnd, itemIds, itemBounds, nodeIndex, slot);
+            child = LEAF_BIT | leaf;
+            bounds = ComputeLeafBounds(leaf);
+        } else {
+            uint32_t childNode = BuildNode(order, groupBegin, groupEnd, itemIds, itemBounds, centroids, nodeIndex, slot);
+            child = childNode;
+            bounds = ComputeNodeBounds(childNode);
+        }
+        nodes[nodeIndex].children[slot] = child;
+        SetChildBounds(nodeIndex, slot, bounds);
+    }
+    return nodeIndex;
+}
+
+uint32_t Bvh::BuildLeaf(const std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                        const uint32_t* itemIds, const AABB* itemBounds, uint32_t parent, uint32_t parentSlot) {
+    uint32_t leafIndex = static_cast<uint32_t>(leaves.size());
+    Leaf leaf;
+    leaf.first = static_cast<uint32_t>(slotItems.size());
+    leaf.count = end - begin;
+    leaf.parent = parent;
+    leaf.parentSlot = parentSlot;
+    leaves.push_back(leaf);
+
+    for (uint32_t i = 0; i < LEAF_SIZE; i++) {
+        if (begin + i < end) {
+            uint32_t item = order[begin + i];
+            const AABB& bounds = itemBounds[item];
+            itemSlots[itemIds[item]] = static_cast<uint32_t>(slotItems.size());
+            slotItems.push_back(itemIds[item]);
+            slotMinX.push_back(bounds.min.x);
+            slotMinY.push_back(bounds.min.y);
+            slotMinZ.push_back(bounds.min.z);
+            slotMaxX.push_back(bounds.max.x);
+            slotMaxY.push_back(bounds.max.y);
+            slotMaxZ.push_back(bounds.max.z);
+        } else {
+            slotItems.push_back(EMPTY_CHILD);
+            slotMinX.push_back(EMPTY_MIN);
+            slotMinY.push_back(EMPTY_MIN);
+            slotMinZ.push_back(EMPTY_MIN);
+            slotMaxX.push_back(EMPTY_MAX);
+            slotMaxY.push_back(EMPTY_MAX);
+            slotMaxZ.push_back(EMPTY_MAX);
+        }
+    }
+    return leafIndex;
+}
+
+AABB Bvh::ComputeLeafBounds(uint32_t leaf) const {
+    AABB bounds;
+    const Leaf& entry = leaves[leaf];
+    for (uint32_t i = entry.first; i < entry.first + entry.count; i++) {
+        AABB item;
+        item.min = Vec3{slotMinX[i], slotMinY[i], slotMinZ[i]};
+        item.max = Vec3{slotMaxX[i], slotMaxY[i], slotMaxZ[i]};
+        bounds.Expand(item);
+    }
+    return bounds;
+}
+
+AABB Bvh::ComputeNodeBounds(uint32_t node) const {
+    AABB bounds;
+    const Node& entry = nodes[node];
+    for (uint32_t slot = 0; slot < 4; slot++) {
+        if (entry.children[slot] == EMPTY_CHILD) continue;
+        AABB child;
+        child.min = Vec3{entry.minX[slot], entry.minY[slot], entry.minZ[slot]};
+        child.max = Vec3{entry.maxX[slot], entry.maxY[slot], entry.maxZ[slot]};
+        bounds.Expand(child);
+    }
+    return bounds;
+}
+
+void Bvh::SetChildBounds(uint32_t node, uint32_t slot, const AABB& bounds) {
+    Node& entry = nodes[node];
+    bool valid = bounds.IsValid();
+    entry.minX[slot] = valid ? bounds.min.x : EMPTY_MIN;
+    entry.minY[slot] = valid ? bounds.min.y : EMPTY_MIN;
+    entry.minZ[slot] = valid ? bounds.min.z : EMPTY_MIN;
+    entry.maxX[slot] = valid ? bounds.max.x : EMPTY_MAX;
+    entry.maxY[slot] = valid ? bounds.max.y : EMPTY_MAX;
+    entry.maxZ[slot] = valid ? bounds.max.z : EMPTY_MAX;
+}
+
+float Bvh::ComputeCost() const {
+    // 所有子包围盒表面积之和，近似遍历代价
+    float cost = 0.0f;
+    for (uint32_t node = 0; node < nodes.size(); node++) {
+        for (uint32_t slot = 0; slot < 4; slot++) {
+            if (nodes[node].children[slot] == EMPTY_CHILD) continue;
+            AABB child;
+            child.min = Vec3{nodes[node].minX[slot], nodes[node].minY[slot], nodes[node].minZ[slot]};
+            child.max = Vec3{nodes[node].maxX[slot], nodes[node].maxY[slot], nodes[node].maxZ[slot]};
+            cost += child.SurfaceArea();
+        }
+    }
+    return cost;
+}
+
+AABB Bvh::GetBounds() const {
+    return nodes.empty() ? AABB{} : ComputeNodeBounds(0);
+}
+
+void Bvh::UpdateItem(uint32_t itemId, const AABB& bounds) {
+    if (itemId >= itemSlots.size() || itemSlots[itemId] == EMPTY_CHILD) return;
+    uint32_t slot = itemSlots[itemId];
+    slotMinX[slot] = bounds.min.x;
+    slotMinY[slot] = bounds.min.y;
+    slotMinZ[slot] = bounds.min.z;
+    slotMaxX[slot] = bounds.max.x;
+    slotMaxY[slot] = bounds.max.y;
+    slotMaxZ[slot] = bounds.max.z;
+    leafDirty[slot / LEAF_SIZE] = 1;
+    anyDirty = true;
+}
+
+void Bvh::Refit() {
+    if (!anyDirty) return;
+
+    for (uint32_t leaf = 0; leaf < leaves.size(); leaf++) {
+        if (!leafDirty[leaf]) continue;
+        leafDirty[leaf] = 0;
+        SetChildBounds(leaves[leaf].parent, leaves[leaf].parentSlot, ComputeLeafBounds(leaf));
+        nodeDirty[leaves[leaf].parent] = 1;
+    }
+
+    // 子节点的索引总是大于父节点，倒序遍历即为自底向上
+    for (uint32_t node = static_cast<uint32_t>(nodes.size()); node-- > 0;) {
+        if (!nodeDirty[node]) continue;
+        nodeDirty[node] = 0;
+        uint32_t parent = nodes[node].parent;
+        if (parent != NO_PARENT) {
+            SetChildBounds(parent, nodes[node].parentSlot, ComputeNodeBounds(node));
+            nodeDirty[parent] = 1;
+        }
+    }
+
+    anyDirty = false;
+    currentCost = ComputeCost();
+}
+
+void Bvh::Cull(const Frustum& frustum, std::vector<uint32_t>& visible, JobSystem* jobSystem) const {
+    visible.clear();
+    if (nodes.empty()) return;
+
+    if (jobSystem == nullptr || jobSystem->GetWorkerCount() == 0 || itemCount < PARALLEL_THRESHOLD) {
+        CullChild(frustum, 0, false, visible);
+        return;
+    }
+
+    // 逐层展开上层节点，得到足够多的子树任务后分给工作线程；
+    // 任务保持树中的顺序，合并后的结果与单线程一致
+    // 任务列表是本帧的临时数据，取自渲染线程的帧线性区
+    uint32_t targetTasks = (jobSystem->GetWorkerCount() + 1) * 4;
+    std::pmr::memory_resource* frameMemory = FrameAllocator::GetResource();
+    std::pmr::vector<Task> tasks(frameMemory);
+    std::pmr::vector<Task> next(frameMemory);
+    tasks.push_back({0, false});
+    bool expanded = true;
+    while (tasks.size() < targetTasks && expanded) {
+        expanded = false;
+        next.clear();
+        next.reserve(tasks.size() * 4);
+        for (const Task& task : tasks) {
+            if ((task.child & LEAF_BIT) || task.fullyInside) {
+                next.push_back(task);
+                continue;
+            }
+            const Node& node = nodes[task.child];
+            int insideMask = 0;
+            int visibleMask = TestBoxes4(node.minX, node.minY, node.minZ, node.maxX, node.maxY, node.maxZ, frustum, insideMask);
+            for (uint32_t slot = 0; slot < 4; slot++) {
+                if (visibleMask & (1 << slot)) {
+                    next.push_back({node.children[slot], (insideMask & (1 << slot)) != 0});
+                }
+            }
+            expanded = true;
+        }
+        tasks.swap(next);
+    }
+
+    // 各任务的结果数组跨帧保留容量，稳定后遍历不再分配
+    std::vector<std::vector<uint32_t>>& results = taskResults;
+    if (results.size() < tasks.size()) {
+        results.resize(tasks.size());
+    }
+    for (size_t i = 0; i < tasks.size(); i++) {
+        results[i].clear();
+    }
+    jobSystem->ParallelFor(static_cast<uint32_t>(tasks.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const Task& task = tasks[i];
+            if (task.fullyInside) {
+                AppendSubtree(task.child, results[i]);
+            } else if (task.child & LEAF_BIT) {
+                CullLeaf(frustum, task.child & ~LEAF_BIT, results[i]);
+            } else {
+                CullChild(frustum, task.child, false, results[i]);
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (size_t i = 0; i < tasks.size(); i++) total += results[i].size();
+    visible.reserve(total);
+    for (size_t i = 0; i < tasks.size(); i++) {
+        visible.insert(visible.end(), results[i].begin(), results[i].end());
+    }
+}
+
+void Bvh::CullChild(const Frustum& frustum, uint32_t child, bool fullyInside, std::vector<uint32_t>& visible) const {
+    if (fullyInside) {
+        AppendSubtree(child, visible);
+        return;
+    }
+    if (child & LEAF_BIT) {
+        CullLeaf(frustum, child & ~LEAF_BIT, visible);
+        return;
+    }
+
+    const Node& node = nodes[child];
+    int insideMask = 0;
+    int visibleMask = TestBoxes4(node.minX, node.minY, node.minZ, node.maxX, node.maxY, node.maxZ, frustum, insideMask);
+    while (visibleMask != 0) {
+        int slot = CountTrailingZeros(static_cast<uint32_t>(visibleMask));
+        visibleMask &= visibleMask - 1;
+        CullChild(frustum, node.children[slot], (insideMask & (1 << slot)) != 0, visible);
+    }
+}
+
+void Bvh::AppendSubtree(uint32_t child, std::vector<uint32_t>& visible) const {
+    // 完全在视锥内的子树不再测试
+    if (child & LEAF_BIT) {
+        const Leaf& leaf = leaves[child & ~LEAF_BIT];
+        visible.insert(visible.end(), slotItems.begin() + leaf.first, slotItems.begin() + leaf.first + leaf.count);
+        return;
+    }
+    for (uint32_t grandchild : nodes[child].children) {
+        if (grandchild != EMPTY_CHILD) {
+            AppendSubtree(grandchild, visible);
+        }
+    }
+}
+
+void Bvh::CullLeaf(const Frustum& frustum, uint32_t leaf, std::vector<uint32_t>& visible) const {
+    uint32_t first = leaves[leaf].first;
+    int mask = TestBoxes8(&slotMinX[first], &slotMinY[first], &slotMinZ[first],
+                          &slotMaxX[first], &slotMaxY[first], &slotMaxZ[first], frustum);
+    while (mask != 0) {
+        int slot = CountTrailingZeros(static_cast<uint32_t>(mask));
+        mask &= mask - 1;
+        visible.push_back(slotItems[first + slot]);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "MathTypes.hpp"
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// 4叉包围体层次结构，用于CPU视锥剔除
+// 内部节点以SoA存放4个子包围盒，一条SSE指令测试4个盒子；
+// 叶子最多8个项目，AVX下一次测试8个盒子
+class Bvh {
+public:
+    static const uint32_t LEAF_SIZE = 8;
+
+    void Build(const uint32_t* itemIds, const AABB* itemBounds, uint32_t count);
+    void Clear();
+
+    // 更新项目包围盒，Refit时向上传播
+    void UpdateItem(uint32_t itemId, const AABB& bounds);
+    void Refit();
+
+    // 多次refit后质量下降（节点总面积相比构建时增长过多）时建议重建
+    bool NeedsRebuild() const { return currentCost > buildCost * REBUILD_COST_RATIO; }
+
+    // 输出与视锥相交的项目id，jobSystem非空且项目较多时多线程遍历（同一实例不能并发调用）
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible, JobSystem* jobSystem = nullptr) const;
+
+    uint32_t GetItemCount() const { return itemCount; }
+    uint32_t GetNodeCount() const { return static_cast<uint32_t>(nodes.size()); }
+    AABB GetBounds() const;
+
+private:
+    static constexpr float REBUILD_COST_RATIO = 1.5f;
+
+    struct alignas(16) Node {
+        float minX[4];
+        float minY[4];
+        float minZ[4];
+        float maxX[4];
+        float maxY[4];
+        float maxZ[4];
+        uint32_t children[4];       // 内部节点索引，或LEAF_BIT|叶子索引，或EMPTY_CHILD
+        uint32_t parent;
+        uint32_t parentSlot;
+    };
+
+    struct Leaf {
+        uint32_t first;             // 在slot数组中的起始位置（LEAF_SIZE对齐）
+        uint32_t count;
+        uint32_t parent;
+        uint32_t parentSlot;
+    };
+
+    struct Task {
+        uint32_t child;
+        bool fullyInside;
+    };
+
+    uint32_t BuildNode(std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                       const uint32_t* itemIds, const AABB* itemBounds, const std::vector<Vec3>& centroids,
+                       uint32_t parent, uint32_t parentSlot);
+    uint32_t BuildLeaf(const std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                       const uint32_t* itemIds, const AABB* itemBounds, uint32_t parent, uint32_t parentSlot);
+    AABB ComputeLeafBounds(uint32_t leaf) const;
+    AABB ComputeNodeBounds(uint32_t node) const;
+    void SetChildBounds(uint32_t node, uint32_t slot, const AABB& bounds);
+    float ComputeCost() const;
+
+    void CullChild(const Frustum& frustum, uint32_t child, bool fullyInside, std::vector<uint32_t>& visible) const;
+    void AppendSubtree(uint32_t child, std::vector<uint32_t>& visible) const;
+    void CullLeaf(const Frustum& frustum, uint32_t leaf, std::vector<uint32_t>& visible) const;
+
+    std::vector<Node> nodes;
+    std::vector<Leaf> leaves;
+
+    // 叶子项目槽位（SoA），每个叶子占LEAF_SIZE个，空槽位为反向包围盒
+    std::vector<float> slotMinX, slotMinY, slotMinZ;
+    std::vector<float> slotMaxX, slotMaxY, slotMaxZ;
+    std::vector<uint32_t> slotItems;
+
+    std::vector<uint32_t> itemSlots;        // 项目id -> 槽位
+    std::vector<uint8_t> leafDirty;
+    std::vector<uint8_t> nodeDirty;
+    bool anyDirty = false;
+
+    // 多线程遍历时各子树任务的输出，跨帧复用
+    mutable std::vector<std::vector<uint32_t>> taskResults;
+
+    uint32_t itemCount = 0;
+    float buildCost = 0.0f;
+    float currentCost = 0.0f;
+};
@@ -1,5 +1,6 @@
 #include "CommandManager.hpp"
 #include "VulkanContext.hpp"
+#include "Metrics.hpp"
 #include <stdexcept>
 
 CommandManager::CommandManager(VulkanContext* context) : context(context) {}
@@ -16,7 +17,7 @@ bool CommandManager::Initialize() {
 
 void CommandManager::Cleanup() {
     if (commandPool != VK_NULL_HANDLE) {
-        vkDestroyCommandPool(context->GetDevice(), commandPool, nullptr);
+        vkDestroyCommandPool(context->GetDevice(), commandPool, context->GetAllocationCallbacks());
         commandPool = VK_NULL_HANDLE;
     }
     commandBuffers.clear();
@@ -28,7 +29,7 @@ bool CommandManager::CreateCommandPool() {
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     poolInfo.queueFamilyIndex = context->GetGraphicsQueueFamily();
     
-    if (vkCreateCommandPool(context->GetDevice(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+    if (vkCreateCommandPool(context->GetDevice(), &poolInfo, context->GetAllocationCallbacks(), &commandPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create command pool!");
     }
     return true;
@@ -76,6 +77,7 @@ void CommandManager::EndSingleTimeCommands(VkCommandBuffer commandBuffer) {
     submitInfo.pCommandBuffers = &commandBuffer;
     
     vkQueueSubmit(context->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    context->GetMetrics()->Add(Metrics::COMMAND_BUFFER_SUBMITS);
     vkQueueWaitIdle(context->GetGraphicsQueue());
     
     vkFreeCommandBuffers(context->GetDevice(), commandPool, 1, &commandBuffer);
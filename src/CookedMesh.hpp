@@ -0,0 +1,50 @@
+#pragma once
+#include "VertexFormat.hpp"
+#include <cstdint>
+
+// vge_cook输出的网格格式：头部 + LOD表 + 顶点数组 + 索引数组
+// 所有LOD共享同一顶点数组，各级索引依次排列（LOD 0最精细）
+// 顶点按CookedVertexLayout量化，可直接作为顶点缓冲绑定，解码参数由头部的包围盒与UV范围得到
+// （CookedVertexLayout::ComputeDequantization，着色器见shaders/vertex_decode.glsl）
+
+#pragma pack(push, 1)
+struct CookedMeshHeader {
+    char magic[4];              // "VGEM"
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t vertexStride;
+    uint32_t indexSize;         // 2或4字节
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t lodCount;
+    uint32_t vertexLayout;      // CookedVertexLayout::GetSignature()
+    float uvMin[2];             // UV范围（UNORM16X2的解码范围）
+    float uvMax[2];
+    uint32_t reserved[2];
+};
+
+struct CookedMeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;                // 相对LOD 0的对象空间几何误差（距离）
+    uint32_t reserved;
+};
+#pragma pack(pop)
+
+// 烘焙顶点：20字节，同样属性全部使用float时为48字节
+//   position  SNORM16X4   相对包围盒中心按半尺寸归一化，w为0
+//   normal    OCT16       八面体编码
+//   tangent   OCT16_SIGN  八面体编码 + 副切线符号
+//   uv        UNORM16X2   在网格UV范围内归一化
+using CookedVertexLayout = VertexLayoutDesc<VertexAttribute<VERTEX_SEMANTIC_POSITION, VERTEX_FORMAT_SNORM16X4>,
+                                            VertexAttribute<VERTEX_SEMANTIC_NORMAL, VERTEX_FORMAT_OCT16>,
+                                            VertexAttribute<VERTEX_SEMANTIC_TANGENT, VERTEX_FORMAT_OCT16_SIGN>,
+                                            VertexAttribute<VERTEX_SEMANTIC_UV, VERTEX_FORMAT_UNORM16X2>>;
+
+static_assert(sizeof(CookedMeshHeader) == 80, "CookedMeshHeader layout mismatch");
+static_assert(sizeof(CookedMeshLod) == 16, "CookedMeshLod layout mismatch");
+static_assert(CookedVertexLayout::STRIDE == 20, "CookedVertexLayout stride mismatch");
+
+const uint32_t COOKED_MESH_VERSION = 3;
+const uint32_t COOKED_MESH_MAX_LODS = 8;
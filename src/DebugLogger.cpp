@@ -0,0 +1,226 @@
+#include "DebugLogger.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+    const char* SeverityName(VkDebugUtilsMessageSeverityFlagBitsEXT severity) {
+        switch (severity) {
+            case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT: return "ERROR";
+            case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT: return "WARNING";
+            case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT: return "INFO";
+            default: return "VERBOSE";
+        }
+    }
+
+    const char* TypeName(VkDebugUtilsMessageTypeFlagsEXT type) {
+        if (type & VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT) return "validation";
+        if (type & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) return "performance";
+        return "general";
+    }
+
+    // FNV-1a，消息ID一并参与，避免不同ID的同文本消息被合并
+    uint64_t HashMessage(int32_t messageId, const char* text) {
+        uint64_t hash = 1469598103934665603ull ^ static_cast<uint32_t>(messageId);
+        for (; *text != '\0'; text++) {
+            hash ^= static_cast<unsigned char>(*text);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+DebugLogger::DebugLogger() {
+    for (uint32_t i = 0; i < QUEUE_CAPACITY; i++) {
+        entries[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+DebugLogger::~DebugLogger() {
+    Cleanup();
+}
+
+bool DebugLogger::Initialize(const Settings& loggerSettings) {
+    settings = loggerSettings;
+    windowStart = std::chrono::steady_clock::now();
+    stopping = false;
+    worker = std::thread(&DebugLogger::WorkerMain, this);
+    return true;
+}
+
+void DebugLogger::Cleanup() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    worker.join();
+
+    // 日志线程已退出，剩余消息在当前线程输出
+    Drain();
+    FlushRateLimit(std::chrono::steady_clock::time_point::max());
+    WriteSummary();
+    std::cerr.flush();
+}
+
+void DebugLogger::FillMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
+    // 严重级别位从VERBOSE到ERROR递增，订阅不低于minSeverity的全部级别
+    const VkDebugUtilsMessageSeverityFlagsEXT allSeverities =
+        VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+        VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+
+    createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+    createInfo.messageSeverity = allSeverities & ~(static_cast<VkDebugUtilsMessageSeverityFlagsEXT>(settings.minSeverity) - 1);
+    createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+    createInfo.pfnUserCallback = Callback;
+    createInfo.pUserData = this;
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL DebugLogger::Callback(
+    VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+    VkDebugUtilsMessageTypeFlagsEXT messageType,
+    const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+    void* pUserData) {
+
+    auto logger = static_cast<DebugLogger*>(pUserData);
+    if (logger == nullptr || messageSeverity < logger->settings.minSeverity) {
+        return VK_FALSE;
+    }
+
+    if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+        logger->errorCount.fetch_add(1, std::memory_order_relaxed);
+    } else if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+        logger->warningCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const char* text = pCallbackData->pMessage != nullptr ? pCallbackData->pMessage : "";
+    if (logger->Push(messageSeverity, messageType, pCallbackData->messageIdNumber, text)) {
+        // 不持有锁通知，日志线程最迟在下一次超时醒来时处理
+        logger->wakeCondition.notify_one();
+    }
+    return VK_FALSE;
+}
+
+bool DebugLogger::Push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+                       int32_t messageId, const char* text) {
+    // 有界MPMC队列（每个槽位的序号表示它可被写入或读取的轮次）
+    uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+    Entry* entry = nullptr;
+    for (;;) {
+        entry = &entries[position & (QUEUE_CAPACITY - 1)];
+        uint64_t sequence = entry->sequence.load(std::memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    entry->severity = severity;
+    entry->type = type;
+    entry->messageId = messageId;
+    size_t length = std::min<size_t>(std::strlen(text), MAX_MESSAGE_LENGTH - 1);
+    std::memcpy(entry->text, text, length);
+    entry->text[length] = '\0';
+    entry->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool DebugLogger::Pop(Entry*& entry) {
+    entry = &entries[dequeuePosition & (QUEUE_CAPACITY - 1)];
+    return entry->sequence.load(std::memory_order_acquire) == dequeuePosition + 1;
+}
+
+void DebugLogger::Release() {
+    entries[dequeuePosition & (QUEUE_CAPACITY - 1)].sequence.store(dequeuePosition + QUEUE_CAPACITY, std::memory_order_release);
+    dequeuePosition++;
+}
+
+void DebugLogger::WorkerMain() {
+    VGE_PROFILE_THREAD("DebugLogger");
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            if (stopping) break;
+            Entry* entry = nullptr;
+            if (!Pop(entry)) {
+                wakeCondition.wait_for(lock, std::chrono::milliseconds(50));
+            }
+        }
+        Drain();
+        FlushRateLimit(std::chrono::steady_clock::now());
+        std::cerr.flush();
+    }
+}
+
+void DebugLogger::Drain() {
+    Entry* entry = nullptr;
+    while (Pop(entry)) {
+        Write(*entry);
+        Release();
+    }
+
+    uint64_t dropped = droppedCount.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped) {
+        std::cerr << "[vulkan] debug log queue full, dropped " << dropped - reportedDropped << " messages\n";
+        reportedDropped = dropped;
+    }
+}
+
+void DebugLogger::Write(const Entry& entry) {
+    // 去重：同一消息只输出第一次，重复次数在退出时汇总
+    uint64_t key = HashMessage(entry.messageId, entry.text);
+    auto it = repeats.find(key);
+    if (it != repeats.end()) {
+        it->second.count++;
+        return;
+    }
+    if (repeats.size() < MAX_TRACKED_MESSAGES) {
+        Repeat& repeat = repeats[key];
+        repeat.count = 1;
+        repeat.summary.assign(entry.text, std::min<size_t>(std::strlen(entry.text), 120));
+    }
+
+    // 限速：每秒窗口内超出的非错误消息只计数
+    bool isError = entry.severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+    if (!isError && settings.maxMessagesPerSecond > 0 && windowPrinted >= settings.maxMessagesPerSecond) {
+        windowSuppressed++;
+        return;
+    }
+    windowPrinted++;
+    std::cerr << "[vulkan][" << TypeName(entry.type) << "][" << SeverityName(entry.severity) << "] "
+              << entry.text << '\n';
+}
+
+void DebugLogger::FlushRateLimit(std::chrono::steady_clock::time_point now) {
+    if (now - windowStart < std::chrono::seconds(1)) return;
+    if (windowSuppressed > 0) {
+        std::cerr << "[vulkan] rate limit: suppressed " << windowSuppressed << " messages\n";
+    }
+    windowStart = std::chrono::steady_clock::now();
+    windowPrinted = 0;
+    windowSuppressed = 0;
+}
+
+void DebugLogger::WriteSummary() {
+    std::vector<const Repeat*> repeated;
+    for (const auto& pair : repeats) {
+        if (pair.second.count > 1) repeated.push_back(&pair.second);
+    }
+    if (repeated.empty()) return;
+
+    std::sort(repeated.begin(), repeated.end(), [](const Repeat* a, const Repeat* b) { return a->count > b->count; });
+    std::cerr << "[vulkan] " << repeated.size() << " messages were repeated:\n";
+    for (size_t i = 0; i < std::min<size_t>(repeated.size(), 10); i++) {
+        std::cerr << "  x" << repeated[i]->count << ": " << repeated[i]->summary << '\n';
+    }
+}
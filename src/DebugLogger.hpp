@@ -0,0 +1,96 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// 异步调试日志：DebugUtils回调只做严重级别过滤并把消息写入无锁有界队列，
+// 后台线程负责去重、限速和输出，驱动线程不会阻塞在std::cerr上
+class DebugLogger {
+public:
+    static const uint32_t QUEUE_CAPACITY = 256;          // 2的幂，队列满时丢弃并计数
+    static const uint32_t MAX_MESSAGE_LENGTH = 1024;     // 超长消息截断
+    static const uint32_t MAX_TRACKED_MESSAGES = 4096;   // 去重表上限，超出后不再去重
+
+    struct Settings {
+        // 低于该级别的消息不订阅也不输出
+        VkDebugUtilsMessageSeverityFlagBitsEXT minSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
+        // 每秒最多输出的非错误消息，0表示不限速；错误消息不受限速
+        uint32_t maxMessagesPerSecond = 20;
+    };
+
+    DebugLogger();
+    ~DebugLogger();
+
+    DebugLogger(const DebugLogger&) = delete;
+    DebugLogger& operator=(const DebugLogger&) = delete;
+
+    bool Initialize(const Settings& loggerSettings);
+    // 输出队列中剩余的消息和重复次数汇总后停止线程
+    void Cleanup();
+
+    // 填写DebugUtils信使的severity/type/回调，pUserData指向本对象
+    void FillMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
+
+    uint64_t GetErrorCount() const { return errorCount.load(std::memory_order_relaxed); }
+    uint64_t GetWarningCount() const { return warningCount.load(std::memory_order_relaxed); }
+    uint64_t GetDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+
+    static VKAPI_ATTR VkBool32 VKAPI_CALL Callback(
+        VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+        VkDebugUtilsMessageTypeFlagsEXT messageType,
+        const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+        void* pUserData);
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> sequence{0};
+        VkDebugUtilsMessageSeverityFlagBitsEXT severity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        VkDebugUtilsMessageTypeFlagsEXT type = 0;
+        int32_t messageId = 0;
+        char text[MAX_MESSAGE_LENGTH];
+    };
+
+    struct Repeat {
+        uint64_t count = 0;
+        std::string summary;
+    };
+
+    // 多生产者（任意调用Vulkan的线程）、单消费者（日志线程）
+    bool Push(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+              int32_t messageId, const char* text);
+    bool Pop(Entry*& entry);
+    void Release();
+
+    void WorkerMain();
+    void Drain();
+    void Write(const Entry& entry);
+    void FlushRateLimit(std::chrono::steady_clock::time_point now);
+    void WriteSummary();
+
+    Settings settings;
+    Entry entries[QUEUE_CAPACITY];
+    alignas(64) std::atomic<uint64_t> enqueuePosition{0};
+    alignas(64) uint64_t dequeuePosition = 0;
+
+    std::atomic<uint64_t> errorCount{0};
+    std::atomic<uint64_t> warningCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+    uint64_t reportedDropped = 0;
+
+    // 以下仅由日志线程访问
+    std::unordered_map<uint64_t, Repeat> repeats;
+    std::chrono::steady_clock::time_point windowStart;
+    uint32_t windowPrinted = 0;
+    uint64_t windowSuppressed = 0;
+
+    std::thread worker;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool stopping = false;
+};
@@ -0,0 +1,352 @@
+#include "DeviceSelector.hpp"
+#include "VulkanContext.hpp"
+#include "VulkanUtils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+namespace {
+    // 已提升为核心的扩展：设备版本不低于promotedVersion时无需启用扩展
+    struct OptionalExtension {
+        const char* name;
+        uint32_t promotedVersion;
+        const char* dependencies[2];    // 低于提升版本时还需要的扩展
+    };
+
+    const OptionalExtension TIMELINE_SEMAPHORE = {VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, VK_API_VERSION_1_2, {nullptr, nullptr}};
+    const OptionalExtension DESCRIPTOR_INDEXING = {VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, VK_API_VERSION_1_2, {nullptr, nullptr}};
+    const OptionalExtension DYNAMIC_RENDERING = {VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, VK_API_VERSION_1_3,
+                                                 {VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME}};
+    const OptionalExtension SYNCHRONIZATION_2 = {VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME, VK_API_VERSION_1_3, {nullptr, nullptr}};
+    const OptionalExtension EXTENDED_DYNAMIC_STATE = {VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME, VK_API_VERSION_1_3, {nullptr, nullptr}};
+    const OptionalExtension EXTENDED_DYNAMIC_STATE_2 = {VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME, VK_API_VERSION_1_3, {nullptr, nullptr}};
+    // 未提升为核心
+    const OptionalExtension EXTENDED_DYNAMIC_STATE_3 = {VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME, UINT32_MAX, {nullptr, nullptr}};
+    const OptionalExtension HOST_QUERY_RESET = {VK_EXT_HOST_QUERY_RESET_EXTENSION_NAME, VK_API_VERSION_1_2, {nullptr, nullptr}};
+
+    bool ResolveExtension(const OptionalExtension& extension, uint32_t apiVersion,
+                          const std::set<std::string>& available, std::vector<std::string>& enabled) {
+        if (apiVersion >= extension.promotedVersion) {
+            return true;
+        }
+        if (available.count(extension.name) == 0) {
+            return false;
+        }
+        for (const char* dependency : extension.dependencies) {
+            if (dependency != nullptr && available.count(dependency) == 0) {
+                return false;
+            }
+        }
+        enabled.push_back(extension.name);
+        for (const char* dependency : extension.dependencies) {
+            if (dependency != nullptr && std::find(enabled.begin(), enabled.end(), dependency) == enabled.end()) {
+                enabled.push_back(dependency);
+            }
+        }
+        return true;
+    }
+
+    std::string ToLower(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    }
+
+    const char* DeviceTypeName(VkPhysicalDeviceType type) {
+        switch (type) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return "discrete";
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return "integrated";
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return "virtual";
+            case VK_PHYSICAL_DEVICE_TYPE_CPU: return "cpu";
+            default: return "other";
+        }
+    }
+
+    int64_t DeviceTypeScore(VkPhysicalDeviceType type) {
+        switch (type) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 4000;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 2000;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 1000;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU: return 100;
+            default: return 500;
+        }
+    }
+}
+
+VkPhysicalDeviceFeatures2* DeviceSelector::FeatureChain::Link() {
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    timelineSemaphore.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    descriptorIndexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    dynamicRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    synchronization2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    extendedDynamicState.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+    extendedDynamicState2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+    extendedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    multiview.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES;
+    shaderDrawParameters.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETERS_FEATURES;
+    hostQueryReset.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES_EXT;
+
+    // 1.1核心结构体总是链入
+    void** next = &features2.pNext;
+    auto append = [&next](auto& structure) {
+        *next = &structure;
+        next = &structure.pNext;
+    };
+    append(multiview);
+    append(shaderDrawParameters);
+    if (hasTimelineSemaphore) append(timelineSemaphore);
+    if (hasDescriptorIndexing) append(descriptorIndexing);
+    if (hasDynamicRendering) append(dynamicRendering);
+    if (hasSynchronization2) append(synchronization2);
+    if (hasExtendedDynamicState) append(extendedDynamicState);
+    if (hasExtendedDynamicState2) append(extendedDynamicState2);
+    if (hasExtendedDynamicState3) append(extendedDynamicState3);
+    if (hasHostQueryReset) append(hostQueryReset);
+    *next = nullptr;
+    return &features2;
+}
+
+DeviceSelector::DeviceSelector(VulkanContext* context) : context(context) {
+    if (const char* value = std::getenv("VGE_DEVICE")) {
+        deviceOverride = value;
+    }
+}
+
+bool DeviceSelector::Select() {
+    VkInstance instance = context->GetInstance();
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    if (deviceCount == 0) {
+        throw std::runtime_error("failed to find GPUs with Vulkan support!");
+    }
+
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+    candidates.clear();
+    candidates.resize(deviceCount);
+    for (uint32_t i = 0; i < deviceCount; i++) {
+        candidates[i].physicalDevice = devices[i];
+        Evaluate(candidates[i]);
+    }
+
+    // 得分最高者；同分时保持枚举顺序
+    selected = nullptr;
+    for (Candidate& candidate : candidates) {
+        if (candidate.suitable && (selected == nullptr || candidate.score > selected->score)) {
+            selected = &candidate;
+        }
+    }
+
+    if (!deviceOverride.empty()) {
+        Candidate* match = nullptr;
+        for (Candidate& candidate : candidates) {
+            if (MatchesOverride(candidate)) {
+                match = &candidate;
+                break;
+            }
+        }
+        if (match == nullptr) {
+            std::cerr << "No device matches \"" << deviceOverride << "\", selecting automatically" << std::endl;
+        } else if (!match->suitable) {
+            std::cerr << "Requested device " << match->capabilities.properties.deviceName
+                      << " is not usable (" << match->rejectReason << "), selecting automatically" << std::endl;
+        } else {
+            selected = match;
+        }
+    }
+
+    for (const Candidate& candidate : candidates) {
+        const DeviceCapabilities& capabilities = candidate.capabilities;
+        std::cout << (&candidate == selected ? "* " : "  ") << capabilities.properties.deviceName
+                  << " [" << DeviceTypeName(capabilities.properties.deviceType) << ", "
+                  << VK_VERSION_MAJOR(capabilities.apiVersion) << "." << VK_VERSION_MINOR(capabilities.apiVersion)
+                  << ", " << capabilities.uuid << "] ";
+        if (candidate.suitable) {
+            std::cout << "score " << candidate.score << std::endl;
+        } else {
+            std::cout << "rejected: " << candidate.rejectReason << std::endl;
+        }
+    }
+
+    if (selected == nullptr) {
+        throw std::runtime_error("failed to find a suitable GPU!");
+    }
+    return true;
+}
+
+void DeviceSelector::Evaluate(Candidate& candidate) {
+    VkPhysicalDevice physicalDevice = candidate.physicalDevice;
+    DeviceCapabilities& capabilities = candidate.capabilities;
+
+    VkPhysicalDeviceIDProperties idProperties{};
+    idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &idProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &capabilities.properties);
+    capabilities.apiVersion = std::min(capabilities.properties.apiVersion, context->GetInstanceApiVersion());
+
+    // 特性链与ID属性都需要1.1
+    if (capabilities.apiVersion < VK_API_VERSION_1_1) {
+        candidate.rejectReason = "Vulkan 1.1 required";
+        return;
+    }
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+    char uuid[VK_UUID_SIZE * 2 + 1] = {};
+    for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+        std::snprintf(uuid + i * 2, 3, "%02x", idProperties.deviceUUID[i]);
+    }
+    capabilities.uuid = uuid;
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            capabilities.deviceLocalMemory += memoryProperties.memoryHeaps[i].size;
+        }
+    }
+
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensionProperties(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensionProperties.data());
+    std::set<std::string> available;
+    for (const auto& extension : extensionProperties) {
+        available.insert(extension.extensionName);
+    }
+
+    // 必需：交换链、同时支持图形与呈现的队列族、可用的表面格式
+    // 无窗口模式没有表面，只要求图形队列；交换链扩展仍然要求（渲染通道以PRESENT_SRC布局结束）
+    bool hasSurface = context->GetSurface() != VK_NULL_HANDLE;
+    if (available.count(VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) {
+        candidate.rejectReason = "no swapchain support";
+        return;
+    }
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    bool queueFound = false;
+    for (uint32_t i = 0; i < queueFamilyCount && !queueFound; i++) {
+        VkBool32 presentSupport = hasSurface ? VK_FALSE : VK_TRUE;
+        if (hasSurface) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, context->GetSurface(), &presentSupport);
+        }
+        if ((queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && presentSupport) {
+            candidate.queueFamily = i;
+            queueFound = true;
+        }
+    }
+    if (!queueFound) {
+        candidate.rejectReason = "no graphics queue with present support";
+        return;
+    }
+    if (hasSurface && !VulkanUtils::QuerySwapChainSupport(physicalDevice, context->GetSurface())) {
+        candidate.rejectReason = "no surface formats or present modes";
+        return;
+    }
+
+    // 可选扩展
+    candidate.extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    std::vector<std::string>& extensions = candidate.extensions;
+    capabilities.memoryBudget = available.count(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) != 0;
+    if (capabilities.memoryBudget) extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    capabilities.drawIndirectCount = available.count(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) != 0;
+    if (capabilities.drawIndirectCount) extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+    // 只查询能启用的结构体，查询结果即为创建设备时启用的特性
+    FeatureChain& chain = candidate.features;
+    uint32_t apiVersion = capabilities.apiVersion;
+    chain.hasTimelineSemaphore = ResolveExtension(TIMELINE_SEMAPHORE, apiVersion, available, extensions);
+    chain.hasDescriptorIndexing = ResolveExtension(DESCRIPTOR_INDEXING, apiVersion, available, extensions);
+    chain.hasDynamicRendering = ResolveExtension(DYNAMIC_RENDERING, apiVersion, available, extensions);
+    chain.hasSynchronization2 = ResolveExtension(SYNCHRONIZATION_2, apiVersion, available, extensions);
+    chain.hasExtendedDynamicState = ResolveExtension(EXTENDED_DYNAMIC_STATE, apiVersion, available, extensions);
+    chain.hasExtendedDynamicState2 = ResolveExtension(EXTENDED_DYNAMIC_STATE_2, apiVersion, available, extensions);
+    chain.hasExtendedDynamicState3 = ResolveExtension(EXTENDED_DYNAMIC_STATE_3, apiVersion, available, extensions);
+    chain.hasHostQueryReset = ResolveExtension(HOST_QUERY_RESET, apiVersion, available, extensions);
+    vkGetPhysicalDeviceFeatures2(physicalDevice, chain.Link());
+
+    // 核心特性只启用用得到的，robustBufferAccess等有运行时开销的特性保持关闭
+    const VkPhysicalDeviceFeatures& supported = chain.features2.features;
+    VkPhysicalDeviceFeatures enabled{};
+    enabled.samplerAnisotropy = supported.samplerAnisotropy;
+    enabled.multiDrawIndirect = supported.multiDrawIndirect;
+    enabled.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+    enabled.textureCompressionBC = supported.textureCompressionBC;
+    enabled.fillModeNonSolid = supported.fillModeNonSolid;
+    enabled.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+    enabled.shaderInt16 = supported.shaderInt16;
+    chain.features2.features = enabled;
+    capabilities.features = enabled;
+
+    capabilities.timelineSemaphore = chain.hasTimelineSemaphore && chain.timelineSemaphore.timelineSemaphore;
+    capabilities.descriptorIndexing = chain.hasDescriptorIndexing &&
+        chain.descriptorIndexing.runtimeDescriptorArray &&
+        chain.descriptorIndexing.descriptorBindingPartiallyBound &&
+        chain.descriptorIndexing.descriptorBindingVariableDescriptorCount &&
+        chain.descriptorIndexing.shaderSampledImageArrayNonUniformIndexing;
+    capabilities.dynamicRendering = chain.hasDynamicRendering && chain.dynamicRendering.dynamicRendering;
+    capabilities.synchronization2 = chain.hasSynchronization2 && chain.synchronization2.synchronization2;
+    capabilities.extendedDynamicState = chain.hasExtendedDynamicState && chain.extendedDynamicState.extendedDynamicState;
+    capabilities.extendedDynamicState2 = chain.hasExtendedDynamicState2 && chain.extendedDynamicState2.extendedDynamicState2;
+    capabilities.extendedDynamicState3Blend = chain.hasExtendedDynamicState3 &&
+        chain.extendedDynamicState3.extendedDynamicState3ColorBlendEnable &&
+        chain.extendedDynamicState3.extendedDynamicState3ColorBlendEquation &&
+        chain.extendedDynamicState3.extendedDynamicState3ColorWriteMask;
+    capabilities.multiview = chain.multiview.multiview == VK_TRUE;
+    capabilities.shaderDrawParameters = chain.shaderDrawParameters.shaderDrawParameters == VK_TRUE;
+    capabilities.hostQueryReset = chain.hasHostQueryReset && chain.hostQueryReset.hostQueryReset;
+
+    // 设备类型占主导，其次是引擎能用上的可选能力和显存大小
+    int64_t score = DeviceTypeScore(capabilities.properties.deviceType);
+    score += static_cast<int64_t>(VK_VERSION_MINOR(apiVersion)) * 50;
+    score += static_cast<int64_t>(std::min<VkDeviceSize>(capabilities.deviceLocalMemory >> 30, 16)) * 50;
+    const bool optional[] = {
+        capabilities.memoryBudget, capabilities.drawIndirectCount, capabilities.timelineSemaphore,
+        capabilities.descriptorIndexing, capabilities.dynamicRendering, capabilities.synchronization2,
+        capabilities.extendedDynamicState, capabilities.extendedDynamicState2, capabilities.extendedDynamicState3Blend,
+        capabilities.multiview, capabilities.shaderDrawParameters,
+        capabilities.hostQueryReset, enabled.multiDrawIndirect == VK_TRUE, enabled.drawIndirectFirstInstance == VK_TRUE,
+        enabled.samplerAnisotropy == VK_TRUE, enabled.textureCompressionBC == VK_TRUE
+    };
+    for (bool supportedCapability : optional) {
+        score += supportedCapability ? 100 : 0;
+    }
+    candidate.score = score;
+    candidate.suitable = true;
+}
+
+bool DeviceSelector::MatchesOverride(const Candidate& candidate) const {
+    // UUID比较忽略大小写和连字符
+    std::string key;
+    for (char c : ToLower(deviceOverride)) {
+        if (c != '-') key.push_back(c);
+    }
+    if (!candidate.capabilities.uuid.empty() && key == candidate.capabilities.uuid) {
+        return true;
+    }
+    std::string name = ToLower(candidate.capabilities.properties.deviceName);
+    return name.find(ToLower(deviceOverride)) != std::string::npos;
+}
+
+VkResult DeviceSelector::CreateDevice(const VkDeviceQueueCreateInfo* queueInfos, uint32_t queueInfoCount, VkDevice* device) {
+    std::vector<const char*> extensionNames;
+    for (const std::string& extension : selected->extensions) {
+        extensionNames.push_back(extension.c_str());
+    }
+
+    // 特性通过pNext链传入，pEnabledFeatures必须为空
+    VkDeviceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = selected->features.Link();
+    createInfo.queueCreateInfoCount = queueInfoCount;
+    createInfo.pQueueCreateInfos = queueInfos;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensionNames.size());
+    createInfo.ppEnabledExtensionNames = extensionNames.data();
+    return vkCreateDevice(selected->physicalDevice, &createInfo, context->GetAllocationCallbacks(), device);
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class VulkanContext;
+
+// 协商后的设备能力：子系统据此在运行时选择最快的可用路径
+struct DeviceCapabilities {
+    uint32_t apiVersion = VK_API_VERSION_1_0;     // 实例与设备版本中较低者
+    VkPhysicalDeviceProperties properties{};
+    std::string uuid;                             // VkPhysicalDeviceIDProperties::deviceUUID，32位十六进制
+    VkDeviceSize deviceLocalMemory = 0;
+    VkPhysicalDeviceFeatures features{};          // 已启用的核心特性
+
+    bool memoryBudget = false;
+    bool drawIndirectCount = false;
+    bool timelineSemaphore = false;
+    bool descriptorIndexing = false;              // 部分绑定、可变长度、非一致索引的采样图像数组
+    bool dynamicRendering = false;
+    bool synchronization2 = false;
+    bool extendedDynamicState = false;            // 剔除、正面、拓扑、深度测试/写入/比较
+    bool extendedDynamicState2 = false;           // 深度偏移开关、图元重启
+    bool extendedDynamicState3Blend = false;      // 混合开关、混合方程、颜色写掩码
+    bool multiview = false;
+    bool shaderDrawParameters = false;
+    bool hostQueryReset = false;
+};
+
+// 评分式物理设备选择：拒绝缺少必需能力的设备，其余按类型、显存和可选特性打分，
+// 并通过VkPhysicalDeviceFeatures2链协商并启用引擎能使用的全部可选特性
+// 环境变量VGE_DEVICE或SetOverride可按名称子串（不区分大小写）或UUID指定设备
+class DeviceSelector {
+public:
+    explicit DeviceSelector(VulkanContext* context);
+
+    void SetOverride(const std::string& nameOrUuid) { deviceOverride = nameOrUuid; }
+
+    // 枚举并评估所有设备，选出得分最高（或被指定）的设备
+    bool Select();
+
+    // 用协商结果创建逻辑设备
+    VkResult CreateDevice(const VkDeviceQueueCreateInfo* queueInfos, uint32_t queueInfoCount, VkDevice* device);
+
+    VkPhysicalDevice GetPhysicalDevice() const { return selected != nullptr ? selected->physicalDevice : VK_NULL_HANDLE; }
+    uint32_t GetQueueFamily() const { return selected != nullptr ? selected->queueFamily : 0; }
+    const DeviceCapabilities& GetCapabilities() const { return selected->capabilities; }
+
+private:
+    // 只链入设备支持的结构体；每次使用前重新连接pNext
+    struct FeatureChain {
+        VkPhysicalDeviceFeatures2 features2{};
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphore{};
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexing{};
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRendering{};
+        VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2{};
+        VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicState{};
+        VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2{};
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3{};
+        VkPhysicalDeviceMultiviewFeatures multiview{};
+        VkPhysicalDeviceShaderDrawParametersFeatures shaderDrawParameters{};
+        VkPhysicalDeviceHostQueryResetFeaturesEXT hostQueryReset{};
+
+        bool hasTimelineSemaphore = false;
+        bool hasDescriptorIndexing = false;
+        bool hasDynamicRendering = false;
+        bool hasSynchronization2 = false;
+        bool hasExtendedDynamicState = false;
+        bool hasExtendedDynamicState2 = false;
+        bool hasExtendedDynamicState3 = false;
+        bool hasHostQueryReset = false;
+
+        VkPhysicalDeviceFeatures2* Link();
+    };
+
+    struct Candidate {
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        uint32_t queueFamily = 0;
+        bool suitable = false;
+        std::string rejectReason;
+        int64_t score = 0;
+        DeviceCapabilities capabilities;
+        std::vector<std::string> extensions;      // 需要启用的设备扩展
+        FeatureChain features;                    // 查询到的支持情况，创建设备时直接启用
+    };
+
+    void Evaluate(Candidate& candidate);
+    bool MatchesOverride(const Candidate& candidate) const;
+
+    VulkanContext* context;
+    std::string deviceOverride;
+    std::vector<Candidate> candidates;
+    Candidate* selected = nullptr;
+};
@@ -0,0 +1,514 @@
+#include "DynamicResolution.hpp"
+#include "VulkanContext.hpp"
+#include "VulkanUtils.hpp"
+#include "MemoryManager.hpp"
+#include "Swapchain.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    const char* const UPSCALE_SHADER_PATH = "shaders/upscale.comp.spv";
+    const VkFormat OUTPUT_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+void ResolutionController::SetSettings(const Settings& value) {
+    settings = value;
+    settings.maxScale = std::min(std::max(settings.maxScale, 0.1f), 1.0f);
+    settings.minScale = std::min(std::max(settings.minScale, 0.1f), settings.maxScale);
+    settings.smoothing = std::min(std::max(settings.smoothing, 0.01f), 1.0f);
+    Reset();
+}
+
+void ResolutionController::Reset() {
+    scale = settings.maxScale;
+    smoothedMilliseconds = 0.0f;
+    hasSample = false;
+    cooldown = 0;
+}
+
+float ResolutionController::Update(float gpuMilliseconds) {
+    if (!hasSample) {
+        smoothedMilliseconds = gpuMilliseconds;
+        hasSample = true;
+    } else {
+        smoothedMilliseconds += settings.smoothing * (gpuMilliseconds - smoothedMilliseconds);
+    }
+    if (settings.targetMilliseconds <= 0.0f || settings.minScale == settings.maxScale) {
+        scale = settings.maxScale;
+        return scale;
+    }
+    if (cooldown > 0) {
+        cooldown--;
+        return scale;
+    }
+
+    // 目标取滞后区间的中点，调整后既不会立刻触发反向调整，也留有余量
+    float budget = settings.targetMilliseconds;
+    float aim = budget * (1.0f + settings.raiseThreshold) * 0.5f;
+    bool spike = gpuMilliseconds > budget * settings.spikeThreshold;
+    float load = spike ? std::max(gpuMilliseconds, smoothedMilliseconds) : smoothedMilliseconds;
+
+    float desired = scale;
+    if (load > budget) {
+        // 超出预算：一步降到预测的目标缩放
+        desired = scale * std::sqrt(aim / load);
+    } else if (load < budget * settings.raiseThreshold) {
+        // 低于预算：限制步长，避免在内容变化时来回振荡
+        desired = std::min(scale * std::sqrt(aim / std::max(load, 0.01f)), scale + settings.maxRaiseStep);
+    }
+    desired = std::min(std::max(desired, settings.minScale), settings.maxScale);
+    if (std::fabs(desired - scale) < 0.01f) {
+        return scale;
+    }
+
+    // 平滑值按像素数比例预测调整后的时间，之后的测量再修正
+    float ratio = desired / scale;
+    smoothedMilliseconds = load * ratio * ratio;
+    scale = desired;
+    cooldown = settings.cooldownFrames;
+    return scale;
+}
+
+std::vector<const char*> DynamicResolution::GetShaderPaths() {
+    return {UPSCALE_SHADER_PATH};
+}
+
+DynamicResolution::DynamicResolution(VulkanContext* context) : context(context) {
+    controller.SetSettings(settings.controller);
+}
+
+DynamicResolution::~DynamicResolution() {
+    Cleanup();
+}
+
+bool DynamicResolution::Initialize() {
+    if (!CreatePipeline()) return false;
+    if (!CreateQueryPool()) return false;
+    supported = true;
+    return true;
+}
+
+void DynamicResolution::Cleanup() {
+    VkDevice device = context->GetDevice();
+
+    DestroyTargets();
+    if (queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, queryPool, context->GetAllocationCallbacks());
+        queryPool = VK_NULL_HANDLE;
+    }
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, context->GetAllocationCallbacks());
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    if (pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pipeline, context->GetAllocationCallbacks());
+        pipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pipelineLayout, context->GetAllocationCallbacks());
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (setLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, setLayout, context->GetAllocationCallbacks());
+        setLayout = VK_NULL_HANDLE;
+    }
+    if (linearSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, linearSampler, context->GetAllocationCallbacks());
+        linearSampler = VK_NULL_HANDLE;
+    }
+    supported = false;
+}
+
+bool DynamicResolution::CreatePipeline() {
+    VkDevice device = context->GetDevice();
+
+    // 子矩形之外的纹素由着色器夹住UV排除，边缘寻址方式无关
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+    if (vkCreateSampler(device, &samplerInfo, context->GetAllocationCallbacks(), &linearSampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upscale sampler!");
+    }
+
+    // 场景目标 + 输出存储图像
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, context->GetAllocationCallbacks(), &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upscale descriptor set layout!");
+    }
+
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(UpscaleParams);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, context->GetAllocationCallbacks(), &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upscale pipeline layout!");
+    }
+
+    VkShaderModule shaderModule = VulkanUtils::CreateShaderModule(device, context->LoadShaderCode(UPSCALE_SHADER_PATH),
+                                                                  context->GetAllocationCallbacks());
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+    VkResult result = vkCreateComputePipelines(device, context->GetPipelineCache(), 1, &pipelineInfo, context->GetAllocationCallbacks(), &pipeline);
+    vkDestroyShaderModule(device, shaderModule, context->GetAllocationCallbacks());
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upscale pipeline!");
+    }
+
+    VkDescriptorPoolSize poolSizes[] = {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1}
+    };
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+    if (vkCreateDescriptorPool(device, &poolInfo, context->GetAllocationCallbacks(), &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upscale descriptor pool!");
+    }
+
+    // 描述符集只分配一次，目标重建时重写
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upscale descriptor set!");
+    }
+    return true;
+}
+
+bool DynamicResolution::CreateQueryPool() {
+    // 图形队列不支持时间戳时控制器不工作，缩放固定为最大值
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(context->GetPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(context->GetPhysicalDevice(), &familyCount, families.data());
+    uint32_t validBits = context->GetGraphicsQueueFamily() < familyCount ? families[context->GetGraphicsQueueFamily()].timestampValidBits : 0;
+    if (validBits == 0) {
+        std::cerr << "GPU timestamps not supported, dynamic resolution uses a fixed scale" << std::endl;
+        return true;
+    }
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    timestampPeriod = context->GetCapabilities().properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryInfo{};
+    queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryInfo.queryCount = 2 * VulkanContext::MAX_FRAMES_IN_FLIGHT;
+    if (vkCreateQueryPool(context->GetDevice(), &queryInfo, context->GetAllocationCallbacks(), &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+    queryPending.assign(VulkanContext::MAX_FRAMES_IN_FLIGHT, false);
+    return true;
+}
+
+bool DynamicResolution::CreateTargets() {
+    targetsAllowed = true;
+    if (!supported || !settings.enabled) return true;
+
+    Swapchain* swapchain = context->GetSwapchain();
+    if (!swapchain->SupportsUpscale()) {
+        std::cerr << "Dynamic resolution disabled: swapchain images cannot be copied to" << std::endl;
+        settings.enabled = false;
+        return true;
+    }
+    targetExtent = swapchain->GetExtent();
+    VkDevice device = context->GetDevice();
+    MemoryManager* memoryManager = context->GetMemoryManager();
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = swapchain->GetImageFormat();
+    imageInfo.extent = {targetExtent.width, targetExtent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+    if (memoryManager->CreateImage(imageInfo, allocInfo, &sceneImage, &sceneAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create dynamic resolution scene target" << std::endl;
+        return false;
+    }
+    imageInfo.format = OUTPUT_FORMAT;
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    if (memoryManager->CreateImage(imageInfo, allocInfo, &outputImage, &outputAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create dynamic resolution output image" << std::endl;
+        DestroyTargets();
+        return false;
+    }
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = sceneImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = swapchain->GetImageFormat();
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.layerCount = 1;
+    if (vkCreateImageView(device, &viewInfo, context->GetAllocationCallbacks(), &sceneView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create scene target view!");
+    }
+    viewInfo.image = outputImage;
+    viewInfo.format = OUTPUT_FORMAT;
+    if (vkCreateImageView(device, &viewInfo, context->GetAllocationCallbacks(), &outputView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upscale output view!");
+    }
+
+    // 与交换链帧缓冲共用深度缓冲，渲染通道兼容
+    VkImageView attachments[] = {sceneView, swapchain->GetDepthImageView()};
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = context->GetRenderPass();
+    framebufferInfo.attachmentCount = 2;
+    framebufferInfo.pAttachments = attachments;
+    framebufferInfo.width = targetExtent.width;
+    framebufferInfo.height = targetExtent.height;
+    framebufferInfo.layers = 1;
+    if (vkCreateFramebuffer(device, &framebufferInfo, context->GetAllocationCallbacks(), &sceneFramebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create scene target framebuffer!");
+    }
+
+    VkDescriptorImageInfo sourceInfo{linearSampler, sceneView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkDescriptorImageInfo destinationInfo{VK_NULL_HANDLE, outputView, VK_IMAGE_LAYOUT_GENERAL};
+    VkWriteDescriptorSet writes[2]{};
+    for (uint32_t i = 0; i < 2; i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+    }
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].pImageInfo = &sourceInfo;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[1].pImageInfo = &destinationInfo;
+    vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+    return true;
+}
+
+void DynamicResolution::DestroyTargets() {
+    VkDevice device = context->GetDevice();
+    if (sceneFramebuffer != VK_NULL_HANDLE) {
+        vkDestroyFramebuffer(device, sceneFramebuffer, context->GetAllocationCallbacks());
+        sceneFramebuffer = VK_NULL_HANDLE;
+    }
+    if (sceneView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, sceneView, context->GetAllocationCallbacks());
+        sceneView = VK_NULL_HANDLE;
+    }
+    if (outputView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, outputView, context->GetAllocationCallbacks());
+        outputView = VK_NULL_HANDLE;
+    }
+    if (sceneImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(context->GetAllocator(), sceneImage, sceneAllocation);
+        sceneImage = VK_NULL_HANDLE;
+        sceneAllocation = VK_NULL_HANDLE;
+    }
+    if (outputImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(context->GetAllocator(), outputImage, outputAllocation);
+        outputImage = VK_NULL_HANDLE;
+        outputAllocation = VK_NULL_HANDLE;
+    }
+    targetExtent = {0, 0};
+}
+
+bool DynamicResolution::OnResize() {
+    if (!supported) return true;
+    DestroyTargets();
+    if (!CreateTargets()) {
+        settings.enabled = false;
+        return false;
+    }
+    // 启用时内部目标须与新的交换链同尺寸，否则放大拷贝按旧尺寸裁剪
+    if (!settings.enabled) return true;
+    VkExtent2D extent = context->GetSwapchainExtent();
+    if (sceneFramebuffer == VK_NULL_HANDLE || targetExtent.width != extent.width || targetExtent.height != extent.height) {
+        settings.enabled = false;
+        return false;
+    }
+    return true;
+}
+
+void DynamicResolution::SetSettings(const Settings& value) {
+    settings = value;
+    controller.SetSettings(settings.controller);
+    // 启动之后才启用时在此创建目标（旧目标在禁用后保留，重新启用不再分配）
+    if (targetsAllowed && supported && settings.enabled && sceneFramebuffer == VK_NULL_HANDLE && !CreateTargets()) {
+        settings.enabled = false;
+    }
+}
+
+VkExtent2D DynamicResolution::GetRenderExtent() const {
+    if (!IsActive()) return context->GetSwapchainExtent();
+
+    float scale = controller.GetScale();
+    auto scaled = [scale](uint32_t size) {
+        uint32_t value = static_cast<uint32_t>(static_cast<float>(size) * scale + 0.5f);
+        value = (value + EXTENT_ALIGNMENT - 1) / EXTENT_ALIGNMENT * EXTENT_ALIGNMENT;
+        return std::min(std::max(value, 1u), size);
+    };
+    return {scaled(targetExtent.width), scaled(targetExtent.height)};
+}
+
+void DynamicResolution::Update() {
+    size_t frame = context->GetCurrentFrame();
+    if (queryPool == VK_NULL_HANDLE || !queryPending[frame]) return;
+    queryPending[frame] = false;
+
+    // 飞行栅栏已发出，结果可用，不需要等待
+    uint64_t timestamps[2] = {};
+    VkResult result = vkGetQueryPoolResults(context->GetDevice(), queryPool, static_cast<uint32_t>(frame * 2), 2,
+                                            sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) return;
+
+    uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+    gpuMilliseconds = static_cast<float>(static_cast<double>(ticks) * timestampPeriod / 1e6);
+    if (IsActive()) {
+        controller.Update(gpuMilliseconds);
+    }
+}
+
+void DynamicResolution::BeginFrame(VkCommandBuffer commandBuffer) {
+    if (queryPool == VK_NULL_HANDLE) return;
+    uint32_t frame = static_cast<uint32_t>(context->GetCurrentFrame());
+    vkCmdResetQueryPool(commandBuffer, queryPool, frame * 2, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, frame * 2);
+    queryPending[frame] = true;
+}
+
+void DynamicResolution::EndFrame(VkCommandBuffer commandBuffer, VkImage image, VkExtent2D extent) {
+    uint32_t frame = static_cast<uint32_t>(context->GetCurrentFrame());
+    if (!IsActive()) {
+        if (queryPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, frame * 2 + 1);
+        }
+        return;
+    }
+
+    Metrics* metrics = context->GetMetrics();
+    VkExtent2D renderExtent = GetRenderExtent();
+    // 交换链在窗口模式下可能先于目标重建，只写两者的交集
+    VkExtent2D outputExtent = {std::min(extent.width, targetExtent.width), std::min(extent.height, targetExtent.height)};
+
+    // 场景目标：渲染通道结束于PRESENT_SRC，转为采样；输出图像每帧整体重写，等待上一帧的拷贝读取
+    VkImageMemoryBarrier barriers[2]{};
+    for (auto& barrier : barriers) {
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+    }
+    barriers[0].image = sceneImage;
+    barriers[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barriers[1].image = outputImage;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+
+    VkFormat format = context->GetSwapchain()->GetImageFormat();
+    UpscaleParams params{};
+    params.sourceWidth = static_cast<float>(renderExtent.width);
+    params.sourceHeight = static_cast<float>(renderExtent.height);
+    params.destinationWidth = outputExtent.width;
+    params.destinationHeight = outputExtent.height;
+    params.sharpness = std::min(std::max(settings.sharpness, 0.0f), 1.0f);
+    params.swapRedBlue = (format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM) ? 1u : 0u;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(commandBuffer, (outputExtent.width + GROUP_SIZE - 1) / GROUP_SIZE,
+                  (outputExtent.height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+
+    // 结束时间戳不含拷贝到交换链：拷贝与缩放无关，且会等待图像获取
+    if (queryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, frame * 2 + 1);
+    }
+
+    // 输出图像（RGBA8，着色器已按交换链的通道顺序和sRGB编码写入）按位拷贝到交换链图像；
+    // 交换链图像的布局转换在提交等待获取信号量的TRANSFER阶段之后执行
+    barriers[0].image = outputImage;
+    barriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[1].image = image;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+
+    VkImageCopy region{};
+    region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.srcSubresource.layerCount = 1;
+    region.dstSubresource = region.srcSubresource;
+    region.extent = {outputExtent.width, outputExtent.height, 1};
+    vkCmdCopyImage(commandBuffer, outputImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].dstAccessMask = 0;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barriers[1]);
+
+    metrics->Add(Metrics::BARRIERS, 3);
+    metrics->Add(Metrics::PIPELINE_BINDS);
+    metrics->Add(Metrics::DESCRIPTOR_BINDS);
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <cstdint>
+#include <vector>
+#include "vk_mem_alloc.h"
+
+class VulkanContext;
+
+// 分辨率控制器：按测得的GPU帧时间与预算调整渲染缩放（每轴），纯CPU逻辑
+// 帧时间先做指数平滑；超出预算或单帧突增时下调，低于预算的raiseThreshold倍时缓慢上调，
+// 两者之间保持不变（滞后区间）。GPU时间近似与像素数成正比，按缩放的平方预测调整后的时间
+class ResolutionController {
+public:
+    struct Settings {
+        float targetMilliseconds = 16.0f;   // GPU帧时间预算
+        float minScale = 0.5f;
+        float maxScale = 1.0f;              // 不超过1（场景目标按输出尺寸分配）
+        float smoothing = 0.1f;             // 指数平滑系数，越大响应越快
+        float raiseThreshold = 0.85f;       // 平滑时间低于预算的该比例才上调
+        float spikeThreshold = 1.5f;        // 单帧超出预算的该倍数时不等平滑立即下调
+        float maxRaiseStep = 0.05f;         // 每次上调的最大缩放增量
+        uint32_t cooldownFrames = 8;        // 调整后等待的帧数（测量结果滞后飞行帧数）
+    };
+
+    void SetSettings(const Settings& value);
+    const Settings& GetSettings() const { return settings; }
+    // 回到最大缩放并丢弃平滑状态
+    void Reset();
+
+    // 输入一帧的GPU时间，返回之后使用的缩放
+    float Update(float gpuMilliseconds);
+
+    float GetScale() const { return scale; }
+    float GetSmoothedMilliseconds() const { return smoothedMilliseconds; }
+
+private:
+    Settings settings;
+    float scale = 1.0f;
+    float smoothedMilliseconds = 0.0f;
+    bool hasSample = false;
+    uint32_t cooldown = 0;
+};
+
+// 动态分辨率：场景通道渲染到按输出尺寸分配的场景目标的左上角子矩形（尺寸变化不重新分配），
+// 帧末计算着色器把子矩形双线性放大（可选对比度自适应锐化）到输出图像，再拷贝到交换链图像
+// 每帧首尾写时间戳，飞行栅栏之后读回该槽位上次的GPU时间驱动ResolutionController
+// 未启用时仍测量GPU时间，场景直接渲染到交换链帧缓冲
+class DynamicResolution {
+public:
+    struct Settings {
+        bool enabled = false;
+        ResolutionController::Settings controller;
+        float sharpness = 0.5f;             // 0为纯双线性
+    };
+
+    DynamicResolution(VulkanContext* context);
+    ~DynamicResolution();
+
+    // 管线、采样器、描述符与时间戳查询池，不依赖交换链
+    bool Initialize();
+    // 交换链帧缓冲就绪后创建场景目标与输出图像（未启用时推迟到启用时创建）
+    bool CreateTargets();
+    void Cleanup();
+
+    // 初始化时读取的着色器，启动阶段据此提前读入
+    static std::vector<const char*> GetShaderPaths();
+
+    // 交换链重建后按新尺寸重新创建目标（设备已空闲），失败时关闭动态分辨率并返回false
+    bool OnResize();
+
+    void SetSettings(const Settings& value);
+    const Settings& GetSettings() const { return settings; }
+    bool IsSupported() const { return supported; }
+    bool IsActive() const { return supported && settings.enabled && sceneFramebuffer != VK_NULL_HANDLE; }
+
+    // 等待飞行栅栏之后调用：读取该槽位上次的GPU时间并更新缩放
+    void Update();
+    // 命令缓冲开始后调用：写帧开始时间戳
+    void BeginFrame(VkCommandBuffer commandBuffer);
+    // 场景通道之后调用：启用时把场景目标放大到image（须为UNDEFINED或PRESENT_SRC布局，结束时为PRESENT_SRC），
+    // 写帧结束时间戳；提交须在TRANSFER阶段等待图像获取信号量
+    void EndFrame(VkCommandBuffer commandBuffer, VkImage image, VkExtent2D extent);
+
+    // 本帧场景通道的渲染区域（场景目标左上角），未启用时为交换链尺寸
+    VkExtent2D GetRenderExtent() const;
+    VkFramebuffer GetFramebuffer() const { return sceneFramebuffer; }
+    float GetScale() const { return controller.GetScale(); }
+    // 最近一次测得的GPU帧时间（不支持时间戳时为0）
+    float GetGpuMilliseconds() const { return gpuMilliseconds; }
+    float GetSmoothedGpuMilliseconds() const { return controller.GetSmoothedMilliseconds(); }
+
+private:
+    // 与upscale.comp中的UpscaleParams一致
+    struct UpscaleParams {
+        float sourceWidth;
+        float sourceHeight;
+        uint32_t destinationWidth;
+        uint32_t destinationHeight;
+        float sharpness;
+        uint32_t swapRedBlue;
+    };
+
+    static const uint32_t GROUP_SIZE = 8;
+    // 渲染尺寸按此对齐，缩放的微小变化不会逐帧改变分辨率
+    static const uint32_t EXTENT_ALIGNMENT = 8;
+
+    bool CreatePipeline();
+    bool CreateQueryPool();
+    void DestroyTargets();
+
+    VulkanContext* context;
+    Settings settings;
+    ResolutionController controller;
+    bool supported = false;
+    bool targetsAllowed = false;        // 交换链帧缓冲已创建
+
+    // 放大管线
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkSampler linearSampler = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    // 场景目标（与交换链格式一致，和交换链深度缓冲组成帧缓冲）与放大输出（RGBA8存储图像）
+    VkExtent2D targetExtent{};
+    VkImage sceneImage = VK_NULL_HANDLE;
+    VmaAllocation sceneAllocation = VK_NULL_HANDLE;
+    VkImageView sceneView = VK_NULL_HANDLE;
+    VkFramebuffer sceneFramebuffer = VK_NULL_HANDLE;
+    VkImage outputImage = VK_NULL_HANDLE;
+    VmaAllocation outputAllocation = VK_NULL_HANDLE;
+    VkImageView outputView = VK_NULL_HANDLE;
+
+    // 每个飞行帧两个时间戳：帧开始与放大结束
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    std::vector<bool> queryPending;
+    uint64_t timestampMask = 0;
+    double timestampPeriod = 0.0;       // 每个计数的纳秒数
+    float gpuMilliseconds = 0.0f;
+};
@@ -0,0 +1,232 @@
+#include "FrameAllocator.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+
+namespace {
+    // 溢出后主块的扩大粒度
+    const size_t GROWTH_GRANULARITY = 4096;
+
+    size_t AlignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+std::atomic<FrameAllocator*> FrameAllocator::current{nullptr};
+thread_local FrameAllocator::Stage FrameAllocator::threadStage = FrameAllocator::STAGE_RENDER;
+
+LinearArena::LinearArena(size_t capacity, std::pmr::memory_resource* upstream) : upstream(upstream) {
+    if (capacity > 0) {
+        this->capacity = AlignUp(capacity, BLOCK_ALIGNMENT);
+        block = static_cast<uint8_t*>(upstream->allocate(this->capacity, BLOCK_ALIGNMENT));
+    }
+}
+
+LinearArena::~LinearArena() {
+    while (overflow != nullptr) {
+        OverflowBlock* next = overflow->next;
+        upstream->deallocate(overflow, overflow->size, BLOCK_ALIGNMENT);
+        overflow = next;
+    }
+    if (block != nullptr) {
+        upstream->deallocate(block, capacity, BLOCK_ALIGNMENT);
+    }
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment) {
+    bytes = std::max<size_t>(bytes, 1);
+    if (block != nullptr) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(block);
+        uintptr_t address = AlignUp(base + used, alignment);
+        if (address + bytes <= base + capacity) {
+            used = address + bytes - base;
+            return reinterpret_cast<void*>(address);
+        }
+    }
+
+    // 先尝试最近的溢出块，放不下再向上游申请一块（至少与主块同样大）
+    size_t headerSize = AlignUp(sizeof(OverflowBlock), BLOCK_ALIGNMENT);
+    if (overflow != nullptr) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(overflow);
+        uintptr_t address = AlignUp(base + overflowUsed, alignment);
+        if (address + bytes <= base + overflow->size) {
+            overflowBytes += address + bytes - (base + overflowUsed);
+            overflowUsed = address + bytes - base;
+            return reinterpret_cast<void*>(address);
+        }
+    }
+
+    size_t blockSize = std::max(capacity, AlignUp(headerSize + bytes + alignment, GROWTH_GRANULARITY));
+    OverflowBlock* newBlock = static_cast<OverflowBlock*>(upstream->allocate(blockSize, BLOCK_ALIGNMENT));
+    newBlock->next = overflow;
+    newBlock->size = blockSize;
+    overflow = newBlock;
+    overflowCount++;
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(newBlock);
+    uintptr_t address = AlignUp(base + headerSize, alignment);
+    overflowUsed = address + bytes - base;
+    overflowBytes += address + bytes - (base + headerSize);
+    return reinterpret_cast<void*>(address);
+}
+
+void LinearArena::do_deallocate(void*, size_t, size_t) {
+    // 内存在Reset时统一回收
+}
+
+void LinearArena::Reset() {
+    bool overflowed = overflow != nullptr;
+    size_t peak = GetPeak();
+    while (overflow != nullptr) {
+        OverflowBlock* next = overflow->next;
+        upstream->deallocate(overflow, overflow->size, BLOCK_ALIGNMENT);
+        overflow = next;
+    }
+
+    // 主块扩大到峰值的1.25倍，留出帧间波动的余量
+    if (overflowed) {
+        if (block != nullptr) {
+            upstream->deallocate(block, capacity, BLOCK_ALIGNMENT);
+        }
+        capacity = AlignUp(peak + peak / 4, GROWTH_GRANULARITY);
+        block = static_cast<uint8_t*>(upstream->allocate(capacity, BLOCK_ALIGNMENT));
+    }
+    used = 0;
+    overflowUsed = 0;
+    overflowBytes = 0;
+}
+
+PoolResource::PoolResource(size_t blockSize, size_t blocksPerChunk, std::pmr::memory_resource* upstream)
+    : upstream(upstream),
+      blockSize(AlignUp(std::max(blockSize, sizeof(FreeBlock)), BLOCK_ALIGNMENT)),
+      blocksPerChunk(std::max<size_t>(blocksPerChunk, 1)) {
+}
+
+PoolResource::~PoolResource() {
+    size_t chunkSize = AlignUp(sizeof(Chunk), BLOCK_ALIGNMENT) + blockSize * blocksPerChunk;
+    while (chunks != nullptr) {
+        Chunk* next = chunks->next;
+        upstream->deallocate(chunks, chunkSize, BLOCK_ALIGNMENT);
+        chunks = next;
+    }
+}
+
+void PoolResource::Reserve(size_t count) {
+    while (totalBlocks - blocksInUse < count) {
+        AddChunk();
+    }
+}
+
+void PoolResource::AddChunk() {
+    size_t headerSize = AlignUp(sizeof(Chunk), BLOCK_ALIGNMENT);
+    uint8_t* memory = static_cast<uint8_t*>(upstream->allocate(headerSize + blockSize * blocksPerChunk, BLOCK_ALIGNMENT));
+    Chunk* chunk = reinterpret_cast<Chunk*>(memory);
+    chunk->next = chunks;
+    chunks = chunk;
+
+    // 逆序压入，使块按地址顺序取出
+    for (size_t i = blocksPerChunk; i-- > 0;) {
+        FreeBlock* freeBlock = reinterpret_cast<FreeBlock*>(memory + headerSize + i * blockSize);
+        freeBlock->next = freeList;
+        freeList = freeBlock;
+    }
+    totalBlocks += blocksPerChunk;
+}
+
+void* PoolResource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > blockSize || alignment > BLOCK_ALIGNMENT) {
+        return upstream->allocate(bytes, alignment);
+    }
+    if (freeList == nullptr) {
+        AddChunk();
+    }
+    FreeBlock* freeBlock = freeList;
+    freeList = freeBlock->next;
+    blocksInUse++;
+    return freeBlock;
+}
+
+void PoolResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    if (bytes > blockSize || alignment > BLOCK_ALIGNMENT) {
+        upstream->deallocate(pointer, bytes, alignment);
+        return;
+    }
+    FreeBlock* freeBlock = static_cast<FreeBlock*>(pointer);
+    freeBlock->next = freeList;
+    freeList = freeBlock;
+    blocksInUse--;
+}
+
+FrameAllocator::FrameAllocator() {}
+
+FrameAllocator::~FrameAllocator() {
+    Cleanup();
+}
+
+bool FrameAllocator::Initialize(uint32_t frameCount, uint32_t threadCount, size_t arenaSize) {
+    this->frameCount = std::max(frameCount, 1u);
+    this->threadCount = std::max(threadCount, 1u);
+    uint32_t arenaCount = STAGE_COUNT * this->frameCount * this->threadCount;
+    arenas.clear();
+    arenas.reserve(arenaCount);
+    for (uint32_t i = 0; i < arenaCount; i++) {
+        arenas.push_back(std::make_unique<LinearArena>(arenaSize));
+    }
+    for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+        currentSlot[stage].store(0, std::memory_order_relaxed);
+        stageThreads[stage].store(std::thread::id(), std::memory_order_relaxed);
+    }
+    stageThreads[STAGE_RENDER].store(std::this_thread::get_id(), std::memory_order_relaxed);
+    return true;
+}
+
+void FrameAllocator::Cleanup() {
+    FrameAllocator* self = this;
+    current.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+    arenas.clear();
+    frameCount = 0;
+    threadCount = 0;
+}
+
+void FrameAllocator::BeginFrame(uint32_t frameSlot, Stage stage) {
+    if (arenas.empty()) return;
+    uint32_t slot = frameSlot % frameCount;
+    // 该槽位上次的并行任务都已在上次使用时结束，重置不需要同步；另一阶段的线性区不受影响
+    size_t peak = 0;
+    for (uint32_t thread = 0; thread < threadCount; thread++) {
+        LinearArena& arena = *arenas[(stage * frameCount + slot) * threadCount + thread];
+        peak = std::max(peak, arena.GetPeak());
+        arena.Reset();
+    }
+    size_t previousPeak = peakUsage.load(std::memory_order_relaxed);
+    while (peak > previousPeak && !peakUsage.compare_exchange_weak(previousPeak, peak, std::memory_order_relaxed)) {}
+    currentSlot[stage].store(slot, std::memory_order_release);
+    stageThreads[stage].store(std::this_thread::get_id(), std::memory_order_relaxed);
+    threadStage = stage;
+}
+
+std::pmr::memory_resource* FrameAllocator::GetThreadResource() {
+    uint32_t threadIndex = JobSystem::GetThreadIndex();
+    Stage stage = threadStage;
+    if (arenas.empty() || threadIndex >= threadCount ||
+        (threadIndex == 0 && stageThreads[stage].load(std::memory_order_relaxed) != std::this_thread::get_id())) {
+        return std::pmr::new_delete_resource();
+    }
+    uint32_t slot = currentSlot[stage].load(std::memory_order_acquire);
+    return arenas[(stage * frameCount + slot) * threadCount + threadIndex].get();
+}
+
+FrameAllocator::Statistics FrameAllocator::GetStatistics() const {
+    Statistics statistics;
+    statistics.peak = peakUsage.load(std::memory_order_relaxed);
+    for (const auto& arena : arenas) {
+        statistics.capacity += arena->GetCapacity();
+        statistics.peak = std::max(statistics.peak, arena->GetPeak());
+        statistics.overflows += arena->GetOverflowCount();
+    }
+    return statistics;
+}
+
+std::pmr::memory_resource* FrameAllocator::GetResource() {
+    FrameAllocator* allocator = current.load(std::memory_order_acquire);
+    return allocator != nullptr ? allocator->GetThreadResource() : std::pmr::new_delete_resource();
+}
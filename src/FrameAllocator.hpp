@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+// 线性分配器：在一块连续内存上顺序分配，单独释放为空操作，Reset一次丢弃全部分配
+// 容量不足时向上游申请溢出块；Reset时若发生过溢出，主块扩大到本轮峰值，之后的同等负载不再访问上游
+// 非线程安全，每个线程使用自己的实例
+class LinearArena : public std::pmr::memory_resource {
+public:
+    explicit LinearArena(size_t capacity = 0, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~LinearArena() override;
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void Reset();
+
+    size_t GetCapacity() const { return capacity; }
+    size_t GetUsed() const { return used; }
+    // 自上次Reset以来的用量（含溢出块）
+    size_t GetPeak() const { return used + overflowBytes; }
+    uint64_t GetOverflowCount() const { return overflowCount; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    // 溢出块头部，块按链表在Reset时归还上游
+    struct OverflowBlock {
+        OverflowBlock* next;
+        size_t size;
+    };
+
+    static const size_t BLOCK_ALIGNMENT = 64;
+
+    std::pmr::memory_resource* upstream;
+    uint8_t* block = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+
+    OverflowBlock* overflow = nullptr;
+    size_t overflowUsed = 0;        // 当前溢出块中已用的字节
+    size_t overflowBytes = 0;       // 本轮溢出分配的总字节
+    uint64_t overflowCount = 0;     // 累计向上游申请溢出块的次数
+};
+
+// 定长块池：不超过blockSize的分配从空闲链表取块，链表为空时按chunk批量向上游申请，
+// 块只在析构时归还；更大或对齐要求更高的分配直接转给上游
+// 非线程安全，共享时由使用者加锁
+class PoolResource : public std::pmr::memory_resource {
+public:
+    explicit PoolResource(size_t blockSize, size_t blocksPerChunk = 64,
+                          std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~PoolResource() override;
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    // 预先准备至少count个空闲块（启动时调用，避免帧内首次使用时申请）
+    void Reserve(size_t count);
+
+    size_t GetBlockSize() const { return blockSize; }
+    size_t GetBlocksInUse() const { return blocksInUse; }
+    size_t GetTotalBlocks() const { return totalBlocks; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct Chunk {
+        Chunk* next;
+    };
+
+    static const size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+    void AddChunk();
+
+    std::pmr::memory_resource* upstream;
+    size_t blockSize;
+    size_t blocksPerChunk;
+    Chunk* chunks = nullptr;
+    FreeBlock* freeList = nullptr;
+    size_t blocksInUse = 0;
+    size_t totalBlocks = 0;
+};
+
+// 每帧内存：每个阶段（渲染、模拟）的每个飞行帧槽位为该阶段的线程和每个工作线程各持有一个LinearArena，
+// 阶段线程等待该槽位可重用后调用BeginFrame重置本阶段该槽位的全部线性区，
+// 其中的分配因此在同一槽位下次使用前一直有效（可供GPU读取前的CPU侧数据使用）
+// 工作线程在ParallelFor任务中使用提交线程所属阶段的线性区，两个阶段可同时并行而互不重置对方的内存；
+// 与帧无关的后台线程得到默认堆资源
+class FrameAllocator {
+public:
+    static const size_t DEFAULT_ARENA_SIZE = 256 * 1024;
+
+    enum Stage : uint32_t {
+        STAGE_RENDER = 0,
+        STAGE_SIMULATION = 1,
+        STAGE_COUNT
+    };
+
+    struct Statistics {
+        size_t capacity = 0;            // 全部线性区的容量之和
+        size_t peak = 0;                // 单个线性区的最大单帧用量
+        uint64_t overflows = 0;         // 累计溢出次数，稳定后应不再增长
+    };
+
+    // 存活期间当前线程按stage取线性区（JobSystem在协助执行ParallelFor时使用），可嵌套
+    class StageScope {
+    public:
+        explicit StageScope(Stage stage) : previous(threadStage) { threadStage = stage; }
+        ~StageScope() { threadStage = previous; }
+
+        StageScope(const StageScope&) = delete;
+        StageScope& operator=(const StageScope&) = delete;
+
+    private:
+        Stage previous;
+    };
+
+    FrameAllocator();
+    ~FrameAllocator();
+
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    // threadCount包含阶段线程（JobSystem工作线程数 + 1）
+    bool Initialize(uint32_t frameCount, uint32_t threadCount, size_t arenaSize = DEFAULT_ARENA_SIZE);
+    void Cleanup();
+
+    // 阶段线程在该槽位可重用之后调用（渲染线程在等待飞行栅栏之后），调用线程成为该阶段的线程
+    void BeginFrame(uint32_t frameSlot, Stage stage = STAGE_RENDER);
+
+    // 当前线程在所属阶段当前槽位的线性区；既不是阶段线程也不是工作线程时为默认堆资源
+    std::pmr::memory_resource* GetThreadResource();
+    Statistics GetStatistics() const;
+
+    // 当前线程所属的阶段，ParallelFor据此让工作线程使用同一阶段的线性区
+    static Stage GetThreadStage() { return threadStage; }
+
+    // 全局实例：Scene、Bvh等不持有上下文的模块经此取得资源，未设置时返回默认堆资源
+    static void SetCurrent(FrameAllocator* allocator) { current.store(allocator, std::memory_order_release); }
+    static std::pmr::memory_resource* GetResource();
+
+private:
+    uint32_t frameCount = 0;
+    uint32_t threadCount = 0;
+    // arenas[(stage * frameCount + frameSlot) * threadCount + threadIndex]
+    std::vector<std::unique_ptr<LinearArena>> arenas;
+    std::atomic<uint32_t> currentSlot[STAGE_COUNT] = {};
+    std::atomic<std::thread::id> stageThreads[STAGE_COUNT] = {};
+    std::atomic<size_t> peakUsage{0};   // 已重置的各轮中单个线性区的最大用量
+
+    static std::atomic<FrameAllocator*> current;
+    static thread_local Stage threadStage;
+};
@@ -0,0 +1,392 @@
+#include "FrameCapture.hpp"
+#include "VulkanContext.hpp"
+#include "Renderer.hpp"
+#include "Swapchain.hpp"
+#include "Scene.hpp"
+#include "GeometryPool.hpp"
+#include "OcclusionCuller.hpp"
+#include "FramePipeline.hpp"
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    const char CAPTURE_MAGIC[4] = {'V', 'G', 'E', 'F'};
+
+    template <typename T>
+    void Write(std::vector<char>& out, const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteBlob(std::vector<char>& out, const char* data, uint64_t size) {
+        Write(out, size);
+        out.insert(out.end(), data, data + size);
+    }
+
+    void WriteString(std::vector<char>& out, const std::string& value) {
+        WriteBlob(out, value.data(), value.size());
+    }
+
+    // 按顺序读取块数据，越界后所有读取失败
+    struct Reader {
+        const char* data;
+        uint64_t size;
+        uint64_t offset = 0;
+        bool valid = true;
+
+        template <typename T>
+        bool Read(T& value) {
+            if (!valid || size - offset < sizeof(T)) return valid = false;
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool ReadBlob(std::vector<char>& value) {
+            uint64_t length = 0;
+            if (!Read(length) || size - offset < length) return valid = false;
+            value.assign(data + offset, data + offset + length);
+            offset += length;
+            return true;
+        }
+
+        bool ReadString(std::string& value) {
+            std::vector<char> bytes;
+            if (!ReadBlob(bytes)) return false;
+            value.assign(bytes.begin(), bytes.end());
+            return true;
+        }
+    };
+
+    void AppendChunk(std::vector<char>& out, FrameCapture::ChunkType type, const std::vector<char>& payload) {
+        FrameCapture::ChunkHeader header{type, 0, payload.size()};
+        Write(out, header);
+        out.insert(out.end(), payload.begin(), payload.end());
+    }
+}
+
+FrameCapture::FrameCapture() : passEnabled(VulkanContext::PASS_COUNT, 1) {}
+
+bool FrameCapture::Record(VulkanContext* context) {
+    const Scene* scene = context->GetScene();
+    const GeometryPool* geometryPool = context->GetGeometryPool();
+    const LodSelector* lodSelector = context->GetLodSelector();
+
+    VkExtent2D extent = context->GetSwapchain()->GetExtent();
+    width = extent.width;
+    height = extent.height;
+    frameNumber = context->GetFrameNumber();
+
+    shaders.clear();
+    std::vector<const char*> shaderPaths = Renderer::GetShaderPaths();
+    for (const char* path : OcclusionCuller::GetShaderPaths()) {
+        shaderPaths.push_back(path);
+    }
+    for (const char* path : shaderPaths) {
+        Shader shader;
+        shader.path = path;
+        try {
+            shader.code = context->LoadShaderCode(path);
+        } catch (const std::exception& e) {
+            std::cerr << "frame capture: cannot read shader " << path << ": " << e.what() << std::endl;
+            return false;
+        }
+        shaders.push_back(std::move(shader));
+    }
+
+    meshes.clear();
+    for (MeshHandle handle = 0; handle < geometryPool->GetMeshCount(); handle++) {
+        const std::vector<char>* source = geometryPool->GetSourceData(handle);
+        if (source == nullptr) {
+            std::cerr << "frame capture: mesh data was not retained, enable capture before Initialize" << std::endl;
+            return false;
+        }
+        meshes.push_back(Mesh{geometryPool->GetMesh(handle).name, *source});
+    }
+
+    // DrawFrame已整理过层级，密集顺序中父节点总在子节点之前
+    nodes.assign(scene->GetNodeCount(), Node{});
+    const uint32_t* parents = scene->GetParentIndices();
+    const Mat4* localMatrices = scene->GetLocalMatrices();
+    const AABB* localBounds = scene->GetLocalBounds();
+    const uint8_t* boundsFlags = scene->GetBoundsFlags();
+    for (uint32_t i = 0; i < scene->GetNodeCount(); i++) {
+        Node& node = nodes[i];
+        node.local = localMatrices[i];
+        node.bounds = localBounds[i];
+        node.parent = parents[i];
+        node.hasBounds = boundsFlags[i];
+        node.mesh = lodSelector->GetMesh(scene->GetHandle(i));
+    }
+
+    drawItems.clear();
+    for (const OcclusionCuller::DrawItem& item : context->GetOcclusionCuller()->GetDrawItems()) {
+        DrawItem captured;
+        captured.node = scene->IsValid(item.node) ? scene->GetIndex(item.node) : UINT32_MAX;
+        captured.mesh = item.mesh;
+        captured.indexCount = item.indexCount;
+        captured.firstIndex = item.firstIndex;
+        captured.vertexOffset = item.vertexOffset;
+        captured.objectIndex = item.objectIndex;
+        drawItems.push_back(captured);
+    }
+
+    // 视图取自本帧录制所用的快照；场景取自最近一次模拟，流水线深度大于1时可能领先快照数帧
+    const RenderSnapshot& snapshot = context->GetFramePipeline()->GetRenderSnapshot();
+    view.viewProjection = snapshot.viewProjection;
+    view.lodCamera = snapshot.lodCamera;
+    view.lodSettings = snapshot.lodSettings;
+
+    passEnabled.resize(VulkanContext::PASS_COUNT);
+    for (uint32_t pass = 0; pass < VulkanContext::PASS_COUNT; pass++) {
+        passEnabled[pass] = context->IsFramePassEnabled(static_cast<VulkanContext::FramePass>(pass)) ? 1 : 0;
+    }
+    return true;
+}
+
+bool FrameCapture::Save(const std::string& path) const {
+    std::vector<char> body;
+    uint32_t chunkCount = 0;
+
+    for (const Shader& shader : shaders) {
+        std::vector<char> payload;
+        WriteString(payload, shader.path);
+        WriteBlob(payload, shader.code.data(), shader.code.size());
+        AppendChunk(body, CHUNK_SHADER, payload);
+        chunkCount++;
+    }
+    for (const Mesh& mesh : meshes) {
+        std::vector<char> payload;
+        WriteString(payload, mesh.name);
+        WriteBlob(payload, mesh.data.data(), mesh.data.size());
+        AppendChunk(body, CHUNK_MESH, payload);
+        chunkCount++;
+    }
+
+    std::vector<char> payload;
+    Write(payload, static_cast<uint32_t>(nodes.size()));
+    for (const Node& node : nodes) {
+        Write(payload, node);
+    }
+    AppendChunk(body, CHUNK_SCENE, payload);
+
+    payload.clear();
+    Write(payload, static_cast<uint32_t>(drawItems.size()));
+    for (const DrawItem& item : drawItems) {
+        Write(payload, item);
+    }
+    AppendChunk(body, CHUNK_DRAW_ITEMS, payload);
+
+    payload.clear();
+    Write(payload, view.viewProjection);
+    Write(payload, view.lodCamera.position);
+    Write(payload, view.lodCamera.projectionScale);
+    Write(payload, view.lodSettings.errorThreshold);
+    Write(payload, view.lodSettings.hysteresis);
+    AppendChunk(body, CHUNK_VIEW, payload);
+
+    payload.clear();
+    Write(payload, static_cast<uint32_t>(passEnabled.size()));
+    payload.insert(payload.end(), passEnabled.begin(), passEnabled.end());
+    AppendChunk(body, CHUNK_PASSES, payload);
+    chunkCount += 4;
+
+    FileHeader header{};
+    std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.width = width;
+    header.height = height;
+    header.frameNumber = frameNumber;
+    header.chunkCount = chunkCount;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "failed to open capture file for writing: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(body.data(), static_cast<std::streamsize>(body.size()));
+    if (!file) {
+        std::cerr << "failed to write capture file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool FrameCapture::Load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "failed to open capture file: " << path << std::endl;
+        return false;
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    FileHeader header;
+    if (contents.size() < sizeof(header)) {
+        std::cerr << "capture file too small: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (std::memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION) {
+        std::cerr << "unsupported capture file: " << path << std::endl;
+        return false;
+    }
+    width = header.width;
+    height = header.height;
+    frameNumber = header.frameNumber;
+    shaders.clear();
+    meshes.clear();
+    nodes.clear();
+    drawItems.clear();
+    view = View{};
+    passEnabled.assign(VulkanContext::PASS_COUNT, 1);
+
+    Reader fileReader{contents.data(), contents.size()};
+    fileReader.offset = sizeof(header);
+    for (uint32_t c = 0; c < header.chunkCount; c++) {
+        ChunkHeader chunk;
+        if (!fileReader.Read(chunk) || fileReader.size - fileReader.offset < chunk.size) {
+            std::cerr << "truncated capture file: " << path << std::endl;
+            return false;
+        }
+        Reader reader{contents.data() + fileReader.offset, chunk.size};
+        fileReader.offset += chunk.size;
+
+        uint32_t count = 0;
+        switch (chunk.type) {
+            case CHUNK_SHADER: {
+                Shader shader;
+                reader.ReadString(shader.path);
+                reader.ReadBlob(shader.code);
+                shaders.push_back(std::move(shader));
+                break;
+            }
+            case CHUNK_MESH: {
+                Mesh mesh;
+                reader.ReadString(mesh.name);
+                reader.ReadBlob(mesh.data);
+                meshes.push_back(std::move(mesh));
+                break;
+            }
+            case CHUNK_SCENE:
+                reader.Read(count);
+                for (uint32_t i = 0; i < count && reader.valid; i++) {
+                    Node node{};
+                    reader.Read(node);
+                    nodes.push_back(node);
+                }
+                break;
+            case CHUNK_DRAW_ITEMS:
+                reader.Read(count);
+                for (uint32_t i = 0; i < count && reader.valid; i++) {
+                    DrawItem item;
+                    reader.Read(item);
+                    drawItems.push_back(item);
+                }
+                break;
+            case CHUNK_VIEW:
+                reader.Read(view.viewProjection);
+                reader.Read(view.lodCamera.position);
+                reader.Read(view.lodCamera.projectionScale);
+                reader.Read(view.lodSettings.errorThreshold);
+                reader.Read(view.lodSettings.hysteresis);
+                break;
+            case CHUNK_PASSES:
+                reader.Read(count);
+                for (uint32_t i = 0; i < count && reader.valid; i++) {
+                    uint8_t enabled = 1;
+                    reader.Read(enabled);
+                    if (i < passEnabled.size()) passEnabled[i] = enabled;
+                }
+                break;
+            default:
+                // 未知块：跳过，便于向后兼容
+                break;
+        }
+        if (!reader.valid) {
+            std::cerr << "corrupt chunk " << chunk.type << " in capture file: " << path << std::endl;
+            return false;
+        }
+    }
+
+    // 父节点须在子节点之前，网格序号须有效
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        if ((nodes[i].parent != UINT32_MAX && nodes[i].parent >= i) ||
+            (nodes[i].mesh != UINT32_MAX && nodes[i].mesh >= meshes.size())) {
+            std::cerr << "invalid scene node " << i << " in capture file: " << path << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void FrameCapture::ApplyShaders(VulkanContext* context) const {
+    for (const Shader& shader : shaders) {
+        context->SetShaderOverride(shader.path, shader.code);
+    }
+}
+
+bool FrameCapture::Restore(VulkanContext* context) const {
+    Scene* scene = context->GetScene();
+    GeometryPool* geometryPool = context->GetGeometryPool();
+    LodSelector* lodSelector = context->GetLodSelector();
+
+    // 捕获文件中的网格序号 -> 当前几何池句柄
+    std::vector<MeshHandle> meshHandles(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++) {
+        meshHandles[i] = geometryPool->AddMesh(meshes[i].name, meshes[i].data);
+        if (meshHandles[i] == INVALID_MESH) {
+            std::cerr << "frame capture: failed to restore mesh " << meshes[i].name << std::endl;
+            return false;
+        }
+    }
+    auto remapMesh = [&](uint32_t mesh) {
+        return mesh < meshHandles.size() ? meshHandles[mesh] : INVALID_MESH;
+    };
+
+    std::vector<NodeHandle> nodeHandles(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const Node& node = nodes[i];
+        NodeHandle parent = node.parent == UINT32_MAX ? INVALID_NODE : nodeHandles[node.parent];
+        NodeHandle handle = scene->CreateNode(parent);
+        scene->SetLocalMatrix(handle, node.local);
+        if (node.hasBounds) {
+            scene->SetLocalBounds(handle, node.bounds);
+        }
+        if (node.mesh != UINT32_MAX) {
+            lodSelector->SetMesh(handle, remapMesh(node.mesh));
+        }
+        nodeHandles[i] = handle;
+    }
+
+    std::vector<OcclusionCuller::DrawItem> items;
+    items.reserve(drawItems.size());
+    for (const DrawItem& captured : drawItems) {
+        OcclusionCuller::DrawItem item;
+        item.node = captured.node < nodeHandles.size() ? nodeHandles[captured.node] : INVALID_NODE;
+        item.mesh = captured.mesh == INVALID_MESH ? INVALID_MESH : remapMesh(captured.mesh);
+        item.indexCount = captured.indexCount;
+        item.firstIndex = captured.firstIndex;
+        item.vertexOffset = captured.vertexOffset;
+        item.objectIndex = captured.objectIndex;
+        items.push_back(item);
+    }
+    context->GetOcclusionCuller()->SetDrawItems(items);
+
+    LodCamera lodCamera = view.lodCamera;
+    VkExtent2D extent = context->GetSwapchain()->GetExtent();
+    if (height != 0 && extent.height != height) {
+        lodCamera.projectionScale *= static_cast<float>(extent.height) / static_cast<float>(height);
+    }
+    context->SetCameraViewProjection(view.viewProjection);
+    context->SetLodCamera(lodCamera);
+    lodSelector->SetSettings(view.lodSettings);
+
+    for (uint32_t pass = 0; pass < VulkanContext::PASS_COUNT; pass++) {
+        context->SetFramePassEnabled(static_cast<VulkanContext::FramePass>(pass), passEnabled[pass] != 0);
+    }
+    return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "LodSelector.hpp"
+#include "MathTypes.hpp"
+
+class VulkanContext;
+
+// 帧捕获文件（.vgef）：记录重放一帧所需的全部输入——着色器SPIR-V、几何池中的烘焙网格、
+// 场景层级、遮挡剔除的实例列表、相机与LOD参数以及启用的帧通道，
+// 回放时在无窗口上下文中重建这些状态，按同样的通道顺序重新录制命令
+// 文件布局：FileHeader，随后chunkCount个块，每块为ChunkHeader加size字节数据
+class FrameCapture {
+public:
+    static const uint32_t VERSION = 1;
+
+    enum ChunkType : uint32_t {
+        CHUNK_SHADER = 0,       // 路径 + SPIR-V
+        CHUNK_MESH = 1,         // 名称 + 烘焙网格数据，按MeshHandle顺序
+        CHUNK_SCENE = 2,        // 节点数组，按场景密集索引顺序
+        CHUNK_DRAW_ITEMS = 3,   // 遮挡剔除实例，节点为密集索引
+        CHUNK_VIEW = 4,         // 相机视图投影、LOD相机与LOD设置
+        CHUNK_PASSES = 5        // 各帧通道是否启用
+    };
+
+    struct FileHeader {
+        char magic[4];          // "VGEF"
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint64_t frameNumber;
+        uint32_t chunkCount;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(FileHeader) == 32, "FileHeader layout mismatch");
+
+    struct ChunkHeader {
+        uint32_t type;
+        uint32_t reserved;
+        uint64_t size;
+    };
+    static_assert(sizeof(ChunkHeader) == 16, "ChunkHeader layout mismatch");
+
+    struct Shader {
+        std::string path;
+        std::vector<char> code;
+    };
+
+    struct Mesh {
+        std::string name;
+        std::vector<char> data;
+    };
+
+    struct Node {
+        Mat4 local;
+        AABB bounds;
+        uint32_t parent;        // 密集索引，根节点为UINT32_MAX，总小于自身索引
+        uint32_t hasBounds;
+        uint32_t mesh;          // 捕获文件中的网格序号，无网格为UINT32_MAX
+        uint32_t padding[3];
+    };
+    static_assert(sizeof(Node) == 112, "Node layout mismatch");
+
+    struct DrawItem {
+        uint32_t node;          // 密集索引，UINT32_MAX为无节点
+        uint32_t mesh;
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t objectIndex;
+    };
+
+    struct View {
+        Mat4 viewProjection;
+        LodCamera lodCamera;
+        LodSettings lodSettings;
+    };
+
+    FrameCapture();
+
+    // 记录上下文当前帧的输入；须在VulkanContext::SetCaptureEnabled(true)后初始化，否则网格数据不可用
+    // 在渲染线程上调用，调用方须持有FramePipeline::LockSimulation
+    bool Record(VulkanContext* context);
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+
+    // 回放：ApplyShaders在Initialize之前调用，Restore在Initialize之后调用
+    // 分辨率与捕获时不同时按高度缩放LOD相机的投影系数
+    void ApplyShaders(VulkanContext* context) const;
+    bool Restore(VulkanContext* context) const;
+
+    uint32_t GetWidth() const { return width; }
+    uint32_t GetHeight() const { return height; }
+    uint64_t GetFrameNumber() const { return frameNumber; }
+    const std::vector<Shader>& GetShaders() const { return shaders; }
+    const std::vector<Mesh>& GetMeshes() const { return meshes; }
+    const std::vector<Node>& GetNodes() const { return nodes; }
+    const std::vector<DrawItem>& GetDrawItems() const { return drawItems; }
+    const View& GetView() const { return view; }
+
+private:
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t frameNumber = 0;
+    std::vector<Shader> shaders;
+    std::vector<Mesh> meshes;
+    std::vector<Node> nodes;
+    std::vector<DrawItem> drawItems;
+    View view;
+    std::vector<uint8_t> passEnabled;
+};
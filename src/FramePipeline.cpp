@@ -0,0 +1,257 @@
+#include "FramePipeline.hpp"
+#include "VulkanContext.hpp"
+#include "AllocationTracker.hpp"
+#include "FrameAllocator.hpp"
+#include "JobSystem.hpp"
+#include "Metrics.hpp"
+#include "Profiler.hpp"
+#include "SceneCuller.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+    // 变换拷贝的并行粒度（节点）
+    const uint32_t EXTRACT_GRAIN = 4096;
+
+    double Milliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    uint32_t ClampDepth(uint32_t depth) {
+        if (depth < 1) return 1;
+        return depth > FramePipeline::MAX_DEPTH ? FramePipeline::MAX_DEPTH : depth;
+    }
+}
+
+FramePipeline::FramePipeline(VulkanContext* context) : context(context) {
+    if (const char* value = std::getenv("VGE_PIPELINE_DEPTH")) {
+        depth = ClampDepth(static_cast<uint32_t>(std::strtoul(value, nullptr, 10)));
+    }
+}
+
+FramePipeline::~FramePipeline() {
+    Stop();
+}
+
+void FramePipeline::SetDepth(uint32_t newDepth) {
+    newDepth = ClampDepth(newDepth);
+    if (newDepth == depth) return;
+    Stop();
+    depth = newDepth;
+    // 统计按深度分开，便于对比各深度的延迟
+    statistics = Statistics();
+}
+
+const RenderSnapshot& FramePipeline::AcquireSnapshot() {
+    if (depth == 1) {
+        // 逐帧同步：在渲染线程上模拟，快照固定为第一个
+        Simulate(snapshots[0]);
+        renderSnapshot = &snapshots[0];
+        statistics.simulationMilliseconds = Milliseconds(renderSnapshot->simulationEnd - renderSnapshot->simulationBegin);
+        statistics.copiedNodes = renderSnapshot->copiedNodes;
+        return *renderSnapshot;
+    }
+
+    if (!thread.joinable()) {
+        thread = std::thread(&FramePipeline::ThreadMain, this);
+    }
+
+    auto waitBegin = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(queueMutex);
+    {
+        VGE_PROFILE_ZONE("WaitForSimulation");
+        queueCondition.wait(lock, [this]() { return produced > acquired || failure != nullptr; });
+    }
+    if (failure) {
+        // 模拟线程因异常退出，丢弃其余快照后在渲染线程上重新抛出
+        std::exception_ptr error = failure;
+        failure = nullptr;
+        statistics.droppedFrames += produced - acquired;
+        produced = acquired = released = 0;
+        lock.unlock();
+        thread.join();
+        std::rethrow_exception(error);
+    }
+    renderSnapshot = &snapshots[acquired % depth];
+    acquired++;
+    statistics.simulationWaitMilliseconds = simulationWaitMilliseconds;
+    lock.unlock();
+
+    statistics.renderWaitMilliseconds += Milliseconds(std::chrono::steady_clock::now() - waitBegin);
+    statistics.simulationMilliseconds = Milliseconds(renderSnapshot->simulationEnd - renderSnapshot->simulationBegin);
+    statistics.copiedNodes = renderSnapshot->copiedNodes;
+    return *renderSnapshot;
+}
+
+void FramePipeline::ReleaseSnapshot(bool submitted) {
+    if (submitted) {
+        // 流水线增加的延迟：快照的模拟开始到命令提交
+        double latency = Milliseconds(std::chrono::steady_clock::now() - renderSnapshot->simulationBegin);
+        statistics.frames++;
+        statistics.latencyMilliseconds = latency;
+        statistics.averageLatencyMilliseconds += (latency - statistics.averageLatencyMilliseconds) / static_cast<double>(statistics.frames);
+        statistics.maxLatencyMilliseconds = std::max(statistics.maxLatencyMilliseconds, latency);
+        context->GetMetrics()->Add(Metrics::PIPELINE_LATENCY_US, static_cast<uint64_t>(latency * 1000.0));
+    } else {
+        statistics.droppedFrames++;
+    }
+
+    if (depth == 1) return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        released++;
+    }
+    queueCondition.notify_all();
+}
+
+void FramePipeline::Stop() {
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopRequested = true;
+    }
+    queueCondition.notify_all();
+    thread.join();
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (failure) {
+        try {
+            std::rethrow_exception(failure);
+        } catch (const std::exception& e) {
+            std::cerr << "Simulation thread failed: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Simulation thread failed" << std::endl;
+        }
+        failure = nullptr;
+    }
+    // 已生成但未录制的快照被丢弃，场景保持在最后一次模拟后的状态
+    statistics.droppedFrames += produced - acquired;
+    produced = acquired = released = 0;
+    stopRequested = false;
+}
+
+FramePipeline::Statistics FramePipeline::GetStatistics() const {
+    return statistics;
+}
+
+void FramePipeline::ThreadMain() {
+    VGE_PROFILE_THREAD("Simulation");
+    // 模拟线程的分配计入渲染线程跟踪的帧
+    AllocationTracker::TrackCurrentThread();
+    try {
+        while (true) {
+            RenderSnapshot* snapshot = nullptr;
+            uint64_t sequence = 0;
+            {
+                auto waitBegin = std::chrono::steady_clock::now();
+                std::unique_lock<std::mutex> lock(queueMutex);
+                {
+                    VGE_PROFILE_ZONE("WaitForRenderer");
+                    // 最多depth个快照未被渲染线程用完
+                    queueCondition.wait(lock, [this]() { return stopRequested || produced - released < depth; });
+                }
+                if (stopRequested) break;
+                simulationWaitMilliseconds += Milliseconds(std::chrono::steady_clock::now() - waitBegin);
+                sequence = produced;
+                snapshot = &snapshots[sequence % depth];
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(simulationMutex);
+                // 模拟阶段的临时数据使用独立的线性区，不与渲染线程的槽位互相重置
+                context->GetFrameAllocator()->BeginFrame(static_cast<uint32_t>(sequence), FrameAllocator::STAGE_SIMULATION);
+                Simulate(*snapshot);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                produced++;
+            }
+            queueCondition.notify_all();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        failure = std::current_exception();
+    }
+    queueCondition.notify_all();
+}
+
+void FramePipeline::Simulate(RenderSnapshot& snapshot) {
+    VGE_PROFILE_ZONE("Simulation");
+    snapshot.simulationBegin = std::chrono::steady_clock::now();
+    uint64_t frame = simulationFrame++;
+    // 回调看到的是按当前显示高度缩放后的LOD相机，可以再覆盖
+    context->UpdateLodProjection();
+    if (simulationCallback) {
+        simulationCallback(frame);
+    }
+
+    Scene* scene = context->GetScene();
+    SceneCuller* sceneCuller = context->GetSceneCuller();
+    LodSelector* lodSelector = context->GetLodSelector();
+    scene->UpdateWorldMatrices();
+    sceneCuller->Update();
+
+    snapshot.frame = frame;
+    snapshot.viewProjection = context->GetCameraViewProjection();
+    snapshot.lodCamera = context->GetLodCamera();
+    snapshot.lodSettings = lodSelector->GetSettings();
+    sceneCuller->Cull(snapshot.viewProjection, snapshot.visibleNodes);
+    lodSelector->Select(snapshot.visibleNodes, snapshot.lodCamera, snapshot.visibleLods);
+    lodSelector->CollectTextureRequests(snapshot.visibleNodes, snapshot.lodCamera, snapshot.textureRequests);
+
+    // 序号从1开始，0表示快照中还没有变换
+    ExtractTransforms(snapshot, frame + 1);
+    snapshot.simulationEnd = std::chrono::steady_clock::now();
+}
+
+void FramePipeline::ExtractTransforms(RenderSnapshot& snapshot, uint64_t stamp) {
+    VGE_PROFILE_ZONE("ExtractTransforms");
+    const Scene* scene = context->GetScene();
+    JobSystem* jobSystem = context->GetJobSystem();
+    uint32_t count = scene->GetNodeCount();
+    uint64_t version = scene->GetStructureVersion();
+
+    // 记录每个节点最近一次改变的序号；密集索引重排后旧序号失效，各快照都会整体重新拷贝
+    if (version != stampStructureVersion || nodeStamps.size() != count) {
+        nodeStamps.assign(count, stamp);
+        stampStructureVersion = version;
+    } else if (scene->GetChangedCount() > 0) {
+        const uint8_t* changed = scene->GetChangedFlags();
+        jobSystem->ParallelFor(count, EXTRACT_GRAIN, [this, changed, stamp](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                if (changed[i]) nodeStamps[i] = stamp;
+            }
+        });
+    }
+
+    const Mat4* worldMatrices = scene->GetWorldMatrices();
+    const AABB* worldBounds = scene->GetWorldBounds();
+    const uint8_t* boundsFlags = scene->GetBoundsFlags();
+    if (snapshot.structureVersion != version) {
+        snapshot.worldMatrices.assign(worldMatrices, worldMatrices + count);
+        snapshot.worldBounds.assign(worldBounds, worldBounds + count);
+        snapshot.boundsFlags.assign(boundsFlags, boundsFlags + count);
+        snapshot.handleIndices.assign(scene->GetHandleIndices(), scene->GetHandleIndices() + scene->GetHandleCount());
+        snapshot.structureVersion = version;
+        snapshot.copiedNodes = count;
+    } else {
+        // 写时复制：快照上次生成之后没有改变的节点沿用已有的副本
+        uint64_t previous = snapshot.transformStamp;
+        copiedNodes.store(0, std::memory_order_relaxed);
+        jobSystem->ParallelFor(count, EXTRACT_GRAIN, [&](uint32_t begin, uint32_t end) {
+            uint32_t copied = 0;
+            for (uint32_t i = begin; i < end; i++) {
+                if (nodeStamps[i] <= previous) continue;
+                snapshot.worldMatrices[i] = worldMatrices[i];
+                snapshot.worldBounds[i] = worldBounds[i];
+                snapshot.boundsFlags[i] = boundsFlags[i];
+                copied++;
+            }
+            if (copied > 0) copiedNodes.fetch_add(copied, std::memory_order_relaxed);
+        });
+        snapshot.copiedNodes = copiedNodes.load(std::memory_order_relaxed);
+    }
+    snapshot.transformStamp = stamp;
+}
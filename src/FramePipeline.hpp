@@ -0,0 +1,133 @@
+#pragma once
+#include "LodSelector.hpp"
+#include "MathTypes.hpp"
+#include "Scene.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class VulkanContext;
+
+// 一帧命令录制所需的场景数据：由模拟阶段生成，交给渲染线程后只读
+struct RenderSnapshot {
+    uint64_t frame = 0;                                     // 模拟帧号
+    std::chrono::steady_clock::time_point simulationBegin;
+    std::chrono::steady_clock::time_point simulationEnd;
+
+    // 相机与LOD参数
+    Mat4 viewProjection = Mat4::Identity();
+    LodCamera lodCamera;
+    LodSettings lodSettings;
+
+    // 变换：Scene密集数组的SoA副本，结构不变时只重新拷贝该快照上次生成之后改变过的节点
+    std::vector<Mat4> worldMatrices;
+    std::vector<AABB> worldBounds;
+    std::vector<uint8_t> boundsFlags;
+    std::vector<uint32_t> handleIndices;                    // 句柄到密集索引
+    uint64_t structureVersion = UINT64_MAX;
+    uint64_t transformStamp = 0;                            // 上次拷贝变换时的模拟步序号（从1开始）
+    uint32_t copiedNodes = 0;                               // 本次生成时拷贝的节点变换
+
+    // 可见集：可见节点的密集索引与选中的LOD一一对应
+    std::vector<uint32_t> visibleNodes;
+    std::vector<uint8_t> visibleLods;
+    // 可见节点关联的流式纹理的驻留请求，渲染线程在调度纹理加载前提交
+    std::vector<TextureRequest> textureRequests;
+
+    bool IsValid(NodeHandle node) const { return node < handleIndices.size() && handleIndices[node] != INVALID_NODE; }
+    uint32_t GetIndex(NodeHandle node) const { return handleIndices[node]; }
+    uint32_t GetNodeCount() const { return static_cast<uint32_t>(worldMatrices.size()); }
+};
+
+// 模拟与渲染的帧流水线：模拟阶段（应用回调、世界矩阵、场景剔除、LOD选择）把结果写入快照，
+// 渲染线程只从快照录制命令。深度为1时模拟在DrawFrame中同步执行（与之前的逐帧同步相同）；
+// 深度为N（N>1）时模拟在独立线程上最多领先渲染N-1帧，渲染线程录制第k帧的同时模拟第k+1帧。
+// 快照轮换使用，默认3个（一个正在录制、一个已就绪、一个正在生成）。
+// 延迟按快照的模拟开始到命令提交计时，计入Metrics的pipeline_latency_us
+class FramePipeline {
+public:
+    static const uint32_t MAX_DEPTH = 3;
+    static const uint32_t DEFAULT_DEPTH = 3;
+
+    // 在模拟阶段开始时调用：修改场景、相机（VulkanContext::SetCameraViewProjection/SetLodCamera）和LOD设置
+    // 深度大于1时在模拟线程上运行，与渲染线程并行
+    using SimulationCallback = std::function<void(uint64_t frame)>;
+
+    struct Statistics {
+        uint64_t frames = 0;                    // 已提交的快照
+        uint64_t droppedFrames = 0;             // 生成后未提交（跳过的帧或停止时丢弃）
+        double simulationMilliseconds = 0.0;    // 最近一帧的模拟阶段耗时
+        double latencyMilliseconds = 0.0;       // 最近一帧从模拟开始到提交
+        double averageLatencyMilliseconds = 0.0;
+        double maxLatencyMilliseconds = 0.0;
+        double renderWaitMilliseconds = 0.0;    // 渲染线程等待快照的累计时间
+        double simulationWaitMilliseconds = 0.0;// 模拟线程等待空闲快照的累计时间
+        uint32_t copiedNodes = 0;               // 最近一帧拷贝到快照的节点变换
+    };
+
+    explicit FramePipeline(VulkanContext* context);
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    // 1..MAX_DEPTH，环境变量VGE_PIPELINE_DEPTH可设置初始值；在帧之间由渲染线程调用，
+    // 运行中改变时先停止模拟线程并丢弃尚未录制的快照，统计清零
+    void SetDepth(uint32_t depth);
+    uint32_t GetDepth() const { return depth; }
+    // 须在第一帧之前设置
+    void SetSimulationCallback(SimulationCallback callback) { simulationCallback = std::move(callback); }
+
+    // 渲染线程：取得下一帧的快照，深度为1时在调用线程上模拟；模拟线程的异常在此重新抛出
+    const RenderSnapshot& AcquireSnapshot();
+    // 渲染线程：快照的命令已提交（submitted为false表示跳过了该帧），之后快照可被模拟阶段重用
+    void ReleaseSnapshot(bool submitted);
+    // 最近一次取得的快照，只应在渲染线程上于Acquire与Release之间读取
+    const RenderSnapshot& GetRenderSnapshot() const { return *renderSnapshot; }
+
+    // 停止模拟线程，丢弃尚未录制的快照（Cleanup与改变深度时调用）
+    void Stop();
+
+    // 持有期间模拟阶段不运行，其他线程可安全访问Scene与LodSelector（如帧捕获）
+    std::unique_lock<std::mutex> LockSimulation() { return std::unique_lock<std::mutex>(simulationMutex); }
+
+    Statistics GetStatistics() const;
+
+private:
+    void ThreadMain();
+    void Simulate(RenderSnapshot& snapshot);
+    void ExtractTransforms(RenderSnapshot& snapshot, uint64_t stamp);
+
+    VulkanContext* context;
+    uint32_t depth = DEFAULT_DEPTH;
+    SimulationCallback simulationCallback;
+    RenderSnapshot snapshots[MAX_DEPTH];
+    const RenderSnapshot* renderSnapshot = &snapshots[0];
+
+    // 模拟状态（只在模拟阶段访问）
+    uint64_t simulationFrame = 0;
+    std::vector<uint64_t> nodeStamps;           // 每个节点的世界变换最近改变时的模拟步序号
+    uint64_t stampStructureVersion = UINT64_MAX;
+    std::atomic<uint32_t> copiedNodes{0};
+    double simulationWaitMilliseconds = 0.0;
+    std::mutex simulationMutex;
+
+    // 快照轮换：序号从0开始，快照i位于snapshots[i % depth]
+    std::thread thread;
+    mutable std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    uint64_t produced = 0;                      // 已生成
+    uint64_t acquired = 0;                      // 已交给渲染线程
+    uint64_t released = 0;                      // 渲染线程已用完
+    bool stopRequested = false;
+    std::exception_ptr failure;
+
+    // 渲染线程的统计
+    Statistics statistics;
+};
@@ -0,0 +1,333 @@
+#include "FrameReadback.hpp"
+#include "VulkanContext.hpp"
+#include "Swapchain.hpp"
+#include "MemoryManager.hpp"
+#include "ImageEncoder.hpp"
+#include "Profiler.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <csignal>
+#endif
+
+FrameReadback::FrameReadback(VulkanContext* context) : context(context) {}
+
+FrameReadback::~FrameReadback() {
+    Cleanup();
+}
+
+bool FrameReadback::Initialize() {
+    stopping = false;
+    worker = std::thread(&FrameReadback::WorkerMain, this);
+    return true;
+}
+
+void FrameReadback::Cleanup() {
+    if (worker.joinable()) {
+        Flush();
+        CloseStream();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workAvailable.notify_one();
+        worker.join();
+    }
+    for (Slot& slot : slots) {
+        DestroySlot(slot);
+    }
+}
+
+void FrameReadback::RequestScreenshot(const std::string& path) {
+    pendingScreenshots.push_back(path);
+}
+
+bool FrameReadback::StartStream(const std::string& target, StreamFormat format) {
+    StopStream();
+
+    if (!target.empty() && target[0] == '|') {
+#ifndef _WIN32
+        // 读端退出时让fwrite返回错误而不是终止进程
+        std::signal(SIGPIPE, SIG_IGN);
+        stream = popen(target.c_str() + 1, "w");
+#else
+        stream = popen(target.c_str() + 1, "wb");
+#endif
+        streamIsPipe = true;
+    } else {
+        stream = std::fopen(target.c_str(), "wb");
+    }
+    if (stream == nullptr) {
+        std::cerr << "failed to open frame stream: " << target << std::endl;
+        streamIsPipe = false;
+        return false;
+    }
+
+    streamFormat = format;
+    streamExtent = {0, 0};
+    streamFailed = false;
+    streamActive = true;
+    return true;
+}
+
+void FrameReadback::StopStream() {
+    if (!streamActive) return;
+    // 不再录制新的流帧，已录制的写完后关闭
+    streamActive = false;
+    Flush();
+    CloseStream();
+}
+
+void FrameReadback::CloseStream() {
+    if (stream == nullptr) return;
+    if (streamIsPipe) {
+        pclose(stream);
+    } else {
+        std::fclose(stream);
+    }
+    stream = nullptr;
+    streamIsPipe = false;
+    streamActive = false;
+}
+
+void FrameReadback::CollectCompleted() {
+    VGE_PROFILE_FUNCTION();
+    uint32_t completed[SLOT_COUNT];
+    uint32_t completedCount = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t i = 0; i < SLOT_COUNT; i++) {
+        Slot& slot = slots[i];
+        if (slot.state == SLOT_GPU && vkGetFenceStatus(context->GetDevice(), slot.fence) == VK_SUCCESS) {
+            vmaInvalidateAllocation(context->GetAllocator(), slot.allocation, 0, VK_WHOLE_SIZE);
+            slot.state = SLOT_ENCODING;
+            completed[completedCount++] = i;
+        }
+    }
+    if (completedCount == 0) return;
+
+    // 流中的帧须按录制顺序写出；最多SLOT_COUNT个槽位，直接插入排序
+    for (uint32_t i = 1; i < completedCount; i++) {
+        uint32_t index = completed[i];
+        uint32_t j = i;
+        for (; j > 0 && slots[completed[j - 1]].sequence > slots[index].sequence; j--) {
+            completed[j] = completed[j - 1];
+        }
+        completed[j] = index;
+    }
+    for (uint32_t i = 0; i < completedCount; i++) {
+        queue[(queueHead + queueCount) % SLOT_COUNT] = completed[i];
+        queueCount++;
+    }
+    workAvailable.notify_one();
+}
+
+void FrameReadback::RecordCopy(VkCommandBuffer commandBuffer, VkImage image, VkExtent2D extent, VkFence fence) {
+    bool wantStream = streamActive && !streamFailed;
+    if (pendingScreenshots.empty() && !wantStream) return;
+
+    if (!context->GetSwapchain()->SupportsReadback()) {
+        std::cerr << "swapchain images do not support transfer, frame readback disabled" << std::endl;
+        pendingScreenshots.clear();
+        StopStream();
+        return;
+    }
+
+    if (wantStream) {
+        if (streamExtent.width == 0) {
+            streamExtent = extent;
+        } else if (streamExtent.width != extent.width || streamExtent.height != extent.height) {
+            droppedCount++;
+            wantStream = false;
+        }
+    }
+    if (pendingScreenshots.empty() && !wantStream) return;
+
+    Slot* slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Slot& candidate : slots) {
+            if (candidate.state == SLOT_FREE) {
+                slot = &candidate;
+                slot->state = SLOT_GPU;
+                break;
+            }
+        }
+    }
+    VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    if (slot == nullptr || !EnsureCapacity(*slot, size)) {
+        // 截图留到下一帧，流帧丢弃
+        if (slot != nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot->state = SLOT_FREE;
+        }
+        if (wantStream) droppedCount++;
+        return;
+    }
+
+    slot->fence = fence;
+    slot->extent = extent;
+    slot->stream = wantStream;
+    slot->sequence = nextSequence++;
+    slot->screenshotPath.clear();
+    if (!pendingScreenshots.empty()) {
+        slot->screenshotPath.swap(pendingScreenshots.front());
+        pendingScreenshots.pop_front();
+    }
+
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    // 图像由渲染通道或动态分辨率放大后的拷贝写入
+    imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = image;
+    imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageBarrier.subresourceRange.levelCount = 1;
+    imageBarrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->buffer, 1, &region);
+
+    // 图像还给呈现，缓冲写入对主机可见（栅栏发出后读取）
+    imageBarrier.srcAccessMask = 0;
+    imageBarrier.dstAccessMask = 0;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = slot->buffer;
+    bufferBarrier.size = size;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &bufferBarrier, 1, &imageBarrier);
+    context->GetMetrics()->Add(Metrics::BARRIERS, 2);
+    copyCount++;
+}
+
+FrameReadback::Statistics FrameReadback::GetStatistics() const {
+    Statistics statistics;
+    statistics.copies = copyCount.load();
+    statistics.screenshots = screenshotCount.load();
+    statistics.streamedFrames = streamedCount.load();
+    statistics.dropped = droppedCount.load();
+    return statistics;
+}
+
+bool FrameReadback::EnsureCapacity(Slot& slot, VkDeviceSize size) {
+    if (slot.capacity >= size) return true;
+    DestroySlot(slot);
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // 主机随机读取：优先带缓存的主机内存
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo{};
+    if (context->GetMemoryManager()->CreateBuffer(bufferInfo, allocInfo, &slot.buffer, &slot.allocation, &allocationInfo) != VK_SUCCESS) {
+        std::cerr << "failed to create readback buffer of " << size << " bytes" << std::endl;
+        slot.buffer = VK_NULL_HANDLE;
+        slot.allocation = VK_NULL_HANDLE;
+        return false;
+    }
+    slot.mapped = static_cast<const uint8_t*>(allocationInfo.pMappedData);
+    slot.capacity = size;
+    return true;
+}
+
+void FrameReadback::DestroySlot(Slot& slot) {
+    if (slot.buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(context->GetAllocator(), slot.buffer, slot.allocation);
+    }
+    slot.buffer = VK_NULL_HANDLE;
+    slot.allocation = VK_NULL_HANDLE;
+    slot.mapped = nullptr;
+    slot.capacity = 0;
+}
+
+void FrameReadback::Flush() {
+    std::vector<VkFence> fences;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Slot& slot : slots) {
+            if (slot.state == SLOT_GPU) fences.push_back(slot.fence);
+        }
+    }
+    if (!fences.empty()) {
+        vkWaitForFences(context->GetDevice(), static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
+    }
+    CollectCompleted();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this]() { return queueCount == 0 && encodingCount == 0; });
+}
+
+void FrameReadback::WorkerMain() {
+    VGE_PROFILE_THREAD("Readback");
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        workAvailable.wait(lock, [this]() { return stopping || queueCount > 0; });
+        if (queueCount == 0) break;
+        uint32_t index = queue[queueHead];
+        queueHead = (queueHead + 1) % SLOT_COUNT;
+        queueCount--;
+        encodingCount++;
+
+        lock.unlock();
+        Encode(slots[index]);
+        lock.lock();
+
+        slots[index].state = SLOT_FREE;
+        encodingCount--;
+        workDone.notify_all();
+    }
+}
+
+void FrameReadback::Encode(Slot& slot) {
+    VGE_PROFILE_FUNCTION();
+    uint32_t width = slot.extent.width;
+    uint32_t height = slot.extent.height;
+
+    if (!slot.screenshotPath.empty() && ImageEncoder::WritePng(slot.screenshotPath, slot.mapped, width, height)) {
+        screenshotCount++;
+        std::cout << "Saved screenshot " << slot.screenshotPath << std::endl;
+    }
+
+    if (!slot.stream || stream == nullptr || streamFailed) return;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    if (streamFormat == STREAM_I420) {
+        conversionBuffer.resize(ImageEncoder::GetI420Size(width, height));
+        ImageEncoder::BgraToI420(slot.mapped, width, height, conversionBuffer.data());
+    } else {
+        conversionBuffer.resize(pixelCount * 4);
+        ImageEncoder::BgraToRgba(slot.mapped, conversionBuffer.data(), pixelCount);
+    }
+    if (std::fwrite(conversionBuffer.data(), 1, conversionBuffer.size(), stream) != conversionBuffer.size()) {
+        std::cerr << "frame stream write failed, no further frames will be written" << std::endl;
+        streamFailed = true;
+        return;
+    }
+    streamedCount++;
+}
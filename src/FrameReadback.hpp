@@ -0,0 +1,121 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vk_mem_alloc.h"
+
+class VulkanContext;
+
+// 异步GPU回读：在帧命令缓冲末尾把交换链图像拷贝到主机可见的暂存缓冲环，
+// 以该帧的飞行栅栏跟踪完成，之后的帧轮询栅栏并把已完成的槽位交给编码线程，
+// 渲染线程从不等待GPU；编码线程写PNG截图，或把RGBA/I420原始帧流写入文件或管道
+// 没有空闲槽位（编码跟不上）时丢弃该帧的流输出并计数，截图请求顺延到下一帧
+class FrameReadback {
+public:
+    // 飞行帧数 + 编码线程上正在处理的帧
+    static const uint32_t SLOT_COUNT = 4;
+
+    enum StreamFormat : uint32_t {
+        STREAM_RGBA = 0,        // 逐帧R8G8B8A8（ffmpeg -f rawvideo -pix_fmt rgba）
+        STREAM_I420 = 1         // 逐帧YUV 4:2:0平面，BT.601有限范围（-pix_fmt yuv420p）
+    };
+
+    struct Statistics {
+        uint64_t copies = 0;            // 录制的拷贝
+        uint64_t screenshots = 0;       // 写出的截图
+        uint64_t streamedFrames = 0;    // 写入流的帧
+        uint64_t dropped = 0;           // 无空闲槽位或尺寸变化而未写入流的帧
+    };
+
+    FrameReadback(VulkanContext* context);
+    ~FrameReadback();
+
+    bool Initialize();
+    // 等待所有未完成的回读编码完毕后停止编码线程
+    void Cleanup();
+
+    // 下一帧写出PNG截图
+    void RequestScreenshot(const std::string& path);
+
+    // 之后每帧写入流：以"|"开头为管道命令（例如"|ffmpeg -f rawvideo ..."），其余为文件
+    // （引擎日志写在标准输出，因此不支持输出到标准输出）
+    // 流的分辨率取第一帧，之后尺寸不同的帧被丢弃
+    bool StartStream(const std::string& target, StreamFormat format);
+    // 写完已录制的帧后关闭流
+    void StopStream();
+    bool IsStreaming() const { return streamActive; }
+
+    // 每帧在等待飞行栅栏之后调用：把GPU已完成的槽位交给编码线程
+    void CollectCompleted();
+    // 在最后一个渲染通道之后录制拷贝（没有请求时为空操作）；image须处于PRESENT_SRC布局，
+    // fence为本帧提交使用的栅栏
+    void RecordCopy(VkCommandBuffer commandBuffer, VkImage image, VkExtent2D extent, VkFence fence);
+
+    Statistics GetStatistics() const;
+
+private:
+    enum SlotState : uint32_t {
+        SLOT_FREE = 0,
+        SLOT_GPU = 1,           // 拷贝已录制，等待栅栏
+        SLOT_ENCODING = 2       // 已交给编码线程
+    };
+
+    struct Slot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        const uint8_t* mapped = nullptr;
+        VkDeviceSize capacity = 0;
+        SlotState state = SLOT_FREE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkExtent2D extent = {0, 0};
+        uint64_t sequence = 0;          // 录制顺序，流按此顺序写出
+        std::string screenshotPath;
+        bool stream = false;
+    };
+
+    bool EnsureCapacity(Slot& slot, VkDeviceSize size);
+    void DestroySlot(Slot& slot);
+    // 等待所有已录制的拷贝完成并编码完毕
+    void Flush();
+    void WorkerMain();
+    void Encode(Slot& slot);
+    void CloseStream();
+
+    VulkanContext* context;
+    Slot slots[SLOT_COUNT];
+
+    // 槽位状态与编码队列（每个槽位至多在队列中出现一次，固定大小的环形队列）
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    uint32_t queue[SLOT_COUNT] = {};
+    uint32_t queueHead = 0;
+    uint32_t queueCount = 0;
+    uint32_t encodingCount = 0;
+    bool stopping = false;
+    std::thread worker;
+
+    std::deque<std::string> pendingScreenshots;     // 仅渲染线程访问
+    uint64_t nextSequence = 0;
+
+    // 流输出：打开/关闭在渲染线程（先Flush），写入在编码线程
+    FILE* stream = nullptr;
+    bool streamIsPipe = false;
+    bool streamActive = false;
+    std::atomic<bool> streamFailed{false};          // 写入失败（例如管道读端退出）后不再写
+    StreamFormat streamFormat = STREAM_RGBA;
+    VkExtent2D streamExtent = {0, 0};
+    std::vector<uint8_t> conversionBuffer;          // 仅编码线程访问
+
+    std::atomic<uint64_t> copyCount{0};
+    std::atomic<uint64_t> screenshotCount{0};
+    std::atomic<uint64_t> streamedCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+};
@@ -0,0 +1,240 @@
+#include "GeometryPool.hpp"
+#include "VulkanContext.hpp"
+#include "VulkanUtils.hpp"
+#include "MemoryManager.hpp"
+#include "StagingManager.hpp"
+#include "AssetArchive.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+GeometryPool::GeometryPool(VulkanContext* context) : context(context) {}
+
+GeometryPool::~GeometryPool() {
+    Cleanup();
+}
+
+bool GeometryPool::Initialize(uint32_t maxVertices, uint32_t maxIndices, uint32_t maxLods) {
+    MemoryManager* memoryManager = context->GetMemoryManager();
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    bufferInfo.size = static_cast<VkDeviceSize>(maxVertices) * CookedVertexLayout::STRIDE;
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (memoryManager->CreateBuffer(bufferInfo, allocInfo, &vertexBuffer, &vertexAllocation) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create geometry pool vertex buffer!");
+    }
+
+    bufferInfo.size = static_cast<VkDeviceSize>(maxIndices) * sizeof(uint32_t);
+    bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (memoryManager->CreateBuffer(bufferInfo, allocInfo, &indexBuffer, &indexAllocation) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create geometry pool index buffer!");
+    }
+
+    bufferInfo.size = static_cast<VkDeviceSize>(maxLods) * sizeof(GpuLod);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (memoryManager->CreateBuffer(bufferInfo, allocInfo, &lodBuffer, &lodAllocation) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create geometry pool LOD buffer!");
+    }
+
+    vertexCapacity = maxVertices;
+    indexCapacity = maxIndices;
+    lodCapacity = maxLods;
+    return true;
+}
+
+void GeometryPool::Cleanup() {
+    VmaAllocator allocator = context->GetAllocator();
+    if (vertexBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, vertexBuffer, vertexAllocation);
+        vertexBuffer = VK_NULL_HANDLE;
+    }
+    if (indexBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, indexBuffer, indexAllocation);
+        indexBuffer = VK_NULL_HANDLE;
+    }
+    if (lodBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, lodBuffer, lodAllocation);
+        lodBuffer = VK_NULL_HANDLE;
+    }
+    meshes.clear();
+    meshNames.clear();
+    sourceData.clear();
+    vertexCount = indexCount = lodCount = 0;
+}
+
+MeshHandle GeometryPool::LoadMesh(const std::string& path) {
+    MeshHandle existing = FindMesh(path);
+    if (existing != INVALID_MESH) return existing;
+
+    std::vector<char> data;
+    const AssetArchive* archive = context->GetAssetArchive();
+    if (archive == nullptr || !archive->IsOpen() || !archive->Read(path, data)) {
+        try {
+            data = VulkanUtils::ReadFile(path);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return INVALID_MESH;
+        }
+    }
+    return AddMesh(path, data);
+}
+
+MeshHandle GeometryPool::AddMesh(const std::string& name, const std::vector<char>& data) {
+    CookedMeshHeader header;
+    if (data.size() < sizeof(header)) {
+        std::cerr << "cooked mesh too small: " << name << std::endl;
+        return INVALID_MESH;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, "VGEM", 4) != 0 || header.version != COOKED_MESH_VERSION ||
+        header.vertexStride != CookedVertexLayout::STRIDE || header.vertexLayout != CookedVertexLayout::GetSignature() ||
+        (header.indexSize != 2 && header.indexSize != 4) ||
+        header.lodCount > COOKED_MESH_MAX_LODS) {
+        std::cerr << "unsupported cooked mesh (re-run vge_cook): " << name << std::endl;
+        return INVALID_MESH;
+    }
+
+    size_t lodOffset = sizeof(header);
+    size_t vertexOffset = lodOffset + header.lodCount * sizeof(CookedMeshLod);
+    size_t indexOffset = vertexOffset + static_cast<size_t>(header.vertexCount) * CookedVertexLayout::STRIDE;
+    size_t end = indexOffset + static_cast<size_t>(header.indexCount) * header.indexSize;
+    if (end > data.size()) {
+        std::cerr << "truncated cooked mesh: " << name << std::endl;
+        return INVALID_MESH;
+    }
+
+    uint32_t meshLodCount = std::max(1u, header.lodCount);
+    if (header.vertexCount > vertexCapacity - vertexCount || header.indexCount > indexCapacity - indexCount ||
+        meshLodCount > lodCapacity - lodCount) {
+        std::cerr << "geometry pool is full, cannot add mesh: " << name << std::endl;
+        return INVALID_MESH;
+    }
+
+    MeshInfo mesh;
+    mesh.name = name;
+    mesh.vertexOffset = static_cast<int32_t>(vertexCount);
+    mesh.vertexCount = header.vertexCount;
+    mesh.lodCount = meshLodCount;
+    mesh.lodBase = lodCount;
+    mesh.bounds.min = Vec3{header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]};
+    mesh.bounds.max = Vec3{header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]};
+    mesh.dequantization = CookedVertexLayout::ComputeDequantization(header.boundsMin, header.boundsMax, header.uvMin, header.uvMax);
+
+    // 没有LOD表时整个索引范围作为LOD 0
+    std::vector<GpuLod> gpuLods(meshLodCount);
+    for (uint32_t l = 0; l < meshLodCount; l++) {
+        CookedMeshLod lod{0, header.indexCount, 0.0f, 0};
+        if (header.lodCount > 0) {
+            std::memcpy(&lod, data.data() + lodOffset + l * sizeof(CookedMeshLod), sizeof(lod));
+        }
+        if (static_cast<uint64_t>(lod.firstIndex) + lod.indexCount > header.indexCount) {
+            std::cerr << "invalid LOD range in cooked mesh: " << name << std::endl;
+            return INVALID_MESH;
+        }
+        mesh.lods[l].firstIndex = indexCount + lod.firstIndex;
+        mesh.lods[l].indexCount = lod.indexCount;
+        mesh.lods[l].error = lod.error;
+        gpuLods[l] = GpuLod{mesh.lods[l].firstIndex, lod.indexCount, lod.error, 0};
+    }
+
+    // 16位索引展开为32位，所有网格共用一种索引类型
+    std::vector<uint32_t> indices(header.indexCount);
+    if (header.indexSize == 2) {
+        const uint8_t* source = reinterpret_cast<const uint8_t*>(data.data() + indexOffset);
+        for (uint32_t i = 0; i < header.indexCount; i++) {
+            uint16_t index;
+            std::memcpy(&index, source + i * sizeof(uint16_t), sizeof(index));
+            indices[i] = index;
+        }
+    } else {
+        std::memcpy(indices.data(), data.data() + indexOffset, indices.size() * sizeof(uint32_t));
+    }
+
+    if (!Upload(vertexBuffer, static_cast<VkDeviceSize>(vertexCount) * CookedVertexLayout::STRIDE,
+                data.data() + vertexOffset, static_cast<VkDeviceSize>(header.vertexCount) * CookedVertexLayout::STRIDE) ||
+        !Upload(indexBuffer, static_cast<VkDeviceSize>(indexCount) * sizeof(uint32_t),
+                indices.data(), indices.size() * sizeof(uint32_t)) ||
+        !Upload(lodBuffer, static_cast<VkDeviceSize>(lodCount) * sizeof(GpuLod),
+                gpuLods.data(), gpuLods.size() * sizeof(GpuLod))) {
+        return INVALID_MESH;
+    }
+
+    // 传输写入对之后的顶点读取、索引读取和剔除着色器可见
+    StagingManager* staging = context->GetStagingManager();
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(staging->GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+    context->GetMetrics()->Add(Metrics::BARRIERS);
+    mesh.uploadBatch = staging->Submit();
+
+    vertexCount += header.vertexCount;
+    indexCount += header.indexCount;
+    lodCount += meshLodCount;
+
+    MeshHandle handle = static_cast<MeshHandle>(meshes.size());
+    meshes.push_back(std::move(mesh));
+    meshNames[name] = handle;
+    if (retainSourceData) {
+        sourceData.push_back(data);
+    }
+    return handle;
+}
+
+bool GeometryPool::Upload(VkBuffer destination, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    StagingManager* staging = context->GetStagingManager();
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    // 大网格分块上传，避免单次占满环形缓冲
+    VkDeviceSize chunkLimit = std::max<VkDeviceSize>(staging->GetCapacity() / 4, 16);
+    while (size > 0) {
+        VkDeviceSize chunk = std::min(size, chunkLimit);
+        StagingRegion region;
+        if (!staging->Allocate(chunk, 16, region)) {
+            // 环形缓冲已满：提交已录制的拷贝并等待回收
+            staging->WaitIdle();
+            if (!staging->Allocate(chunk, 16, region)) {
+                std::cerr << "failed to allocate staging memory for geometry upload" << std::endl;
+                return false;
+            }
+        }
+        std::memcpy(region.mapped, bytes, static_cast<size_t>(chunk));
+
+        VkBufferCopy copy{};
+        copy.srcOffset = region.offset;
+        copy.dstOffset = offset;
+        copy.size = chunk;
+        vkCmdCopyBuffer(staging->GetCommandBuffer(), region.buffer, destination, 1, &copy);
+
+        bytes += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+MeshHandle GeometryPool::FindMesh(const std::string& name) const {
+    auto it = meshNames.find(name);
+    return it == meshNames.end() ? INVALID_MESH : it->second;
+}
+
+bool GeometryPool::IsReady(MeshHandle mesh) const {
+    return mesh < meshes.size() && context->GetStagingManager()->IsComplete(meshes[mesh].uploadBatch);
+}
+
+void GeometryPool::Bind(VkCommandBuffer commandBuffer) const {
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+}
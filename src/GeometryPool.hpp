@@ -0,0 +1,103 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CookedMesh.hpp"
+#include "MathTypes.hpp"
+#include "vk_mem_alloc.h"
+
+class VulkanContext;
+
+using MeshHandle = uint32_t;
+const MeshHandle INVALID_MESH = UINT32_MAX;
+
+// 一级LOD在共享索引缓冲中的范围
+struct MeshLod {
+    uint32_t firstIndex = 0;    // 共享索引缓冲中的绝对位置
+    uint32_t indexCount = 0;
+    float error = 0.0f;         // 对象空间几何误差
+};
+
+struct MeshInfo {
+    std::string name;
+    int32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    uint32_t lodCount = 0;
+    MeshLod lods[COOKED_MESH_MAX_LODS];
+    AABB bounds;                // 对象空间包围盒
+    VertexDequantization dequantization;    // 量化位置与UV的解码参数（着色器推送常量）
+    uint32_t lodBase = 0;       // 在GPU LOD表中的起始位置
+    uint64_t uploadBatch = 0;
+};
+
+// 共享几何池：所有网格及其各级LOD放在同一组顶点/索引缓冲中，
+// 一次绑定即可绘制任意网格的任意LOD（也便于GPU生成间接绘制命令）
+// 顶点为vge_cook输出的量化格式（CookedVertexLayout），索引统一为32位
+class GeometryPool {
+public:
+    // 与着色器中的MeshLod结构一致（std430）
+    struct GpuLod {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        float error;
+        uint32_t padding;
+    };
+
+    GeometryPool(VulkanContext* context);
+    ~GeometryPool();
+
+    bool Initialize(uint32_t vertexCapacity = 4 * 1024 * 1024, uint32_t indexCapacity = 16 * 1024 * 1024,
+                    uint32_t lodCapacity = 65536);
+    void Cleanup();
+
+    // 加载烘焙网格（优先从资源档案读取），同名网格只加载一次；失败返回INVALID_MESH
+    MeshHandle LoadMesh(const std::string& path);
+    MeshHandle AddMesh(const std::string& name, const std::vector<char>& data);
+    MeshHandle FindMesh(const std::string& name) const;
+
+    const MeshInfo& GetMesh(MeshHandle mesh) const { return meshes[mesh]; }
+    uint32_t GetMeshCount() const { return static_cast<uint32_t>(meshes.size()); }
+
+    // 保留每个网格的烘焙数据（帧捕获需要），须在加载网格之前设置
+    void SetRetainSourceData(bool retain) { retainSourceData = retain; }
+    // 未保留时返回nullptr
+    const std::vector<char>* GetSourceData(MeshHandle mesh) const {
+        return mesh < sourceData.size() ? &sourceData[mesh] : nullptr;
+    }
+
+    // 上传批次完成后才能绘制
+    bool IsReady(MeshHandle mesh) const;
+
+    void Bind(VkCommandBuffer commandBuffer) const;
+
+    VkBuffer GetVertexBuffer() const { return vertexBuffer; }
+    VkBuffer GetIndexBuffer() const { return indexBuffer; }
+    VkBuffer GetLodBuffer() const { return lodBuffer; }
+
+private:
+    bool Upload(VkBuffer destination, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+    VulkanContext* context;
+
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VmaAllocation vertexAllocation = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VmaAllocation indexAllocation = VK_NULL_HANDLE;
+    VkBuffer lodBuffer = VK_NULL_HANDLE;
+    VmaAllocation lodAllocation = VK_NULL_HANDLE;
+
+    // 只追加分配
+    uint32_t vertexCapacity = 0;
+    uint32_t indexCapacity = 0;
+    uint32_t lodCapacity = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t lodCount = 0;
+
+    std::vector<MeshInfo> meshes;
+    std::unordered_map<std::string, MeshHandle> meshNames;
+    bool retainSourceData = false;
+    std::vector<std::vector<char>> sourceData;
+};
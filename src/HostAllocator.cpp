@@ -0,0 +1,357 @@
+#include "HostAllocator.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+    // 分配头部，紧挨在返回给驱动的指针之前
+    struct AllocationHeader {
+        uint64_t size;          // 请求的字节数
+        uint32_t offset;        // 返回指针相对块起点的偏移
+        uint16_t sizeClass;     // LARGE_CLASS表示直接向系统申请
+        uint8_t scope;
+        uint8_t reserved;
+    };
+    const size_t HEADER_SIZE = 16;
+    static_assert(sizeof(AllocationHeader) == HEADER_SIZE, "allocation header must stay 16 bytes");
+
+    const uint16_t LARGE_CLASS = 0xFFFF;
+    const size_t MIN_CLASS_SIZE = 32;
+    // chunk起点按64字节对齐，头部占一个对齐单位，不小于64字节的块因此都64字节对齐
+    const size_t CHUNK_SIZE = 64 * 1024;
+    const size_t CHUNK_HEADER_SIZE = 64;
+    const size_t MAX_POOL_ALIGNMENT = 64;
+
+    const char* SCOPE_NAMES[HostAllocator::SCOPE_COUNT] = {
+        "command",
+        "object",
+        "cache",
+        "device",
+        "instance"
+    };
+
+    size_t ClassSize(uint32_t sizeClass) {
+        return MIN_CLASS_SIZE << sizeClass;
+    }
+
+    size_t AlignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    void* SystemAllocate(size_t size, size_t alignment) {
+#ifdef _WIN32
+        return _aligned_malloc(size, alignment);
+#else
+        return std::aligned_alloc(alignment, AlignUp(size, alignment));
+#endif
+    }
+
+    void SystemFree(void* pointer) {
+#ifdef _WIN32
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+
+    AllocationHeader* HeaderOf(void* memory) {
+        return reinterpret_cast<AllocationHeader*>(static_cast<uint8_t*>(memory) - HEADER_SIZE);
+    }
+
+    uint32_t ScopeIndex(VkSystemAllocationScope scope) {
+        uint32_t index = static_cast<uint32_t>(scope);
+        return index < HostAllocator::SCOPE_COUNT ? index : static_cast<uint32_t>(VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+    }
+}
+
+thread_local const char* HostAllocator::currentSite = nullptr;
+
+HostAllocator::HostAllocator() {
+    callbacks.pUserData = this;
+    callbacks.pfnAllocation = AllocationCallback;
+    callbacks.pfnReallocation = ReallocationCallback;
+    callbacks.pfnFree = FreeCallback;
+    callbacks.pfnInternalAllocation = InternalAllocationCallback;
+    callbacks.pfnInternalFree = InternalFreeCallback;
+}
+
+HostAllocator::~HostAllocator() {
+    // 仍有存活分配说明有对象未销毁，或创建与销毁使用了不同的回调
+    for (uint32_t scope = 0; scope < SCOPE_COUNT; scope++) {
+        uint64_t count = scopes[scope].count.load(std::memory_order_relaxed);
+        if (count > 0) {
+            std::cerr << "HostAllocator: " << count << " " << SCOPE_NAMES[scope] << "-scope allocations ("
+                      << scopes[scope].bytes.load(std::memory_order_relaxed) << " bytes) still live at shutdown" << std::endl;
+        }
+    }
+    for (SizeClass& sizeClass : sizeClasses) {
+        while (sizeClass.chunks != nullptr) {
+            Chunk* next = sizeClass.chunks->next;
+            SystemFree(sizeClass.chunks);
+            sizeClass.chunks = next;
+        }
+        sizeClass.freeList = nullptr;
+    }
+}
+
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::AllocationCallback(void* userData, size_t size, size_t alignment,
+                                                              VkSystemAllocationScope scope) {
+    return static_cast<HostAllocator*>(userData)->Allocate(size, alignment, ScopeIndex(scope));
+}
+
+VKAPI_ATTR void* VKAPI_CALL HostAllocator::ReallocationCallback(void* userData, void* original, size_t size, size_t alignment,
+                                                                VkSystemAllocationScope scope) {
+    return static_cast<HostAllocator*>(userData)->Reallocate(original, size, alignment, ScopeIndex(scope));
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::FreeCallback(void* userData, void* memory) {
+    static_cast<HostAllocator*>(userData)->Free(memory);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::InternalAllocationCallback(void* userData, size_t size, VkInternalAllocationType,
+                                                                     VkSystemAllocationScope scope) {
+    HostAllocator* self = static_cast<HostAllocator*>(userData);
+    self->scopes[ScopeIndex(scope)].internalBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+VKAPI_ATTR void VKAPI_CALL HostAllocator::InternalFreeCallback(void* userData, size_t size, VkInternalAllocationType,
+                                                               VkSystemAllocationScope scope) {
+    HostAllocator* self = static_cast<HostAllocator*>(userData);
+    self->scopes[ScopeIndex(scope)].internalBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void* HostAllocator::Allocate(size_t size, size_t alignment, uint32_t scope) {
+    size = std::max<size_t>(size, 1);
+    alignment = std::max<size_t>(alignment, 1);
+    // 头部之后按请求对齐，偏移至少容纳头部
+    size_t offset = std::max(HEADER_SIZE, alignment);
+    size_t total = offset + size;
+
+    uint32_t sizeClass = SIZE_CLASS_COUNT;
+    if (alignment <= MAX_POOL_ALIGNMENT) {
+        for (uint32_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+            if (ClassSize(i) >= total && ClassSize(i) >= alignment) {
+                sizeClass = i;
+                break;
+            }
+        }
+    }
+
+    uint8_t* block;
+    if (sizeClass < SIZE_CLASS_COUNT) {
+        block = static_cast<uint8_t*>(PopBlock(sizeClass));
+    } else {
+        block = static_cast<uint8_t*>(SystemAllocate(total, std::max(alignment, HEADER_SIZE)));
+    }
+    if (block == nullptr) return nullptr;
+
+    uint8_t* memory = block + offset;
+    AllocationHeader* header = HeaderOf(memory);
+    header->size = size;
+    header->offset = static_cast<uint32_t>(offset);
+    header->sizeClass = sizeClass < SIZE_CLASS_COUNT ? static_cast<uint16_t>(sizeClass) : LARGE_CLASS;
+    header->scope = static_cast<uint8_t>(scope);
+    header->reserved = 0;
+    Record(scope, size);
+    return memory;
+}
+
+void* HostAllocator::Reallocate(void* original, size_t size, size_t alignment, uint32_t scope) {
+    if (original == nullptr) return Allocate(size, alignment, scope);
+    if (size == 0) {
+        Free(original);
+        return nullptr;
+    }
+
+    // 原块容量够且对齐满足时原地调整
+    AllocationHeader* header = HeaderOf(original);
+    if (header->sizeClass != LARGE_CLASS && ClassSize(header->sizeClass) >= header->offset + size &&
+        (reinterpret_cast<uintptr_t>(original) & (std::max<size_t>(alignment, 1) - 1)) == 0) {
+        Release(header->scope, header->size);
+        header->size = size;
+        header->scope = static_cast<uint8_t>(scope);
+        Record(scope, size);
+        return original;
+    }
+
+    // 失败时原分配保持不变
+    void* memory = Allocate(size, alignment, scope);
+    if (memory == nullptr) return nullptr;
+    std::memcpy(memory, original, std::min<size_t>(header->size, size));
+    Free(original);
+    return memory;
+}
+
+void HostAllocator::Free(void* memory) {
+    if (memory == nullptr) return;
+    AllocationHeader* header = HeaderOf(memory);
+    Release(header->scope, header->size);
+    void* block = static_cast<uint8_t*>(memory) - header->offset;
+    if (header->sizeClass == LARGE_CLASS) {
+        SystemFree(block);
+    } else {
+        PushBlock(header->sizeClass, block);
+    }
+}
+
+void* HostAllocator::PopBlock(uint32_t sizeClass) {
+    SizeClass& pool = sizeClasses[sizeClass];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (pool.freeList == nullptr) {
+        uint8_t* memory = static_cast<uint8_t*>(SystemAllocate(CHUNK_SIZE, CHUNK_HEADER_SIZE));
+        if (memory == nullptr) return nullptr;
+        Chunk* chunk = reinterpret_cast<Chunk*>(memory);
+        chunk->next = pool.chunks;
+        pool.chunks = chunk;
+        pooledBytes.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+
+        // 逆序压入，使块按地址顺序取出
+        size_t blockSize = ClassSize(sizeClass);
+        size_t blockCount = (CHUNK_SIZE - CHUNK_HEADER_SIZE) / blockSize;
+        for (size_t i = blockCount; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(memory + CHUNK_HEADER_SIZE + i * blockSize);
+            block->next = pool.freeList;
+            pool.freeList = block;
+        }
+    }
+    FreeBlock* block = pool.freeList;
+    pool.freeList = block->next;
+    return block;
+}
+
+void HostAllocator::PushBlock(uint32_t sizeClass, void* block) {
+    SizeClass& pool = sizeClasses[sizeClass];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->next = pool.freeList;
+    pool.freeList = freeBlock;
+}
+
+void HostAllocator::Record(uint32_t scope, size_t size) {
+    ScopeCounters& counters = scopes[scope];
+    uint64_t bytes = counters.bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    uint64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+    while (bytes > peak && !counters.peakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+    }
+    if (frameActive.load(std::memory_order_relaxed)) {
+        RecordFrameAllocation(scope, size);
+    }
+}
+
+void HostAllocator::Release(uint32_t scope, size_t size) {
+    scopes[scope].bytes.fetch_sub(size, std::memory_order_relaxed);
+    scopes[scope].count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void HostAllocator::RecordFrameAllocation(uint32_t scope, size_t size) {
+    frameAllocations.fetch_add(1, std::memory_order_relaxed);
+    frameBytes.fetch_add(size, std::memory_order_relaxed);
+    frameScopes[scope].fetch_add(1, std::memory_order_relaxed);
+    if (!reportEnabled) return;
+
+    // 标签是静态字符串，按指针比较
+    const char* name = currentSite != nullptr ? currentSite : "(unlabeled)";
+    std::lock_guard<std::mutex> lock(siteMutex);
+    CallSiteRecord* record = nullptr;
+    for (uint32_t i = 0; i < siteCount; i++) {
+        if (sites[i].name == name) {
+            record = &sites[i];
+            break;
+        }
+    }
+    if (record == nullptr) {
+        if (siteCount == MAX_CALL_SITES) {
+            droppedAllocations++;
+            return;
+        }
+        record = &sites[siteCount++];
+        record->name = name;
+    }
+    record->allocations++;
+    record->bytes += size;
+    record->scopes[scope]++;
+}
+
+void HostAllocator::BeginFrame() {
+    frameAllocations.store(0, std::memory_order_relaxed);
+    frameBytes.store(0, std::memory_order_relaxed);
+    for (auto& counter : frameScopes) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    frameActive.store(true, std::memory_order_release);
+}
+
+HostAllocator::FrameCounters HostAllocator::EndFrame() {
+    frameActive.store(false, std::memory_order_release);
+    FrameCounters counters;
+    counters.allocations = frameAllocations.load(std::memory_order_relaxed);
+    counters.bytes = frameBytes.load(std::memory_order_relaxed);
+    for (uint32_t scope = 0; scope < SCOPE_COUNT; scope++) {
+        counters.scopes[scope] = frameScopes[scope].load(std::memory_order_relaxed);
+    }
+    trackedFrames++;
+    if (counters.allocations > 0) allocatingFrames++;
+    return counters;
+}
+
+HostAllocator::Statistics HostAllocator::GetStatistics() const {
+    Statistics statistics;
+    for (uint32_t scope = 0; scope < SCOPE_COUNT; scope++) {
+        ScopeStatistics& out = statistics.scopes[scope];
+        out.bytes = scopes[scope].bytes.load(std::memory_order_relaxed);
+        out.count = scopes[scope].count.load(std::memory_order_relaxed);
+        out.peakBytes = scopes[scope].peakBytes.load(std::memory_order_relaxed);
+        out.totalAllocations = scopes[scope].totalAllocations.load(std::memory_order_relaxed);
+        out.internalBytes = scopes[scope].internalBytes.load(std::memory_order_relaxed);
+    }
+    statistics.pooledBytes = pooledBytes.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void HostAllocator::PrintReport() const {
+    Statistics statistics = GetStatistics();
+    std::printf("Driver host allocations (pools %llu KB)\n", static_cast<unsigned long long>(statistics.pooledBytes / 1024));
+    std::printf("  %-9s %10s %12s %12s %12s %12s\n", "scope", "live", "bytes", "peak bytes", "total", "internal");
+    for (uint32_t scope = 0; scope < SCOPE_COUNT; scope++) {
+        const ScopeStatistics& s = statistics.scopes[scope];
+        std::printf("  %-9s %10llu %12llu %12llu %12llu %12llu\n", SCOPE_NAMES[scope],
+                    static_cast<unsigned long long>(s.count), static_cast<unsigned long long>(s.bytes),
+                    static_cast<unsigned long long>(s.peakBytes), static_cast<unsigned long long>(s.totalAllocations),
+                    static_cast<unsigned long long>(s.internalBytes));
+    }
+
+    std::lock_guard<std::mutex> lock(siteMutex);
+    std::printf("Frame loop: %llu of %llu frames allocated\n", static_cast<unsigned long long>(allocatingFrames),
+                static_cast<unsigned long long>(trackedFrames));
+    if (!reportEnabled || siteCount == 0) return;
+
+    // 按分配次数从多到少输出
+    uint32_t order[MAX_CALL_SITES];
+    for (uint32_t i = 0; i < siteCount; i++) order[i] = i;
+    std::sort(order, order + siteCount, [this](uint32_t a, uint32_t b) { return sites[a].allocations > sites[b].allocations; });
+    double frames = static_cast<double>(std::max<uint64_t>(trackedFrames, 1));
+    std::printf("  %-28s %10s %12s %8s %8s %8s %8s %8s\n", "call site", "per frame", "bytes", "command", "object",
+                "cache", "device", "instance");
+    for (uint32_t i = 0; i < siteCount; i++) {
+        const CallSiteRecord& record = sites[order[i]];
+        std::printf("  %-28s %10.2f %12llu %8llu %8llu %8llu %8llu %8llu\n", record.name,
+                    static_cast<double>(record.allocations) / frames, static_cast<unsigned long long>(record.bytes),
+                    static_cast<unsigned long long>(record.scopes[0]), static_cast<unsigned long long>(record.scopes[1]),
+                    static_cast<unsigned long long>(record.scopes[2]), static_cast<unsigned long long>(record.scopes[3]),
+                    static_cast<unsigned long long>(record.scopes[4]));
+    }
+    if (droppedAllocations > 0) {
+        std::printf("  (%llu allocations from further call sites not listed)\n", static_cast<unsigned long long>(droppedAllocations));
+    }
+}
+
+const char* HostAllocator::GetScopeName(uint32_t scope) {
+    return scope < SCOPE_COUNT ? SCOPE_NAMES[scope] : "unknown";
+}
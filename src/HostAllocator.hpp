@@ -0,0 +1,141 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Vulkan主机内存回调：驱动的主机侧分配按大小类从块池取得，更大或对齐要求更高的分配直接向系统申请
+// 每个分配前有16字节头部（请求大小、大小类、作用域），按VkSystemAllocationScope统计当前字节、个数与峰值
+// 帧跟踪期间（BeginFrame与EndFrame之间）的分配单独计数；开启报告时再按线程当前的CallSite标签归类，
+// 用于找出帧循环中仍会让驱动分配主机内存的Vulkan调用
+// 回调可能在驱动的任意线程上调用，内部不使用operator new
+class HostAllocator {
+public:
+    static const uint32_t SCOPE_COUNT = 5;          // VK_SYSTEM_ALLOCATION_SCOPE_COMMAND..INSTANCE
+    static const uint32_t SIZE_CLASS_COUNT = 8;     // 32、64、...、4096字节
+    static const uint32_t MAX_CALL_SITES = 32;
+
+    struct ScopeStatistics {
+        uint64_t bytes = 0;                 // 当前存活的请求字节
+        uint64_t count = 0;                 // 当前存活的分配个数
+        uint64_t peakBytes = 0;
+        uint64_t totalAllocations = 0;      // 累计分配次数（重分配也计一次）
+        uint64_t internalBytes = 0;         // 驱动自行分配并经internal通知报告的字节
+    };
+
+    struct Statistics {
+        ScopeStatistics scopes[SCOPE_COUNT];
+        uint64_t pooledBytes = 0;           // 块池向系统申请的内存
+    };
+
+    // 一帧内的分配
+    struct FrameCounters {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t scopes[SCOPE_COUNT] = {};  // 各作用域的分配次数
+    };
+
+    // 调用点标签：存活期间当前线程上的帧内分配计入name（静态字符串），可嵌套
+    class CallSite {
+    public:
+        explicit CallSite(const char* name) : previous(currentSite) { currentSite = name; }
+        ~CallSite() { currentSite = previous; }
+
+        CallSite(const CallSite&) = delete;
+        CallSite& operator=(const CallSite&) = delete;
+
+    private:
+        const char* previous;
+    };
+
+    HostAllocator();
+    ~HostAllocator();
+
+    HostAllocator(const HostAllocator&) = delete;
+    HostAllocator& operator=(const HostAllocator&) = delete;
+
+    // 传给vkCreate*/vkDestroy*与VMA；同一对象的创建与销毁须使用同一回调
+    const VkAllocationCallbacks* GetCallbacks() const { return &callbacks; }
+
+    // 按调用点记录帧内分配，退出时由PrintReport输出
+    void SetReportEnabled(bool enabled) { reportEnabled = enabled; }
+    bool IsReportEnabled() const { return reportEnabled; }
+
+    // 渲染线程在帧开始与结束时调用，期间任意线程上的驱动分配计入本帧
+    void BeginFrame();
+    FrameCounters EndFrame();
+
+    Statistics GetStatistics() const;
+    void PrintReport() const;
+
+    static const char* GetScopeName(uint32_t scope);
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct Chunk {
+        Chunk* next;
+    };
+    // 每个大小类一条空闲链表，chunk只在析构时归还系统
+    struct SizeClass {
+        std::mutex mutex;
+        FreeBlock* freeList = nullptr;
+        Chunk* chunks = nullptr;
+    };
+    struct ScopeCounters {
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> peakBytes{0};
+        std::atomic<uint64_t> totalAllocations{0};
+        std::atomic<uint64_t> internalBytes{0};
+    };
+    struct CallSiteRecord {
+        const char* name;
+        uint64_t allocations;
+        uint64_t bytes;
+        uint64_t scopes[SCOPE_COUNT];
+    };
+
+    static VKAPI_ATTR void* VKAPI_CALL AllocationCallback(void* userData, size_t size, size_t alignment,
+                                                          VkSystemAllocationScope scope);
+    static VKAPI_ATTR void* VKAPI_CALL ReallocationCallback(void* userData, void* original, size_t size, size_t alignment,
+                                                            VkSystemAllocationScope scope);
+    static VKAPI_ATTR void VKAPI_CALL FreeCallback(void* userData, void* memory);
+    static VKAPI_ATTR void VKAPI_CALL InternalAllocationCallback(void* userData, size_t size, VkInternalAllocationType type,
+                                                                 VkSystemAllocationScope scope);
+    static VKAPI_ATTR void VKAPI_CALL InternalFreeCallback(void* userData, size_t size, VkInternalAllocationType type,
+                                                           VkSystemAllocationScope scope);
+
+    void* Allocate(size_t size, size_t alignment, uint32_t scope);
+    void* Reallocate(void* original, size_t size, size_t alignment, uint32_t scope);
+    void Free(void* memory);
+    void* PopBlock(uint32_t sizeClass);
+    void PushBlock(uint32_t sizeClass, void* block);
+    void Record(uint32_t scope, size_t size);
+    void Release(uint32_t scope, size_t size);
+    void RecordFrameAllocation(uint32_t scope, size_t size);
+
+    VkAllocationCallbacks callbacks{};
+    SizeClass sizeClasses[SIZE_CLASS_COUNT];
+    ScopeCounters scopes[SCOPE_COUNT];
+    std::atomic<uint64_t> pooledBytes{0};
+
+    // 帧跟踪
+    std::atomic<bool> frameActive{false};
+    std::atomic<uint64_t> frameAllocations{0};
+    std::atomic<uint64_t> frameBytes{0};
+    std::atomic<uint64_t> frameScopes[SCOPE_COUNT] = {};
+    uint64_t trackedFrames = 0;
+    uint64_t allocatingFrames = 0;
+
+    // 调用点报告（定长表，满后的调用点计入droppedAllocations）
+    bool reportEnabled = false;
+    mutable std::mutex siteMutex;
+    CallSiteRecord sites[MAX_CALL_SITES] = {};
+    uint32_t siteCount = 0;
+    uint64_t droppedAllocations = 0;
+
+    static thread_local const char* currentSite;
+};
@@ -0,0 +1,308 @@
+#include "ImageEncoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VGE_ENCODER_SSE2 1
+#endif
+
+namespace {
+    // BT.601有限范围，8位定点系数（与常见视频编码器的默认转换一致）
+    inline uint8_t Luma(const uint8_t* pixel) {
+        return static_cast<uint8_t>(((66 * pixel[2] + 129 * pixel[1] + 25 * pixel[0] + 128) >> 8) + 16);
+    }
+
+    // b/g/r为2x2块的4像素之和
+    inline uint8_t ChromaU(int b, int g, int r) {
+        return static_cast<uint8_t>(((112 * b - 74 * g - 38 * r + 512) >> 10) + 128);
+    }
+
+    inline uint8_t ChromaV(int b, int g, int r) {
+        return static_cast<uint8_t>(((-18 * b - 94 * g + 112 * r + 512) >> 10) + 128);
+    }
+
+    void LumaRow(const uint8_t* row, uint32_t begin, uint32_t end, uint8_t* destination) {
+        for (uint32_t x = begin; x < end; x++) {
+            destination[x] = Luma(row + x * 4);
+        }
+    }
+
+    // 块的第二列/第二行越界时重复边缘像素
+    void ChromaRow(const uint8_t* row0, const uint8_t* row1, uint32_t width, uint32_t beginBlock, uint32_t endBlock,
+                   uint8_t* u, uint8_t* v) {
+        for (uint32_t block = beginBlock; block < endBlock; block++) {
+            uint32_t x0 = block * 2;
+            uint32_t x1 = std::min(x0 + 1, width - 1);
+            const uint8_t* p[4] = {row0 + x0 * 4, row0 + x1 * 4, row1 + x0 * 4, row1 + x1 * 4};
+            int b = p[0][0] + p[1][0] + p[2][0] + p[3][0];
+            int g = p[0][1] + p[1][1] + p[2][1] + p[3][1];
+            int r = p[0][2] + p[1][2] + p[2][2] + p[3][2];
+            u[block] = ChromaU(b, g, r);
+            v[block] = ChromaV(b, g, r);
+        }
+    }
+
+#ifdef VGE_ENCODER_SSE2
+    // 4个int32通道[x0, x1, x2, x3]：low = [a0, b0, a1, b1]，high = [a2, b2, a3, b3]，返回ai + bi
+    inline __m128i AddPairs(__m128i low, __m128i high) {
+        __m128 lowFloat = _mm_castsi128_ps(low);
+        __m128 highFloat = _mm_castsi128_ps(high);
+        __m128i even = _mm_castps_si128(_mm_shuffle_ps(lowFloat, highFloat, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i odd = _mm_castps_si128(_mm_shuffle_ps(lowFloat, highFloat, _MM_SHUFFLE(3, 1, 3, 1)));
+        return _mm_add_epi32(even, odd);
+    }
+
+    // 4个BGRA像素 -> 4个int32亮度
+    inline __m128i Luma4(__m128i pixels) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i coefficients = _mm_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0);
+        __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), coefficients);
+        __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coefficients);
+        __m128i sum = _mm_add_epi32(AddPairs(low, high), _mm_set1_epi32(128));
+        return _mm_add_epi32(_mm_srli_epi32(sum, 8), _mm_set1_epi32(16));
+    }
+
+    void Luma8(const uint8_t* source, uint8_t* destination) {
+        __m128i low = Luma4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+        __m128i high = Luma4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 16)));
+        __m128i packed = _mm_packs_epi32(low, high);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(packed, packed));
+    }
+
+    // 上下两行各4个像素 -> 两个2x2块的BGRA之和（16位）[块0, 块1]
+    inline __m128i BlockSums(__m128i row0, __m128i row1) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+        __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+        left = _mm_add_epi16(left, _mm_srli_si128(left, 8));
+        right = _mm_add_epi16(right, _mm_srli_si128(right, 8));
+        return _mm_unpacklo_epi64(left, right);
+    }
+
+    inline __m128i Chroma4(__m128i blocks01, __m128i blocks23, __m128i coefficients) {
+        __m128i sum = AddPairs(_mm_madd_epi16(blocks01, coefficients), _mm_madd_epi16(blocks23, coefficients));
+        sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(512)), 10);
+        return _mm_add_epi32(sum, _mm_set1_epi32(128));
+    }
+
+    // 上下两行各8个像素 -> 4个U和4个V
+    void Chroma8(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v) {
+        const __m128i uCoefficients = _mm_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0);
+        const __m128i vCoefficients = _mm_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0);
+        __m128i blocks01 = BlockSums(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1)));
+        __m128i blocks23 = BlockSums(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 16)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 16)));
+        __m128i packed = _mm_packs_epi32(Chroma4(blocks01, blocks23, uCoefficients),
+                                         Chroma4(blocks01, blocks23, vCoefficients));
+        __m128i bytes = _mm_packus_epi16(packed, packed);
+        int32_t uBytes = _mm_cvtsi128_si32(bytes);
+        int32_t vBytes = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 4));
+        std::memcpy(u, &uBytes, 4);
+        std::memcpy(v, &vBytes, 4);
+    }
+#endif
+
+    uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+        static const std::vector<uint32_t> table = []() {
+            std::vector<uint32_t> entries(256);
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++) {
+                    value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                }
+                entries[i] = value;
+            }
+            return entries;
+        }();
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    uint32_t Adler32(const uint8_t* data, size_t size) {
+        // 每5552字节取一次模，保证32位累加不溢出
+        const uint32_t MOD = 65521;
+        uint32_t a = 1, b = 0;
+        while (size > 0) {
+            size_t count = std::min<size_t>(size, 5552);
+            size -= count;
+            for (size_t i = 0; i < count; i++) {
+                a += *data++;
+                b += a;
+            }
+            a %= MOD;
+            b %= MOD;
+        }
+        return (b << 16) | a;
+    }
+
+    void AppendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void AppendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+        AppendBigEndian(out, static_cast<uint32_t>(data.size()));
+        size_t typeOffset = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        AppendBigEndian(out, Crc32(out.data() + typeOffset, data.size() + 4));
+    }
+}
+
+namespace ImageEncoder {
+    void BgraToRgba(const uint8_t* source, uint8_t* destination, size_t pixelCount) {
+        size_t i = 0;
+#ifdef VGE_ENCODER_SSE2
+        // 按32位通道交换字节0和字节2
+        const __m128i greenAlpha = _mm_set1_epi32(static_cast<int32_t>(0xFF00FF00u));
+        const __m128i redBlue = _mm_set1_epi32(0x00FF00FF);
+        for (; i + 4 <= pixelCount; i += 4) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+            __m128i swapped = _mm_and_si128(pixels, redBlue);
+            swapped = _mm_or_si128(_mm_slli_epi32(swapped, 16), _mm_srli_epi32(swapped, 16));
+            swapped = _mm_or_si128(swapped, _mm_and_si128(pixels, greenAlpha));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), swapped);
+        }
+#endif
+        for (; i < pixelCount; i++) {
+            destination[i * 4 + 0] = source[i * 4 + 2];
+            destination[i * 4 + 1] = source[i * 4 + 1];
+            destination[i * 4 + 2] = source[i * 4 + 0];
+            destination[i * 4 + 3] = source[i * 4 + 3];
+        }
+    }
+
+    size_t GetI420Size(uint32_t width, uint32_t height) {
+        size_t chromaSize = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+        return static_cast<size_t>(width) * height + chromaSize * 2;
+    }
+
+    void BgraToI420Reference(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* destination) {
+        if (width == 0 || height == 0) return;
+        uint32_t chromaWidth = (width + 1) / 2;
+        uint32_t chromaHeight = (height + 1) / 2;
+        uint8_t* yPlane = destination;
+        uint8_t* uPlane = yPlane + static_cast<size_t>(width) * height;
+        uint8_t* vPlane = uPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+        size_t stride = static_cast<size_t>(width) * 4;
+
+        for (uint32_t y = 0; y < height; y++) {
+            LumaRow(source + y * stride, 0, width, yPlane + static_cast<size_t>(y) * width);
+        }
+        for (uint32_t block = 0; block < chromaHeight; block++) {
+            uint32_t y0 = block * 2;
+            uint32_t y1 = std::min(y0 + 1, height - 1);
+            ChromaRow(source + y0 * stride, source + y1 * stride, width, 0, chromaWidth,
+                      uPlane + static_cast<size_t>(block) * chromaWidth, vPlane + static_cast<size_t>(block) * chromaWidth);
+        }
+    }
+
+    void BgraToI420(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* destination) {
+#ifdef VGE_ENCODER_SSE2
+        if (width == 0 || height == 0) return;
+        uint32_t chromaWidth = (width + 1) / 2;
+        uint32_t chromaHeight = (height + 1) / 2;
+        uint8_t* yPlane = destination;
+        uint8_t* uPlane = yPlane + static_cast<size_t>(width) * height;
+        uint8_t* vPlane = uPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+        size_t stride = static_cast<size_t>(width) * 4;
+        // 每次处理两行各8个像素，剩余的列走标量路径
+        uint32_t vectorWidth = width & ~7u;
+
+        for (uint32_t block = 0; block < chromaHeight; block++) {
+            uint32_t y0 = block * 2;
+            uint32_t y1 = std::min(y0 + 1, height - 1);
+            const uint8_t* row0 = source + y0 * stride;
+            const uint8_t* row1 = source + y1 * stride;
+            uint8_t* luma0 = yPlane + static_cast<size_t>(y0) * width;
+            uint8_t* luma1 = yPlane + static_cast<size_t>(y1) * width;
+            uint8_t* u = uPlane + static_cast<size_t>(block) * chromaWidth;
+            uint8_t* v = vPlane + static_cast<size_t>(block) * chromaWidth;
+
+            for (uint32_t x = 0; x < vectorWidth; x += 8) {
+                Luma8(row0 + x * 4, luma0 + x);
+                if (y1 != y0) Luma8(row1 + x * 4, luma1 + x);
+                Chroma8(row0 + x * 4, row1 + x * 4, u + x / 2, v + x / 2);
+            }
+            LumaRow(row0, vectorWidth, width, luma0);
+            if (y1 != y0) LumaRow(row1, vectorWidth, width, luma1);
+            ChromaRow(row0, row1, width, vectorWidth / 2, chromaWidth, u, v);
+        }
+#else
+        BgraToI420Reference(source, width, height, destination);
+#endif
+    }
+
+    std::vector<uint8_t> EncodePng(const uint8_t* source, uint32_t width, uint32_t height) {
+        // 逐行：滤波类型0 + RGB
+        size_t rowSize = 1 + static_cast<size_t>(width) * 3;
+        std::vector<uint8_t> raw(rowSize * height);
+        for (uint32_t y = 0; y < height; y++) {
+            uint8_t* row = raw.data() + y * rowSize;
+            const uint8_t* pixel = source + static_cast<size_t>(y) * width * 4;
+            row[0] = 0;
+            for (uint32_t x = 0; x < width; x++, pixel += 4) {
+                row[1 + x * 3 + 0] = pixel[2];
+                row[1 + x * 3 + 1] = pixel[1];
+                row[1 + x * 3 + 2] = pixel[0];
+            }
+        }
+
+        // zlib流：存储块每块最多65535字节
+        const size_t MAX_BLOCK = 65535;
+        std::vector<uint8_t> zlib;
+        zlib.reserve(raw.size() + raw.size() / MAX_BLOCK * 5 + 16);
+        zlib.push_back(0x78);
+        zlib.push_back(0x01);
+        size_t offset = 0;
+        do {
+            size_t count = std::min(raw.size() - offset, MAX_BLOCK);
+            bool last = offset + count == raw.size();
+            zlib.push_back(last ? 1 : 0);
+            zlib.push_back(static_cast<uint8_t>(count));
+            zlib.push_back(static_cast<uint8_t>(count >> 8));
+            zlib.push_back(static_cast<uint8_t>(~count));
+            zlib.push_back(static_cast<uint8_t>(~count >> 8));
+            zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + count);
+            offset += count;
+        } while (offset < raw.size());
+        AppendBigEndian(zlib, Adler32(raw.data(), raw.size()));
+
+        std::vector<uint8_t> header;
+        AppendBigEndian(header, width);
+        AppendBigEndian(header, height);
+        header.push_back(8);    // 位深
+        header.push_back(2);    // RGB
+        header.push_back(0);
+        header.push_back(0);
+        header.push_back(0);
+
+        static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        std::vector<uint8_t> png(SIGNATURE, SIGNATURE + 8);
+        png.reserve(zlib.size() + 64);
+        AppendChunk(png, "IHDR", header);
+        AppendChunk(png, "IDAT", zlib);
+        AppendChunk(png, "IEND", {});
+        return png;
+    }
+
+    bool WritePng(const std::string& path, const uint8_t* source, uint32_t width, uint32_t height) {
+        std::vector<uint8_t> png = EncodePng(source, width, height);
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "failed to open " << path << " for writing" << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+        return static_cast<bool>(file);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 回读图像的像素转换与编码，输入均为交换链的B8G8R8A8像素（行间无填充）
+namespace ImageEncoder {
+    // 交换B和R通道得到R8G8B8A8
+    void BgraToRgba(const uint8_t* source, uint8_t* destination, size_t pixelCount);
+
+    // I420（YUV 4:2:0平面：Y全分辨率，U/V各为(w+1)/2 x (h+1)/2），BT.601有限范围，
+    // 色度取2x2像素均值，奇数宽高时边缘像素重复；x86上用SSE2内核
+    size_t GetI420Size(uint32_t width, uint32_t height);
+    void BgraToI420(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* destination);
+    // 标量实现，结果与BgraToI420逐字节一致（基准测试与校验用）
+    void BgraToI420Reference(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* destination);
+
+    // 8位RGB PNG（丢弃alpha），deflate使用不压缩的存储块：编码开销接近内存拷贝，文件约为原始大小
+    std::vector<uint8_t> EncodePng(const uint8_t* source, uint32_t width, uint32_t height);
+    bool WritePng(const std::string& path, const uint8_t* source, uint32_t width, uint32_t height);
+}
@@ -0,0 +1,203 @@
+#include "JobSystem.hpp"
+#include "AllocationTracker.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <new>
+#include <string>
+
+namespace {
+    thread_local uint32_t currentThreadIndex = 0;
+}
+
+struct JobSystem::ParallelForState {
+    void* object = nullptr;
+    RangeFunction function = nullptr;
+    uint32_t count = 0;
+    uint32_t grainSize = 1;
+    uint32_t chunkCount = 0;
+    FrameAllocator::Stage stage = FrameAllocator::STAGE_RENDER;
+    std::atomic<uint32_t> nextChunk{0};
+    std::atomic<uint32_t> completedChunks{0};
+    // 调用线程与尚未执行的协助任务各持有一个引用，最后一个释放的归还到块池
+    std::atomic<uint32_t> references{0};
+
+    // 领取并执行块，直到没有剩余；块分完后才执行的协助任务不会再访问函数对象
+    // 协助线程按提交线程所属的阶段使用帧内存
+    void Run() {
+        FrameAllocator::StageScope scope(stage);
+        for (uint32_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+            uint32_t begin = chunk * grainSize;
+            uint32_t end = std::min(count, begin + grainSize);
+            function(object, begin, end);
+            completedChunks.fetch_add(1, std::memory_order_release);
+        }
+    }
+};
+
+JobSystem::JobSystem() : statePool(sizeof(ParallelForState), 16) {}
+
+JobSystem::~JobSystem() {
+    Cleanup();
+}
+
+bool JobSystem::Initialize(uint32_t workerCount) {
+    if (workerCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    stopping = false;
+    queue.resize(INITIAL_QUEUE_CAPACITY);
+    queueHead = 0;
+    queueCount = 0;
+    // 嵌套的ParallelFor每层占用一个状态
+    statePool.Reserve(16);
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&JobSystem::WorkerMain, this, i + 1);
+    }
+    return true;
+}
+
+void JobSystem::Cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+    queue.clear();
+    queueHead = 0;
+    queueCount = 0;
+    pendingJobs = 0;
+}
+
+uint32_t JobSystem::GetThreadIndex() {
+    return currentThreadIndex;
+}
+
+void JobSystem::WorkerMain(uint32_t index) {
+    currentThreadIndex = index;
+    AllocationTracker::TrackCurrentThread();
+#ifdef VGE_PROFILER
+    std::string threadName = "Worker " + std::to_string(index);
+    VGE_PROFILE_THREAD(threadName.c_str());
+#endif
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || queueCount > 0; });
+            if (stopping && queueCount == 0) {
+                return;
+            }
+            job = std::move(queue[queueHead]);
+            queueHead = (queueHead + 1) % queue.size();
+            queueCount--;
+        }
+
+        {
+            VGE_PROFILE_ZONE("Job");
+            if (job.parallelFor != nullptr) {
+                job.parallelFor->Run();
+                ReleaseState(job.parallelFor);
+            } else {
+                job.function();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            pendingJobs--;
+            if (pendingJobs == 0) {
+                idleCondition.notify_all();
+            }
+        }
+    }
+}
+
+void JobSystem::PushJob(Job&& job) {
+    if (queueCount == queue.size()) {
+        std::vector<Job> grown(queue.empty() ? INITIAL_QUEUE_CAPACITY : queue.size() * 2);
+        for (size_t i = 0; i < queueCount; i++) {
+            grown[i] = std::move(queue[(queueHead + i) % queue.size()]);
+        }
+        queue.swap(grown);
+        queueHead = 0;
+    }
+    queue[(queueHead + queueCount) % queue.size()] = std::move(job);
+    queueCount++;
+    pendingJobs++;
+}
+
+void JobSystem::Submit(std::function<void()> job) {
+    if (workers.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        Job entry;
+        entry.function = std::move(job);
+        PushJob(std::move(entry));
+    }
+    queueCondition.notify_one();
+}
+
+void JobSystem::WaitIdle() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    idleCondition.wait(lock, [this]() { return pendingJobs == 0; });
+}
+
+void JobSystem::ParallelForRange(uint32_t count, uint32_t grainSize, void* object, RangeFunction function) {
+    if (count == 0) return;
+    grainSize = std::max(1u, grainSize);
+    uint32_t chunkCount = (count + grainSize - 1) / grainSize;
+
+    // 只有一块或没有工作线程时直接执行
+    if (chunkCount == 1 || workers.empty()) {
+        function(object, 0, count);
+        return;
+    }
+
+    uint32_t helperCount = std::min(GetWorkerCount(), chunkCount - 1);
+    ParallelForState* state = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        state = new (statePool.allocate(sizeof(ParallelForState), alignof(ParallelForState))) ParallelForState();
+        state->object = object;
+        state->function = function;
+        state->count = count;
+        state->grainSize = grainSize;
+        state->chunkCount = chunkCount;
+        state->stage = FrameAllocator::GetThreadStage();
+        state->references.store(helperCount + 1, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < helperCount; i++) {
+            Job job;
+            job.parallelFor = state;
+            PushJob(std::move(job));
+        }
+    }
+    for (uint32_t i = 0; i < helperCount; i++) {
+        queueCondition.notify_one();
+    }
+
+    state->Run();
+
+    // 等待其他线程手上的块完成
+    while (state->completedChunks.load(std::memory_order_acquire) < chunkCount) {
+        std::this_thread::yield();
+    }
+    ReleaseState(state);
+}
+
+void JobSystem::ReleaseState(ParallelForState* state) {
+    if (state->references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    std::lock_guard<std::mutex> lock(queueMutex);
+    state->~ParallelForState();
+    statePool.deallocate(state, sizeof(ParallelForState), alignof(ParallelForState));
+}
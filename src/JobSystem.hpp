@@ -0,0 +1,77 @@
+#pragma once
+#include "FrameAllocator.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 固定数量工作线程的任务系统
+// ParallelFor由调用线程一同执行，嵌套调用或工作线程繁忙时不会死锁
+// ParallelFor不分配堆内存：函数按引用传给协助线程，共享状态取自定长块池，队列为预分配的环形缓冲
+class JobSystem {
+public:
+    JobSystem();
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // workerCount为0时使用硬件线程数-1
+    bool Initialize(uint32_t workerCount = 0);
+    void Cleanup();
+
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    // 把[0, count)按grainSize切块并行执行func(begin, end)，返回时全部完成
+    template <typename Function>
+    void ParallelFor(uint32_t count, uint32_t grainSize, Function&& func) {
+        using Callable = std::remove_reference_t<Function>;
+        ParallelForRange(count, grainSize, const_cast<void*>(static_cast<const void*>(std::addressof(func))),
+                         [](void* object, uint32_t begin, uint32_t end) { (*static_cast<Callable*>(object))(begin, end); });
+    }
+
+    // 提交独立任务（std::function可能在堆上保存闭包，帧内的并行工作应使用ParallelFor）
+    void Submit(std::function<void()> job);
+    void WaitIdle();
+
+    // 当前线程编号：工作线程为1..N，其他线程为0
+    static uint32_t GetThreadIndex();
+
+private:
+    using RangeFunction = void (*)(void* object, uint32_t begin, uint32_t end);
+    struct ParallelForState;
+
+    // 队列项：普通任务或ParallelFor的协助任务
+    struct Job {
+        std::function<void()> function;
+        ParallelForState* parallelFor = nullptr;
+    };
+
+    // 队列的初始容量，稳定运行时不需要扩大
+    static const size_t INITIAL_QUEUE_CAPACITY = 256;
+
+    void ParallelForRange(uint32_t count, uint32_t grainSize, void* object, RangeFunction function);
+    void WorkerMain(uint32_t index);
+    // 调用者持有queueMutex
+    void PushJob(Job&& job);
+    void ReleaseState(ParallelForState* state);
+
+    std::vector<std::thread> workers;
+    // 环形缓冲，满时按原顺序搬入两倍大小的缓冲
+    std::vector<Job> queue;
+    size_t queueHead = 0;
+    size_t queueCount = 0;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::condition_variable idleCondition;
+    uint32_t pendingJobs = 0;
+    bool stopping = false;
+
+    // ParallelFor共享状态的块池，由queueMutex保护
+    PoolResource statePool;
+};
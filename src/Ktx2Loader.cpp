@@ -0,0 +1,218 @@
+#include "Ktx2Loader.hpp"
+#include "VulkanContext.hpp"
+#include "TextureTranscoder.hpp"
+#include "AssetArchive.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+namespace {
+    const uint8_t KTX2_IDENTIFIER[12] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+
+    struct Ktx2Header {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(Ktx2Header) == 80, "KTX2 header layout mismatch");
+
+    struct Ktx2LevelIndex {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    const uint32_t MAX_LEVELS = 32;
+
+    bool IsAstcFormat(VkFormat format) {
+        return format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK;
+    }
+}
+
+Ktx2Loader::Ktx2Loader(VulkanContext* context) : context(context) {}
+
+bool Ktx2Loader::IsFormatSupported(VkFormat format) {
+    auto it = formatSupport.find(static_cast<int>(format));
+    if (it != formatSupport.end()) {
+        return it->second;
+    }
+
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(context->GetPhysicalDevice(), format, &properties);
+
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                          VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+                                          VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    bool supported = (properties.optimalTilingFeatures & required) == required;
+    formatSupport[static_cast<int>(format)] = supported;
+    return supported;
+}
+
+bool Ktx2Loader::Open(const std::string& path, Ktx2Texture& texture) {
+    const uint8_t* mapped = nullptr;
+    size_t mappedSize = 0;
+    const AssetArchive* archive = context->GetAssetArchive();
+    if (archive != nullptr && archive->IsOpen()) {
+        const ArchiveEntry* entry = archive->Find(path);
+        if (entry != nullptr && entry->compression == AssetCompression::None) {
+            mapped = archive->GetStoredData(*entry);
+            mappedSize = static_cast<size_t>(entry->size);
+        }
+    }
+
+    std::ifstream file;
+    uint64_t sourceSize = mappedSize;
+    if (mapped == nullptr) {
+        file.open(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            std::cerr << "failed to open KTX2 file: " << path << std::endl;
+            return false;
+        }
+        sourceSize = static_cast<uint64_t>(file.tellg());
+    }
+
+    auto readBytes = [&](uint64_t offset, void* dst, size_t size) {
+        if (mapped != nullptr) {
+            if (offset + size > mappedSize) return false;
+            std::memcpy(dst, mapped + offset, size);
+            return true;
+        }
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(static_cast<char*>(dst), static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    };
+
+    Ktx2Header header;
+    if (!readBytes(0, &header, sizeof(header)) ||
+        std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        std::cerr << "not a KTX2 file: " << path << std::endl;
+        return false;
+    }
+
+    // 只支持未超压缩的2D纹理
+    if (header.supercompressionScheme != 0) {
+        std::cerr << "unsupported KTX2 supercompression scheme " << header.supercompressionScheme << ": " << path << std::endl;
+        return false;
+    }
+    if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1) {
+        std::cerr << "only 2D KTX2 textures are supported: " << path << std::endl;
+        return false;
+    }
+    if (header.vkFormat == VK_FORMAT_UNDEFINED) {
+        std::cerr << "KTX2 file without a Vulkan format (Basis Universal) is not supported: " << path << std::endl;
+        return false;
+    }
+
+    // 32级已覆盖任意32位尺寸的完整mip链，更大的层级数只可能来自损坏的文件
+    uint32_t levelCount = std::max(1u, header.levelCount);
+    if (levelCount > MAX_LEVELS) {
+        std::cerr << "invalid KTX2 level count " << header.levelCount << ": " << path << std::endl;
+        return false;
+    }
+    std::vector<Ktx2LevelIndex> levelIndex(levelCount);
+    if (!readBytes(sizeof(header), levelIndex.data(), levelCount * sizeof(Ktx2LevelIndex))) {
+        std::cerr << "truncated KTX2 level index: " << path << std::endl;
+        return false;
+    }
+
+    texture.path = path;
+    texture.mappedData = mapped;
+    texture.mappedSize = mappedSize;
+    texture.fileFormat = static_cast<VkFormat>(header.vkFormat);
+    texture.width = header.pixelWidth;
+    texture.height = std::max(1u, header.pixelHeight);
+    // 层级索引不可信：在这里一次性确认每级都位于文件内、块压缩格式的长度与mip大小一致，
+    // 流式线程上的ReadLevel据此按长度分配和读取
+    TextureFormatInfo formatInfo = TextureStreamer::GetFormatInfo(texture.fileFormat);
+    bool blockCompressed = formatInfo.blockWidth > 1 || formatInfo.blockHeight > 1;
+    texture.levels.resize(levelCount);
+    for (uint32_t i = 0; i < levelCount; i++) {
+        const Ktx2LevelIndex& level = levelIndex[i];
+        if (level.byteOffset > sourceSize || level.byteLength > sourceSize - level.byteOffset ||
+            (blockCompressed &&
+             level.byteLength != TextureStreamer::ComputeMipSize(texture.fileFormat, texture.width, texture.height, i))) {
+            std::cerr << "invalid KTX2 level " << i << " (offset " << level.byteOffset << ", length "
+                      << level.byteLength << "): " << path << std::endl;
+            return false;
+        }
+        texture.levels[i].byteOffset = level.byteOffset;
+        texture.levels[i].byteLength = level.byteLength;
+    }
+
+    // 设备支持则直接上传压缩数据，否则退回CPU转码
+    if (IsFormatSupported(texture.fileFormat)) {
+        texture.uploadFormat = texture.fileFormat;
+        texture.transcode = false;
+    } else if (TextureTranscoder::CanTranscode(texture.fileFormat)) {
+        texture.uploadFormat = TextureTranscoder::GetTranscodedFormat(texture.fileFormat);
+        texture.transcode = true;
+    } else {
+        std::cerr << "device does not support format " << header.vkFormat
+                  << (IsAstcFormat(texture.fileFormat) ? " (ASTC)" : "")
+                  << " and no transcoder is available: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Ktx2Loader::ReadLevel(const Ktx2Texture& texture, uint32_t level, std::vector<uint8_t>& data) const {
+    if (level >= texture.levels.size()) return false;
+
+    const Ktx2Level& entry = texture.levels[level];
+    std::vector<uint8_t> raw(entry.byteLength);
+    if (texture.mappedData != nullptr) {
+        if (entry.byteOffset + entry.byteLength > texture.mappedSize) return false;
+        std::memcpy(raw.data(), texture.mappedData + entry.byteOffset, static_cast<size_t>(entry.byteLength));
+    } else {
+        std::ifstream file(texture.path, std::ios::binary);
+        if (!file.is_open()) return false;
+        file.seekg(static_cast<std::streamoff>(entry.byteOffset));
+        file.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(entry.byteLength));
+        if (!file) return false;
+    }
+
+    if (!texture.transcode) {
+        data = std::move(raw);
+        return true;
+    }
+
+    uint32_t width = std::max(1u, texture.width >> level);
+    uint32_t height = std::max(1u, texture.height >> level);
+    // 在流式加载线程上调用，与工作线程一同解码
+    return TextureTranscoder::Transcode(texture.fileFormat, width, height, raw.data(), raw.size(), data, context->GetJobSystem());
+}
+
+TextureHandle Ktx2Loader::LoadStreamed(const std::string& path, TextureStreamer* streamer) {
+    auto texture = std::make_shared<Ktx2Texture>();
+    if (!Open(path, *texture)) {
+        return INVALID_TEXTURE;
+    }
+
+    TextureDesc desc;
+    desc.format = texture->uploadFormat;
+    desc.width = texture->width;
+    desc.height = texture->height;
+    desc.mipLevels = static_cast<uint32_t>(texture->levels.size());
+
+    // 加载回调在流式系统的工作线程上执行
+    return streamer->CreateTexture(desc, [this, texture](uint32_t mipLevel, std::vector<uint8_t>& data) {
+        return ReadLevel(*texture, mipLevel, data);
+    });
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include "TextureStreamer.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class VulkanContext;
+
+// KTX2文件中单个mip层级的位置
+struct Ktx2Level {
+    uint64_t byteOffset = 0;
+    uint64_t byteLength = 0;
+};
+
+struct Ktx2Texture {
+    std::string path;
+    const uint8_t* mappedData = nullptr;           // 来自资源档案时指向映射内存
+    size_t mappedSize = 0;
+    VkFormat fileFormat = VK_FORMAT_UNDEFINED;     // 文件中的格式
+    VkFormat uploadFormat = VK_FORMAT_UNDEFINED;   // 实际上传的格式
+    bool transcode = false;                        // 设备不支持时CPU解码
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<Ktx2Level> levels;                 // levels[0]为最高精度
+};
+
+// KTX2加载器：设备支持的BCn/ASTC格式直接上传mip链，否则在CPU上转码
+class Ktx2Loader {
+public:
+    Ktx2Loader(VulkanContext* context);
+
+    // 解析头部和层级索引，并根据设备格式支持决定上传格式
+    // 资源档案中有同名且未压缩的条目时直接从映射读取，否则读取磁盘文件
+    bool Open(const std::string& path, Ktx2Texture& texture);
+
+    // 读取（必要时转码）一个mip层级
+    bool ReadLevel(const Ktx2Texture& texture, uint32_t level, std::vector<uint8_t>& data) const;
+
+    // 打开文件并交给TextureStreamer按需流式上传
+    TextureHandle LoadStreamed(const std::string& path, TextureStreamer* streamer);
+
+    // 设备是否支持以该格式采样（结果缓存）
+    bool IsFormatSupported(VkFormat format);
+
+private:
+    VulkanContext* context;
+    std::unordered_map<int, bool> formatSupport;
+};
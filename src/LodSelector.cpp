@@ -0,0 +1,128 @@
+#include "LodSelector.hpp"
+#include "Profiler.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    const uint32_t SELECT_GRAIN_SIZE = 1024;
+
+    float DistanceToBox(const Vec3& point, const AABB& box) {
+        float dx = std::max(std::max(box.min.x - point.x, point.x - box.max.x), 0.0f);
+        float dy = std::max(std::max(box.min.y - point.y, point.y - box.max.y), 0.0f);
+        float dz = std::max(std::max(box.min.z - point.z, point.z - box.max.z), 0.0f);
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    float MaxAxisScale(const Mat4& matrix) {
+        const float* m = matrix.m;
+        float x = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+        float y = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+        float z = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+        return std::sqrt(std::max(x, std::max(y, z)));
+    }
+}
+
+LodSelector::LodSelector(Scene* scene, GeometryPool* geometryPool, JobSystem* jobSystem)
+    : scene(scene), geometryPool(geometryPool), jobSystem(jobSystem) {
+}
+
+void LodSelector::SetMesh(NodeHandle node, MeshHandle mesh) {
+    if (node >= nodeMeshes.size()) {
+        nodeMeshes.resize(node + 1, INVALID_MESH);
+        currentLods.resize(node + 1, 0);
+    }
+    nodeMeshes[node] = mesh;
+    currentLods[node] = 0;
+
+    if (mesh != INVALID_MESH && !scene->GetBoundsFlags()[scene->GetIndex(node)]) {
+        scene->SetLocalBounds(node, geometryPool->GetMesh(mesh).bounds);
+    }
+}
+
+MeshHandle LodSelector::GetMesh(NodeHandle node) const {
+    return node < nodeMeshes.size() ? nodeMeshes[node] : INVALID_MESH;
+}
+
+void LodSelector::SetTexture(NodeHandle node, TextureHandle texture) {
+    if (node >= nodeTextures.size()) {
+        nodeTextures.resize(node + 1, INVALID_TEXTURE);
+    }
+    nodeTextures[node] = texture;
+}
+
+TextureHandle LodSelector::GetTexture(NodeHandle node) const {
+    return node < nodeTextures.size() ? nodeTextures[node] : INVALID_TEXTURE;
+}
+
+uint32_t LodSelector::SelectLod(const MeshInfo& mesh, float errorScale, float distance,
+                                const LodCamera& camera, const LodSettings& settings, uint32_t currentLod) {
+    if (mesh.lodCount <= 1) return 0;
+
+    // 相机在包围盒内时投影误差无界，使用最精细的一级
+    float pixelsPerError = errorScale * camera.projectionScale / std::max(distance, 1e-6f);
+    uint32_t lod = std::min(currentLod, mesh.lodCount - 1);
+    while (lod > 0 && mesh.lods[lod].error * pixelsPerError > settings.errorThreshold) {
+        lod--;
+    }
+    float coarsenThreshold = settings.errorThreshold * (1.0f - settings.hysteresis);
+    while (lod + 1 < mesh.lodCount && mesh.lods[lod + 1].error * pixelsPerError <= coarsenThreshold) {
+        lod++;
+    }
+    return lod;
+}
+
+void LodSelector::Select(const std::vector<uint32_t>& visibleIndices, const LodCamera& camera, std::vector<uint8_t>& lods) {
+    VGE_PROFILE_FUNCTION();
+    lods.assign(visibleIndices.size(), 0);
+    if (nodeMeshes.empty()) return;
+
+    const Mat4* worldMatrices = scene->GetWorldMatrices();
+    const AABB* worldBounds = scene->GetWorldBounds();
+    const uint8_t* boundsFlags = scene->GetBoundsFlags();
+
+    // 每个节点只由一个任务读写，不需要同步
+    auto selectRange = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            uint32_t index = visibleIndices[i];
+            NodeHandle node = scene->GetHandle(index);
+            if (node >= nodeMeshes.size() || nodeMeshes[node] == INVALID_MESH) continue;
+            MeshHandle mesh = nodeMeshes[node];
+            if (!geometryPool->IsReady(mesh)) continue;
+
+            float distance = boundsFlags[index] ? DistanceToBox(camera.position, worldBounds[index]) : 0.0f;
+            uint32_t lod = SelectLod(geometryPool->GetMesh(mesh), MaxAxisScale(worldMatrices[index]),
+                                     distance, camera, settings, currentLods[node]);
+            currentLods[node] = static_cast<uint8_t>(lod);
+            lods[i] = static_cast<uint8_t>(lod);
+        }
+    };
+
+    uint32_t count = static_cast<uint32_t>(visibleIndices.size());
+    if (jobSystem != nullptr && count > SELECT_GRAIN_SIZE) {
+        jobSystem->ParallelFor(count, SELECT_GRAIN_SIZE, selectRange);
+    } else {
+        selectRange(0, count);
+    }
+}
+
+void LodSelector::CollectTextureRequests(const std::vector<uint32_t>& visibleIndices, const LodCamera& camera,
+                                         std::vector<TextureRequest>& requests) const {
+    requests.clear();
+    if (nodeTextures.empty()) return;
+
+    const AABB* worldBounds = scene->GetWorldBounds();
+    const uint8_t* boundsFlags = scene->GetBoundsFlags();
+    for (uint32_t index : visibleIndices) {
+        NodeHandle node = scene->GetHandle(index);
+        if (node >= nodeTextures.size() || nodeTextures[node] == INVALID_TEXTURE || !boundsFlags[index]) continue;
+
+        // 相机在包围盒内时请求最高精度
+        const AABB& bounds = worldBounds[index];
+        float extent = std::max(bounds.max.x - bounds.min.x, std::max(bounds.max.y - bounds.min.y, bounds.max.z - bounds.min.z));
+        float distance = DistanceToBox(camera.position, bounds);
+        float screenSize = distance > 0.0f ? extent * camera.projectionScale / distance : FLT_MAX;
+        requests.push_back({nodeTextures[node], screenSize});
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "GeometryPool.hpp"
+#include "MathTypes.hpp"
+#include "Scene.hpp"
+#include "TextureStreamer.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// LOD选择使用的相机参数
+struct LodCamera {
+    Vec3 position;
+    float projectionScale = 0.0f;   // 距离d处长度e的投影像素数为 e * projectionScale / d
+
+    static float ComputeProjectionScale(float fovY, float viewportHeight) {
+        return viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+    }
+};
+
+struct LodSettings {
+    float errorThreshold = 1.0f;    // 允许的屏幕空间误差（像素）
+    float hysteresis = 0.25f;       // 切换到更粗LOD时要求误差低于阈值的(1 - hysteresis)倍，避免边界处来回切换
+};
+
+// 按屏幕空间误差为每个实例选择网格LOD：选择投影误差不超过阈值的最粗一级
+// 与hiz_cull.comp中的GPU选择使用相同的规则
+class LodSelector {
+public:
+    LodSelector(Scene* scene, GeometryPool* geometryPool, JobSystem* jobSystem);
+
+    // 关联节点与网格，节点没有包围盒时使用网格包围盒
+    void SetMesh(NodeHandle node, MeshHandle mesh);
+    MeshHandle GetMesh(NodeHandle node) const;
+
+    // 关联节点与流式纹理，节点可见时按其屏幕尺寸请求mip
+    void SetTexture(NodeHandle node, TextureHandle texture);
+    TextureHandle GetTexture(NodeHandle node) const;
+
+    void SetSettings(const LodSettings& newSettings) { settings = newSettings; }
+    const LodSettings& GetSettings() const { return settings; }
+
+    // 为可见节点（Scene密集索引）选择LOD，lods与visibleIndices一一对应，未关联网格的节点为0
+    void Select(const std::vector<uint32_t>& visibleIndices, const LodCamera& camera, std::vector<uint8_t>& lods);
+
+    // 为关联了纹理的可见节点生成驻留请求，屏幕尺寸 = 世界包围盒最大边 × projectionScale / 距离
+    void CollectTextureRequests(const std::vector<uint32_t>& visibleIndices, const LodCamera& camera,
+                                std::vector<TextureRequest>& requests) const;
+
+    // errorScale为世界矩阵的最大轴缩放，distance为相机到世界包围盒的距离
+    static uint32_t SelectLod(const MeshInfo& mesh, float errorScale, float distance,
+                              const LodCamera& camera, const LodSettings& settings, uint32_t currentLod);
+
+private:
+    Scene* scene;
+    GeometryPool* geometryPool;
+    JobSystem* jobSystem;
+    LodSettings settings;
+
+    // 按NodeHandle索引
+    std::vector<MeshHandle> nodeMeshes;
+    std::vector<uint8_t> currentLods;
+    std::vector<TextureHandle> nodeTextures;
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// 场景使用的基础数学类型，矩阵为列主序（与GLSL一致）
+
+struct Vec3 {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+struct Quat {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float w = 1.0f;
+
+    static Quat FromAxisAngle(const Vec3& axis, float radians) {
+        float length = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+        if (length <= 0.0f) return Quat{};
+        float s = std::sin(radians * 0.5f) / length;
+        return Quat{axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f)};
+    }
+};
+
+struct alignas(16) Mat4 {
+    float m[16];    // m[column * 4 + row]
+
+    static Mat4 Identity() {
+        Mat4 result;
+        std::memset(result.m, 0, sizeof(result.m));
+        result.m[0] = result.m[5] = result.m[10] = result.m[15] = 1.0f;
+        return result;
+    }
+};
+
+// 平移/旋转/缩放
+struct Transform {
+    Vec3 position;
+    Quat rotation;
+    Vec3 scale{1.0f, 1.0f, 1.0f};
+
+    Mat4 ToMatrix() const {
+        float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+        float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+        float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+        Mat4 result;
+        result.m[0] = (1.0f - 2.0f * (yy + zz)) * scale.x;
+        result.m[1] = 2.0f * (xy + wz) * scale.x;
+        result.m[2] = 2.0f * (xz - wy) * scale.x;
+        result.m[3] = 0.0f;
+        result.m[4] = 2.0f * (xy - wz) * scale.y;
+        result.m[5] = (1.0f - 2.0f * (xx + zz)) * scale.y;
+        result.m[6] = 2.0f * (yz + wx) * scale.y;
+        result.m[7] = 0.0f;
+        result.m[8] = 2.0f * (xz + wy) * scale.z;
+        result.m[9] = 2.0f * (yz - wx) * scale.z;
+        result.m[10] = (1.0f - 2.0f * (xx + yy)) * scale.z;
+        result.m[11] = 0.0f;
+        result.m[12] = position.x;
+        result.m[13] = position.y;
+        result.m[14] = position.z;
+        result.m[15] = 1.0f;
+        return result;
+    }
+};
+
+// 标量版本矩阵乘法 result = a * b，SIMD版本见Scene.cpp
+inline void MultiplyMat4(const Mat4& a, const Mat4& b, Mat4& result) {
+    Mat4 temp;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            temp.m[column * 4 + row] = a.m[row] * b.m[column * 4] +
+                                       a.m[4 + row] * b.m[column * 4 + 1] +
+                                       a.m[8 + row] * b.m[column * 4 + 2] +
+                                       a.m[12 + row] * b.m[column * 4 + 3];
+        }
+    }
+    result = temp;
+}
+
+// 轴对齐包围盒
+struct AABB {
+    Vec3 min{ 1e30f,  1e30f,  1e30f};
+    Vec3 max{-1e30f, -1e30f, -1e30f};
+
+    bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    void Expand(const AABB& other) {
+        min.x = std::min(min.x, other.min.x);
+        min.y = std::min(min.y, other.min.y);
+        min.z = std::min(min.z, other.min.z);
+        max.x = std::max(max.x, other.max.x);
+        max.y = std::max(max.y, other.max.y);
+        max.z = std::max(max.z, other.max.z);
+    }
+
+    float SurfaceArea() const {
+        if (!IsValid()) return 0.0f;
+        float dx = max.x - min.x, dy = max.y - min.y, dz = max.z - min.z;
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+};
+
+// 变换包围盒：中心点按矩阵变换，半径按矩阵绝对值变换
+inline AABB TransformAABB(const Mat4& matrix, const AABB& box) {
+    const float* m = matrix.m;
+    float cx = (box.min.x + box.max.x) * 0.5f, cy = (box.min.y + box.max.y) * 0.5f, cz = (box.min.z + box.max.z) * 0.5f;
+    float ex = (box.max.x - box.min.x) * 0.5f, ey = (box.max.y - box.min.y) * 0.5f, ez = (box.max.z - box.min.z) * 0.5f;
+
+    float centerX = m[0] * cx + m[4] * cy + m[8] * cz + m[12];
+    float centerY = m[1] * cx + m[5] * cy + m[9] * cz + m[13];
+    float centerZ = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+    float extentX = std::fabs(m[0]) * ex + std::fabs(m[4]) * ey + std::fabs(m[8]) * ez;
+    float extentY = std::fabs(m[1]) * ex + std::fabs(m[5]) * ey + std::fabs(m[9]) * ez;
+    float extentZ = std::fabs(m[2]) * ex + std::fabs(m[6]) * ey + std::fabs(m[10]) * ez;
+
+    AABB result;
+    result.min = Vec3{centerX - extentX, centerY - extentY, centerZ - extentZ};
+    result.max = Vec3{centerX + extentX, centerY + extentY, centerZ + extentZ};
+    return result;
+}
+
+// 视锥体六个平面（ax + by + cz + d >= 0 为内侧），法线已归一化
+struct Frustum {
+    float planes[6][4];
+
+    // 从列主序的视图投影矩阵提取（Vulkan深度范围0..1）
+    static Frustum FromViewProjection(const Mat4& viewProjection) {
+        const float* m = viewProjection.m;
+        float rows[4][4];
+        for (int row = 0; row < 4; row++) {
+            for (int column = 0; column < 4; column++) {
+                rows[row][column] = m[column * 4 + row];
+            }
+        }
+
+        Frustum frustum;
+        for (int i = 0; i < 4; i++) {
+            frustum.planes[0][i] = rows[3][i] + rows[0][i];     // 左
+            frustum.planes[1][i] = rows[3][i] - rows[0][i];     // 右
+            frustum.planes[2][i] = rows[3][i] + rows[1][i];     // 下
+            frustum.planes[3][i] = rows[3][i] - rows[1][i];     // 上
+            frustum.planes[4][i] = rows[2][i];                  // 近
+            frustum.planes[5][i] = rows[3][i] - rows[2][i];     // 远
+        }
+        for (auto& plane : frustum.planes) {
+            float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            if (length > 0.0f) {
+                for (float& value : plane) value /= length;
+            }
+        }
+        return frustum;
+    }
+};
@@ -0,0 +1,479 @@
+#include "MemoryManager.hpp"
+#include "Metrics.hpp"
+#include "Profiler.hpp"
+#include "VulkanContext.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+MemoryManager::MemoryManager(VulkanContext* context) : context(context) {}
+
+MemoryManager::~MemoryManager() {
+    Cleanup();
+}
+
+bool MemoryManager::Initialize() {
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(context->GetAllocator(), &memoryProperties);
+
+    heapFlags.resize(memoryProperties->memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+        heapFlags[i] = memoryProperties->memoryHeaps[i].flags;
+    }
+
+    typeToHeap.resize(memoryProperties->memoryTypeCount);
+    for (uint32_t i = 0; i < memoryProperties->memoryTypeCount; i++) {
+        typeToHeap[i] = memoryProperties->memoryTypes[i].heapIndex;
+    }
+
+    statistics.heaps.resize(memoryProperties->memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+        statistics.heaps[i].deviceLocal = (heapFlags[i] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    if (!CreateDefragResources()) return false;
+
+    if (const char* value = std::getenv("VGE_MEMORY_STATS")) {
+        uint32_t interval = 60;
+        if (const char* intervalValue = std::getenv("VGE_MEMORY_STATS_INTERVAL")) {
+            interval = static_cast<uint32_t>(std::strtoul(intervalValue, nullptr, 10));
+        }
+        SetStatisticsExport(value, interval);
+    }
+
+    UpdateBudgets();
+    UpdateDetailedStatistics();
+    return true;
+}
+
+void MemoryManager::Cleanup() {
+    if (context->GetDevice() == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (defragContext != VK_NULL_HANDLE) {
+        if (defragPassActive) {
+            vkWaitForFences(context->GetDevice(), 1, &defragFence, VK_TRUE, UINT64_MAX);
+            vkDeviceWaitIdle(context->GetDevice());
+            if (!defragCommitted) {
+                for (auto resource : pendingMoves) {
+                    resource->CommitMove();
+                }
+            }
+            for (auto resource : pendingMoves) {
+                resource->ReleaseOld();
+            }
+            pendingMoves.clear();
+            vmaEndDefragmentationPass(context->GetAllocator(), defragContext, &defragPass);
+            defragPassActive = false;
+        }
+        vmaEndDefragmentation(context->GetAllocator(), defragContext, nullptr);
+        defragContext = VK_NULL_HANDLE;
+    }
+
+    if (defragFence != VK_NULL_HANDLE) {
+        vkDestroyFence(context->GetDevice(), defragFence, context->GetAllocationCallbacks());
+        defragFence = VK_NULL_HANDLE;
+    }
+
+    if (defragCommandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(context->GetDevice(), defragCommandPool, context->GetAllocationCallbacks());
+        defragCommandPool = VK_NULL_HANDLE;
+        defragCommandBuffer = VK_NULL_HANDLE;
+    }
+
+    evictionHandlers.clear();
+}
+
+bool MemoryManager::CreateDefragResources() {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = context->GetGraphicsQueueFamily();
+
+    if (vkCreateCommandPool(context->GetDevice(), &poolInfo, context->GetAllocationCallbacks(), &defragCommandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create defragmentation command pool!");
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = defragCommandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(context->GetDevice(), &allocInfo, &defragCommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate defragmentation command buffer!");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(context->GetDevice(), &fenceInfo, context->GetAllocationCallbacks(), &defragFence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create defragmentation fence!");
+    }
+    return true;
+}
+
+void MemoryManager::BeginFrame(uint64_t frameIndex) {
+    VGE_PROFILE_FUNCTION();
+    statistics.frameIndex = frameIndex;
+    vmaSetCurrentFrameIndex(context->GetAllocator(), static_cast<uint32_t>(frameIndex));
+
+    UpdateBudgets();
+    HandleMemoryPressure();
+
+    if (defragContext != VK_NULL_HANDLE) {
+        StepDefragmentation();
+    }
+
+    // 碎片率来自详细统计，只在其刷新的帧上判断是否开始整理
+    if (detailedStatsInterval != 0 && frameIndex % detailedStatsInterval == 0) {
+        UpdateDetailedStatistics();
+        if (defragContext == VK_NULL_HANDLE && ShouldDefragment()) {
+            BeginDefragmentation();
+        }
+    }
+
+    if (exportInterval != 0 && !exportPath.empty() && frameIndex % exportInterval == 0) {
+        WriteStatisticsJson(exportPath);
+    }
+}
+
+void MemoryManager::UpdateBudgets() {
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(context->GetAllocator(), budgets);
+
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    for (size_t i = 0; i < statistics.heaps.size(); i++) {
+        HeapStatistics& heap = statistics.heaps[i];
+        heap.budget = budgets[i].budget;
+        heap.usage = budgets[i].usage;
+        heap.blockBytes = budgets[i].statistics.blockBytes;
+        heap.allocationBytes = budgets[i].statistics.allocationBytes;
+        heap.blockCount = budgets[i].statistics.blockCount;
+        heap.allocationCount = budgets[i].statistics.allocationCount;
+    }
+}
+
+void MemoryManager::UpdateDetailedStatistics() {
+    // vmaCalculateStatistics会遍历所有分配，只按间隔调用
+    VmaTotalStatistics totalStats{};
+    vmaCalculateStatistics(context->GetAllocator(), &totalStats);
+
+    for (size_t i = 0; i < statistics.heaps.size(); i++) {
+        const VmaDetailedStatistics& detailed = totalStats.memoryHeap[i];
+        HeapStatistics& heap = statistics.heaps[i];
+
+        VkDeviceSize freeBytes = detailed.statistics.blockBytes - detailed.statistics.allocationBytes;
+        heap.largestFreeRange = detailed.unusedRangeCount > 0 ? detailed.unusedRangeSizeMax : 0;
+        heap.fragmentation = freeBytes > 0
+            ? 1.0f - static_cast<float>(heap.largestFreeRange) / static_cast<float>(freeBytes)
+            : 0.0f;
+    }
+}
+
+void MemoryManager::HandleMemoryPressure() {
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    for (uint32_t i = 0; i < statistics.heaps.size(); i++) {
+        const HeapStatistics& heap = statistics.heaps[i];
+        if (heap.budget == 0) continue;
+
+        // 已驱逐但尚未释放的字节视为已腾出，避免在它们释放之前的每一帧重复驱逐
+        VkDeviceSize usage = heap.usage > heap.pendingEviction ? heap.usage - heap.pendingEviction : 0;
+        if (static_cast<float>(usage) > static_cast<float>(heap.budget) * pressureThreshold) {
+            VkDeviceSize target = static_cast<VkDeviceSize>(static_cast<float>(heap.budget) * evictionTarget);
+            EvictLocked(i, usage - target);
+        }
+    }
+}
+
+bool MemoryManager::HasBudget(uint32_t heapIndex, VkDeviceSize size) const {
+    if (heapIndex >= statistics.heaps.size()) return false;
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    const HeapStatistics& heap = statistics.heaps[heapIndex];
+    return heap.usage + size <= heap.budget;
+}
+
+uint32_t MemoryManager::GetHeapIndex(uint32_t memoryTypeIndex) const {
+    return memoryTypeIndex < typeToHeap.size() ? typeToHeap[memoryTypeIndex] : 0;
+}
+
+VkResult MemoryManager::CreateBuffer(const VkBufferCreateInfo& bufferInfo, const VmaAllocationCreateInfo& allocInfo,
+                                     VkBuffer* buffer, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo) {
+    // 只有设置了WITHIN_BUDGET_BIT的可流式分配受预算约束，其余分配可以超出软预算
+    VkResult result = vmaCreateBuffer(context->GetAllocator(), &bufferInfo, &allocInfo, buffer, allocation, allocationInfo);
+    if (result != VK_ERROR_OUT_OF_DEVICE_MEMORY || (allocInfo.flags & VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT) == 0) {
+        if (result == VK_SUCCESS) context->GetMetrics()->Add(Metrics::ALLOCATIONS);
+        return result;
+    }
+
+    // 超出预算：安排驱逐，不在本次调用中重试
+    uint32_t memoryTypeIndex = 0;
+    if (vmaFindMemoryTypeIndexForBufferInfo(context->GetAllocator(), &bufferInfo, &allocInfo, &memoryTypeIndex) == VK_SUCCESS) {
+        return HandleOutOfBudget(GetHeapIndex(memoryTypeIndex), bufferInfo.size);
+    }
+    return result;
+}
+
+VkResult MemoryManager::CreateImage(const VkImageCreateInfo& imageInfo, const VmaAllocationCreateInfo& allocInfo,
+                                    VkImage* image, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo) {
+    VkResult result = vmaCreateImage(context->GetAllocator(), &imageInfo, &allocInfo, image, allocation, allocationInfo);
+    if (result != VK_ERROR_OUT_OF_DEVICE_MEMORY || (allocInfo.flags & VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT) == 0) {
+        if (result == VK_SUCCESS) context->GetMetrics()->Add(Metrics::ALLOCATIONS);
+        return result;
+    }
+
+    // 失败路径上才查询图像的实际内存需求
+    VkImage probe = VK_NULL_HANDLE;
+    if (vkCreateImage(context->GetDevice(), &imageInfo, context->GetAllocationCallbacks(), &probe) == VK_SUCCESS) {
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(context->GetDevice(), probe, &requirements);
+        vkDestroyImage(context->GetDevice(), probe, context->GetAllocationCallbacks());
+
+        uint32_t memoryTypeIndex = 0;
+        if (vmaFindMemoryTypeIndex(context->GetAllocator(), requirements.memoryTypeBits, &allocInfo, &memoryTypeIndex) == VK_SUCCESS) {
+            return HandleOutOfBudget(GetHeapIndex(memoryTypeIndex), requirements.size);
+        }
+    }
+    return result;
+}
+
+VkResult MemoryManager::HandleOutOfBudget(uint32_t heapIndex, VkDeviceSize size) {
+    // 被驱逐的资源可能仍被在途帧引用，内存要等这些帧结束后才释放，立即重试必然再次失败
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    HeapStatistics& heap = statistics.heaps[heapIndex];
+    if (heap.pendingEviction < size) {
+        VkDeviceSize usage = heap.usage > heap.pendingEviction ? heap.usage - heap.pendingEviction : 0;
+        VkDeviceSize overflow = usage + size > heap.budget ? usage + size - heap.budget : 0;
+        EvictLocked(heapIndex, std::max(overflow, size - heap.pendingEviction));
+    }
+    return heap.pendingEviction > 0 ? VK_NOT_READY : VK_ERROR_OUT_OF_DEVICE_MEMORY;
+}
+
+uint32_t MemoryManager::RegisterEvictionHandler(EvictionCallback callback) {
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    uint32_t handle = nextEvictionHandle++;
+    evictionHandlers.push_back({handle, std::move(callback)});
+    return handle;
+}
+
+void MemoryManager::UnregisterEvictionHandler(uint32_t handle) {
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    evictionHandlers.erase(
+        std::remove_if(evictionHandlers.begin(), evictionHandlers.end(),
+                       [handle](const EvictionHandler& handler) { return handler.handle == handle; }),
+        evictionHandlers.end());
+}
+
+VkDeviceSize MemoryManager::Evict(uint32_t heapIndex, VkDeviceSize bytesToFree) {
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    return EvictLocked(heapIndex, bytesToFree);
+}
+
+VkDeviceSize MemoryManager::EvictLocked(uint32_t heapIndex, VkDeviceSize bytesToFree) {
+    VkDeviceSize freed = 0;
+    for (auto& handler : evictionHandlers) {
+        if (freed >= bytesToFree) break;
+        freed += handler.callback(heapIndex, bytesToFree - freed);
+    }
+    statistics.heaps[heapIndex].pendingEviction += freed;
+    return freed;
+}
+
+void MemoryManager::ReleaseEvictedBytes(uint32_t heapIndex, VkDeviceSize bytes) {
+    if (heapIndex >= statistics.heaps.size()) return;
+    // 处理方自行按预算驱逐的资源也在此归还，不一定经过Evict登记
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    HeapStatistics& heap = statistics.heaps[heapIndex];
+    heap.pendingEviction -= std::min(heap.pendingEviction, bytes);
+    statistics.bytesEvicted += bytes;
+}
+
+void MemoryManager::SetDefragmentationLimits(VkDeviceSize bytesPerPass, uint32_t allocationsPerPass) {
+    defragBytesPerPass = bytesPerPass;
+    defragAllocationsPerPass = allocationsPerPass;
+}
+
+bool MemoryManager::ShouldDefragment() const {
+    if (defragThreshold <= 0.0f) return false;
+    for (const HeapStatistics& heap : statistics.heaps) {
+        if (!heap.deviceLocal) continue;
+        // 空闲字节太少时碎片率没有意义，移动也腾不出可用的区间
+        VkDeviceSize freeBytes = heap.blockBytes - heap.allocationBytes;
+        if (freeBytes >= defragBytesPerPass && heap.fragmentation > defragThreshold) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MemoryManager::BeginDefragmentation() {
+    if (defragContext != VK_NULL_HANDLE) return;
+
+    VmaDefragmentationInfo defragInfo{};
+    defragInfo.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+    defragInfo.maxBytesPerPass = defragBytesPerPass;
+    defragInfo.maxAllocationsPerPass = defragAllocationsPerPass;
+
+    if (vmaBeginDefragmentation(context->GetAllocator(), &defragInfo, &defragContext) != VK_SUCCESS) {
+        defragContext = VK_NULL_HANDLE;
+        std::cerr << "failed to begin memory defragmentation" << std::endl;
+        return;
+    }
+    statistics.defragmenting = true;
+}
+
+void MemoryManager::StepDefragmentation() {
+    VkDevice device = context->GetDevice();
+
+    if (!defragPassActive) {
+        VkResult result = vmaBeginDefragmentationPass(context->GetAllocator(), defragContext, &defragPass);
+        if (result == VK_SUCCESS) {
+            FinishDefragmentation();
+            return;
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkResetCommandBuffer(defragCommandBuffer, 0);
+        vkBeginCommandBuffer(defragCommandBuffer, &beginInfo);
+
+        for (uint32_t i = 0; i < defragPass.moveCount; i++) {
+            VmaDefragmentationMove& move = defragPass.pMoves[i];
+
+            VmaAllocationInfo allocationInfo;
+            vmaGetAllocationInfo(context->GetAllocator(), move.srcAllocation, &allocationInfo);
+            auto resource = static_cast<MovableResource*>(allocationInfo.pUserData);
+
+            if (resource != nullptr && resource->BeginMove(defragCommandBuffer, move.dstTmpAllocation)) {
+                pendingMoves.push_back(resource);
+            } else {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+            }
+        }
+
+        vkEndCommandBuffer(defragCommandBuffer);
+        defragPassActive = true;
+        defragCommitted = false;
+
+        if (pendingMoves.empty()) {
+            // 没有可移动的资源，直接结束本轮
+            defragCommitted = true;
+            defragReleaseCountdown = 0;
+        } else {
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &defragCommandBuffer;
+
+            vkResetFences(device, 1, &defragFence);
+            if (vkQueueSubmit(context->GetGraphicsQueue(), 1, &submitInfo, defragFence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit defragmentation commands!");
+            }
+            context->GetMetrics()->Add(Metrics::COMMAND_BUFFER_SUBMITS);
+            return;
+        }
+    }
+
+    if (!defragCommitted) {
+        if (vkGetFenceStatus(device, defragFence) != VK_SUCCESS) return;
+
+        for (auto resource : pendingMoves) {
+            resource->CommitMove();
+        }
+        defragCommitted = true;
+        // 之前录制的帧仍可能引用旧资源，等所有在途帧完成后再释放
+        defragReleaseCountdown = VulkanContext::MAX_FRAMES_IN_FLIGHT - 1;
+        return;
+    }
+
+    if (defragReleaseCountdown > 0) {
+        defragReleaseCountdown--;
+        if (defragReleaseCountdown > 0) return;
+    }
+
+    for (auto resource : pendingMoves) {
+        resource->ReleaseOld();
+    }
+    pendingMoves.clear();
+    defragPassActive = false;
+
+    if (vmaEndDefragmentationPass(context->GetAllocator(), defragContext, &defragPass) == VK_SUCCESS) {
+        FinishDefragmentation();
+    }
+}
+
+void MemoryManager::FinishDefragmentation() {
+    VmaDefragmentationStats defragStats{};
+    vmaEndDefragmentation(context->GetAllocator(), defragContext, &defragStats);
+    defragContext = VK_NULL_HANDLE;
+
+    statistics.defragBytesMoved += defragStats.bytesMoved;
+    statistics.defragAllocationsMoved += defragStats.allocationsMoved;
+    statistics.defragmenting = false;
+
+    UpdateDetailedStatistics();
+}
+
+void MemoryManager::SetStatisticsExport(const std::string& path, uint32_t intervalFrames) {
+    exportPath = path;
+    exportInterval = intervalFrames;
+}
+
+std::string MemoryManager::ExportStatisticsJson() {
+    UpdateBudgets();
+    UpdateDetailedStatistics();
+
+    VkDeviceSize totalUsage = 0;
+    VkDeviceSize totalBudget = 0;
+    uint32_t totalAllocations = 0;
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"frame\": " << statistics.frameIndex << ",\n";
+    json << "  \"heaps\": [\n";
+    for (size_t i = 0; i < statistics.heaps.size(); i++) {
+        const HeapStatistics& heap = statistics.heaps[i];
+        totalUsage += heap.usage;
+        totalBudget += heap.budget;
+        totalAllocations += heap.allocationCount;
+
+        json << "    {\"index\": " << i
+             << ", \"deviceLocal\": " << (heap.deviceLocal ? "true" : "false")
+             << ", \"budget\": " << heap.budget
+             << ", \"usage\": " << heap.usage
+             << ", \"blockBytes\": " << heap.blockBytes
+             << ", \"allocationBytes\": " << heap.allocationBytes
+             << ", \"blockCount\": " << heap.blockCount
+             << ", \"allocationCount\": " << heap.allocationCount
+             << ", \"largestFreeRange\": " << heap.largestFreeRange
+             << ", \"fragmentation\": " << heap.fragmentation
+             << ", \"pendingEviction\": " << heap.pendingEviction << "}";
+        json << (i + 1 < statistics.heaps.size() ? ",\n" : "\n");
+    }
+    json << "  ],\n";
+    json << "  \"totalUsage\": " << totalUsage << ",\n";
+    json << "  \"totalBudget\": " << totalBudget << ",\n";
+    json << "  \"totalAllocations\": " << totalAllocations << ",\n";
+    json << "  \"bytesEvicted\": " << statistics.bytesEvicted << ",\n";
+    json << "  \"defragmenting\": " << (statistics.defragmenting ? "true" : "false") << ",\n";
+    json << "  \"defragBytesMoved\": " << statistics.defragBytesMoved << ",\n";
+    json << "  \"defragAllocationsMoved\": " << statistics.defragAllocationsMoved << "\n";
+    json << "}\n";
+    return json.str();
+}
+
+bool MemoryManager::WriteStatisticsJson(const std::string& path) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "failed to open memory statistics file: " << path << std::endl;
+        return false;
+    }
+    file << ExportStatisticsJson();
+    return true;
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include "vk_mem_alloc.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class VulkanContext;
+
+// 单个内存堆的预算与统计
+struct HeapStatistics {
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+    VkDeviceSize blockBytes = 0;
+    VkDeviceSize allocationBytes = 0;
+    uint32_t blockCount = 0;
+    uint32_t allocationCount = 0;
+    VkDeviceSize largestFreeRange = 0;
+    float fragmentation = 0.0f;   // 1 - 最大空闲区间 / 总空闲字节
+    VkDeviceSize pendingEviction = 0;   // 已驱逐、等待在途帧结束后释放的字节
+    bool deviceLocal = false;
+};
+
+// 每帧导出的内存统计
+struct MemoryStatistics {
+    uint64_t frameIndex = 0;
+    std::vector<HeapStatistics> heaps;
+    VkDeviceSize bytesEvicted = 0;
+    VkDeviceSize defragBytesMoved = 0;
+    uint32_t defragAllocationsMoved = 0;
+    bool defragmenting = false;
+};
+
+// 可被碎片整理移动的资源（分配的pUserData需指向该对象）
+// 资源在移动期间只能被GPU读取
+class MovableResource {
+public:
+    virtual ~MovableResource() = default;
+
+    // 在dstAllocation上创建新资源并录制拷贝命令，返回false表示忽略本次移动
+    virtual bool BeginMove(VkCommandBuffer commandBuffer, VmaAllocation dstAllocation) = 0;
+    // 拷贝完成后切换到新资源
+    virtual void CommitMove() = 0;
+    // 所有引用旧资源的帧结束后销毁旧资源
+    virtual void ReleaseOld() = 0;
+};
+
+// 驱逐回调：尝试在指定堆上释放bytesToFree字节，返回安排释放的字节数。
+// GPU可能仍在使用被驱逐的资源，内存在引用它的帧结束后才真正释放，此时处理方调用ReleaseEvictedBytes。
+// 回调在持有预算锁时执行，不能在回调中调用MemoryManager的预算与驱逐接口
+using EvictionCallback = std::function<VkDeviceSize(uint32_t heapIndex, VkDeviceSize bytesToFree)>;
+
+class MemoryManager {
+public:
+    MemoryManager(VulkanContext* context);
+    ~MemoryManager();
+
+    bool Initialize();
+    void Cleanup();
+
+    // 每帧调用：刷新预算、处理内存压力、碎片率超过阈值时开始并推进碎片整理、按间隔导出统计
+    void BeginFrame(uint64_t frameIndex);
+
+    // 资源创建。allocInfo设置VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT的可流式分配受预算约束：超预算时安排驱逐
+    // 可流式资源并返回VK_NOT_READY，驱逐的内存要在之后的帧才释放，调用方应在之后的帧重试；没有可驱逐的资源时
+    // 返回VK_ERROR_OUT_OF_DEVICE_MEMORY。未设置该位的分配（深度缓冲、暂存环等必需资源）可以超出软预算。
+    // 可在启动图的工作线程上并发调用
+    VkResult CreateBuffer(const VkBufferCreateInfo& bufferInfo, const VmaAllocationCreateInfo& allocInfo,
+                          VkBuffer* buffer, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo = nullptr);
+    VkResult CreateImage(const VkImageCreateInfo& imageInfo, const VmaAllocationCreateInfo& allocInfo,
+                         VkImage* image, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo = nullptr);
+    bool HasBudget(uint32_t heapIndex, VkDeviceSize size) const;
+    uint32_t GetHeapIndex(uint32_t memoryTypeIndex) const;
+
+    // 驱逐回调注册
+    uint32_t RegisterEvictionHandler(EvictionCallback callback);
+    void UnregisterEvictionHandler(uint32_t handle);
+    VkDeviceSize Evict(uint32_t heapIndex, VkDeviceSize bytesToFree);
+    // 驱逐的资源销毁、内存实际归还后由处理方调用
+    void ReleaseEvictedBytes(uint32_t heapIndex, VkDeviceSize bytes);
+
+    // 增量碎片整理
+    void BeginDefragmentation();
+    bool IsDefragmenting() const { return defragContext != VK_NULL_HANDLE; }
+    void SetDefragmentationLimits(VkDeviceSize bytesPerPass, uint32_t allocationsPerPass);
+    // 显存堆的碎片率超过阈值且空闲字节不少于一轮的移动量时自动开始整理，0表示不自动整理
+    void SetDefragmentationThreshold(float threshold) { defragThreshold = threshold; }
+
+    // 统计导出（也可由VGE_MEMORY_STATS=路径与VGE_MEMORY_STATS_INTERVAL=帧数启用，间隔默认60帧）
+    const MemoryStatistics& GetStatistics() const { return statistics; }
+    std::string ExportStatisticsJson();
+    bool WriteStatisticsJson(const std::string& path);
+    void SetStatisticsExport(const std::string& path, uint32_t intervalFrames);
+    void SetPressureThreshold(float threshold) { pressureThreshold = threshold; }
+
+private:
+    VulkanContext* context;
+
+    MemoryStatistics statistics;
+    std::vector<VkMemoryPropertyFlags> heapFlags;
+    std::vector<uint32_t> typeToHeap;
+    float pressureThreshold = 0.9f;
+    float evictionTarget = 0.8f;
+
+    struct EvictionHandler {
+        uint32_t handle;
+        EvictionCallback callback;
+    };
+    std::vector<EvictionHandler> evictionHandlers;
+    uint32_t nextEvictionHandle = 1;
+    // 保护各堆的预算、用量与待释放字节以及驱逐回调表
+    mutable std::mutex budgetMutex;
+
+    // 碎片整理状态
+    VmaDefragmentationContext defragContext = VK_NULL_HANDLE;
+    VmaDefragmentationPassMoveInfo defragPass{};
+    std::vector<MovableResource*> pendingMoves;
+    VkCommandPool defragCommandPool = VK_NULL_HANDLE;
+    VkCommandBuffer defragCommandBuffer = VK_NULL_HANDLE;
+    VkFence defragFence = VK_NULL_HANDLE;
+    bool defragPassActive = false;
+    bool defragCommitted = false;
+    uint32_t defragReleaseCountdown = 0;
+    VkDeviceSize defragBytesPerPass = 16ull * 1024 * 1024;
+    uint32_t defragAllocationsPerPass = 64;
+    float defragThreshold = 0.5f;
+
+    // 统计导出
+    std::string exportPath;
+    uint32_t exportInterval = 0;
+    uint32_t detailedStatsInterval = 60;
+
+    void UpdateBudgets();
+    void UpdateDetailedStatistics();
+    void HandleMemoryPressure();
+    VkResult HandleOutOfBudget(uint32_t heapIndex, VkDeviceSize size);
+    VkDeviceSize EvictLocked(uint32_t heapIndex, VkDeviceSize bytesToFree);
+    bool ShouldDefragment() const;
+    void StepDefragmentation();
+    void FinishDefragmentation();
+    bool CreateDefragResources();
+};
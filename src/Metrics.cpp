@@ -0,0 +1,175 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    const char* COUNTER_NAMES[Metrics::COUNTER_COUNT] = {
+        "draw_calls",
+        "pipeline_binds",
+        "descriptor_binds",
+        "barriers",
+        "bytes_uploaded",
+        "allocations",
+        "command_buffer_submits",
+        "host_allocations",
+        "pipeline_latency_us"
+    };
+
+    uint32_t BucketOf(uint64_t value) {
+        uint32_t bucket = 0;
+        while (value != 0) {
+            bucket++;
+            value >>= 1;
+        }
+        return bucket;
+    }
+
+    uint64_t BucketUpperBound(uint32_t bucket) {
+        if (bucket == 0) return 0;
+        if (bucket >= 64) return UINT64_MAX;
+        return (1ull << bucket) - 1;
+    }
+}
+
+const char* Metrics::GetCounterName(Counter counter) {
+    return counter < COUNTER_COUNT ? COUNTER_NAMES[counter] : "unknown";
+}
+
+uint64_t Metrics::CounterStats::GetPercentile(double percentile) const {
+    if (frames == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(frames) + 0.5);
+    target = std::max<uint64_t>(1, std::min(target, frames));
+    uint64_t accumulated = 0;
+    for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        accumulated += histogram[bucket];
+        if (accumulated >= target) {
+            return std::min(BucketUpperBound(bucket), max);
+        }
+    }
+    return max;
+}
+
+void Metrics::EndFrame(uint64_t frameIndex) {
+    if (!outputPath.empty()) {
+        pendingRows.push_back(frameIndex);
+    }
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++) {
+        uint64_t value = current[i].exchange(0, std::memory_order_relaxed);
+        lastFrame[i] = value;
+
+        CounterStats& counterStats = stats[i];
+        counterStats.min = counterStats.frames == 0 ? value : std::min(counterStats.min, value);
+        counterStats.max = std::max(counterStats.max, value);
+        counterStats.total += value;
+        counterStats.frames++;
+        counterStats.histogram[BucketOf(value)]++;
+
+        if (!outputPath.empty()) {
+            pendingRows.push_back(value);
+        }
+    }
+
+    if (outputInterval > 0 && ++framesSinceFlush >= outputInterval) {
+        Flush();
+    }
+}
+
+void Metrics::ResetStatistics() {
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++) {
+        stats[i] = CounterStats{};
+        lastFrame[i] = 0;
+    }
+}
+
+void Metrics::SetOutput(const std::string& basePath, uint32_t intervalFrames) {
+    outputPath = basePath;
+    csvPath = basePath + ".csv";
+    jsonPath = basePath + ".json";
+    outputInterval = intervalFrames;
+    framesSinceFlush = 0;
+    csvStarted = false;
+    pendingRows.clear();
+    if (intervalFrames > 0) {
+        pendingRows.reserve(static_cast<size_t>(intervalFrames) * (COUNTER_COUNT + 1));
+    }
+}
+
+bool Metrics::Flush() {
+    if (outputPath.empty()) return true;
+    framesSinceFlush = 0;
+    bool success = WriteCsv();
+    return WriteJson() && success;
+}
+
+bool Metrics::WriteCsv() {
+    // 第一次写出时截断文件并写表头，之后只追加新帧
+    FILE* file = std::fopen(csvPath.c_str(), csvStarted ? "a" : "w");
+    if (file == nullptr) {
+        std::cerr << "failed to open metrics file: " << csvPath << std::endl;
+        return false;
+    }
+    if (!csvStarted) {
+        std::fprintf(file, "frame");
+        for (uint32_t i = 0; i < COUNTER_COUNT; i++) {
+            std::fprintf(file, ",%s", COUNTER_NAMES[i]);
+        }
+        std::fprintf(file, "\n");
+        csvStarted = true;
+    }
+
+    const size_t rowSize = COUNTER_COUNT + 1;
+    for (size_t row = 0; row + rowSize <= pendingRows.size(); row += rowSize) {
+        std::fprintf(file, "%llu", static_cast<unsigned long long>(pendingRows[row]));
+        for (size_t i = 1; i < rowSize; i++) {
+            std::fprintf(file, ",%llu", static_cast<unsigned long long>(pendingRows[row + i]));
+        }
+        std::fprintf(file, "\n");
+    }
+    pendingRows.clear();
+
+    bool success = std::ferror(file) == 0;
+    std::fclose(file);
+    return success;
+}
+
+bool Metrics::WriteJson() const {
+    // 统计覆盖自上次ResetStatistics以来的所有帧，每次整体重写
+    FILE* file = std::fopen(jsonPath.c_str(), "w");
+    if (file == nullptr) {
+        std::cerr << "failed to open metrics file: " << jsonPath << std::endl;
+        return false;
+    }
+
+    std::fprintf(file, "{\n");
+    for (uint32_t i = 0; i < COUNTER_COUNT; i++) {
+        const CounterStats& counterStats = stats[i];
+        std::fprintf(file, "  \"%s\": {\"frames\": %llu, \"min\": %llu, \"max\": %llu, \"mean\": %.3f, "
+                           "\"p50\": %llu, \"p95\": %llu, \"p99\": %llu, \"last\": %llu, \"histogram\": [",
+                     COUNTER_NAMES[i],
+                     static_cast<unsigned long long>(counterStats.frames),
+                     static_cast<unsigned long long>(counterStats.min),
+                     static_cast<unsigned long long>(counterStats.max),
+                     counterStats.GetMean(),
+                     static_cast<unsigned long long>(counterStats.GetPercentile(50.0)),
+                     static_cast<unsigned long long>(counterStats.GetPercentile(95.0)),
+                     static_cast<unsigned long long>(counterStats.GetPercentile(99.0)),
+                     static_cast<unsigned long long>(lastFrame[i]));
+
+        // 只写非空桶：[上界, 帧数]
+        bool first = true;
+        for (uint32_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            if (counterStats.histogram[bucket] == 0) continue;
+            std::fprintf(file, "%s[%llu, %llu]", first ? "" : ", ",
+                         static_cast<unsigned long long>(BucketUpperBound(bucket)),
+                         static_cast<unsigned long long>(counterStats.histogram[bucket]));
+            first = false;
+        }
+        std::fprintf(file, "]}%s\n", i + 1 < COUNTER_COUNT ? "," : "");
+    }
+    std::fprintf(file, "}\n");
+
+    bool success = std::ferror(file) == 0;
+    std::fclose(file);
+    return success;
+}
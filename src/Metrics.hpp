@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 每帧引擎计数器：命令录制和资源路径调用Add累加，EndFrame时汇入统计与直方图
+// 可每N帧及退出时写出CSV（逐帧数值）和JSON（统计与直方图），测试可通过查询接口断言上限
+class Metrics {
+public:
+    enum Counter : uint32_t {
+        DRAW_CALLS = 0,
+        PIPELINE_BINDS,
+        DESCRIPTOR_BINDS,
+        BARRIERS,
+        BYTES_UPLOADED,
+        ALLOCATIONS,
+        COMMAND_BUFFER_SUBMITS,
+        HOST_ALLOCATIONS,
+        PIPELINE_LATENCY_US,
+        COUNTER_COUNT
+    };
+
+    // 桶0为0，桶i（i>=1）为[2^(i-1), 2^i)
+    static const uint32_t HISTOGRAM_BUCKETS = 65;
+
+    struct CounterStats {
+        uint64_t frames = 0;
+        uint64_t total = 0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        uint64_t histogram[HISTOGRAM_BUCKETS] = {};
+
+        double GetMean() const { return frames > 0 ? static_cast<double>(total) / static_cast<double>(frames) : 0.0; }
+        // 按直方图估计的百分位（返回所在桶的上界，偏保守）
+        uint64_t GetPercentile(double percentile) const;
+    };
+
+    static const char* GetCounterName(Counter counter);
+
+    // 任意线程可调用
+    void Add(Counter counter, uint64_t value = 1) { current[counter].fetch_add(value, std::memory_order_relaxed); }
+
+    // 每帧结束时调用一次：汇总本帧数值并清零，需要时写出
+    void EndFrame(uint64_t frameIndex);
+
+    // 查询接口
+    uint64_t GetCurrent(Counter counter) const { return current[counter].load(std::memory_order_relaxed); }
+    uint64_t GetLastFrame(Counter counter) const { return lastFrame[counter]; }
+    const CounterStats& GetStats(Counter counter) const { return stats[counter]; }
+    bool IsWithinLimit(Counter counter, uint64_t maxPerFrame) const { return stats[counter].max <= maxPerFrame; }
+    void ResetStatistics();
+
+    // 输出到<basePath>.csv和<basePath>.json，每intervalFrames帧写出一次（0表示只在Flush时写出）
+    void SetOutput(const std::string& basePath, uint32_t intervalFrames);
+    bool Flush();
+
+private:
+    bool WriteCsv();
+    bool WriteJson() const;
+
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> current{};
+    uint64_t lastFrame[COUNTER_COUNT] = {};
+    CounterStats stats[COUNTER_COUNT];
+
+    // 尚未写入CSV的帧：帧号 + 各计数器（按写出间隔预留，帧内不扩容）
+    std::vector<uint64_t> pendingRows;
+    std::string outputPath;
+    std::string csvPath;
+    std::string jsonPath;
+    uint32_t outputInterval = 0;
+    uint32_t framesSinceFlush = 0;
+    bool csvStarted = false;
+};
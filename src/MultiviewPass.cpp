@@ -0,0 +1,576 @@
+#include "MultiviewPass.hpp"
+#include "VulkanContext.hpp"
+#include "VulkanUtils.hpp"
+#include "MemoryManager.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    const char* const DEPTH_SHADER_PATH = "shaders/multiview_depth.vert.spv";
+
+    float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 Cross(const Vec3& a, const Vec3& b) {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+    Vec3 Normalize(const Vec3& v) {
+        float length = std::sqrt(Dot(v, v));
+        return length > 0.0f ? Vec3{v.x / length, v.y / length, v.z / length} : v;
+    }
+
+    // 右手坐标系观察矩阵
+    Mat4 LookAt(const Vec3& eye, const Vec3& forward, const Vec3& up) {
+        Vec3 f = Normalize(forward);
+        Vec3 s = Normalize(Cross(f, up));
+        Vec3 u = Cross(s, f);
+
+        Mat4 result = Mat4::Identity();
+        result.m[0] = s.x;  result.m[4] = s.y;  result.m[8] = s.z;
+        result.m[1] = u.x;  result.m[5] = u.y;  result.m[9] = u.z;
+        result.m[2] = -f.x; result.m[6] = -f.y; result.m[10] = -f.z;
+        result.m[12] = -Dot(s, eye);
+        result.m[13] = -Dot(u, eye);
+        result.m[14] = Dot(f, eye);
+        return result;
+    }
+
+    // 深度范围[0, 1]的透视投影；y不翻转，与Vulkan帧缓冲的行序组合后恰好符合立方体贴图的面朝向
+    Mat4 Perspective(float verticalFov, float aspect, float nearPlane, float farPlane) {
+        float f = 1.0f / std::tan(verticalFov * 0.5f);
+        Mat4 result;
+        std::memset(result.m, 0, sizeof(result.m));
+        result.m[0] = f / aspect;
+        result.m[5] = f;
+        result.m[10] = farPlane / (nearPlane - farPlane);
+        result.m[11] = -1.0f;
+        result.m[14] = nearPlane * farPlane / (nearPlane - farPlane);
+        return result;
+    }
+}
+
+MultiviewPass::MultiviewPass(VulkanContext* context) : context(context) {}
+
+MultiviewPass::~MultiviewPass() {
+    Cleanup();
+}
+
+bool MultiviewPass::Initialize(const Settings& newSettings) {
+    settings = newSettings;
+
+    if (!context->GetCapabilities().multiview) {
+        std::cerr << "Multiview rendering not supported by the device" << std::endl;
+        return false;
+    }
+    if (settings.viewCount == 0 || settings.viewCount > MAX_VIEWS) {
+        std::cerr << "Multiview view count must be 1.." << MAX_VIEWS << std::endl;
+        return false;
+    }
+    if (settings.cubeCompatible && (settings.viewCount != 6 || settings.extent.width != settings.extent.height)) {
+        std::cerr << "Cube multiview pass needs 6 views and a square extent" << std::endl;
+        return false;
+    }
+
+    if (!CreateTargets()) return false;
+    if (!CreateRenderPass()) return false;
+    if (!CreateViewResources()) return false;
+    if (settings.colorFormat == VK_FORMAT_UNDEFINED && !CreateDepthPipeline()) return false;
+    return true;
+}
+
+void MultiviewPass::Cleanup() {
+    VkDevice device = context->GetDevice();
+    VmaAllocator allocator = context->GetAllocator();
+
+    if (depthPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, depthPipeline, context->GetAllocationCallbacks());
+        depthPipeline = VK_NULL_HANDLE;
+    }
+    if (depthLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, depthLayout, context->GetAllocationCallbacks());
+        depthLayout = VK_NULL_HANDLE;
+    }
+    for (auto& frame : frames) {
+        if (frame.viewBuffer != VK_NULL_HANDLE) {
+            vmaDestroyBuffer(allocator, frame.viewBuffer, frame.viewAllocation);
+        }
+    }
+    frames.clear();
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, context->GetAllocationCallbacks());
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    if (viewSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, viewSetLayout, context->GetAllocationCallbacks());
+        viewSetLayout = VK_NULL_HANDLE;
+    }
+    if (framebuffer != VK_NULL_HANDLE) {
+        vkDestroyFramebuffer(device, framebuffer, context->GetAllocationCallbacks());
+        framebuffer = VK_NULL_HANDLE;
+    }
+    if (renderPass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(device, renderPass, context->GetAllocationCallbacks());
+        renderPass = VK_NULL_HANDLE;
+    }
+
+    VkImageView views[] = {colorView, colorSampleView, depthView, depthSampleView};
+    for (VkImageView view : views) {
+        if (view != VK_NULL_HANDLE) vkDestroyImageView(device, view, context->GetAllocationCallbacks());
+    }
+    colorView = colorSampleView = depthView = depthSampleView = VK_NULL_HANDLE;
+    if (colorImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(allocator, colorImage, colorAllocation);
+        colorImage = VK_NULL_HANDLE;
+    }
+    if (depthImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(allocator, depthImage, depthAllocation);
+        depthImage = VK_NULL_HANDLE;
+    }
+}
+
+VkImageView MultiviewPass::CreateView(VkImage image, VkFormat format, VkImageAspectFlags aspect, VkImageViewType viewType) {
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = viewType;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspect;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = settings.viewCount;
+
+    VkImageView view;
+    if (vkCreateImageView(context->GetDevice(), &viewInfo, context->GetAllocationCallbacks(), &view) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create multiview image view!");
+    }
+    return view;
+}
+
+bool MultiviewPass::CreateTargets() {
+    // 每个视图一层；渲染用2D数组视图，采样时立方体兼容的目标用立方体视图
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.flags = settings.cubeCompatible ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = {settings.extent.width, settings.extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = settings.viewCount;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    VkImageViewType sampleViewType = settings.cubeCompatible ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    MemoryManager* memoryManager = context->GetMemoryManager();
+
+    if (settings.colorFormat != VK_FORMAT_UNDEFINED) {
+        imageInfo.format = settings.colorFormat;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (memoryManager->CreateImage(imageInfo, allocInfo, &colorImage, &colorAllocation) != VK_SUCCESS) {
+            std::cerr << "Failed to create multiview color target" << std::endl;
+            return false;
+        }
+        colorView = CreateView(colorImage, settings.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+        colorSampleView = CreateView(colorImage, settings.colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, sampleViewType);
+    }
+
+    imageInfo.format = settings.depthFormat;
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (memoryManager->CreateImage(imageInfo, allocInfo, &depthImage, &depthAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create multiview depth target" << std::endl;
+        return false;
+    }
+    depthView = CreateView(depthImage, settings.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+    depthSampleView = CreateView(depthImage, settings.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, sampleViewType);
+    return true;
+}
+
+bool MultiviewPass::CreateRenderPass() {
+    bool hasColor = settings.colorFormat != VK_FORMAT_UNDEFINED;
+
+    // 渲染后两个附件都转为只读布局供后续着色器采样（阴影贴图或立体合成）
+    VkAttachmentDescription attachments[2]{};
+    uint32_t attachmentCount = 0;
+
+    VkAttachmentReference colorAttachmentRef{};
+    if (hasColor) {
+        VkAttachmentDescription& colorAttachment = attachments[attachmentCount];
+        colorAttachment.format = settings.colorFormat;
+        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        colorAttachmentRef.attachment = attachmentCount++;
+        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    VkAttachmentDescription& depthAttachment = attachments[attachmentCount];
+    depthAttachment.format = settings.depthFormat;
+    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = attachmentCount++;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = hasColor ? 1 : 0;
+    subpass.pColorAttachments = hasColor ? &colorAttachmentRef : nullptr;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    VkSubpassDependency dependencies[2]{};
+    // 进入：上一帧对目标的采样完成后才能覆盖
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[0].srcAccessMask = 0;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    // 离开：附件写入对后续片段着色器采样可见
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    // 每个子通道的viewMask选中附件的前N层；立体视图空间相关，提示实现可以共享可见性计算
+    uint32_t viewMask = (1u << settings.viewCount) - 1;
+    VkRenderPassMultiviewCreateInfo multiviewInfo{};
+    multiviewInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+    multiviewInfo.subpassCount = 1;
+    multiviewInfo.pViewMasks = &viewMask;
+    multiviewInfo.correlationMaskCount = settings.cubeCompatible ? 0 : 1;
+    multiviewInfo.pCorrelationMasks = settings.cubeCompatible ? nullptr : &viewMask;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.pNext = &multiviewInfo;
+    renderPassInfo.attachmentCount = attachmentCount;
+    renderPassInfo.pAttachments = attachments;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 2;
+    renderPassInfo.pDependencies = dependencies;
+
+    if (vkCreateRenderPass(context->GetDevice(), &renderPassInfo, context->GetAllocationCallbacks(), &renderPass) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create multiview render pass!");
+    }
+
+    // 多视图帧缓冲的layers必须为1，视图由viewMask选择
+    VkImageView framebufferViews[2];
+    uint32_t viewCount = 0;
+    if (hasColor) framebufferViews[viewCount++] = colorView;
+    framebufferViews[viewCount++] = depthView;
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = renderPass;
+    framebufferInfo.attachmentCount = viewCount;
+    framebufferInfo.pAttachments = framebufferViews;
+    framebufferInfo.width = settings.extent.width;
+    framebufferInfo.height = settings.extent.height;
+    framebufferInfo.layers = 1;
+
+    if (vkCreateFramebuffer(context->GetDevice(), &framebufferInfo, context->GetAllocationCallbacks(), &framebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create multiview framebuffer!");
+    }
+    return true;
+}
+
+bool MultiviewPass::CreateViewResources() {
+    VkDevice device = context->GetDevice();
+    const uint32_t frameCount = VulkanContext::MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, context->GetAllocationCallbacks(), &viewSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create multiview descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frameCount};
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = frameCount;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(device, &poolInfo, context->GetAllocationCallbacks(), &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create multiview descriptor pool!");
+    }
+
+    // 视图矩阵每帧由CPU写入，按飞行帧各一份
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(ViewData);
+    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo hostInfo{};
+    hostInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    hostInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    frames.resize(frameCount);
+    for (auto& frame : frames) {
+        VmaAllocationInfo allocationInfo{};
+        if (context->GetMemoryManager()->CreateBuffer(bufferInfo, hostInfo, &frame.viewBuffer, &frame.viewAllocation, &allocationInfo) != VK_SUCCESS) {
+            std::cerr << "Failed to create multiview uniform buffer" << std::endl;
+            return false;
+        }
+        frame.views = static_cast<ViewData*>(allocationInfo.pMappedData);
+        std::memset(frame.views, 0, sizeof(ViewData));
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &viewSetLayout;
+        if (vkAllocateDescriptorSets(device, &allocInfo, &frame.viewSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate multiview descriptor set!");
+        }
+
+        VkDescriptorBufferInfo descriptorBuffer = {frame.viewBuffer, 0, sizeof(ViewData)};
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = frame.viewSet;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        write.pBufferInfo = &descriptorBuffer;
+        vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    }
+    return true;
+}
+
+bool MultiviewPass::CreateDepthPipeline() {
+    VkDevice device = context->GetDevice();
+
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(ObjectConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &viewSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, context->GetAllocationCallbacks(), &depthLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create multiview depth pipeline layout!");
+    }
+
+    VkShaderModule vertShaderModule = VulkanUtils::CreateShaderModule(device, context->LoadShaderCode(DEPTH_SHADER_PATH),
+                                                                      context->GetAllocationCallbacks());
+
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module = vertShaderModule;
+    vertShaderStageInfo.pName = "main";
+
+    // 几何池顶点：只读取量化位置
+    VkVertexInputBindingDescription bindingDescription = CookedVertexLayout::GetBindingDescription();
+    VkVertexInputAttributeDescription positionAttribute = CookedVertexLayout::GetAttributeDescription<VERTEX_SEMANTIC_POSITION>();
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = 1;
+    vertexInputInfo.pVertexAttributeDescriptions = &positionAttribute;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    // 阴影投射体不做背面剔除，用深度偏移抑制自阴影条纹
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_TRUE;
+    rasterizer.depthBiasConstantFactor = 1.25f;
+    rasterizer.depthBiasSlopeFactor = 1.75f;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.attachmentCount = 0;
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 1;
+    pipelineInfo.pStages = &vertShaderStageInfo;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = depthLayout;
+    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.subpass = 0;
+
+    VkResult result = vkCreateGraphicsPipelines(device, context->GetPipelineCache(), 1, &pipelineInfo, context->GetAllocationCallbacks(), &depthPipeline);
+    vkDestroyShaderModule(device, vertShaderModule, context->GetAllocationCallbacks());
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create multiview depth pipeline!");
+    }
+    return true;
+}
+
+VkDescriptorSet MultiviewPass::GetViewSet() const {
+    return frames.empty() ? VK_NULL_HANDLE : frames[context->GetCurrentFrame()].viewSet;
+}
+
+void MultiviewPass::SetViews(const Mat4* viewProjections, const Vec3* positions, uint32_t count) {
+    if (frames.empty()) return;
+    ViewData* views = frames[context->GetCurrentFrame()].views;
+    count = std::min(count, settings.viewCount);
+    for (uint32_t i = 0; i < count; i++) {
+        std::memcpy(views->viewProjection[i], viewProjections[i].m, sizeof(viewProjections[i].m));
+        if (positions != nullptr) {
+            views->viewPosition[i][0] = positions[i].x;
+            views->viewPosition[i][1] = positions[i].y;
+            views->viewPosition[i][2] = positions[i].z;
+            views->viewPosition[i][3] = 1.0f;
+        }
+    }
+    views->viewCount = count;
+}
+
+void MultiviewPass::Begin(VkCommandBuffer commandBuffer) {
+    VkClearValue clearValues[2]{};
+    uint32_t clearCount = 0;
+    if (settings.colorFormat != VK_FORMAT_UNDEFINED) {
+        clearValues[clearCount++].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    }
+    clearValues[clearCount++].depthStencil = {1.0f, 0};
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = renderPass;
+    renderPassInfo.framebuffer = framebuffer;
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = settings.extent;
+    renderPassInfo.clearValueCount = clearCount;
+    renderPassInfo.pClearValues = clearValues;
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    // 视口和裁剪对所有视图相同
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(settings.extent.width);
+    viewport.height = static_cast<float>(settings.extent.height);
+    viewport.maxDepth = 1.0f;
+    VkRect2D scissor = {{0, 0}, settings.extent};
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void MultiviewPass::End(VkCommandBuffer commandBuffer) {
+    vkCmdEndRenderPass(commandBuffer);
+}
+
+void MultiviewPass::BindDepthPipeline(VkCommandBuffer commandBuffer) {
+    VkDescriptorSet viewSet = GetViewSet();
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthLayout, 0, 1, &viewSet, 0, nullptr);
+    context->GetGeometryPool()->Bind(commandBuffer);
+    context->GetMetrics()->Add(Metrics::PIPELINE_BINDS);
+    context->GetMetrics()->Add(Metrics::DESCRIPTOR_BINDS);
+}
+
+void MultiviewPass::DrawMesh(VkCommandBuffer commandBuffer, MeshHandle mesh, uint32_t lod, const Mat4& model) {
+    const GeometryPool* geometryPool = context->GetGeometryPool();
+    if (mesh >= geometryPool->GetMeshCount() || !geometryPool->IsReady(mesh)) return;
+    const MeshInfo& info = geometryPool->GetMesh(mesh);
+    if (info.lodCount == 0) return;
+    const MeshLod& meshLod = info.lods[std::min(lod, info.lodCount - 1)];
+
+    ObjectConstants constants{};
+    std::memcpy(constants.model, model.m, sizeof(constants.model));
+    std::memcpy(constants.positionOffset, info.dequantization.positionOffset, sizeof(info.dequantization.positionOffset));
+    std::memcpy(constants.positionScale, info.dequantization.positionScale, sizeof(info.dequantization.positionScale));
+    vkCmdPushConstants(commandBuffer, depthLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+
+    // 一次绘制覆盖全部视图
+    vkCmdDrawIndexed(commandBuffer, meshLod.indexCount, 1, meshLod.firstIndex, info.vertexOffset, 0);
+    context->GetMetrics()->Add(Metrics::DRAW_CALLS);
+}
+
+void MultiviewPass::ComputeCubeViews(const Vec3& position, float nearPlane, float farPlane, Mat4 viewProjections[6]) {
+    // 立方体贴图各面的朝向与上方向
+    static const Vec3 FORWARD[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    static const Vec3 UP[6] = {{0, -1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}, {0, -1, 0}, {0, -1, 0}};
+
+    Mat4 projection = Perspective(1.5707964f, 1.0f, nearPlane, farPlane);
+    for (uint32_t face = 0; face < 6; face++) {
+        MultiplyMat4(projection, LookAt(position, FORWARD[face], UP[face]), viewProjections[face]);
+    }
+}
+
+void MultiviewPass::ComputeStereoViews(const Mat4& centerView, const Mat4& projection, float interpupillaryDistance,
+                                       Mat4 viewProjections[2]) {
+    // 左眼在中心左侧，场景在其视图空间中向右平移
+    for (uint32_t eye = 0; eye < 2; eye++) {
+        Mat4 view = centerView;
+        view.m[12] += (eye == 0 ? 0.5f : -0.5f) * interpupillaryDistance;
+        MultiplyMat4(projection, view, viewProjections[eye]);
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <cstdint>
+#include <vector>
+#include "GeometryPool.hpp"
+#include "MathTypes.hpp"
+#include "vk_mem_alloc.h"
+
+class VulkanContext;
+
+// 单遍多视图渲染（VK_KHR_multiview，1.1核心）：渲染通道的viewMask覆盖分层附件的N层，
+// 场景只录制一次，驱动把每个绘制广播到所有视图，着色器用gl_ViewIndex索引视图矩阵
+// 典型用法：双目立体输出（2视图，颜色+深度）和点光源立方体阴影（6视图，仅深度，立方体兼容）
+// 仅深度时提供内置管线（shaders/multiview_depth.vert）直接绘制几何池网格；
+// 其他管线用GetRenderPass()创建，并把GetViewSetLayout()作为set 0
+class MultiviewPass {
+public:
+    // maxMultiviewViewCount保证的最小值
+    static const uint32_t MAX_VIEWS = 6;
+
+    struct Settings {
+        uint32_t viewCount = 2;
+        VkExtent2D extent = {1024, 1024};
+        VkFormat colorFormat = VK_FORMAT_UNDEFINED;     // UNDEFINED为仅深度
+        VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+        bool cubeCompatible = false;                    // 6个视图对应立方体贴图的+X,-X,+Y,-Y,+Z,-Z面
+    };
+
+    // 与着色器中的Views一致（std140）
+    struct ViewData {
+        float viewProjection[MAX_VIEWS][16];
+        float viewPosition[MAX_VIEWS][4];
+        uint32_t viewCount;
+        uint32_t padding[3];
+    };
+    static_assert(sizeof(ViewData) == 496, "ViewData layout mismatch");
+
+    // 与内置深度管线的推送常量一致
+    struct ObjectConstants {
+        float model[16];
+        float positionOffset[4];    // MeshInfo::dequantization
+        float positionScale[4];
+    };
+    static_assert(sizeof(ObjectConstants) == 96, "ObjectConstants layout mismatch");
+
+    MultiviewPass(VulkanContext* context);
+    ~MultiviewPass();
+
+    bool Initialize(const Settings& settings);
+    void Cleanup();
+
+    // 写入当前帧的视图数据，positions可为nullptr
+    void SetViews(const Mat4* viewProjections, const Vec3* positions, uint32_t count);
+
+    // 开始/结束渲染通道；结束后颜色和深度处于着色器只读布局，可直接采样
+    void Begin(VkCommandBuffer commandBuffer);
+    void End(VkCommandBuffer commandBuffer);
+
+    // 内置仅深度管线：绑定管线、视图描述符集和几何池缓冲后逐网格绘制
+    void BindDepthPipeline(VkCommandBuffer commandBuffer);
+    void DrawMesh(VkCommandBuffer commandBuffer, MeshHandle mesh, uint32_t lod, const Mat4& model);
+
+    VkRenderPass GetRenderPass() const { return renderPass; }
+    VkDescriptorSetLayout GetViewSetLayout() const { return viewSetLayout; }
+    VkDescriptorSet GetViewSet() const;
+    VkImageView GetColorView() const { return colorSampleView; }
+    VkImageView GetDepthView() const { return depthSampleView; }
+    uint32_t GetViewCount() const { return settings.viewCount; }
+    VkExtent2D GetExtent() const { return settings.extent; }
+
+    // 立方体6个面的视图投影矩阵（90度视场），顺序与立方体贴图层一致
+    static void ComputeCubeViews(const Vec3& position, float nearPlane, float farPlane, Mat4 viewProjections[6]);
+    // 由中心视图沿视图空间x轴各偏移半个瞳距得到左右眼的视图投影矩阵
+    static void ComputeStereoViews(const Mat4& centerView, const Mat4& projection, float interpupillaryDistance,
+                                   Mat4 viewProjections[2]);
+
+private:
+    struct FrameResources {
+        VkBuffer viewBuffer = VK_NULL_HANDLE;
+        VmaAllocation viewAllocation = VK_NULL_HANDLE;
+        ViewData* views = nullptr;
+        VkDescriptorSet viewSet = VK_NULL_HANDLE;
+    };
+
+    bool CreateTargets();
+    bool CreateRenderPass();
+    bool CreateViewResources();
+    bool CreateDepthPipeline();
+    VkImageView CreateView(VkImage image, VkFormat format, VkImageAspectFlags aspect, VkImageViewType viewType);
+
+    VulkanContext* context;
+    Settings settings;
+
+    VkImage colorImage = VK_NULL_HANDLE;
+    VmaAllocation colorAllocation = VK_NULL_HANDLE;
+    VkImageView colorView = VK_NULL_HANDLE;             // 渲染用2D数组视图
+    VkImageView colorSampleView = VK_NULL_HANDLE;       // 采样用（立方体兼容时为立方体视图）
+    VkImage depthImage = VK_NULL_HANDLE;
+    VmaAllocation depthAllocation = VK_NULL_HANDLE;
+    VkImageView depthView = VK_NULL_HANDLE;
+    VkImageView depthSampleView = VK_NULL_HANDLE;
+
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout viewSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    std::vector<FrameResources> frames;
+
+    VkPipelineLayout depthLayout = VK_NULL_HANDLE;
+    VkPipeline depthPipeline = VK_NULL_HANDLE;
+};
@@ -0,0 +1,731 @@
+#include "OcclusionCuller.hpp"
+#include "VulkanContext.hpp"
+#include "VulkanUtils.hpp"
+#include "MemoryManager.hpp"
+#include "Swapchain.hpp"
+#include "GeometryPool.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    const char* const REDUCE_SHADER_PATH = "shaders/hiz_reduce.comp.spv";
+    const char* const CULL_SHADER_PATH = "shaders/hiz_cull.comp.spv";
+
+    struct ReduceParams {
+        uint32_t sourceWidth;
+        uint32_t sourceHeight;
+        uint32_t destinationWidth;
+        uint32_t destinationHeight;
+    };
+
+    void GlobalBarrier(Metrics* metrics, VkCommandBuffer commandBuffer,
+                       VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                       VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        metrics->Add(Metrics::BARRIERS);
+    }
+}
+
+std::vector<const char*> OcclusionCuller::GetShaderPaths() {
+    return {REDUCE_SHADER_PATH, CULL_SHADER_PATH};
+}
+
+OcclusionCuller::OcclusionCuller(VulkanContext* context) : context(context) {}
+
+OcclusionCuller::~OcclusionCuller() {
+    Cleanup();
+}
+
+bool OcclusionCuller::Initialize() {
+    const VkPhysicalDeviceFeatures& features = context->GetEnabledFeatures();
+    if (!features.drawIndirectFirstInstance) {
+        // 绘制着色器通过firstInstance索引实例数据
+        std::cerr << "Occlusion culling disabled: drawIndirectFirstInstance not supported" << std::endl;
+        return true;
+    }
+    multiDrawIndirect = features.multiDrawIndirect == VK_TRUE;
+    if (multiDrawIndirect && context->IsDrawIndirectCountSupported()) {
+        drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(context->GetDevice(), "vkCmdDrawIndexedIndirectCountKHR"));
+    }
+
+    if (!CreateSampler()) return false;
+    if (!CreatePipelines()) return false;
+    if (!CreateDescriptorPool()) return false;
+    if (!EnsureCapacity(1)) return false;
+
+    supported = true;
+    return true;
+}
+
+bool OcclusionCuller::CreateDepthResources() {
+    if (!supported) return true;
+    if (!CreatePyramid()) return false;
+    UpdateCullDescriptors();
+    return true;
+}
+
+void OcclusionCuller::Cleanup() {
+    VkDevice device = context->GetDevice();
+
+    DestroyPyramid();
+    DestroyBuffers();
+    frames.clear();
+    reduceSets.clear();
+
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, context->GetAllocationCallbacks());
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    if (reducePipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, reducePipeline, context->GetAllocationCallbacks());
+        reducePipeline = VK_NULL_HANDLE;
+    }
+    if (cullPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, cullPipeline, context->GetAllocationCallbacks());
+        cullPipeline = VK_NULL_HANDLE;
+    }
+    if (reduceLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, reduceLayout, context->GetAllocationCallbacks());
+        reduceLayout = VK_NULL_HANDLE;
+    }
+    if (cullLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, cullLayout, context->GetAllocationCallbacks());
+        cullLayout = VK_NULL_HANDLE;
+    }
+    if (reduceSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, reduceSetLayout, context->GetAllocationCallbacks());
+        reduceSetLayout = VK_NULL_HANDLE;
+    }
+    if (cullSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, cullSetLayout, context->GetAllocationCallbacks());
+        cullSetLayout = VK_NULL_HANDLE;
+    }
+    if (pointSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, pointSampler, context->GetAllocationCallbacks());
+        pointSampler = VK_NULL_HANDLE;
+    }
+    supported = false;
+}
+
+bool OcclusionCuller::CreateSampler() {
+    // 只通过texelFetch读取，过滤方式无关
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(context->GetDevice(), &samplerInfo, context->GetAllocationCallbacks(), &pointSampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create depth pyramid sampler!");
+    }
+    return true;
+}
+
+VkPipeline OcclusionCuller::CreateComputePipeline(const char* path, VkPipelineLayout layout) {
+    VkShaderModule shaderModule = VulkanUtils::CreateShaderModule(context->GetDevice(), context->LoadShaderCode(path), context->GetAllocationCallbacks());
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = layout;
+
+    VkPipeline pipeline;
+    VkResult result = vkCreateComputePipelines(context->GetDevice(), context->GetPipelineCache(), 1, &pipelineInfo, context->GetAllocationCallbacks(), &pipeline);
+    vkDestroyShaderModule(context->GetDevice(), shaderModule, context->GetAllocationCallbacks());
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+    return pipeline;
+}
+
+bool OcclusionCuller::CreatePipelines() {
+    VkDevice device = context->GetDevice();
+
+    // 下采样：源（深度或上一级）+ 目标存储图像
+    VkDescriptorSetLayoutBinding reduceBindings[2]{};
+    reduceBindings[0].binding = 0;
+    reduceBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    reduceBindings[0].descriptorCount = 1;
+    reduceBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    reduceBindings[1].binding = 1;
+    reduceBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    reduceBindings[1].descriptorCount = 1;
+    reduceBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = reduceBindings;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, context->GetAllocationCallbacks(), &reduceSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create depth reduce descriptor set layout!");
+    }
+
+    // 剔除：参数、实例、可见性、绘制命令、绘制数量、Hi-Z、几何池LOD表、LOD状态
+    VkDescriptorSetLayoutBinding cullBindings[8]{};
+    for (uint32_t i = 0; i < 8; i++) {
+        cullBindings[i].binding = i;
+        cullBindings[i].descriptorCount = 1;
+        cullBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        cullBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    }
+    cullBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    cullBindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+    layoutInfo.bindingCount = 8;
+    layoutInfo.pBindings = cullBindings;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, context->GetAllocationCallbacks(), &cullSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create cull descriptor set layout!");
+    }
+
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(ReduceParams);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &reduceSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, context->GetAllocationCallbacks(), &reduceLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create depth reduce pipeline layout!");
+    }
+
+    pushRange.size = sizeof(uint32_t);
+    pipelineLayoutInfo.pSetLayouts = &cullSetLayout;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, context->GetAllocationCallbacks(), &cullLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create cull pipeline layout!");
+    }
+
+    reducePipeline = CreateComputePipeline(REDUCE_SHADER_PATH, reduceLayout);
+    cullPipeline = CreateComputePipeline(CULL_SHADER_PATH, cullLayout);
+    return true;
+}
+
+bool OcclusionCuller::CreateDescriptorPool() {
+    const uint32_t frameCount = VulkanContext::MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorPoolSize poolSizes[] = {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_PYRAMID_LEVELS + frameCount},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_PYRAMID_LEVELS},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frameCount},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 6 * frameCount}
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = MAX_PYRAMID_LEVELS + frameCount;
+    poolInfo.poolSizeCount = 4;
+    poolInfo.pPoolSizes = poolSizes;
+    if (vkCreateDescriptorPool(context->GetDevice(), &poolInfo, context->GetAllocationCallbacks(), &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create occlusion descriptor pool!");
+    }
+
+    // 描述符集只分配一次，尺寸或容量变化时重写
+    std::vector<VkDescriptorSetLayout> reduceLayouts(MAX_PYRAMID_LEVELS, reduceSetLayout);
+    reduceSets.resize(MAX_PYRAMID_LEVELS);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = MAX_PYRAMID_LEVELS;
+    allocInfo.pSetLayouts = reduceLayouts.data();
+    if (vkAllocateDescriptorSets(context->GetDevice(), &allocInfo, reduceSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate depth reduce descriptor sets!");
+    }
+
+    frames.resize(frameCount);
+    for (auto& frame : frames) {
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &cullSetLayout;
+        if (vkAllocateDescriptorSets(context->GetDevice(), &allocInfo, &frame.cullSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate cull descriptor set!");
+        }
+    }
+    return true;
+}
+
+bool OcclusionCuller::CreatePyramid() {
+    depthExtent = context->GetSwapchainExtent();
+
+    // level 0为深度的一半（向上取整），逐级减半到1x1
+    pyramidExtents.clear();
+    VkExtent2D extent = {std::max(1u, (depthExtent.width + 1) / 2), std::max(1u, (depthExtent.height + 1) / 2)};
+    while (pyramidExtents.size() < MAX_PYRAMID_LEVELS) {
+        pyramidExtents.push_back(extent);
+        if (extent.width == 1 && extent.height == 1) break;
+        extent = {std::max(1u, (extent.width + 1) / 2), std::max(1u, (extent.height + 1) / 2)};
+    }
+    uint32_t levelCount = static_cast<uint32_t>(pyramidExtents.size());
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R32_SFLOAT;
+    imageInfo.extent = {pyramidExtents[0].width, pyramidExtents[0].height, 1};
+    imageInfo.mipLevels = levelCount;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    if (context->GetMemoryManager()->CreateImage(imageInfo, allocInfo, &pyramidImage, &pyramidAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create depth pyramid" << std::endl;
+        return false;
+    }
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = pyramidImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R32_SFLOAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = levelCount;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    if (vkCreateImageView(context->GetDevice(), &viewInfo, context->GetAllocationCallbacks(), &pyramidView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create depth pyramid view!");
+    }
+
+    pyramidLevelViews.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        viewInfo.subresourceRange.baseMipLevel = level;
+        viewInfo.subresourceRange.levelCount = 1;
+        if (vkCreateImageView(context->GetDevice(), &viewInfo, context->GetAllocationCallbacks(), &pyramidLevelViews[level]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create depth pyramid level view!");
+        }
+    }
+
+    // 每级的源：level 0读深度缓冲，其余读上一级（窗口大小变化时在帧内重建，使用栈上数组）
+    VkDescriptorImageInfo sourceInfos[MAX_PYRAMID_LEVELS] = {};
+    VkDescriptorImageInfo destinationInfos[MAX_PYRAMID_LEVELS] = {};
+    VkWriteDescriptorSet writes[MAX_PYRAMID_LEVELS * 2];
+    uint32_t writeCount = 0;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        sourceInfos[level].sampler = pointSampler;
+        sourceInfos[level].imageView = level == 0 ? context->GetSwapchain()->GetDepthImageView() : pyramidLevelViews[level - 1];
+        sourceInfos[level].imageLayout = level == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+        destinationInfos[level].imageView = pyramidLevelViews[level];
+        destinationInfos[level].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = reduceSets[level];
+        write.descriptorCount = 1;
+        write.dstBinding = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &sourceInfos[level];
+        writes[writeCount++] = write;
+        write.dstBinding = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write.pImageInfo = &destinationInfos[level];
+        writes[writeCount++] = write;
+    }
+    vkUpdateDescriptorSets(context->GetDevice(), writeCount, writes, 0, nullptr);
+    return true;
+}
+
+void OcclusionCuller::DestroyPyramid() {
+    VkDevice device = context->GetDevice();
+    for (VkImageView view : pyramidLevelViews) {
+        vkDestroyImageView(device, view, context->GetAllocationCallbacks());
+    }
+    pyramidLevelViews.clear();
+    if (pyramidView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, pyramidView, context->GetAllocationCallbacks());
+        pyramidView = VK_NULL_HANDLE;
+    }
+    if (pyramidImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(context->GetAllocator(), pyramidImage, pyramidAllocation);
+        pyramidImage = VK_NULL_HANDLE;
+        pyramidAllocation = VK_NULL_HANDLE;
+    }
+    pyramidExtents.clear();
+    depthExtent = {0, 0};
+}
+
+bool OcclusionCuller::OnResize() {
+    if (!supported) return true;
+    // 交换链重建时设备已空闲
+    DestroyPyramid();
+    if (!CreateDepthResources()) {
+        supported = false;
+        return false;
+    }
+    // 金字塔须按新的深度缓冲尺寸重建，否则遮挡测试按旧尺寸采样
+    VkExtent2D extent = context->GetSwapchainExtent();
+    if (pyramidImage == VK_NULL_HANDLE || depthExtent.width != extent.width || depthExtent.height != extent.height) {
+        supported = false;
+        return false;
+    }
+    return true;
+}
+
+bool OcclusionCuller::EnsureCapacity(uint32_t count) {
+    if (count <= drawCapacity) return true;
+
+    // 扩容很少发生，等待GPU空闲后直接替换
+    vkDeviceWaitIdle(context->GetDevice());
+    DestroyBuffers();
+
+    uint32_t capacity = 256;
+    while (capacity < count) capacity *= 2;
+
+    MemoryManager* memoryManager = context->GetMemoryManager();
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // CPU每帧写入的实例与参数
+    VmaAllocationCreateInfo hostInfo{};
+    hostInfo.usage = VMA_MEMORY_USAGE_AUTO;
+    hostInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    for (auto& frame : frames) {
+        VmaAllocationInfo allocationInfo{};
+        bufferInfo.size = sizeof(GpuInstance) * capacity;
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        if (memoryManager->CreateBuffer(bufferInfo, hostInfo, &frame.instanceBuffer, &frame.instanceAllocation, &allocationInfo) != VK_SUCCESS) {
+            std::cerr << "Failed to create occlusion instance buffer" << std::endl;
+            return false;
+        }
+        frame.instances = static_cast<GpuInstance*>(allocationInfo.pMappedData);
+
+        bufferInfo.size = sizeof(CullData);
+        bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        if (memoryManager->CreateBuffer(bufferInfo, hostInfo, &frame.uniformBuffer, &frame.uniformAllocation, &allocationInfo) != VK_SUCCESS) {
+            std::cerr << "Failed to create occlusion uniform buffer" << std::endl;
+            return false;
+        }
+        frame.uniforms = static_cast<CullData*>(allocationInfo.pMappedData);
+    }
+
+    // 只由GPU读写的缓冲
+    VmaAllocationCreateInfo deviceInfo{};
+    deviceInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    bufferInfo.size = sizeof(uint32_t) * capacity;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (memoryManager->CreateBuffer(bufferInfo, deviceInfo, &visibilityBuffer, &visibilityAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create visibility buffer" << std::endl;
+        return false;
+    }
+    if (memoryManager->CreateBuffer(bufferInfo, deviceInfo, &lodStateBuffer, &lodStateAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create LOD state buffer" << std::endl;
+        return false;
+    }
+
+    bufferInfo.size = sizeof(VkDrawIndexedIndirectCommand) * capacity * 2;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    if (memoryManager->CreateBuffer(bufferInfo, deviceInfo, &drawBuffer, &drawAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create indirect draw buffer" << std::endl;
+        return false;
+    }
+
+    bufferInfo.size = sizeof(uint32_t) * 2;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (memoryManager->CreateBuffer(bufferInfo, deviceInfo, &drawCountBuffer, &drawCountAllocation) != VK_SUCCESS) {
+        std::cerr << "Failed to create draw count buffer" << std::endl;
+        return false;
+    }
+
+    drawCapacity = capacity;
+    visibilityReset = true;
+    if (pyramidView != VK_NULL_HANDLE) {
+        UpdateCullDescriptors();
+    }
+    return true;
+}
+
+void OcclusionCuller::DestroyBuffers() {
+    VmaAllocator allocator = context->GetAllocator();
+    for (auto& frame : frames) {
+        if (frame.instanceBuffer != VK_NULL_HANDLE) {
+            vmaDestroyBuffer(allocator, frame.instanceBuffer, frame.instanceAllocation);
+            frame.instanceBuffer = VK_NULL_HANDLE;
+            frame.instances = nullptr;
+        }
+        if (frame.uniformBuffer != VK_NULL_HANDLE) {
+            vmaDestroyBuffer(allocator, frame.uniformBuffer, frame.uniformAllocation);
+            frame.uniformBuffer = VK_NULL_HANDLE;
+            frame.uniforms = nullptr;
+        }
+    }
+    if (visibilityBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, visibilityBuffer, visibilityAllocation);
+        visibilityBuffer = VK_NULL_HANDLE;
+    }
+    if (lodStateBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, lodStateBuffer, lodStateAllocation);
+        lodStateBuffer = VK_NULL_HANDLE;
+    }
+    if (drawBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, drawBuffer, drawAllocation);
+        drawBuffer = VK_NULL_HANDLE;
+    }
+    if (drawCountBuffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(allocator, drawCountBuffer, drawCountAllocation);
+        drawCountBuffer = VK_NULL_HANDLE;
+    }
+    drawCapacity = 0;
+}
+
+void OcclusionCuller::UpdateCullDescriptors() {
+    // 几何池的LOD表容量固定，缓冲在整个生命周期内不变
+    VkBuffer lodBuffer = context->GetGeometryPool()->GetLodBuffer();
+    for (auto& frame : frames) {
+        VkDescriptorBufferInfo bufferInfos[8] = {
+            {frame.uniformBuffer, 0, VK_WHOLE_SIZE},
+            {frame.instanceBuffer, 0, VK_WHOLE_SIZE},
+            {visibilityBuffer, 0, VK_WHOLE_SIZE},
+            {drawBuffer, 0, VK_WHOLE_SIZE},
+            {drawCountBuffer, 0, VK_WHOLE_SIZE},
+            {},
+            {lodBuffer, 0, VK_WHOLE_SIZE},
+            {lodStateBuffer, 0, VK_WHOLE_SIZE}
+        };
+        VkDescriptorImageInfo pyramidInfo{pointSampler, pyramidView, VK_IMAGE_LAYOUT_GENERAL};
+
+        VkWriteDescriptorSet writes[8]{};
+        for (uint32_t i = 0; i < 8; i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.cullSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            if (i != 5) {
+                writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].pBufferInfo = &bufferInfos[i];
+            } else {
+                writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                writes[i].pImageInfo = &pyramidInfo;
+            }
+        }
+        vkUpdateDescriptorSets(context->GetDevice(), 8, writes, 0, nullptr);
+    }
+}
+
+void OcclusionCuller::SetDrawItems(const std::vector<DrawItem>& items) {
+    drawItems = items;
+    // 实例索引变化后上一帧的可见性失效，第一帧全部在后期阶段测试
+    visibilityReset = true;
+    if (supported && !EnsureCapacity(static_cast<uint32_t>(drawItems.size()))) {
+        drawItems.clear();
+    }
+}
+
+void OcclusionCuller::WriteInstances(FrameResources& frame, const RenderSnapshot& snapshot) {
+    const GeometryPool* geometryPool = context->GetGeometryPool();
+    const Mat4& viewProjection = snapshot.viewProjection;
+    const LodCamera& lodCamera = snapshot.lodCamera;
+    const LodSettings& lodSettings = snapshot.lodSettings;
+    const AABB* worldBounds = snapshot.worldBounds.data();
+    const uint8_t* boundsFlags = snapshot.boundsFlags.data();
+    const Mat4* worldMatrices = snapshot.worldMatrices.data();
+
+    for (size_t i = 0; i < drawItems.size(); i++) {
+        const DrawItem& item = drawItems[i];
+        AABB bounds;
+        float errorScale = 1.0f;
+        if (snapshot.IsValid(item.node)) {
+            uint32_t index = snapshot.GetIndex(item.node);
+            if (boundsFlags[index]) bounds = worldBounds[index];
+            const float* m = worldMatrices[index].m;
+            errorScale = std::sqrt(std::max({m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+                                             m[4] * m[4] + m[5] * m[5] + m[6] * m[6],
+                                             m[8] * m[8] + m[9] * m[9] + m[10] * m[10]}));
+        }
+
+        GpuInstance& instance = frame.instances[i];
+        instance.boundsMin[0] = bounds.min.x;
+        instance.boundsMin[1] = bounds.min.y;
+        instance.boundsMin[2] = bounds.min.z;
+        instance.boundsMax[0] = bounds.max.x;
+        instance.boundsMax[1] = bounds.max.y;
+        instance.boundsMax[2] = bounds.max.z;
+        instance.indexCount = item.indexCount;
+        instance.firstIndex = item.firstIndex;
+        instance.vertexOffset = item.vertexOffset;
+        instance.objectIndex = item.objectIndex;
+        instance.lodBase = 0;
+        instance.lodCount = 0;
+        instance.lodErrorScale = errorScale;
+
+        if (item.mesh != INVALID_MESH) {
+            // 上传完成前输出空绘制；之后由着色器从LOD表中选择索引范围
+            const MeshInfo& mesh = geometryPool->GetMesh(item.mesh);
+            bool ready = geometryPool->IsReady(item.mesh);
+            instance.indexCount = ready ? mesh.lods[0].indexCount : 0;
+            instance.firstIndex = mesh.lods[0].firstIndex;
+            instance.vertexOffset = mesh.vertexOffset;
+            instance.lodBase = mesh.lodBase;
+            instance.lodCount = ready ? mesh.lodCount : 0;
+        }
+    }
+
+    Frustum frustum = Frustum::FromViewProjection(viewProjection);
+    CullData& data = *frame.uniforms;
+    std::memcpy(data.viewProjection, viewProjection.m, sizeof(data.viewProjection));
+    std::memcpy(data.planes, frustum.planes, sizeof(data.planes));
+    data.depthWidth = static_cast<float>(renderExtent.width);
+    data.depthHeight = static_cast<float>(renderExtent.height);
+    data.instanceCount = static_cast<uint32_t>(drawItems.size());
+    data.drawCapacity = drawCapacity;
+    data.pyramidLevels = static_cast<uint32_t>(pyramidExtents.size());
+    data.compact = IsCompacting() ? 1u : 0u;
+    data.lodThreshold = lodSettings.errorThreshold;
+    data.lodHysteresis = lodSettings.hysteresis;
+    data.cameraPosition[0] = lodCamera.position.x;
+    data.cameraPosition[1] = lodCamera.position.y;
+    data.cameraPosition[2] = lodCamera.position.z;
+    data.projectionScale = lodCamera.projectionScale;
+
+    // 非HOST_COHERENT内存需要显式刷新
+    vmaFlushAllocation(context->GetAllocator(), frame.instanceAllocation, 0, sizeof(GpuInstance) * drawItems.size());
+    vmaFlushAllocation(context->GetAllocator(), frame.uniformAllocation, 0, sizeof(CullData));
+}
+
+void OcclusionCuller::Dispatch(VkCommandBuffer commandBuffer, Phase phase) {
+    uint32_t phaseValue = phase;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullLayout, 0, 1, &frames[currentFrame].cullSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, cullLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(phaseValue), &phaseValue);
+    uint32_t count = static_cast<uint32_t>(drawItems.size());
+    vkCmdDispatch(commandBuffer, (count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+    context->GetMetrics()->Add(Metrics::PIPELINE_BINDS);
+    context->GetMetrics()->Add(Metrics::DESCRIPTOR_BINDS);
+}
+
+void OcclusionCuller::CullEarly(VkCommandBuffer commandBuffer, const RenderSnapshot& snapshot) {
+    if (!supported || drawItems.empty()) return;
+
+    currentFrame = context->GetCurrentFrame();
+    VkExtent2D extent = context->GetRenderExtent();
+    renderExtent = {std::min(extent.width, depthExtent.width), std::min(extent.height, depthExtent.height)};
+    WriteInstances(frames[currentFrame], snapshot);
+
+    // 上一帧的间接绘制与剔除读写结束后才能清零
+    GlobalBarrier(context->GetMetrics(), commandBuffer,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    if (visibilityReset) {
+        vkCmdFillBuffer(commandBuffer, visibilityBuffer, 0, VK_WHOLE_SIZE, 0);
+        vkCmdFillBuffer(commandBuffer, lodStateBuffer, 0, VK_WHOLE_SIZE, 0);
+        visibilityReset = false;
+    }
+    vkCmdFillBuffer(commandBuffer, drawCountBuffer, 0, VK_WHOLE_SIZE, 0);
+    GlobalBarrier(context->GetMetrics(), commandBuffer,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    Dispatch(commandBuffer, PHASE_EARLY);
+
+    // 早期命令供第一段渲染通道使用，可见性和计数供后期阶段读写
+    GlobalBarrier(context->GetMetrics(), commandBuffer,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+}
+
+void OcclusionCuller::BuildDepthPyramid(VkCommandBuffer commandBuffer) {
+    if (!supported || drawItems.empty()) return;
+
+    // 每帧整体重写，旧内容可以丢弃
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = pyramidImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = static_cast<uint32_t>(pyramidExtents.size());
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipeline);
+    Metrics* metrics = context->GetMetrics();
+    metrics->Add(Metrics::BARRIERS);
+    metrics->Add(Metrics::PIPELINE_BINDS);
+    // 金字塔按完整深度分配，只归约本帧渲染的子矩形；各级尺寸与CreatePyramid的规则一致
+    VkExtent2D source = renderExtent;
+    for (size_t level = 0; level < pyramidExtents.size(); level++) {
+        VkExtent2D destination = {std::max(1u, (source.width + 1) / 2), std::max(1u, (source.height + 1) / 2)};
+        ReduceParams params{source.width, source.height, destination.width, destination.height};
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reduceLayout, 0, 1, &reduceSets[level], 0, nullptr);
+        metrics->Add(Metrics::DESCRIPTOR_BINDS);
+        vkCmdPushConstants(commandBuffer, reduceLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+        vkCmdDispatch(commandBuffer,
+                      (destination.width + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE,
+                      (destination.height + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, 1);
+
+        // 下一级读取本级
+        GlobalBarrier(metrics, commandBuffer,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        source = destination;
+    }
+}
+
+void OcclusionCuller::CullLate(VkCommandBuffer commandBuffer) {
+    if (!supported || drawItems.empty()) return;
+
+    Dispatch(commandBuffer, PHASE_LATE);
+
+    GlobalBarrier(context->GetMetrics(), commandBuffer,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+}
+
+void OcclusionCuller::Draw(VkCommandBuffer commandBuffer, Phase phase) {
+    if (!supported || drawItems.empty() || !bindCallback) return;
+
+    bindCallback(commandBuffer);
+
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    VkDeviceSize offset = static_cast<VkDeviceSize>(phase) * drawCapacity * stride;
+    uint32_t count = static_cast<uint32_t>(drawItems.size());
+    // 绘制调用按API调用次数计，而不是GPU端展开的命令数
+    if (drawIndexedIndirectCount != nullptr) {
+        drawIndexedIndirectCount(commandBuffer, drawBuffer, offset, drawCountBuffer, phase * sizeof(uint32_t), count, stride);
+        context->GetMetrics()->Add(Metrics::DRAW_CALLS);
+    } else if (multiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, offset, count, stride);
+        context->GetMetrics()->Add(Metrics::DRAW_CALLS);
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, offset + i * stride, 1, stride);
+        }
+        context->GetMetrics()->Add(Metrics::DRAW_CALLS, count);
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "FramePipeline.hpp"
+#include "GeometryPool.hpp"
+#include "LodSelector.hpp"
+#include "MathTypes.hpp"
+#include "Scene.hpp"
+#include "vk_mem_alloc.h"
+
+class VulkanContext;
+
+// GPU两阶段遮挡剔除：
+// 1. 早期阶段：上一帧可见的实例只做视锥测试，绘制后得到当前帧的部分深度
+// 2. 由该深度构建Hi-Z（层级最大深度）金字塔
+// 3. 后期阶段：所有实例做视锥+Hi-Z测试，更新可见性，绘制早期阶段未绘制的新可见实例
+// 被剔除的实例不会出现在间接绘制列表中（支持VK_KHR_draw_indirect_count时压缩列表，
+// 否则对应命令的instanceCount为0）
+// 关联几何池网格的实例在剔除着色器中按屏幕空间误差选择LOD，每个实例的当前LOD保存在GPU上用于滞后判断
+class OcclusionCuller {
+public:
+    enum Phase : uint32_t {
+        PHASE_EARLY = 0,
+        PHASE_LATE = 1
+    };
+
+    // 一个可绘制实例：包围盒取自场景节点的世界包围盒，绘制参数来自共享的几何缓冲
+    // 设置mesh时绘制参数取自几何池并启用LOD选择，忽略indexCount/firstIndex/vertexOffset
+    struct DrawItem {
+        NodeHandle node = INVALID_NODE;     // 无包围盒的节点总是可见
+        MeshHandle mesh = INVALID_MESH;
+        uint32_t indexCount = 0;
+        uint32_t firstIndex = 0;
+        int32_t vertexOffset = 0;
+        uint32_t objectIndex = 0;           // 透传给绘制着色器（例如材质或变换索引）
+    };
+
+    // 与着色器中的Instance结构一致（std430）
+    struct GpuInstance {
+        float boundsMin[3];
+        uint32_t indexCount;
+        float boundsMax[3];
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t objectIndex;
+        uint32_t lodBase;               // 几何池LOD表中的起始位置
+        uint32_t lodCount;              // 0表示不做LOD选择
+        float lodErrorScale;            // 世界矩阵的最大轴缩放
+        uint32_t padding[3];
+    };
+    static_assert(sizeof(GpuInstance) == 64, "GpuInstance layout mismatch");
+
+    OcclusionCuller(VulkanContext* context);
+    ~OcclusionCuller();
+
+    // 管线、描述符池与实例缓冲，不依赖交换链，可与交换链创建并行
+    bool Initialize();
+    // 交换链深度缓冲就绪后创建Hi-Z金字塔并更新描述符
+    bool CreateDepthResources();
+    void Cleanup();
+
+    // 初始化时读取的着色器，启动阶段据此提前读入
+    static std::vector<const char*> GetShaderPaths();
+
+    // 交换链重建后按新尺寸重新创建Hi-Z金字塔，失败时禁用遮挡剔除并返回false
+    bool OnResize();
+
+    bool IsSupported() const { return supported; }
+    bool IsCompacting() const { return drawIndexedIndirectCount != nullptr; }
+
+    // 设置实例列表，实例索引即绘制命令的firstInstance，绘制着色器据此读取GetInstanceBuffer()
+    void SetDrawItems(const std::vector<DrawItem>& items);
+    const std::vector<DrawItem>& GetDrawItems() const { return drawItems; }
+    uint32_t GetInstanceCount() const { return static_cast<uint32_t>(drawItems.size()); }
+
+    // 绘制前绑定管线与几何缓冲
+    void SetBindCallback(std::function<void(VkCommandBuffer)> callback) { bindCallback = std::move(callback); }
+
+    // 帧内调用顺序：CullEarly -> 第一段渲染通道内Draw(EARLY) -> BuildDepthPyramid -> CullLate
+    // -> 第二段渲染通道内Draw(LATE)
+    // 实例的包围盒与变换、相机和LOD参数都取自快照，录制期间不访问模拟阶段可能正在修改的Scene
+    void CullEarly(VkCommandBuffer commandBuffer, const RenderSnapshot& snapshot);
+    void BuildDepthPyramid(VkCommandBuffer commandBuffer);
+    void CullLate(VkCommandBuffer commandBuffer);
+    void Draw(VkCommandBuffer commandBuffer, Phase phase);
+
+    VkBuffer GetInstanceBuffer() const { return frames.empty() ? VK_NULL_HANDLE : frames[currentFrame].instanceBuffer; }
+
+private:
+    // 与着色器中的CullData一致（std140）
+    struct CullData {
+        float viewProjection[16];
+        float planes[6][4];
+        float depthWidth;
+        float depthHeight;
+        uint32_t instanceCount;
+        uint32_t drawCapacity;
+        uint32_t pyramidLevels;
+        uint32_t compact;
+        float lodThreshold;
+        float lodHysteresis;
+        float cameraPosition[3];
+        float projectionScale;
+    };
+    static_assert(sizeof(CullData) == 208, "CullData layout mismatch");
+
+    struct FrameResources {
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;
+        VmaAllocation instanceAllocation = VK_NULL_HANDLE;
+        GpuInstance* instances = nullptr;
+        VkBuffer uniformBuffer = VK_NULL_HANDLE;
+        VmaAllocation uniformAllocation = VK_NULL_HANDLE;
+        CullData* uniforms = nullptr;
+        VkDescriptorSet cullSet = VK_NULL_HANDLE;
+    };
+
+    static const uint32_t MAX_PYRAMID_LEVELS = 16;
+    static const uint32_t REDUCE_GROUP_SIZE = 8;
+    static const uint32_t CULL_GROUP_SIZE = 64;
+
+    bool CreatePipelines();
+    bool CreateSampler();
+    bool CreateDescriptorPool();
+    bool CreatePyramid();
+    void DestroyPyramid();
+    bool EnsureCapacity(uint32_t count);
+    void DestroyBuffers();
+    void UpdateCullDescriptors();
+    void WriteInstances(FrameResources& frame, const RenderSnapshot& snapshot);
+    void Dispatch(VkCommandBuffer commandBuffer, Phase phase);
+    VkPipeline CreateComputePipeline(const char* path, VkPipelineLayout layout);
+
+    VulkanContext* context;
+    bool supported = false;
+
+    std::vector<DrawItem> drawItems;
+    std::function<void(VkCommandBuffer)> bindCallback;
+    bool visibilityReset = true;
+    size_t currentFrame = 0;
+
+    // 管线
+    VkDescriptorSetLayout reduceSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout reduceLayout = VK_NULL_HANDLE;
+    VkPipelineLayout cullLayout = VK_NULL_HANDLE;
+    VkPipeline reducePipeline = VK_NULL_HANDLE;
+    VkPipeline cullPipeline = VK_NULL_HANDLE;
+    VkSampler pointSampler = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+    bool multiDrawIndirect = false;
+
+    // Hi-Z金字塔：level 0为深度的1/2分辨率，每个纹素是其覆盖深度像素的最大值
+    VkImage pyramidImage = VK_NULL_HANDLE;
+    VmaAllocation pyramidAllocation = VK_NULL_HANDLE;
+    VkImageView pyramidView = VK_NULL_HANDLE;
+    std::vector<VkImageView> pyramidLevelViews;
+    std::vector<VkDescriptorSet> reduceSets;
+    std::vector<VkExtent2D> pyramidExtents;
+    VkExtent2D depthExtent{};
+    VkExtent2D renderExtent{};          // 本帧深度中的有效区域（动态分辨率下为左上角子矩形）
+
+    // 实例数据每帧由CPU写入；可见性与绘制命令只由GPU读写，各帧共享
+    std::vector<FrameResources> frames;
+    VkBuffer visibilityBuffer = VK_NULL_HANDLE;
+    VmaAllocation visibilityAllocation = VK_NULL_HANDLE;
+    VkBuffer drawBuffer = VK_NULL_HANDLE;           // 两个阶段各drawCapacity条命令
+    VmaAllocation drawAllocation = VK_NULL_HANDLE;
+    VkBuffer drawCountBuffer = VK_NULL_HANDLE;      // 两个阶段的绘制数量
+    VmaAllocation drawCountAllocation = VK_NULL_HANDLE;
+    VkBuffer lodStateBuffer = VK_NULL_HANDLE;       // 每个实例上一帧选择的LOD
+    VmaAllocation lodStateAllocation = VK_NULL_HANDLE;
+    uint32_t drawCapacity = 0;
+};
@@ -0,0 +1,377 @@
+#include "PipelineLibrary.hpp"
+#include "VulkanContext.hpp"
+#include "VulkanUtils.hpp"
+#include "CookedMesh.hpp"
+#include "Metrics.hpp"
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    // 动态拓扑只能在同一类别内切换，键中用类别的代表拓扑
+    VkPrimitiveTopology TopologyClass(VkPrimitiveTopology topology) {
+        switch (topology) {
+            case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+                return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+                return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+                return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+            default:
+                return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        }
+    }
+
+    VkColorBlendEquationEXT BlendEquation(BlendMode mode) {
+        VkColorBlendEquationEXT equation{};
+        equation.colorBlendOp = VK_BLEND_OP_ADD;
+        equation.alphaBlendOp = VK_BLEND_OP_ADD;
+        switch (mode) {
+            case BLEND_ALPHA:
+                equation.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                equation.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                equation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                equation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                break;
+            case BLEND_ADDITIVE:
+                equation.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                equation.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                equation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                equation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                break;
+            case BLEND_PREMULTIPLIED:
+                equation.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                equation.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                equation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                equation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                break;
+            default:
+                equation.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                equation.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+                equation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                equation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+                break;
+        }
+        return equation;
+    }
+
+    template <typename T>
+    void AppendBytes(std::string& key, const T& value) {
+        key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+}
+
+PipelineLibrary::PipelineLibrary(VulkanContext* context) : context(context) {
+}
+
+PipelineLibrary::~PipelineLibrary() {
+    Cleanup();
+}
+
+bool PipelineLibrary::Initialize() {
+    const DeviceCapabilities& capabilities = context->GetCapabilities();
+    support.extendedDynamicState = capabilities.extendedDynamicState &&
+        vkCmdSetCullMode != nullptr && vkCmdSetFrontFace != nullptr && vkCmdSetPrimitiveTopology != nullptr &&
+        vkCmdSetDepthTestEnable != nullptr && vkCmdSetDepthWriteEnable != nullptr && vkCmdSetDepthCompareOp != nullptr;
+    support.extendedDynamicState2 = capabilities.extendedDynamicState2 &&
+        vkCmdSetDepthBiasEnable != nullptr && vkCmdSetPrimitiveRestartEnable != nullptr;
+    support.extendedDynamicState3Blend = capabilities.extendedDynamicState3Blend &&
+        vkCmdSetColorBlendEnableEXT != nullptr && vkCmdSetColorBlendEquationEXT != nullptr && vkCmdSetColorWriteMaskEXT != nullptr;
+
+    if (capabilities.extendedDynamicState && !support.extendedDynamicState) {
+        std::cerr << "Extended dynamic state entry points missing, using static pipeline state" << std::endl;
+    }
+    return true;
+}
+
+void PipelineLibrary::Cleanup() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : pipelines) {
+        vkDestroyPipeline(context->GetDevice(), entry.second, context->GetAllocationCallbacks());
+    }
+    pipelines.clear();
+    for (auto& entry : shaderModules) {
+        vkDestroyShaderModule(context->GetDevice(), entry.second, context->GetAllocationCallbacks());
+    }
+    shaderModules.clear();
+    variants.clear();
+    requests = 0;
+}
+
+RasterState PipelineLibrary::NormalizeState(const RasterState& state, uint32_t colorAttachmentCount,
+                                            const DynamicStateSupport& support) {
+    RasterState result = state;
+
+    // 无论设备能力如何都不影响管线的字段
+    result.depthBiasConstant = 0.0f;
+    result.depthBiasSlope = 0.0f;
+    if (!result.depthTest) {
+        result.depthWrite = VK_FALSE;
+        result.depthCompare = VK_COMPARE_OP_ALWAYS;
+    }
+    if (colorAttachmentCount == 0) {
+        result.blendMode = BLEND_OPAQUE;
+        result.colorWriteMask = 0;
+    }
+
+    if (support.extendedDynamicState) {
+        result.topology = TopologyClass(result.topology);
+        result.cullMode = VK_CULL_MODE_NONE;
+        result.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        result.depthTest = VK_FALSE;
+        result.depthWrite = VK_FALSE;
+        result.depthCompare = VK_COMPARE_OP_ALWAYS;
+    }
+    if (support.extendedDynamicState2) {
+        result.depthBias = VK_FALSE;
+        result.primitiveRestart = VK_FALSE;
+    }
+    if (support.extendedDynamicState3Blend) {
+        result.blendMode = BLEND_OPAQUE;
+        result.colorWriteMask = 0;
+    }
+    return result;
+}
+
+void PipelineLibrary::AppendKey(std::string& key, const PipelineDesc& desc, const RasterState& state) {
+    key.append(desc.vertexShader);
+    key.push_back('\0');
+    key.append(desc.fragmentShader);
+    key.push_back('\0');
+    AppendBytes(key, desc.layout);
+    AppendBytes(key, desc.renderPass);
+    AppendBytes(key, desc.subpass);
+    AppendBytes(key, desc.colorAttachmentCount);
+    AppendBytes(key, desc.vertexLayout);
+    AppendBytes(key, state);
+    for (uint32_t i = 0; i < desc.specialization.entryCount; i++) {
+        AppendBytes(key, desc.specialization.entries[i]);
+    }
+    key.append(static_cast<const char*>(desc.specialization.data), desc.specialization.size);
+}
+
+VkPipeline PipelineLibrary::GetPipeline(const PipelineDesc& desc) {
+    // 变体键：不使用动态状态时需要的管线；管线键：剔除动态状态后实际需要的管线
+    std::string variantKey;
+    std::string pipelineKey;
+    AppendKey(variantKey, desc, NormalizeState(desc.state, desc.colorAttachmentCount, DynamicStateSupport()));
+    RasterState pipelineState = NormalizeState(desc.state, desc.colorAttachmentCount, support);
+    AppendKey(pipelineKey, desc, pipelineState);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests++;
+        variants.insert(variantKey);
+        auto it = pipelines.find(pipelineKey);
+        if (it != pipelines.end()) {
+            return it->second;
+        }
+    }
+
+    // 创建不持锁，其他线程可同时取用已有管线；并发创建同一管线时保留先插入者
+    VkPipeline pipeline = CreatePipeline(desc, pipelineState);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto result = pipelines.emplace(pipelineKey, pipeline);
+    if (!result.second) {
+        vkDestroyPipeline(context->GetDevice(), pipeline, context->GetAllocationCallbacks());
+    }
+    return result.first->second;
+}
+
+VkShaderModule PipelineLibrary::GetShaderModule(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = shaderModules.find(path);
+        if (it != shaderModules.end()) {
+            return it->second;
+        }
+    }
+
+    VkShaderModule module = VulkanUtils::CreateShaderModule(context->GetDevice(), context->LoadShaderCode(path), context->GetAllocationCallbacks());
+    std::lock_guard<std::mutex> lock(mutex);
+    auto result = shaderModules.emplace(path, module);
+    if (!result.second) {
+        vkDestroyShaderModule(context->GetDevice(), module, context->GetAllocationCallbacks());
+    }
+    return result.first->second;
+}
+
+VkPipeline PipelineLibrary::CreatePipeline(const PipelineDesc& desc, const RasterState& state) {
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = desc.specialization.entryCount;
+    specializationInfo.pMapEntries = desc.specialization.entries;
+    specializationInfo.dataSize = desc.specialization.size;
+    specializationInfo.pData = desc.specialization.data;
+    const VkSpecializationInfo* specialization = desc.specialization.entryCount > 0 ? &specializationInfo : nullptr;
+
+    VkPipelineShaderStageCreateInfo shaderStages[2]{};
+    uint32_t stageCount = 0;
+    shaderStages[stageCount].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[stageCount].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[stageCount].module = GetShaderModule(desc.vertexShader);
+    shaderStages[stageCount].pName = "main";
+    shaderStages[stageCount].pSpecializationInfo = specialization;
+    stageCount++;
+    if (!desc.fragmentShader.empty()) {
+        shaderStages[stageCount].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStages[stageCount].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        shaderStages[stageCount].module = GetShaderModule(desc.fragmentShader);
+        shaderStages[stageCount].pName = "main";
+        shaderStages[stageCount].pSpecializationInfo = specialization;
+        stageCount++;
+    }
+
+    // 烘焙网格的量化顶点：描述由CookedVertexLayout生成，解码见shaders/vertex_decode.glsl
+    VkVertexInputBindingDescription bindingDescription = CookedVertexLayout::GetBindingDescription();
+    auto attributeDescriptions = CookedVertexLayout::GetAttributeDescriptions();
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    if (desc.vertexLayout == VERTEX_LAYOUT_COOKED) {
+        vertexInputInfo.vertexBindingDescriptionCount = 1;
+        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    }
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = state.topology;
+    inputAssembly.primitiveRestartEnable = state.primitiveRestart;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = state.cullMode;
+    rasterizer.frontFace = state.frontFace;
+    rasterizer.depthBiasEnable = state.depthBias;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = state.depthTest;
+    depthStencil.depthWriteEnable = state.depthWrite;
+    depthStencil.depthCompareOp = state.depthCompare;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkColorBlendEquationEXT equation = BlendEquation(state.blendMode);
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.blendEnable = state.blendMode != BLEND_OPAQUE ? VK_TRUE : VK_FALSE;
+    colorBlendAttachment.srcColorBlendFactor = equation.srcColorBlendFactor;
+    colorBlendAttachment.dstColorBlendFactor = equation.dstColorBlendFactor;
+    colorBlendAttachment.colorBlendOp = equation.colorBlendOp;
+    colorBlendAttachment.srcAlphaBlendFactor = equation.srcAlphaBlendFactor;
+    colorBlendAttachment.dstAlphaBlendFactor = equation.dstAlphaBlendFactor;
+    colorBlendAttachment.alphaBlendOp = equation.alphaBlendOp;
+    colorBlendAttachment.colorWriteMask = state.colorWriteMask;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = desc.colorAttachmentCount;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    // 视口、裁剪和深度偏移数值总是动态的，其余按设备能力追加
+    std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_DEPTH_BIAS};
+    if (support.extendedDynamicState) {
+        dynamicStates.insert(dynamicStates.end(), {
+            VK_DYNAMIC_STATE_CULL_MODE, VK_DYNAMIC_STATE_FRONT_FACE, VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+            VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP});
+    }
+    if (support.extendedDynamicState2) {
+        dynamicStates.insert(dynamicStates.end(), {VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE, VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE});
+    }
+    if (support.extendedDynamicState3Blend && desc.colorAttachmentCount > 0) {
+        dynamicStates.insert(dynamicStates.end(), {
+            VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT, VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT});
+    }
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = stageCount;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.renderPass = desc.renderPass;
+    pipelineInfo.subpass = desc.subpass;
+
+    VkPipeline pipeline;
+    if (vkCreateGraphicsPipelines(context->GetDevice(), context->GetPipelineCache(), 1, &pipelineInfo, context->GetAllocationCallbacks(), &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline!");
+    }
+    return pipeline;
+}
+
+void PipelineLibrary::Bind(VkCommandBuffer commandBuffer, VkPipeline pipeline, const PipelineDesc& desc) {
+    const RasterState& state = desc.state;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdSetDepthBias(commandBuffer, state.depthBiasConstant, 0.0f, state.depthBiasSlope);
+
+    if (support.extendedDynamicState) {
+        vkCmdSetCullMode(commandBuffer, state.cullMode);
+        vkCmdSetFrontFace(commandBuffer, state.frontFace);
+        vkCmdSetPrimitiveTopology(commandBuffer, state.topology);
+        vkCmdSetDepthTestEnable(commandBuffer, state.depthTest);
+        vkCmdSetDepthWriteEnable(commandBuffer, state.depthWrite);
+        vkCmdSetDepthCompareOp(commandBuffer, state.depthCompare);
+    }
+    if (support.extendedDynamicState2) {
+        vkCmdSetDepthBiasEnable(commandBuffer, state.depthBias);
+        vkCmdSetPrimitiveRestartEnable(commandBuffer, state.primitiveRestart);
+    }
+    if (support.extendedDynamicState3Blend && desc.colorAttachmentCount > 0) {
+        VkBool32 blendEnable = state.blendMode != BLEND_OPAQUE ? VK_TRUE : VK_FALSE;
+        VkColorBlendEquationEXT equation = BlendEquation(state.blendMode);
+        vkCmdSetColorBlendEnableEXT(commandBuffer, 0, 1, &blendEnable);
+        vkCmdSetColorBlendEquationEXT(commandBuffer, 0, 1, &equation);
+        vkCmdSetColorWriteMaskEXT(commandBuffer, 0, 1, &state.colorWriteMask);
+    }
+    context->GetMetrics()->Add(Metrics::PIPELINE_BINDS);
+}
+
+PipelineLibrary::Statistics PipelineLibrary::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Statistics statistics;
+    statistics.requests = requests;
+    statistics.variants = variants.size();
+    statistics.pipelines = pipelines.size();
+    return statistics;
+}
+
+void PipelineLibrary::PrintStatistics() const {
+    Statistics statistics = GetStatistics();
+    std::cout << "Pipeline variants: " << statistics.variants << " requested, " << statistics.pipelines
+              << " created, " << statistics.GetEliminated() << " eliminated by dynamic state ("
+              << statistics.requests << " lookups; EDS " << (support.extendedDynamicState ? "1" : "-")
+              << (support.extendedDynamicState2 ? "2" : "-") << (support.extendedDynamicState3Blend ? "3" : "-")
+              << ")" << std::endl;
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+class VulkanContext;
+
+// 混合模式（设备支持EDS3混合状态时在绑定时设置）
+enum BlendMode : uint32_t {
+    BLEND_OPAQUE = 0,
+    BLEND_ALPHA = 1,
+    BLEND_ADDITIVE = 2,
+    BLEND_PREMULTIPLIED = 3
+};
+
+// 顶点输入布局
+enum VertexLayout : uint32_t {
+    VERTEX_LAYOUT_NONE = 0,         // 无顶点输入，着色器用gl_VertexIndex生成
+    VERTEX_LAYOUT_COOKED = 1        // GeometryPool的CookedVertexLayout
+};
+
+// 固定功能状态：设备支持对应的扩展动态状态时，字段在Bind时设置而不进入管线键
+struct RasterState {
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;         // EDS1（只能在同一拓扑类别内切换）
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;                           // EDS1
+    VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;                            // EDS1
+    VkBool32 depthTest = VK_TRUE;                                               // EDS1
+    VkBool32 depthWrite = VK_TRUE;                                              // EDS1
+    VkCompareOp depthCompare = VK_COMPARE_OP_LESS;                              // EDS1
+    VkBool32 depthBias = VK_FALSE;                                              // EDS2
+    VkBool32 primitiveRestart = VK_FALSE;                                       // EDS2
+    BlendMode blendMode = BLEND_OPAQUE;                                         // EDS3
+    VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;  // EDS3
+    // 深度偏移数值始终是动态状态
+    float depthBiasConstant = 0.0f;
+    float depthBiasSlope = 0.0f;
+};
+static_assert(sizeof(RasterState) == 48, "RasterState must not contain padding (hashed as bytes)");
+
+// 特化常量：编号与着色器中layout(constant_id = Id)一致，类型限定为4字节标量（bool用VkBool32）
+template <uint32_t Id, typename T>
+struct SpecConstant {
+    static_assert(std::is_same<T, VkBool32>::value || std::is_same<T, int32_t>::value || std::is_same<T, float>::value,
+                  "specialization constants must be VkBool32, uint32_t, int32_t or float");
+    static const uint32_t ID = Id;
+    using Type = T;
+};
+
+// 一组特化常量的原始数据，map entry在变体描述的整个生命周期内有效
+struct SpecializationData {
+    const VkSpecializationMapEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+    const void* data = nullptr;
+    size_t size = 0;
+};
+
+// 着色器变体描述：常量的编号和类型在编译期确定，Set/Get按编号做类型检查，
+// 取代按特性开关编译多份SPIR-V。例如：
+//   enum MaterialFeature : uint32_t {MATERIAL_ALPHA_TEST = 0, MATERIAL_LIGHT_COUNT = 1};
+//   using MaterialVariant = ShaderVariant<SpecConstant<MATERIAL_ALPHA_TEST, VkBool32>,
+//                                         SpecConstant<MATERIAL_LIGHT_COUNT, uint32_t>>;
+//   MaterialVariant variant;
+//   variant.Set<MATERIAL_LIGHT_COUNT>(4u);
+template <typename... Constants>
+class ShaderVariant {
+public:
+    static const uint32_t COUNT = sizeof...(Constants);
+    static_assert(COUNT > 0, "ShaderVariant needs at least one constant");
+
+    // 编号对应的下标，不存在时返回COUNT
+    static constexpr uint32_t IndexOf(uint32_t id) {
+        constexpr uint32_t ids[] = {Constants::ID...};
+        for (uint32_t i = 0; i < COUNT; i++) {
+            if (ids[i] == id) return i;
+        }
+        return COUNT;
+    }
+
+    static constexpr bool HasUniqueIds() {
+        constexpr uint32_t ids[] = {Constants::ID...};
+        for (uint32_t i = 0; i < COUNT; i++) {
+            if (IndexOf(ids[i]) != i) return false;
+        }
+        return true;
+    }
+
+    ShaderVariant() { static_assert(HasUniqueIds(), "duplicate specialization constant id"); }
+
+    template <uint32_t Id>
+    using ConstantType = typename std::tuple_element<IndexOf(Id), std::tuple<typename Constants::Type...>>::type;
+
+    template <uint32_t Id>
+    void Set(ConstantType<Id> value) { std::memcpy(&values[IndexOf(Id)], &value, sizeof(uint32_t)); }
+
+    template <uint32_t Id>
+    ConstantType<Id> Get() const {
+        ConstantType<Id> value;
+        std::memcpy(&value, &values[IndexOf(Id)], sizeof(uint32_t));
+        return value;
+    }
+
+    SpecializationData GetSpecialization() const {
+        static const std::array<VkSpecializationMapEntry, COUNT> entries = MakeEntries();
+        SpecializationData data;
+        data.entries = entries.data();
+        data.entryCount = COUNT;
+        data.data = values.data();
+        data.size = sizeof(values);
+        return data;
+    }
+
+private:
+    static std::array<VkSpecializationMapEntry, COUNT> MakeEntries() {
+        const uint32_t ids[] = {Constants::ID...};
+        std::array<VkSpecializationMapEntry, COUNT> entries{};
+        for (uint32_t i = 0; i < COUNT; i++) {
+            entries[i].constantID = ids[i];
+            entries[i].offset = i * sizeof(uint32_t);
+            entries[i].size = sizeof(uint32_t);
+        }
+        return entries;
+    }
+
+    std::array<uint32_t, COUNT> values{};
+};
+
+// 管线描述：着色器、布局、渲染通道、顶点布局、固定功能状态和特化常量
+struct PipelineDesc {
+    std::string vertexShader;
+    std::string fragmentShader;                 // 为空时只有顶点阶段（仅深度）
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    uint32_t colorAttachmentCount = 1;          // 0或1
+    VertexLayout vertexLayout = VERTEX_LAYOUT_NONE;
+    RasterState state;
+    SpecializationData specialization;          // 同时应用到两个阶段，着色器未声明的常量被忽略
+};
+
+// 管线变体库：按描述去重创建管线，设备支持扩展动态状态时把可动态化的状态从键中剔除，
+// 只在状态不同的变体共享同一个VkPipeline，并在Bind时设置实际状态
+// 统计请求过的不同变体数和实际创建的管线数，二者之差即被消除的管线
+class PipelineLibrary {
+public:
+    // 设备可用的动态状态分组
+    struct DynamicStateSupport {
+        bool extendedDynamicState = false;
+        bool extendedDynamicState2 = false;
+        bool extendedDynamicState3Blend = false;
+    };
+
+    struct Statistics {
+        uint64_t requests = 0;                  // GetPipeline调用次数
+        uint64_t variants = 0;                  // 请求过的不同变体（完整描述）
+        uint64_t pipelines = 0;                 // 实际创建的管线
+        uint64_t GetEliminated() const { return variants - pipelines; }
+    };
+
+    PipelineLibrary(VulkanContext* context);
+    ~PipelineLibrary();
+
+    bool Initialize();
+    void Cleanup();
+
+    // 取得（必要时创建）描述对应的管线，可从任意线程调用；管线归本库所有
+    VkPipeline GetPipeline(const PipelineDesc& desc);
+    template <typename... Constants>
+    VkPipeline GetPipeline(PipelineDesc desc, const ShaderVariant<Constants...>& variant) {
+        desc.specialization = variant.GetSpecialization();
+        return GetPipeline(desc);
+    }
+
+    // 绑定管线并设置其动态状态
+    void Bind(VkCommandBuffer commandBuffer, VkPipeline pipeline, const PipelineDesc& desc);
+
+    const DynamicStateSupport& GetDynamicStateSupport() const { return support; }
+    Statistics GetStatistics() const;
+    void PrintStatistics() const;
+
+    // 把动态化的字段替换为固定值，结果相同的状态共享一个管线
+    static RasterState NormalizeState(const RasterState& state, uint32_t colorAttachmentCount, const DynamicStateSupport& support);
+
+private:
+    static void AppendKey(std::string& key, const PipelineDesc& desc, const RasterState& state);
+    VkPipeline CreatePipeline(const PipelineDesc& desc, const RasterState& state);
+    VkShaderModule GetShaderModule(const std::string& path);
+
+    VulkanContext* context;
+    DynamicStateSupport support;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, VkPipeline> pipelines;
+    std::unordered_set<std::string> variants;
+    std::unordered_map<std::string, VkShaderModule> shaderModules;
+    uint64_t requests = 0;
+};
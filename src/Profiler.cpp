@@ -0,0 +1,120 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // 线程退出后缓冲仍保留，其事件可以继续导出
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Profiler::ThreadBuffer>> registry;
+    // 起点同时记录两种时钟，导出时由两次采样求出每纳秒的tick数
+    const uint64_t epochTicks = Profiler::Ticks();
+    const uint64_t epochNanoseconds = Profiler::Now();
+
+    void WriteEscaped(FILE* file, const char* text) {
+        for (; *text != '\0'; text++) {
+            char c = *text;
+            if (c == '"' || c == '\\') {
+                std::fputc('\\', file);
+                std::fputc(c, file);
+            } else if (static_cast<unsigned char>(c) >= 0x20) {
+                std::fputc(c, file);
+            }
+        }
+    }
+}
+
+std::atomic<bool> Profiler::enabled{true};
+thread_local Profiler::ThreadBuffer* Profiler::threadBuffer = nullptr;
+
+Profiler::ThreadBuffer* Profiler::RegisterThread() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(std::make_unique<ThreadBuffer>());
+    ThreadBuffer* buffer = registry.back().get();
+    buffer->threadId = static_cast<uint32_t>(registry.size());
+    std::snprintf(buffer->name, sizeof(buffer->name), "Thread %u", buffer->threadId);
+    threadBuffer = buffer;
+    return buffer;
+}
+
+void Profiler::SetThreadName(const char* name) {
+    ThreadBuffer* buffer = threadBuffer;
+    if (buffer == nullptr) buffer = RegisterThread();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        std::cerr << "failed to open trace file: " << path << std::endl;
+        return false;
+    }
+
+    uint64_t exportTime = Ticks();
+    uint64_t elapsedNanoseconds = Now() - epochNanoseconds;
+    double microsecondsPerTick = elapsedNanoseconds > 0 && exportTime > epochTicks ?
+        static_cast<double>(elapsedNanoseconds) / static_cast<double>(exportTime - epochTicks) / 1000.0 : 0.001;
+    auto toMicroseconds = [&](uint64_t ticks) {
+        return ticks > epochTicks ? static_cast<double>(ticks - epochTicks) * microsecondsPerTick : 0.0;
+    };
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    std::vector<Event> events;
+    std::vector<const char*> openZones;
+
+    for (const auto& buffer : registry) {
+        // 复制后重新读取head，丢弃复制期间可能已被所属线程覆盖的事件
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            events.push_back(buffer->events[i & (EVENTS_PER_THREAD - 1)]);
+        }
+        uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+        uint64_t valid = newHead > EVENTS_PER_THREAD ? newHead - EVENTS_PER_THREAD : 0;
+        size_t skip = valid > begin ? static_cast<size_t>(std::min<uint64_t>(valid - begin, events.size())) : 0;
+
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"",
+                     first ? "" : ",\n", buffer->threadId);
+        WriteEscaped(file, buffer->name);
+        std::fprintf(file, "\"}}");
+        first = false;
+
+        // 开始事件被覆盖的结束事件无法配对，直接跳过；导出时仍未结束的区段在导出时刻闭合
+        openZones.clear();
+        uint64_t lastTimestamp = exportTime;
+        for (size_t i = skip; i < events.size(); i++) {
+            const Event& event = events[i];
+            lastTimestamp = std::max(lastTimestamp, event.timestamp);
+            double timestamp = toMicroseconds(event.timestamp);
+            if (event.name != nullptr) {
+                openZones.push_back(event.name);
+                std::fprintf(file, ",\n{\"name\":\"");
+                WriteEscaped(file, event.name);
+                std::fprintf(file, "\",\"ph\":\"B\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}", buffer->threadId, timestamp);
+            } else if (!openZones.empty()) {
+                openZones.pop_back();
+                std::fprintf(file, ",\n{\"ph\":\"E\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}", buffer->threadId, timestamp);
+            }
+        }
+        double closeTime = toMicroseconds(lastTimestamp);
+        for (size_t i = 0; i < openZones.size(); i++) {
+            std::fprintf(file, ",\n{\"ph\":\"E\",\"pid\":0,\"tid\":%u,\"ts\":%.3f}", buffer->threadId, closeTime);
+        }
+    }
+
+    std::fprintf(file, "\n]}\n");
+    bool success = std::ferror(file) == 0;
+    std::fclose(file);
+    if (!success) {
+        std::cerr << "failed to write trace file: " << path << std::endl;
+    }
+    return success;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define VGE_PROFILER_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define VGE_PROFILER_TSC 1
+#endif
+
+// CPU区段分析器：RAII区段向每线程的无锁环形缓冲写入带时间戳的开始/结束事件，
+// 按需导出为Chrome trace JSON（chrome://tracing或Perfetto打开）
+// CMake选项VGE_ENABLE_PROFILER=OFF时所有宏为空，不产生任何代码
+class Profiler {
+public:
+    static const uint32_t EVENTS_PER_THREAD = 1u << 16;     // 2的幂，写满后覆盖最旧的事件
+
+    struct Event {
+        const char* name;       // 开始事件的区段名（静态字符串），结束事件为nullptr
+        uint64_t timestamp;     // Ticks()，导出时换算为微秒
+    };
+
+    // 单生产者（所属线程）环形缓冲，导出线程只读
+    struct ThreadBuffer {
+        std::atomic<uint64_t> head{0};
+        uint32_t threadId = 0;
+        char name[32] = {};
+        Event events[EVENTS_PER_THREAD];
+    };
+
+    static void SetEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // 设置当前线程在trace中显示的名称
+    static void SetThreadName(const char* name);
+
+    static void BeginZone(const char* name) { Record(name); }
+    static void EndZone() { Record(nullptr); }
+
+    // 导出所有线程缓冲中保留的事件，可在运行中随时调用
+    static bool ExportChromeTrace(const std::string& path);
+
+    static uint64_t Now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 事件时间戳：x86上读TSC（比steady_clock快数倍），导出时按steady_clock校准
+    static uint64_t Ticks() {
+#ifdef VGE_PROFILER_TSC
+        return __rdtsc();
+#else
+        return Now();
+#endif
+    }
+
+private:
+    static void Record(const char* name) {
+        if (!enabled.load(std::memory_order_relaxed)) return;
+        ThreadBuffer* buffer = threadBuffer;
+        if (buffer == nullptr) buffer = RegisterThread();
+        uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        Event& event = buffer->events[head & (EVENTS_PER_THREAD - 1)];
+        event.name = name;
+        event.timestamp = Ticks();
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    static ThreadBuffer* RegisterThread();
+
+    static std::atomic<bool> enabled;
+    static thread_local ThreadBuffer* threadBuffer;
+};
+
+// 作用域区段，析构时写入结束事件
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) { Profiler::BeginZone(name); }
+    ~ProfileZone() { Profiler::EndZone(); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#ifdef VGE_PROFILER
+#define VGE_PROFILE_CONCAT_INNER(a, b) a##b
+#define VGE_PROFILE_CONCAT(a, b) VGE_PROFILE_CONCAT_INNER(a, b)
+#define VGE_PROFILE_ZONE(name) ProfileZone VGE_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define VGE_PROFILE_FUNCTION() VGE_PROFILE_ZONE(__func__)
+#define VGE_PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#else
+#define VGE_PROFILE_ZONE(name) ((void)0)
+#define VGE_PROFILE_FUNCTION() ((void)0)
+#define VGE_PROFILE_THREAD(name) ((void)0)
+#endif
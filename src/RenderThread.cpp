@@ -0,0 +1,127 @@
+#include "RenderThread.hpp"
+#include "VulkanContext.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+RenderThread::RenderThread(VulkanContext* context) : context(context) {}
+
+RenderThread::~RenderThread() {
+    // 析构时不再抛出，异常应由显式调用的Stop传出
+    if (thread.joinable()) {
+        stopRequested.store(true, std::memory_order_relaxed);
+        Wake();
+        thread.join();
+    }
+}
+
+bool RenderThread::Start() {
+    if (thread.joinable()) return true;
+    stopRequested.store(false, std::memory_order_relaxed);
+    failure = nullptr;
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&RenderThread::ThreadMain, this);
+    return true;
+}
+
+void RenderThread::Stop() {
+    if (!thread.joinable()) return;
+    stopRequested.store(true, std::memory_order_relaxed);
+    Wake();
+    thread.join();
+    if (failure) {
+        std::exception_ptr error = failure;
+        failure = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void RenderThread::PostEvent(const WindowEvent& event) {
+    FlushPendingEvents();
+    if (event.type == WindowEvent::EVENT_RESIZE) {
+        // 已有暂存时只更新暂存值，保持与已入队事件的先后顺序
+        lastResize = event;
+        pendingResize = pendingResize || !events.TryPush(event);
+    } else if (event.type == WindowEvent::EVENT_ICONIFY) {
+        lastIconify = event;
+        pendingIconify = pendingIconify || !events.TryPush(event);
+    } else if (!events.TryPush(event)) {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+    Wake();
+}
+
+void RenderThread::FlushPendingEvents() {
+    if (pendingResize && events.TryPush(lastResize)) {
+        pendingResize = false;
+    }
+    if (pendingIconify && events.TryPush(lastIconify)) {
+        pendingIconify = false;
+    }
+}
+
+void RenderThread::Wake() {
+    // 与WaitForEvents中的栅栏配对：要么渲染线程看到新入队的事件，要么这里看到sleeping并通知
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed) || stopRequested.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeCondition.notify_one();
+    }
+}
+
+void RenderThread::ThreadMain() {
+    VGE_PROFILE_THREAD("Render");
+    try {
+        while (!stopRequested.load(std::memory_order_relaxed)) {
+            DrainEvents();
+            if (ShouldPause()) {
+                WaitForEvents();
+                continue;
+            }
+            context->DrawFrame();
+        }
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    running.store(false, std::memory_order_release);
+    // 唤醒在glfwWaitEvents中等待的主线程，使其结束事件循环
+    if (!context->IsHeadless()) {
+        glfwPostEmptyEvent();
+    }
+}
+
+void RenderThread::DrainEvents() {
+    WindowEvent event;
+    while (events.TryPop(event)) {
+        switch (event.type) {
+            case WindowEvent::EVENT_RESIZE:
+                context->SetFramebufferSize(static_cast<uint32_t>(std::max(event.width, 0)),
+                                            static_cast<uint32_t>(std::max(event.height, 0)));
+                break;
+            case WindowEvent::EVENT_ICONIFY:
+                iconified = event.action != 0;
+                break;
+            default:
+                if (eventHandler) eventHandler(event);
+                break;
+        }
+    }
+}
+
+bool RenderThread::ShouldPause() const {
+    return iconified || context->IsMinimized();
+}
+
+void RenderThread::WaitForEvents() {
+    VGE_PROFILE_ZONE("RenderThreadPaused");
+    paused.store(true, std::memory_order_relaxed);
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeCondition.wait(lock, [this]() {
+            return !events.IsEmpty() || stopRequested.load(std::memory_order_relaxed);
+        });
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+    paused.store(false, std::memory_order_relaxed);
+}
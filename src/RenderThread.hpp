@@ -0,0 +1,100 @@
+#pragma once
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class VulkanContext;
+
+// 主线程转发给渲染线程的窗口事件
+struct WindowEvent {
+    enum Type : uint32_t {
+        EVENT_RESIZE = 0,       // width/height为新的帧缓冲尺寸（像素）
+        EVENT_ICONIFY = 1,      // action为1表示最小化，0表示恢复
+        EVENT_KEY = 2,          // key/action/mods同GLFW按键回调
+        EVENT_MOUSE_BUTTON = 3, // key为鼠标按钮，action/mods同GLFW
+        EVENT_CURSOR = 4        // x/y为光标位置
+    };
+
+    Type type = EVENT_RESIZE;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t key = 0;
+    int32_t action = 0;
+    int32_t mods = 0;
+    double x = 0.0;
+    double y = 0.0;
+};
+
+// 渲染线程：独占图形队列与交换链，循环执行VulkanContext::DrawFrame
+// 主线程只处理系统事件，经SPSC队列转发输入和尺寸变化，不再被帧阻塞，事件处理的停顿也不进入帧时间
+// 窗口最小化（帧缓冲为0或收到最小化事件）时渲染线程睡眠等待下一个事件，既不空转也不阻塞主线程
+// 尺寸变化在下一帧开始前合并为一次交换链重建
+class RenderThread {
+public:
+    static const size_t EVENT_QUEUE_CAPACITY = 256;    // 2的幂
+
+    // 在渲染线程上处理输入事件（尺寸与最小化事件由RenderThread自行处理，不传给回调）
+    using EventHandler = std::function<void(const WindowEvent& event)>;
+
+    explicit RenderThread(VulkanContext* context);
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // 须在Start之前设置
+    void SetEventHandler(EventHandler handler) { eventHandler = std::move(handler); }
+
+    // 上下文初始化完成后在主线程调用，此后主线程不应再调用上下文的帧接口
+    bool Start();
+    // 请求停止并等待渲染线程退出；渲染线程因异常退出时在此重新抛出
+    void Stop();
+
+    // 主线程调用；队列满时尺寸与最小化事件暂存，输入事件丢弃并计数
+    void PostEvent(const WindowEvent& event);
+    // 主线程在事件循环中调用：补发暂存的尺寸与最小化事件，仍有暂存时主线程应带超时等待事件
+    void FlushPendingEvents();
+    bool HasPendingEvents() const { return pendingResize || pendingIconify; }
+
+    // 渲染线程仍在运行（异常退出后为false，主线程据此结束事件循环）
+    bool IsRunning() const { return running.load(std::memory_order_acquire); }
+    bool IsPaused() const { return paused.load(std::memory_order_relaxed); }
+    uint64_t GetDroppedEventCount() const { return droppedEvents.load(std::memory_order_relaxed); }
+
+private:
+    void ThreadMain();
+    void DrainEvents();
+    bool ShouldPause() const;
+    void WaitForEvents();
+    void Wake();
+
+    VulkanContext* context;
+    EventHandler eventHandler;
+    std::thread thread;
+    SpscQueue<WindowEvent, EVENT_QUEUE_CAPACITY> events;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> paused{false};
+    std::exception_ptr failure;
+
+    // 暂停时的睡眠：消费者置sleeping后在锁内检查队列，生产者入队后检查sleeping再通知
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> sleeping{false};
+
+    // 渲染线程的窗口状态
+    bool iconified = false;
+
+    // 主线程侧：入队失败的尺寸与最小化状态，只需保留最新值
+    bool pendingResize = false;
+    bool pendingIconify = false;
+    WindowEvent lastResize;
+    WindowEvent lastIconify;
+    std::atomic<uint64_t> droppedEvents{0};
+};
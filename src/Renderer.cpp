@@ -1,9 +1,20 @@
 #include "Renderer.hpp"
 #include "VulkanContext.hpp"
 #include "CommandManager.hpp"
-#include "VulkanUtils.hpp"
+#include "Swapchain.hpp"
+#include "Metrics.hpp"
+#include "PipelineLibrary.hpp"
 #include <stdexcept>
 
+namespace {
+    const char* const VERTEX_SHADER_PATH = "shaders/triangle.vert.spv";
+    const char* const FRAGMENT_SHADER_PATH = "shaders/triangle.frag.spv";
+}
+
+std::vector<const char*> Renderer::GetShaderPaths() {
+    return {VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH};
+}
+
 Renderer::Renderer(VulkanContext* context) : context(context) {
     commandManager = std::make_unique<CommandManager>(context);
 }
@@ -23,155 +34,127 @@ void Renderer::Cleanup() {
     DestroyGraphicsPipeline();
     
     if (renderPass != VK_NULL_HANDLE) {
-        vkDestroyRenderPass(context->GetDevice(), renderPass, nullptr);
+        vkDestroyRenderPass(context->GetDevice(), renderPass, context->GetAllocationCallbacks());
         renderPass = VK_NULL_HANDLE;
     }
     
-    if (vertShaderModule != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(context->GetDevice(), vertShaderModule, nullptr);
-        vertShaderModule = VK_NULL_HANDLE;
-    }
-    
-    if (fragShaderModule != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(context->GetDevice(), fragShaderModule, nullptr);
-        fragShaderModule = VK_NULL_HANDLE;
+    if (resumeRenderPass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(context->GetDevice(), resumeRenderPass, context->GetAllocationCallbacks());
+        resumeRenderPass = VK_NULL_HANDLE;
     }
     
     commandManager.reset();
 }
 
 bool Renderer::CreateRenderPass() {
+    renderPass = CreateRenderPass(false);
+    resumeRenderPass = CreateRenderPass(true);
+    return true;
+}
+
+VkRenderPass Renderer::CreateRenderPass(bool resume) {
+    // 两个渲染通道附件格式一致，可共用帧缓冲；
+    // 第一段结束时深度转为只读布局供Hi-Z计算着色器采样
     VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = VK_FORMAT_B8G8R8A8_SRGB;
+    colorAttachment.format = context->GetSwapchain()->GetImageFormat();
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.initialLayout = resume ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout = resume ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = Swapchain::DEPTH_FORMAT;
+    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp = resume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = resume ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = resume ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout = resume ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 1;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    VkSubpassDependency dependencies[2]{};
+    // 进入：等待上一次对附件的写入以及计算着色器对深度的读取
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                   VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    // 离开：深度写入对Hi-Z构建可见
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    VkAttachmentDescription attachments[] = {colorAttachment, depthAttachment};
 
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.attachmentCount = 2;
+    renderPassInfo.pAttachments = attachments;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 2;
+    renderPassInfo.pDependencies = dependencies;
 
-    if (vkCreateRenderPass(context->GetDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+    VkRenderPass result;
+    if (vkCreateRenderPass(context->GetDevice(), &renderPassInfo, context->GetAllocationCallbacks(), &result) != VK_SUCCESS) {
         throw std::runtime_error("failed to create render pass!");
     }
-    return true;
+    return result;
 }
 
 bool Renderer::CreateGraphicsPipeline() {
-    auto vertShaderCode = VulkanUtils::ReadFile("shaders/triangle.vert.spv");
-    auto fragShaderCode = VulkanUtils::ReadFile("shaders/triangle.frag.spv");
-
-    vertShaderModule = VulkanUtils::CreateShaderModule(context->GetDevice(), vertShaderCode);
-    fragShaderModule = VulkanUtils::CreateShaderModule(context->GetDevice(), fragShaderCode);
-
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.scissorCount = 1;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = 0;
     pipelineLayoutInfo.pushConstantRangeCount = 0;
 
-    if (vkCreatePipelineLayout(context->GetDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+    if (vkCreatePipelineLayout(context->GetDevice(), &pipelineLayoutInfo, context->GetAllocationCallbacks(), &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
     }
 
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.layout = pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
-    pipelineInfo.subpass = 0;
-
-    if (vkCreateGraphicsPipelines(context->GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create graphics pipeline!");
-    }
+    // 两段渲染通道兼容，同一管线可在二者中使用；固定功能状态取RasterState默认值
+    pipelineDesc.vertexShader = VERTEX_SHADER_PATH;
+    pipelineDesc.fragmentShader = FRAGMENT_SHADER_PATH;
+    pipelineDesc.layout = pipelineLayout;
+    pipelineDesc.renderPass = renderPass;
+    pipelineDesc.subpass = 0;
+    pipelineDesc.colorAttachmentCount = 1;
+    pipelineDesc.vertexLayout = VERTEX_LAYOUT_NONE;
+    graphicsPipeline = context->GetPipelineLibrary()->GetPipeline(pipelineDesc);
 
     return true;
 }
 
 void Renderer::DestroyGraphicsPipeline() {
-    if (graphicsPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(context->GetDevice(), graphicsPipeline, nullptr);
-        graphicsPipeline = VK_NULL_HANDLE;
-    }
+    // 管线归PipelineLibrary所有
+    graphicsPipeline = VK_NULL_HANDLE;
     
     if (pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(context->GetDevice(), pipelineLayout, nullptr);
+        vkDestroyPipelineLayout(context->GetDevice(), pipelineLayout, context->GetAllocationCallbacks());
         pipelineLayout = VK_NULL_HANDLE;
     }
 }
@@ -190,11 +173,24 @@ void Renderer::BeginRenderPass(VkCommandBuffer commandBuffer) {
     renderPassInfo.renderPass = renderPass;
     renderPassInfo.framebuffer = context->GetCurrentFramebuffer();
     renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = context->GetSwapchainExtent();
+    renderPassInfo.renderArea.extent = context->GetRenderExtent();
+
+    VkClearValue clearValues[2]{};
+    clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    clearValues[1].depthStencil = {1.0f, 0};
+    renderPassInfo.clearValueCount = 2;
+    renderPassInfo.pClearValues = clearValues;
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
 
-    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
+void Renderer::BeginResumeRenderPass(VkCommandBuffer commandBuffer) {
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = resumeRenderPass;
+    renderPassInfo.framebuffer = context->GetCurrentFramebuffer();
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = context->GetRenderExtent();
 
     vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 }
@@ -204,13 +200,21 @@ void Renderer::EndRenderPass(VkCommandBuffer commandBuffer) {
 }
 
 void Renderer::DrawTriangle(VkCommandBuffer commandBuffer) {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    context->GetPipelineLibrary()->Bind(commandBuffer, graphicsPipeline, pipelineDesc);
+
+    // 视口和裁剪是动态状态，按本帧渲染尺寸设置（动态分辨率下为帧缓冲左上角的子矩形）
+    VkExtent2D extent = context->GetRenderExtent();
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    VkRect2D scissor{};
+    scissor.extent = extent;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-}
-
-void Renderer::OnWindowResize() {
-    // 重新创建交换链和帧缓冲
-    context->RecreateSwapchain();
+    context->GetMetrics()->Add(Metrics::DRAW_CALLS);
 }
 
 VkCommandBuffer Renderer::GetCurrentCommandBuffer() {
@@ -1,6 +1,8 @@
 #pragma once
-#include <vulkan/vulkan.h>
+#include "VulkanLoader.hpp"
+#include "PipelineLibrary.hpp"
 #include <memory>
+#include <vector>
 
 class VulkanContext;
 class CommandManager;
@@ -10,21 +12,26 @@ public:
     Renderer(VulkanContext* context);
     ~Renderer();
     
+    // 渲染通道格式固定，不依赖交换链，可与交换链创建并行初始化；
+    // 视口与裁剪为动态状态，渲染器不持有与尺寸相关的对象，窗口尺寸变化时无需重建
     bool Initialize();
     void Cleanup();
     
+    // 初始化时读取的着色器，启动阶段据此提前读入
+    static std::vector<const char*> GetShaderPaths();
+    
     // 渲染循环
     void BeginFrame();
     void EndFrame();
     
     // 渲染命令
+    // 帧内分两段渲染：第一段清除并绘制上一帧可见的物体，构建Hi-Z后
+    // 第二段（BeginResumeRenderPass）保留颜色和深度，绘制新出现的物体
     void BeginRenderPass(VkCommandBuffer commandBuffer);
+    void BeginResumeRenderPass(VkCommandBuffer commandBuffer);
     void EndRenderPass(VkCommandBuffer commandBuffer);
     void DrawTriangle(VkCommandBuffer commandBuffer);
     
-    // 窗口大小变化处理
-    void OnWindowResize();
-    
     // Getter方法
     VkCommandBuffer GetCurrentCommandBuffer();
     VkRenderPass GetRenderPass() const { return renderPass; }
@@ -35,14 +42,13 @@ private:
     
     // 渲染相关
     VkRenderPass renderPass = VK_NULL_HANDLE;
+    VkRenderPass resumeRenderPass = VK_NULL_HANDLE;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
     VkPipeline graphicsPipeline = VK_NULL_HANDLE;
-    
-    // 着色器
-    VkShaderModule vertShaderModule = VK_NULL_HANDLE;
-    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    PipelineDesc pipelineDesc;
     
     bool CreateRenderPass();
+    VkRenderPass CreateRenderPass(bool resume);
     bool CreateGraphicsPipeline();
     void DestroyGraphicsPipeline();
 }; 
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "Scene.hpp"
+#include "FrameAllocator.hpp"
+#include "Profiler.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VGE_SCENE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define VGE_SCENE_SSE 1
+#endif
+
+namespace {
+    // 层级节点数超过该值时分给工作线程
+    const uint32_t PARALLEL_THRESHOLD = 8192;
+    const uint32_t PARALLEL_GRAIN = 2048;
+
+#if defined(VGE_SCENE_AVX)
+    inline __m256 MultiplyAdd(__m256 a, __m256 b, __m256 c) {
+#if defined(__FMA__)
+        return _mm256_fmadd_ps(a, b, c);
+#else
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+    }
+#endif
+}
+
+Scene::Scene() {}
+
+void Scene::MultiplyMatrices(const Mat4& parent, const Mat4& local, Mat4& result) {
+#if defined(VGE_SCENE_AVX)
+    // 一次计算两列：两个128位通道分别对应local的第j列和第j+1列
+    __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent.m[0]));
+    __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent.m[4]));
+    __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent.m[8]));
+    __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&parent.m[12]));
+    for (int column = 0; column < 4; column += 2) {
+        __m256 b = _mm256_loadu_ps(&local.m[column * 4]);
+        __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b, 0x00));
+        r = MultiplyAdd(a1, _mm256_permute_ps(b, 0x55), r);
+        r = MultiplyAdd(a2, _mm256_permute_ps(b, 0xAA), r);
+        r = MultiplyAdd(a3, _mm256_permute_ps(b, 0xFF), r);
+        _mm256_storeu_ps(&result.m[column * 4], r);
+    }
+#elif defined(VGE_SCENE_SSE)
+    __m128 a0 = _mm_load_ps(&parent.m[0]);
+    __m128 a1 = _mm_load_ps(&parent.m[4]);
+    __m128 a2 = _mm_load_ps(&parent.m[8]);
+    __m128 a3 = _mm_load_ps(&parent.m[12]);
+    for (int column = 0; column < 4; column++) {
+        __m128 b = _mm_load_ps(&local.m[column * 4]);
+        __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_store_ps(&result.m[column * 4], r);
+    }
+#else
+    MultiplyMat4(parent, local, result);
+#endif
+}
+
+NodeHandle Scene::CreateNode(NodeHandle parent) {
+    return CreateNode(parent, Transform{});
+}
+
+NodeHandle Scene::CreateNode(NodeHandle parent, const Transform& local) {
+    NodeHandle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        handle = static_cast<NodeHandle>(handleToIndex.size());
+        handleToIndex.push_back(0);
+    }
+
+    // 新节点追加在末尾，下次更新时再按层级整理
+    uint32_t index = static_cast<uint32_t>(parents.size());
+    handleToIndex[handle] = index;
+    indexToHandle.push_back(handle);
+    parents.push_back(IsValid(parent) ? handleToIndex[parent] : INVALID_NODE);
+    localMatrices.push_back(local.ToMatrix());
+    worldMatrices.push_back(Mat4::Identity());
+    localBounds.push_back(AABB{});
+    worldBounds.push_back(AABB{});
+    hasBounds.push_back(0);
+    localDirty.push_back(1);
+    changed.push_back(0);
+    removed.push_back(0);
+
+    // 追加到末尾时父节点仍在子节点之前，但层级不再连续
+    structureDirty = true;
+    anyDirty = true;
+    return handle;
+}
+
+void Scene::DestroyNode(NodeHandle node) {
+    if (!IsValid(node)) return;
+    removed[handleToIndex[node]] = 1;
+    structureDirty = true;
+}
+
+bool Scene::IsValid(NodeHandle node) const {
+    if (node >= handleToIndex.size()) return false;
+    uint32_t index = handleToIndex[node];
+    return index != INVALID_NODE && !removed[index];
+}
+
+void Scene::SetParent(NodeHandle node, NodeHandle parent) {
+    if (!IsValid(node)) return;
+    uint32_t index = handleToIndex[node];
+    uint32_t parentIndex = IsValid(parent) ? handleToIndex[parent] : INVALID_NODE;
+
+    // 不允许把节点挂到自己的子树下
+    for (uint32_t ancestor = parentIndex; ancestor != INVALID_NODE; ancestor = parents[ancestor]) {
+        if (ancestor == index) return;
+    }
+
+    parents[index] = parentIndex;
+    localDirty[index] = 1;
+    anyDirty = true;
+    structureDirty = true;
+}
+
+void Scene::SetLocalTransform(NodeHandle node, const Transform& local) {
+    SetLocalMatrix(node, local.ToMatrix());
+}
+
+void Scene::SetLocalMatrix(NodeHandle node, const Mat4& local) {
+    uint32_t index = handleToIndex[node];
+    localMatrices[index] = local;
+    localDirty[index] = 1;
+    anyDirty = true;
+}
+
+const Mat4& Scene::GetLocalMatrix(NodeHandle node) const {
+    return localMatrices[handleToIndex[node]];
+}
+
+const Mat4& Scene::GetWorldMatrix(NodeHandle node) const {
+    return worldMatrices[handleToIndex[node]];
+}
+
+NodeHandle Scene::GetParent(NodeHandle node) const {
+    uint32_t parent = parents[handleToIndex[node]];
+    return parent != INVALID_NODE ? indexToHandle[parent] : INVALID_NODE;
+}
+
+void Scene::SetLocalBounds(NodeHandle node, const AABB& bounds) {
+    uint32_t index = handleToIndex[node];
+    if (!hasBounds[index]) {
+        // 参与剔除的节点集合变化
+        hasBounds[index] = 1;
+        structureDirty = true;
+    }
+    localBounds[index] = bounds;
+    localDirty[index] = 1;
+    anyDirty = true;
+}
+
+void Scene::ClearLocalBounds(NodeHandle node) {
+    uint32_t index = handleToIndex[node];
+    if (hasBounds[index]) {
+        hasBounds[index] = 0;
+        structureDirty = true;
+    }
+}
+
+void Scene::RebuildHierarchy() {
+    uint32_t count = GetNodeCount();
+
+    // 排序用的临时数组取自帧线性区，只有重排后的节点数据进入成员数组
+    std::pmr::memory_resource* frameMemory = FrameAllocator::GetResource();
+
+    // 计算深度并向下传播删除标记（沿父链回溯，结果缓存）
+    std::pmr::vector<int32_t> depth(count, -1, frameMemory);
+    std::pmr::vector<uint8_t> dead(count, 0, frameMemory);
+    std::pmr::vector<uint32_t> stack(frameMemory);
+    for (uint32_t i = 0; i < count; i++) {
+        if (depth[i] >= 0) continue;
+        uint32_t current = i;
+        while (current != INVALID_NODE && depth[current] < 0) {
+            stack.push_back(current);
+            current = parents[current];
+        }
+        int32_t baseDepth = current != INVALID_NODE ? depth[current] : -1;
+        uint8_t baseDead = current != INVALID_NODE ? dead[current] : 0;
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+            depth[node] = ++baseDepth;
+            baseDead = baseDead | removed[node];
+            dead[node] = baseDead;
+        }
+    }
+
+    // 按深度稳定计数排序
+    std::pmr::vector<uint32_t> levelCounts(frameMemory);
+    for (uint32_t i = 0; i < count; i++) {
+        if (dead[i]) continue;
+        if (static_cast<int32_t>(levelCounts.size()) <= depth[i]) {
+            levelCounts.resize(depth[i] + 1, 0);
+        }
+        levelCounts[depth[i]]++;
+    }
+
+    levelStart.assign(levelCounts.size() + 1, 0);
+    for (size_t level = 0; level < levelCounts.size(); level++) {
+        levelStart[level + 1] = levelStart[level] + levelCounts[level];
+    }
+
+    std::pmr::vector<uint32_t> newIndex(count, INVALID_NODE, frameMemory);
+    std::pmr::vector<uint32_t> cursor(levelStart.begin(), levelStart.end() - 1, frameMemory);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!dead[i]) {
+            newIndex[i] = cursor[depth[i]]++;
+        }
+    }
+
+    uint32_t liveCount = levelStart.back();
+    std::vector<uint32_t> newParents(liveCount);
+    std::vector<Mat4> newLocal(liveCount);
+    std::vector<Mat4> newWorld(liveCount);
+    std::vector<AABB> newLocalBounds(liveCount);
+    std::vector<AABB> newWorldBounds(liveCount);
+    std::vector<uint8_t> newHasBounds(liveCount);
+    std::vector<uint8_t> newDirty(liveCount);
+    std::vector<NodeHandle> newHandles(liveCount);
+    for (uint32_t i = 0; i < count; i++) {
+        NodeHandle handle = indexToHandle[i];
+        if (dead[i]) {
+            handleToIndex[handle] = INVALID_NODE;
+            freeHandles.push_back(handle);
+            continue;
+        }
+        uint32_t target = newIndex[i];
+        newParents[target] = parents[i] != INVALID_NODE ? newIndex[parents[i]] : INVALID_NODE;
+        newLocal[target] = localMatrices[i];
+        newWorld[target] = worldMatrices[i];
+        newLocalBounds[target] = localBounds[i];
+        newWorldBounds[target] = worldBounds[i];
+        newHasBounds[target] = hasBounds[i];
+        newDirty[target] = localDirty[i];
+        newHandles[target] = handle;
+        handleToIndex[handle] = target;
+    }
+
+    parents.swap(newParents);
+    localMatrices.swap(newLocal);
+    worldMatrices.swap(newWorld);
+    localBounds.swap(newLocalBounds);
+    worldBounds.swap(newWorldBounds);
+    hasBounds.swap(newHasBounds);
+    localDirty.swap(newDirty);
+    indexToHandle.swap(newHandles);
+    changed.assign(liveCount, 0);
+    removed.assign(liveCount, 0);
+    changedCount = 0;
+
+    structureDirty = false;
+    structureVersion++;
+}
+
+void Scene::UpdateWorldMatrices() {
+    VGE_PROFILE_FUNCTION();
+    if (structureDirty) {
+        RebuildHierarchy();
+    }
+
+    if (!anyDirty) {
+        // 上一次的变化标记只保留一帧
+        if (changedCount > 0) {
+            std::memset(changed.data(), 0, changed.size());
+            changedCount = 0;
+        }
+        return;
+    }
+
+    std::atomic<uint32_t> totalChanged{0};
+    for (uint32_t level = 0; level + 1 < levelStart.size(); level++) {
+        uint32_t begin = levelStart[level];
+        uint32_t count = levelStart[level + 1] - begin;
+
+        // 同一层级的节点只依赖上一层级，互不依赖
+        if (jobSystem != nullptr && count >= PARALLEL_THRESHOLD) {
+            jobSystem->ParallelFor(count, PARALLEL_GRAIN, [this, begin, &totalChanged](uint32_t rangeBegin, uint32_t rangeEnd) {
+                totalChanged += UpdateRange(begin + rangeBegin, begin + rangeEnd);
+            });
+        } else {
+            totalChanged += UpdateRange(begin, begin + count);
+        }
+    }
+
+    changedCount = totalChanged.load();
+    anyDirty = false;
+}
+
+uint32_t Scene::UpdateRange(uint32_t begin, uint32_t end) {
+    uint32_t changedInRange = 0;
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t parent = parents[i];
+        bool needsUpdate = localDirty[i] || (parent != INVALID_NODE && changed[parent]);
+        changed[i] = needsUpdate ? 1 : 0;
+        if (!needsUpdate) continue;
+
+        if (parent == INVALID_NODE) {
+            worldMatrices[i] = localMatrices[i];
+        } else {
+            MultiplyMatrices(worldMatrices[parent], localMatrices[i], worldMatrices[i]);
+        }
+        if (hasBounds[i]) {
+            worldBounds[i] = TransformAABB(worldMatrices[i], localBounds[i]);
+        }
+        localDirty[i] = 0;
+        changedInRange++;
+    }
+    return changedInRange;
+}
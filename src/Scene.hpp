@@ -0,0 +1,91 @@
+#pragma once
+#include "MathTypes.hpp"
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+using NodeHandle = uint32_t;
+const NodeHandle INVALID_NODE = UINT32_MAX;
+
+// 面向数据的场景层级：节点以SoA形式存放在连续数组中，按层级深度排序，
+// 父节点总在子节点之前。世界矩阵按层级逐层更新，同一层级内可并行，
+// 只有局部变换被修改的节点及其子孙会被重新计算
+class Scene {
+public:
+    Scene();
+
+    void SetJobSystem(JobSystem* jobSystem) { this->jobSystem = jobSystem; }
+
+    NodeHandle CreateNode(NodeHandle parent = INVALID_NODE);
+    NodeHandle CreateNode(NodeHandle parent, const Transform& local);
+
+    // 销毁节点及其子树，子孙节点在下次UpdateWorldMatrices时释放
+    void DestroyNode(NodeHandle node);
+    void SetParent(NodeHandle node, NodeHandle parent);
+    bool IsValid(NodeHandle node) const;
+
+    void SetLocalTransform(NodeHandle node, const Transform& local);
+    void SetLocalMatrix(NodeHandle node, const Mat4& local);
+    const Mat4& GetLocalMatrix(NodeHandle node) const;
+    const Mat4& GetWorldMatrix(NodeHandle node) const;
+    NodeHandle GetParent(NodeHandle node) const;
+
+    // 可选的局部包围盒，设置后节点参与可见性剔除
+    void SetLocalBounds(NodeHandle node, const AABB& bounds);
+    void ClearLocalBounds(NodeHandle node);
+
+    // 增量更新世界矩阵（必要时先整理层级顺序）
+    void UpdateWorldMatrices();
+
+    // 密集数组访问，按层级拓扑顺序排列
+    uint32_t GetNodeCount() const { return static_cast<uint32_t>(parents.size()); }
+    uint32_t GetLevelCount() const { return levelStart.empty() ? 0 : static_cast<uint32_t>(levelStart.size() - 1); }
+    const Mat4* GetLocalMatrices() const { return localMatrices.data(); }
+    const Mat4* GetWorldMatrices() const { return worldMatrices.data(); }
+    const uint32_t* GetParentIndices() const { return parents.data(); }
+    const uint8_t* GetChangedFlags() const { return changed.data(); }     // 上次更新中世界矩阵是否改变
+    const AABB* GetLocalBounds() const { return localBounds.data(); }
+    const AABB* GetWorldBounds() const { return worldBounds.data(); }
+    const uint8_t* GetBoundsFlags() const { return hasBounds.data(); }
+    uint32_t GetChangedCount() const { return changedCount; }
+    uint32_t GetIndex(NodeHandle node) const { return handleToIndex[node]; }
+    NodeHandle GetHandle(uint32_t index) const { return indexToHandle[index]; }
+    // 句柄到密集索引的映射（已释放的句柄为INVALID_NODE），更新后与密集数组一致
+    uint32_t GetHandleCount() const { return static_cast<uint32_t>(handleToIndex.size()); }
+    const uint32_t* GetHandleIndices() const { return handleToIndex.data(); }
+
+    // 密集索引重排或带包围盒的节点集合变化时递增，外部按索引缓存的数据需要据此失效
+    uint64_t GetStructureVersion() const { return structureVersion; }
+
+    // 矩阵乘法内核（SSE/AVX），result = parent * local
+    static void MultiplyMatrices(const Mat4& parent, const Mat4& local, Mat4& result);
+
+private:
+    void RebuildHierarchy();
+    uint32_t UpdateRange(uint32_t begin, uint32_t end);
+
+    JobSystem* jobSystem = nullptr;
+
+    // SoA节点数据，按密集索引
+    std::vector<uint32_t> parents;          // 父节点的密集索引
+    std::vector<Mat4> localMatrices;
+    std::vector<Mat4> worldMatrices;
+    std::vector<AABB> localBounds;
+    std::vector<AABB> worldBounds;
+    std::vector<uint8_t> hasBounds;
+    std::vector<uint8_t> localDirty;
+    std::vector<uint8_t> changed;
+    std::vector<uint8_t> removed;
+    std::vector<NodeHandle> indexToHandle;
+    std::vector<uint32_t> levelStart;       // 每个层级在数组中的起始位置
+
+    // 句柄到密集索引的映射，句柄在节点生命周期内保持不变
+    std::vector<uint32_t> handleToIndex;
+    std::vector<NodeHandle> freeHandles;
+
+    bool structureDirty = false;
+    bool anyDirty = false;
+    uint32_t changedCount = 0;
+    uint64_t structureVersion = 0;
+};
@@ -0,0 +1,51 @@
+#include "SceneCuller.hpp"
+#include "Profiler.hpp"
+#include "Scene.hpp"
+
+SceneCuller::SceneCuller(Scene* scene, JobSystem* jobSystem)
+    : scene(scene), jobSystem(jobSystem) {
+}
+
+void SceneCuller::Update() {
+    VGE_PROFILE_FUNCTION();
+    if (scene->GetStructureVersion() != builtVersion || bvh.NeedsRebuild()) {
+        Rebuild();
+        return;
+    }
+    if (scene->GetChangedCount() == 0) return;
+
+    const uint8_t* changed = scene->GetChangedFlags();
+    const uint8_t* hasBounds = scene->GetBoundsFlags();
+    const AABB* worldBounds = scene->GetWorldBounds();
+    uint32_t count = scene->GetNodeCount();
+    for (uint32_t i = 0; i < count; i++) {
+        if (changed[i] && hasBounds[i]) {
+            bvh.UpdateItem(i, worldBounds[i]);
+        }
+    }
+    bvh.Refit();
+}
+
+void SceneCuller::Rebuild() {
+    const uint8_t* hasBounds = scene->GetBoundsFlags();
+    const AABB* worldBounds = scene->GetWorldBounds();
+    uint32_t count = scene->GetNodeCount();
+
+    buildIds.clear();
+    buildBounds.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        if (hasBounds[i]) {
+            buildIds.push_back(i);
+            buildBounds.push_back(worldBounds[i]);
+        }
+    }
+
+    bvh.Build(buildIds.data(), buildBounds.data(), static_cast<uint32_t>(buildIds.size()));
+    builtVersion = scene->GetStructureVersion();
+    rebuildCount++;
+}
+
+void SceneCuller::Cull(const Mat4& viewProjection, std::vector<uint32_t>& visibleIndices) const {
+    VGE_PROFILE_FUNCTION();
+    bvh.Cull(Frustum::FromViewProjection(viewProjection), visibleIndices, jobSystem);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Bvh.hpp"
+#include <cstdint>
+#include <vector>
+
+class Scene;
+class JobSystem;
+
+// 场景的CPU可见性剔除：对带包围盒的节点维护BVH，
+// 节点移动时增量refit，层级重排或质量下降时重建
+class SceneCuller {
+public:
+    SceneCuller(Scene* scene, JobSystem* jobSystem);
+
+    // 在Scene::UpdateWorldMatrices之后每帧调用一次
+    void Update();
+
+    // 输出可见节点的密集索引，可直接索引Scene::GetWorldMatrices()录制绘制命令
+    void Cull(const Mat4& viewProjection, std::vector<uint32_t>& visibleIndices) const;
+
+    const Bvh& GetBvh() const { return bvh; }
+    uint32_t GetRebuildCount() const { return rebuildCount; }
+
+private:
+    void Rebuild();
+
+    Scene* scene;
+    JobSystem* jobSystem;
+    Bvh bvh;
+    uint64_t builtVersion = UINT64_MAX;
+    uint32_t rebuildCount = 0;
+
+    std::vector<uint32_t> buildIds;
+    std::vector<AABB> buildBounds;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+// 单生产者单消费者的无锁有界队列：槽位内联存放，不分配内存
+// 生产者与消费者各自缓存对方的位置，只在看起来满/空时才读取对方的原子量
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue elements must be trivially copyable");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 仅生产者线程调用，队列满时返回false
+    bool TryPush(const T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead == Capacity) return false;
+        }
+        slots[position & (Capacity - 1)] = value;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅消费者线程调用，队列空时返回false
+    bool TryPop(T& value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail) return false;
+        }
+        value = slots[position & (Capacity - 1)];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 任意线程可调用，结果只是瞬时状态
+    bool IsEmpty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    // 生产者与消费者写入的数据分属不同缓存行
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    alignas(64) T slots[Capacity];
+};
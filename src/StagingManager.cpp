@@ -0,0 +1,192 @@
+#include "StagingManager.hpp"
+#include "VulkanContext.hpp"
+#include "MemoryManager.hpp"
+#include "Metrics.hpp"
+#include <stdexcept>
+
+StagingManager::StagingManager(VulkanContext* context) : context(context) {}
+
+StagingManager::~StagingManager() {
+    Cleanup();
+}
+
+bool StagingManager::Initialize(VkDeviceSize ringCapacity) {
+    capacity = ringCapacity;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = capacity;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    VmaAllocationInfo allocationInfo{};
+    if (context->GetMemoryManager()->CreateBuffer(bufferInfo, allocInfo, &buffer, &allocation, &allocationInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create staging buffer!");
+    }
+    mappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = context->GetGraphicsQueueFamily();
+
+    if (vkCreateCommandPool(context->GetDevice(), &poolInfo, context->GetAllocationCallbacks(), &commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create staging command pool!");
+    }
+
+    batches.resize(BATCH_COUNT);
+    std::vector<VkCommandBuffer> commandBuffers(BATCH_COUNT);
+
+    VkCommandBufferAllocateInfo cmdAllocInfo{};
+    cmdAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdAllocInfo.commandPool = commandPool;
+    cmdAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdAllocInfo.commandBufferCount = BATCH_COUNT;
+
+    if (vkAllocateCommandBuffers(context->GetDevice(), &cmdAllocInfo, commandBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate staging command buffers!");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    for (int i = 0; i < BATCH_COUNT; i++) {
+        batches[i].commandBuffer = commandBuffers[i];
+        if (vkCreateFence(context->GetDevice(), &fenceInfo, context->GetAllocationCallbacks(), &batches[i].fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create staging fence!");
+        }
+    }
+    return true;
+}
+
+void StagingManager::Cleanup() {
+    if (commandPool == VK_NULL_HANDLE) {
+        return;
+    }
+
+    WaitIdle();
+
+    for (auto& batch : batches) {
+        vkDestroyFence(context->GetDevice(), batch.fence, context->GetAllocationCallbacks());
+    }
+    batches.clear();
+
+    vkDestroyCommandPool(context->GetDevice(), commandPool, context->GetAllocationCallbacks());
+    commandPool = VK_NULL_HANDLE;
+
+    if (buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(context->GetAllocator(), buffer, allocation);
+        buffer = VK_NULL_HANDLE;
+        allocation = VK_NULL_HANDLE;
+        mappedData = nullptr;
+    }
+}
+
+bool StagingManager::Allocate(VkDeviceSize size, VkDeviceSize alignment, StagingRegion& region) {
+    if (size > capacity) {
+        return false;
+    }
+
+    uint64_t offset = (ringHead + alignment - 1) / alignment * alignment;
+    if (offset % capacity + size > capacity) {
+        // 剩余尾部放不下，从环形缓冲区开头重新开始
+        offset = (offset / capacity + 1) * capacity;
+    }
+
+    if (offset + size - ringTail > capacity) {
+        return false;
+    }
+
+    ringHead = offset + size;
+    region.buffer = buffer;
+    region.offset = offset % capacity;
+    region.mapped = mappedData + region.offset;
+    context->GetMetrics()->Add(Metrics::BYTES_UPLOADED, size);
+    return true;
+}
+
+VkCommandBuffer StagingManager::GetCommandBuffer() {
+    Batch& batch = batches[currentBatch];
+
+    if (!recording) {
+        if (batch.inFlight) {
+            // 所有批次都在GPU上，等待最早的批次
+            vkWaitForFences(context->GetDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+            RetireBatch(batch);
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkResetCommandBuffer(batch.commandBuffer, 0);
+        if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin staging command buffer!");
+        }
+        recording = true;
+    }
+    return batch.commandBuffer;
+}
+
+uint64_t StagingManager::Submit() {
+    if (!recording) {
+        return 0;
+    }
+
+    Batch& batch = batches[currentBatch];
+    if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record staging command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+    vkResetFences(context->GetDevice(), 1, &batch.fence);
+    if (vkQueueSubmit(context->GetGraphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit staging commands!");
+    }
+    context->GetMetrics()->Add(Metrics::COMMAND_BUFFER_SUBMITS);
+
+    batch.id = nextBatchId++;
+    batch.ringEnd = ringHead;
+    batch.inFlight = true;
+    recording = false;
+    currentBatch = (currentBatch + 1) % batches.size();
+    return batch.id;
+}
+
+void StagingManager::Update() {
+    // 批次按提交顺序完成，从最早的批次开始回收
+    for (size_t i = 0; i < batches.size(); i++) {
+        Batch& batch = batches[(currentBatch + i) % batches.size()];
+        if (!batch.inFlight) continue;
+        if (vkGetFenceStatus(context->GetDevice(), batch.fence) != VK_SUCCESS) break;
+        RetireBatch(batch);
+    }
+}
+
+void StagingManager::WaitIdle() {
+    Submit();
+    for (size_t i = 0; i < batches.size(); i++) {
+        Batch& batch = batches[(currentBatch + i) % batches.size()];
+        if (!batch.inFlight) continue;
+        vkWaitForFences(context->GetDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        RetireBatch(batch);
+    }
+}
+
+void StagingManager::RetireBatch(Batch& batch) {
+    batch.inFlight = false;
+    if (batch.ringEnd > ringTail) {
+        ringTail = batch.ringEnd;
+    }
+    if (batch.id > completedBatch) {
+        completedBatch = batch.id;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include "vk_mem_alloc.h"
+#include <vector>
+
+class VulkanContext;
+
+// 环形暂存缓冲区中的一段区域
+struct StagingRegion {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    void* mapped = nullptr;
+};
+
+// 异步上传通道：主机可见的环形暂存缓冲 + 按批次提交的传输命令
+class StagingManager {
+public:
+    StagingManager(VulkanContext* context);
+    ~StagingManager();
+
+    bool Initialize(VkDeviceSize capacity = 64ull * 1024 * 1024);
+    void Cleanup();
+
+    // 在当前批次中分配暂存空间，环形缓冲已满时返回false
+    bool Allocate(VkDeviceSize size, VkDeviceSize alignment, StagingRegion& region);
+
+    // 当前批次的命令缓冲区（首次调用时开始录制）
+    VkCommandBuffer GetCommandBuffer();
+
+    // 提交当前批次，返回批次ID（没有录制内容时返回0）
+    uint64_t Submit();
+
+    // 回收已完成批次占用的暂存空间
+    void Update();
+    void WaitIdle();
+
+    bool IsComplete(uint64_t batchId) const { return batchId <= completedBatch; }
+    VkDeviceSize GetCapacity() const { return capacity; }
+    VkDeviceSize GetAvailable() const { return capacity - (ringHead - ringTail); }
+
+private:
+    VulkanContext* context;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    uint8_t* mappedData = nullptr;
+    VkDeviceSize capacity = 0;
+
+    // 单调递增的虚拟偏移，物理偏移为 offset % capacity
+    uint64_t ringHead = 0;
+    uint64_t ringTail = 0;
+
+    struct Batch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        uint64_t id = 0;
+        uint64_t ringEnd = 0;
+        bool inFlight = false;
+    };
+    static const int BATCH_COUNT = 4;
+    std::vector<Batch> batches;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    size_t currentBatch = 0;
+    bool recording = false;
+    uint64_t nextBatchId = 1;
+    uint64_t completedBatch = 0;
+
+    void RetireBatch(Batch& batch);
+};
@@ -0,0 +1,188 @@
+#include "StartupGraph.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+StartupGraph::TaskId StartupGraph::Add(const char* name, std::function<bool()> func,
+                                       std::initializer_list<TaskId> dependencies, bool mainThread) {
+    TaskId id = static_cast<TaskId>(tasks.size());
+    Task task;
+    task.name = name;
+    task.func = std::move(func);
+    task.mainThread = mainThread;
+    // 依赖只能引用已添加的任务，因此添加顺序即拓扑序
+    for (TaskId dependency : dependencies) {
+        if (dependency < id) {
+            task.dependencies.push_back(dependency);
+            tasks[dependency].dependents.push_back(id);
+        }
+    }
+    tasks.push_back(std::move(task));
+    return id;
+}
+
+double StartupGraph::Elapsed() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool StartupGraph::Run(JobSystem* jobSystemToUse) {
+    VGE_PROFILE_FUNCTION();
+    jobSystem = jobSystemToUse;
+    startTime = std::chrono::steady_clock::now();
+    finishedCount = 0;
+    mainQueue.clear();
+    firstException = nullptr;
+
+    std::vector<TaskId> ready;
+    for (TaskId id = 0; id < tasks.size(); id++) {
+        Task& task = tasks[id];
+        task.remaining = static_cast<uint32_t>(task.dependencies.size());
+        task.state = STATE_PENDING;
+        task.anyDependencyFailed = false;
+        if (task.remaining == 0) ready.push_back(id);
+    }
+    Dispatch(ready);
+
+    // 调用线程执行主线程任务，其余时间等待工作线程完成
+    std::unique_lock<std::mutex> lock(mutex);
+    while (finishedCount < tasks.size()) {
+        if (!mainQueue.empty()) {
+            TaskId id = mainQueue.front();
+            mainQueue.erase(mainQueue.begin());
+            lock.unlock();
+            Execute(id);
+            lock.lock();
+            continue;
+        }
+        condition.wait(lock);
+    }
+    lock.unlock();
+
+    // 最后一个工作任务可能仍在返回途中
+    if (jobSystem != nullptr) jobSystem->WaitIdle();
+    wallMilliseconds = Elapsed();
+
+    if (firstException) std::rethrow_exception(firstException);
+    for (const Task& task : tasks) {
+        if (task.state != STATE_DONE) return false;
+    }
+    return true;
+}
+
+void StartupGraph::Dispatch(const std::vector<TaskId>& ready) {
+    bool queuedMain = false;
+    for (TaskId id : ready) {
+        if (tasks[id].mainThread || jobSystem == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            mainQueue.push_back(id);
+            queuedMain = true;
+        } else {
+            jobSystem->Submit([this, id]() { Execute(id); });
+        }
+    }
+    if (queuedMain) condition.notify_all();
+}
+
+void StartupGraph::Execute(TaskId id) {
+    Task& task = tasks[id];
+    task.threadIndex = JobSystem::GetThreadIndex();
+    task.startMilliseconds = Elapsed();
+
+    bool succeeded = false;
+    std::exception_ptr exception;
+    {
+        VGE_PROFILE_ZONE(task.name);
+        // 工作线程上的异常会终止进程，捕获后交给Run在调用线程重新抛出
+        try {
+            succeeded = task.func();
+        } catch (...) {
+            exception = std::current_exception();
+        }
+    }
+
+    std::vector<TaskId> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task.endMilliseconds = Elapsed();
+        if (exception && !firstException) firstException = exception;
+        Complete(id, succeeded ? STATE_DONE : STATE_FAILED, ready);
+    }
+    condition.notify_all();
+    Dispatch(ready);
+}
+
+void StartupGraph::Complete(TaskId id, State state, std::vector<TaskId>& ready) {
+    Task& task = tasks[id];
+    task.state = state;
+    finishedCount++;
+
+    for (TaskId dependentId : task.dependents) {
+        Task& dependent = tasks[dependentId];
+        if (state != STATE_DONE) dependent.anyDependencyFailed = true;
+        if (--dependent.remaining > 0) continue;
+        if (dependent.anyDependencyFailed) {
+            // 前置任务失败：不执行，连同其后继一并跳过
+            dependent.startMilliseconds = dependent.endMilliseconds = task.endMilliseconds;
+            Complete(dependentId, STATE_SKIPPED, ready);
+        } else {
+            ready.push_back(dependentId);
+        }
+    }
+}
+
+void StartupGraph::PrintReport() const {
+    static const char* const STATE_NAMES[] = {"pending", "ok", "FAILED", "skipped"};
+
+    // 关键路径：按拓扑序累加，每个任务取结束最晚的前置任务
+    std::vector<double> pathLength(tasks.size(), 0.0);
+    std::vector<int64_t> pathPrevious(tasks.size(), -1);
+    double taskMilliseconds = 0.0;
+    int64_t pathEnd = -1;
+    for (TaskId id = 0; id < tasks.size(); id++) {
+        const Task& task = tasks[id];
+        double duration = task.endMilliseconds - task.startMilliseconds;
+        taskMilliseconds += duration;
+        for (TaskId dependency : task.dependencies) {
+            if (pathLength[dependency] > pathLength[id]) {
+                pathLength[id] = pathLength[dependency];
+                pathPrevious[id] = dependency;
+            }
+        }
+        pathLength[id] += duration;
+        if (pathEnd < 0 || pathLength[id] > pathLength[pathEnd]) pathEnd = id;
+    }
+
+    std::vector<TaskId> order(tasks.size());
+    for (TaskId id = 0; id < tasks.size(); id++) order[id] = id;
+    std::stable_sort(order.begin(), order.end(), [this](TaskId a, TaskId b) {
+        return tasks[a].startMilliseconds < tasks[b].startMilliseconds;
+    });
+
+    std::printf("Startup timing (%.2f ms wall, %.2f ms summed over tasks, %.2fx overlap):\n",
+                wallMilliseconds, taskMilliseconds, wallMilliseconds > 0.0 ? taskMilliseconds / wallMilliseconds : 0.0);
+    std::printf("  %-20s %10s %10s  %-8s %s\n", "phase", "start ms", "dur ms", "thread", "state");
+    for (TaskId id : order) {
+        const Task& task = tasks[id];
+        char thread[24];   // "worker" + 最长10位的uint32_t
+        if (task.state == STATE_SKIPPED) {
+            std::snprintf(thread, sizeof(thread), "-");
+        } else if (task.threadIndex == 0) {
+            std::snprintf(thread, sizeof(thread), "main");
+        } else {
+            std::snprintf(thread, sizeof(thread), "worker%u", task.threadIndex);
+        }
+        std::printf("  %-20s %10.2f %10.2f  %-8s %s\n", task.name, task.startMilliseconds,
+                    task.endMilliseconds - task.startMilliseconds, thread, STATE_NAMES[task.state]);
+    }
+
+    if (pathEnd >= 0) {
+        std::vector<const char*> path;
+        for (int64_t id = pathEnd; id >= 0; id = pathPrevious[id]) path.push_back(tasks[id].name);
+        std::printf("  critical path %.2f ms:", pathLength[pathEnd]);
+        for (size_t i = path.size(); i-- > 0;) {
+            std::printf(" %s%s", path[i], i > 0 ? " ->" : "");
+        }
+        std::printf("\n");
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <vector>
+
+class JobSystem;
+
+// 启动依赖图：依赖满足的任务在任务系统上并行执行，标记为主线程的任务（GLFW窗口等）
+// 由调用Run的线程执行；记录每个任务的起止时间并输出启动耗时报告
+class StartupGraph {
+public:
+    typedef uint32_t TaskId;
+
+    // name须为静态字符串（同时用作分析器区段名）；func返回false表示失败
+    TaskId Add(const char* name, std::function<bool()> func, std::initializer_list<TaskId> dependencies = {},
+               bool mainThread = false);
+
+    // 执行全部任务，返回时都已结束；任一任务失败时其后继任务被跳过并返回false，
+    // 任务抛出的第一个异常在调用线程重新抛出
+    bool Run(JobSystem* jobSystem);
+
+    void PrintReport() const;
+    double GetWallMilliseconds() const { return wallMilliseconds; }
+
+private:
+    enum State : uint32_t {
+        STATE_PENDING = 0,
+        STATE_DONE,
+        STATE_FAILED,
+        STATE_SKIPPED
+    };
+
+    struct Task {
+        const char* name;
+        std::function<bool()> func;
+        std::vector<TaskId> dependencies;
+        std::vector<TaskId> dependents;
+        bool mainThread = false;
+
+        // 运行状态
+        uint32_t remaining = 0;
+        State state = STATE_PENDING;
+        bool anyDependencyFailed = false;
+        double startMilliseconds = 0.0;
+        double endMilliseconds = 0.0;
+        uint32_t threadIndex = 0;           // JobSystem::GetThreadIndex()，0为调用Run的线程
+    };
+
+    void Execute(TaskId id);
+    // 持锁调用：完成一个任务并把就绪的后继任务派发出去
+    void Complete(TaskId id, State state, std::vector<TaskId>& ready);
+    void Dispatch(const std::vector<TaskId>& ready);
+    double Elapsed() const;
+
+    std::vector<Task> tasks;
+    JobSystem* jobSystem = nullptr;
+    std::chrono::steady_clock::time_point startTime;
+    double wallMilliseconds = 0.0;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<TaskId> mainQueue;
+    uint32_t finishedCount = 0;
+    std::exception_ptr firstException;
+};
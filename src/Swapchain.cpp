@@ -1,7 +1,9 @@
 #include "Swapchain.hpp"
 #include "VulkanContext.hpp"
 #include "VulkanUtils.hpp"
-#include <GLFW/glfw3.h>
+#include "MemoryManager.hpp"
+#include "FrameAllocator.hpp"
+#include "Profiler.hpp"
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
@@ -12,10 +14,34 @@ Swapchain::~Swapchain() {
     Cleanup();
 }
 
+bool Swapchain::SelectSurfaceFormat() {
+    if (context->IsHeadless()) {
+        surfaceFormat = {COLOR_FORMAT, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+        swapchainImageFormat = COLOR_FORMAT;
+        return true;
+    }
+
+    // 启动时在工作线程上调用一次，表面格式在窗口大小变化时不变
+    std::vector<VkSurfaceFormatKHR> formats;
+    uint32_t formatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(context->GetPhysicalDevice(), context->GetSurface(), &formatCount, nullptr);
+    if (formatCount != 0) {
+        formats.resize(formatCount);
+        vkGetPhysicalDeviceSurfaceFormatsKHR(context->GetPhysicalDevice(), context->GetSurface(), &formatCount, formats.data());
+    }
+    if (formats.empty()) {
+        throw std::runtime_error("Surface does not report any formats!");
+    }
+
+    surfaceFormat = ChooseSwapSurfaceFormat(formats);
+    swapchainImageFormat = surfaceFormat.format;
+    return true;
+}
+
 bool Swapchain::Initialize() {
     if (!CreateSwapchain()) return false;
     if (!CreateImageViews()) return false;
-    if (!CreateFramebuffers()) return false;
+    if (!CreateDepthResources()) return false;
     return true;
 }
 
@@ -24,18 +50,14 @@ void Swapchain::Cleanup() {
 }
 
 bool Swapchain::CreateSwapchain() {
+    if (context->IsHeadless()) return CreateOffscreenImages();
+
     VkSurfaceCapabilitiesKHR capabilities;
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(context->GetPhysicalDevice(), context->GetSurface(), &capabilities);
 
-    std::vector<VkSurfaceFormatKHR> formats;
-    uint32_t formatCount;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(context->GetPhysicalDevice(), context->GetSurface(), &formatCount, nullptr);
-    if (formatCount != 0) {
-        formats.resize(formatCount);
-        vkGetPhysicalDeviceSurfaceFormatsKHR(context->GetPhysicalDevice(), context->GetSurface(), &formatCount, formats.data());
-    }
-
-    std::vector<VkPresentModeKHR> presentModes;
+    // 查询结果只在创建期间使用，取自帧线性区（窗口大小变化时在帧内重建）
+    std::pmr::memory_resource* frameMemory = FrameAllocator::GetResource();
+    std::pmr::vector<VkPresentModeKHR> presentModes(frameMemory);
     uint32_t presentModeCount;
     vkGetPhysicalDeviceSurfacePresentModesKHR(context->GetPhysicalDevice(), context->GetSurface(), &presentModeCount, nullptr);
     if (presentModeCount != 0) {
@@ -43,7 +65,7 @@ bool Swapchain::CreateSwapchain() {
         vkGetPhysicalDeviceSurfacePresentModesKHR(context->GetPhysicalDevice(), context->GetSurface(), &presentModeCount, presentModes.data());
     }
 
-    VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(formats);
+    // 表面格式已由SelectSurfaceFormat确定，渲染通道按同一格式创建
     VkPresentModeKHR presentMode = ChooseSwapPresentMode(presentModes);
     swapchainExtent = ChooseSwapExtent(capabilities);
 
@@ -60,7 +82,10 @@ bool Swapchain::CreateSwapchain() {
     createInfo.imageColorSpace = surfaceFormat.colorSpace;
     createInfo.imageExtent = swapchainExtent;
     createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // 表面支持时附加拷贝源/目标用途，供帧回读和动态分辨率放大使用
+    imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                 (capabilities.supportedUsageFlags & (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+    createInfo.imageUsage = imageUsage;
     createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     createInfo.preTransform = capabilities.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
@@ -68,7 +93,7 @@ bool Swapchain::CreateSwapchain() {
     createInfo.clipped = VK_TRUE;
     createInfo.oldSwapchain = VK_NULL_HANDLE;
 
-    if (vkCreateSwapchainKHR(context->GetDevice(), &createInfo, nullptr, &swapchain) != VK_SUCCESS) {
+    if (vkCreateSwapchainKHR(context->GetDevice(), &createInfo, context->GetAllocationCallbacks(), &swapchain) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create swap chain!");
     }
 
@@ -76,7 +101,42 @@ bool Swapchain::CreateSwapchain() {
     swapchainImages.resize(imageCount);
     vkGetSwapchainImagesKHR(context->GetDevice(), swapchain, &imageCount, swapchainImages.data());
 
-    swapchainImageFormat = surfaceFormat.format;
+    return true;
+}
+
+bool Swapchain::CreateOffscreenImages() {
+    // 与窗口模式的首选格式一致，渲染通道和管线无需区分两种模式
+    swapchainImageFormat = COLOR_FORMAT;
+    swapchainExtent = context->GetHeadlessExtent();
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = swapchainImageFormat;
+    imageInfo.extent.width = swapchainExtent.width;
+    imageInfo.extent.height = swapchainExtent.height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.usage = imageUsage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    // 图像数与飞行帧数一致，轮换使用
+    swapchainImages.resize(VulkanContext::MAX_FRAMES_IN_FLIGHT);
+    offscreenAllocations.resize(VulkanContext::MAX_FRAMES_IN_FLIGHT);
+    for (size_t i = 0; i < swapchainImages.size(); i++) {
+        if (context->GetMemoryManager()->CreateImage(imageInfo, allocInfo, &swapchainImages[i], &offscreenAllocations[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create offscreen image!");
+        }
+    }
+    nextOffscreenImage = 0;
     return true;
 }
 
@@ -99,31 +159,73 @@ bool Swapchain::CreateImageViews() {
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
-        if (vkCreateImageView(context->GetDevice(), &viewInfo, nullptr, &swapchainImageViews[i]) != VK_SUCCESS) {
+        if (vkCreateImageView(context->GetDevice(), &viewInfo, context->GetAllocationCallbacks(), &swapchainImageViews[i]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create texture image view!");
         }
     }
     return true;
 }
+bool Swapchain::CreateDepthResources() {
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = DEPTH_FORMAT;
+    imageInfo.extent.width = swapchainExtent.width;
+    imageInfo.extent.height = swapchainExtent.height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    // 采样用于构建Hi-Z层级
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+    if (context->GetMemoryManager()->CreateImage(imageInfo, allocInfo, &depthImage, &depthAllocation) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create depth image!");
+    }
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = depthImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = DEPTH_FORMAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(context->GetDevice(), &viewInfo, context->GetAllocationCallbacks(), &depthImageView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create depth image view!");
+    }
+    return true;
+}
 
 bool Swapchain::CreateFramebuffers() {
     swapchainFramebuffers.resize(swapchainImageViews.size());
 
     for (size_t i = 0; i < swapchainImageViews.size(); i++) {
         VkImageView attachments[] = {
-            swapchainImageViews[i]
+            swapchainImageViews[i],
+            depthImageView
         };
 
         VkFramebufferCreateInfo framebufferInfo{};
         framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = context->GetRenderPass(); // 需要从Renderer获取
-        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.renderPass = context->GetRenderPass();
+        framebufferInfo.attachmentCount = 2;
         framebufferInfo.pAttachments = attachments;
         framebufferInfo.width = swapchainExtent.width;
         framebufferInfo.height = swapchainExtent.height;
         framebufferInfo.layers = 1;
 
-        if (vkCreateFramebuffer(context->GetDevice(), &framebufferInfo, nullptr, &swapchainFramebuffers[i]) != VK_SUCCESS) {
+        if (vkCreateFramebuffer(context->GetDevice(), &framebufferInfo, context->GetAllocationCallbacks(), &swapchainFramebuffers[i]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create framebuffer!");
         }
     }
@@ -132,26 +234,51 @@ bool Swapchain::CreateFramebuffers() {
 
 void Swapchain::CleanupSwapchain() {
     for (auto framebuffer : swapchainFramebuffers) {
-        vkDestroyFramebuffer(context->GetDevice(), framebuffer, nullptr);
+        vkDestroyFramebuffer(context->GetDevice(), framebuffer, context->GetAllocationCallbacks());
     }
 
     for (auto imageView : swapchainImageViews) {
-        vkDestroyImageView(context->GetDevice(), imageView, nullptr);
+        vkDestroyImageView(context->GetDevice(), imageView, context->GetAllocationCallbacks());
     }
 
+    if (depthImageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(context->GetDevice(), depthImageView, context->GetAllocationCallbacks());
+        depthImageView = VK_NULL_HANDLE;
+    }
+    if (depthImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(context->GetAllocator(), depthImage, depthAllocation);
+        depthImage = VK_NULL_HANDLE;
+        depthAllocation = VK_NULL_HANDLE;
+    }
+
+    for (size_t i = 0; i < offscreenAllocations.size(); i++) {
+        vmaDestroyImage(context->GetAllocator(), swapchainImages[i], offscreenAllocations[i]);
+    }
+    offscreenAllocations.clear();
+
     if (swapchain != VK_NULL_HANDLE) {
-        vkDestroySwapchainKHR(context->GetDevice(), swapchain, nullptr);
+        vkDestroySwapchainKHR(context->GetDevice(), swapchain, context->GetAllocationCallbacks());
         swapchain = VK_NULL_HANDLE;
     }
+    swapchainFramebuffers.clear();
+    swapchainImageViews.clear();
+    swapchainImages.clear();
 }
 
 uint32_t Swapchain::AcquireNextImage(VkSemaphore semaphore, VkFence fence) {
+    VGE_PROFILE_FUNCTION();
+    if (context->IsHeadless()) {
+        uint32_t imageIndex = nextOffscreenImage;
+        nextOffscreenImage = (nextOffscreenImage + 1) % static_cast<uint32_t>(swapchainImages.size());
+        return imageIndex;
+    }
+
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(context->GetDevice(), swapchain, UINT64_MAX, semaphore, fence, &imageIndex);
     
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        Recreate();
-        return 0; // 重新创建后返回第一帧
+        // 未取得图像，信号量也不会发出；由调用方重建交换链并跳过本帧
+        return INVALID_IMAGE;
     } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
         throw std::runtime_error("Failed to acquire swap chain image!");
     }
@@ -183,16 +310,13 @@ bool Swapchain::PresentImage(uint32_t imageIndex, VkSemaphore waitSemaphore) {
 }
 
 void Swapchain::Recreate() {
-    int width = 0, height = 0;
-    glfwGetFramebufferSize(context->GetWindow(), &width, &height);
-    while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(context->GetWindow(), &width, &height);
-        glfwWaitEvents();
-    }
+    // 最小化期间不重建，恢复后由上下文重新调用
+    if (context->IsMinimized()) return;
 
     vkDeviceWaitIdle(context->GetDevice());
     CleanupSwapchain();
     Initialize();
+    CreateFramebuffers();
 }
 
 VkFramebuffer Swapchain::GetFramebuffer(uint32_t index) const {
@@ -208,14 +332,14 @@ VkSwapchainKHR Swapchain::GetSwapchain() const {
 
 VkSurfaceFormatKHR Swapchain::ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) {
     for (const auto& availableFormat : availableFormats) {
-        if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB && availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+        if (availableFormat.format == COLOR_FORMAT && availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
             return availableFormat;
         }
     }
     return availableFormats[0];
 }
 
-VkPresentModeKHR Swapchain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
+VkPresentModeKHR Swapchain::ChooseSwapPresentMode(const std::pmr::vector<VkPresentModeKHR>& availablePresentModes) {
     for (const auto& availablePresentMode : availablePresentModes) {
         if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
             return availablePresentMode;
@@ -228,13 +352,8 @@ VkExtent2D Swapchain::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilit
     if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
         return capabilities.currentExtent;
     } else {
-        int width, height;
-        glfwGetFramebufferSize(context->GetWindow(), &width, &height);
-
-        VkExtent2D actualExtent = {
-            static_cast<uint32_t>(width),
-            static_cast<uint32_t>(height)
-        };
+        // 在渲染线程上运行，不调用GLFW（窗口函数只能在主线程调用），使用主线程转发的帧缓冲尺寸
+        VkExtent2D actualExtent = context->GetFramebufferExtent();
 
         actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
         actualExtent.height = std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
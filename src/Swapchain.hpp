@@ -1,29 +1,52 @@
 #pragma once
-#include <vulkan/vulkan.h>
+#include "VulkanLoader.hpp"
 #include <vector>
 #include <memory>
+#include <memory_resource>
+#include "vk_mem_alloc.h"
 
 class VulkanContext;
 
 class Swapchain {
 public:
+    // 首选颜色格式，无窗口模式的离屏图像始终使用
+    static const VkFormat COLOR_FORMAT = VK_FORMAT_B8G8R8A8_SRGB;
+    // 深度缓冲格式，同时作为Hi-Z遮挡剔除的采样源
+    static const VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+    // AcquireNextImage在交换链过期时返回
+    static const uint32_t INVALID_IMAGE = UINT32_MAX;
+
     Swapchain(VulkanContext* context);
     ~Swapchain();
     
+    // 查询表面格式并确定图像格式（首选COLOR_FORMAT，否则退回表面的第一个格式）。
+    // 在设备就绪后、交换链与渲染通道创建前调用，两者因此可以并行初始化
+    bool SelectSurfaceFormat();
+    // 创建交换链、图像视图和深度缓冲；帧缓冲引用渲染通道，须在Renderer初始化后
+    // 单独调用CreateFramebuffers
     bool Initialize();
+    bool CreateFramebuffers();
     void Cleanup();
     
-    // 交换链操作
+    // 交换链操作（无窗口模式下按顺序轮换离屏图像，不使用信号量和栅栏）
     uint32_t AcquireNextImage(VkSemaphore semaphore, VkFence fence);
     bool PresentImage(uint32_t imageIndex, VkSemaphore waitSemaphore);
     
-    // 获取交换链信息
+    // 获取交换链信息（无窗口模式下交换链句柄为空）
+    VkSwapchainKHR GetSwapchain() const;
     VkFormat GetImageFormat() const { return swapchainImageFormat; }
     VkExtent2D GetExtent() const { return swapchainExtent; }
     VkFramebuffer GetFramebuffer(uint32_t index) const;
     size_t GetImageCount() const { return swapchainImages.size(); }
+    VkImage GetImage(uint32_t index) const { return swapchainImages[index]; }
+    // 图像可作为拷贝源（帧回读）；窗口模式取决于表面支持的用途
+    bool SupportsReadback() const { return (imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0; }
+    // 图像可作为拷贝目标（动态分辨率放大结果拷入）
+    bool SupportsUpscale() const { return (imageUsage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0; }
+    VkImage GetDepthImage() const { return depthImage; }
+    VkImageView GetDepthImageView() const { return depthImageView; }
     
-    // 窗口大小变化处理
+    // 窗口大小变化处理：成员数组只clear不释放，图像数量不变时重建不再分配；最小化时为空操作
     void Recreate();
     
 private:
@@ -33,16 +56,28 @@ private:
     std::vector<VkImage> swapchainImages;
     std::vector<VkImageView> swapchainImageViews;
     std::vector<VkFramebuffer> swapchainFramebuffers;
-    VkFormat swapchainImageFormat;
+    VkFormat swapchainImageFormat = COLOR_FORMAT;
+    VkSurfaceFormatKHR surfaceFormat = {COLOR_FORMAT, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
     VkExtent2D swapchainExtent;
+    VkImageUsageFlags imageUsage = 0;
+    
+    // 无窗口模式的离屏图像（可作为拷贝源和目标）
+    std::vector<VmaAllocation> offscreenAllocations;
+    uint32_t nextOffscreenImage = 0;
+    
+    // 深度缓冲（各交换链图像共享）
+    VkImage depthImage = VK_NULL_HANDLE;
+    VmaAllocation depthAllocation = VK_NULL_HANDLE;
+    VkImageView depthImageView = VK_NULL_HANDLE;
     
     bool CreateSwapchain();
+    bool CreateOffscreenImages();
     bool CreateImageViews();
-    bool CreateFramebuffers();
+    bool CreateDepthResources();
     void CleanupSwapchain();
     
     // 交换链支持查询
     VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
+    VkPresentModeKHR ChooseSwapPresentMode(const std::pmr::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 }; 
\ No newline at end of file
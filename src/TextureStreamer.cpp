@@ -0,0 +1,797 @@
+#include "TextureStreamer.hpp"
+#include "FrameAllocator.hpp"
+#include "Profiler.hpp"
+#include "VulkanContext.hpp"
+#include "StagingManager.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// 单个流式纹理；同时作为碎片整理可移动资源
+struct TextureStreamer::Texture : public MovableResource {
+    TextureStreamer* streamer = nullptr;
+    TextureDesc desc;
+    MipLoader loader;
+    uint32_t generation = 0;
+    bool alive = false;
+    bool destroyPending = false;
+
+    uint32_t tailMip = 0;        // 常驻的最低精度起点
+    uint32_t residentMip = 0;    // 当前驻留的最高精度层级（等于mipLevels表示尚未驻留）
+    uint32_t requestedMip = 0;   // 本帧请求的最高精度层级
+    uint64_t lastUsedFrame = 0;
+    VkDeviceSize residentSize = 0;
+
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+
+    // 上传中的新图像
+    bool loading = false;
+    bool uploading = false;
+    uint64_t uploadBatch = 0;
+    uint32_t pendingResidentMip = 0;
+    VkDeviceSize pendingSize = 0;
+    VkImage pendingImage = VK_NULL_HANDLE;
+    VkImageView pendingView = VK_NULL_HANDLE;
+    VmaAllocation pendingAllocation = VK_NULL_HANDLE;
+
+    // 碎片整理移动状态
+    bool moving = false;
+    VkImage moveImage = VK_NULL_HANDLE;
+    VkImageView moveView = VK_NULL_HANDLE;
+
+    bool BeginMove(VkCommandBuffer commandBuffer, VmaAllocation dstAllocation) override;
+    void CommitMove() override;
+    void ReleaseOld() override;
+
+    uint32_t ResidentLevelCount() const { return desc.mipLevels - residentMip; }
+};
+
+namespace {
+    void TransitionImage(Metrics* metrics, VkCommandBuffer commandBuffer, VkImage image, uint32_t levelCount,
+                         VkImageLayout oldLayout, VkImageLayout newLayout,
+                         VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                         VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = levelCount;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        metrics->Add(Metrics::BARRIERS);
+    }
+
+    // 从旧图像拷贝两者共有的mip层级
+    void CopySharedLevels(VkCommandBuffer commandBuffer, VkImage src, uint32_t srcResidentMip,
+                          VkImage dst, uint32_t dstResidentMip, const TextureDesc& desc) {
+        uint32_t firstShared = std::max(srcResidentMip, dstResidentMip);
+        std::vector<VkImageCopy> regions;
+        for (uint32_t level = firstShared; level < desc.mipLevels; level++) {
+            VkImageCopy region{};
+            region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - srcResidentMip, 0, 1};
+            region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - dstResidentMip, 0, 1};
+            region.extent.width = std::max(1u, desc.width >> level);
+            region.extent.height = std::max(1u, desc.height >> level);
+            region.extent.depth = 1;
+            regions.push_back(region);
+        }
+        if (regions.empty()) return;
+
+        vkCmdCopyImage(commandBuffer, src, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       static_cast<uint32_t>(regions.size()), regions.data());
+    }
+}
+
+TextureStreamer::TextureStreamer(VulkanContext* context, StagingManager* staging)
+    : context(context), staging(staging) {}
+
+TextureStreamer::~TextureStreamer() {
+    Cleanup();
+}
+
+bool TextureStreamer::Initialize(VkDeviceSize budgetBytes) {
+    budget = budgetBytes;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context->GetPhysicalDevice(), &properties);
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.anisotropyEnable = VK_TRUE;
+    samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(context->GetDevice(), &samplerInfo, context->GetAllocationCallbacks(), &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+
+    // 显存压力时由MemoryManager回调驱逐
+    evictionHandler = context->GetMemoryManager()->RegisterEvictionHandler(
+        [this](uint32_t heapIndex, VkDeviceSize bytesToFree) -> VkDeviceSize {
+            if (!context->GetMemoryManager()->GetStatistics().heaps[heapIndex].deviceLocal) return 0;
+            return EvictLeastRecentlyUsed(bytesToFree);
+        });
+
+    loaderRunning = true;
+    loaderThread = std::thread(&TextureStreamer::LoaderThreadMain, this);
+    return true;
+}
+
+void TextureStreamer::Cleanup() {
+    if (loaderThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(loaderMutex);
+            loaderRunning = false;
+        }
+        loaderCondition.notify_all();
+        loaderThread.join();
+    }
+
+    if (context->GetDevice() == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (evictionHandler != 0) {
+        context->GetMemoryManager()->UnregisterEvictionHandler(evictionHandler);
+        evictionHandler = 0;
+    }
+
+    staging->WaitIdle();
+    vkDeviceWaitIdle(context->GetDevice());
+
+    for (auto& texture : textures) {
+        if (texture->pendingImage != VK_NULL_HANDLE) {
+            vkDestroyImageView(context->GetDevice(), texture->pendingView, context->GetAllocationCallbacks());
+            vmaDestroyImage(context->GetAllocator(), texture->pendingImage, texture->pendingAllocation);
+        }
+        if (texture->image != VK_NULL_HANDLE) {
+            vkDestroyImageView(context->GetDevice(), texture->view, context->GetAllocationCallbacks());
+            vmaDestroyImage(context->GetAllocator(), texture->image, texture->allocation);
+        }
+    }
+    textures.clear();
+    freeHandles.clear();
+    DestroyRetiredImages(true);
+    residentBytes = 0;
+    retiringBytes = 0;
+
+    if (sampler != VK_NULL_HANDLE) {
+        vkDestroySampler(context->GetDevice(), sampler, context->GetAllocationCallbacks());
+        sampler = VK_NULL_HANDLE;
+    }
+}
+
+TextureFormatInfo TextureStreamer::GetFormatInfo(VkFormat format) {
+    // ASTC的UNORM/SRGB格式成对连续排列，块大小均为16字节
+    if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) {
+        static const uint32_t astcBlocks[14][2] = {
+            {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6},
+            {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}
+        };
+        uint32_t index = (format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2;
+        return {astcBlocks[index][0], astcBlocks[index][1], 16};
+    }
+
+    switch (format) {
+        case VK_FORMAT_R8_UNORM:
+            return {1, 1, 1};
+        case VK_FORMAT_R8G8_UNORM:
+            return {1, 1, 2};
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return {1, 1, 8};
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return {1, 1, 16};
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+            return {4, 4, 8};
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return {4, 4, 16};
+        default:
+            return {1, 1, 4};
+    }
+}
+
+VkDeviceSize TextureStreamer::ComputeMipSize(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevel) {
+    TextureFormatInfo info = GetFormatInfo(format);
+    uint32_t mipWidth = std::max(1u, width >> mipLevel);
+    uint32_t mipHeight = std::max(1u, height >> mipLevel);
+    VkDeviceSize blocksX = (mipWidth + info.blockWidth - 1) / info.blockWidth;
+    VkDeviceSize blocksY = (mipHeight + info.blockHeight - 1) / info.blockHeight;
+    return blocksX * blocksY * info.bytesPerBlock;
+}
+
+VkDeviceSize TextureStreamer::ComputeResidentSize(const Texture& texture, uint32_t residentMip) const {
+    VkDeviceSize size = 0;
+    for (uint32_t level = residentMip; level < texture.desc.mipLevels; level++) {
+        size += ComputeMipSize(texture.desc.format, texture.desc.width, texture.desc.height, level);
+    }
+    return size;
+}
+
+TextureHandle TextureStreamer::CreateTexture(const TextureDesc& desc, MipLoader loader) {
+    TextureHandle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        handle = static_cast<TextureHandle>(textures.size());
+        textures.push_back(std::make_unique<Texture>());
+    }
+
+    Texture& texture = *textures[handle];
+    uint32_t generation = texture.generation + 1;
+    texture = Texture{};
+    texture.streamer = this;
+    texture.generation = generation;
+    texture.alive = true;
+    texture.desc = desc;
+    texture.loader = std::move(loader);
+
+    // 尾部：第一个最大边不超过tailDimension的层级
+    uint32_t tailMip = 0;
+    while (tailMip + 1 < desc.mipLevels &&
+           std::max(desc.width >> tailMip, desc.height >> tailMip) > tailDimension) {
+        tailMip++;
+    }
+    texture.tailMip = tailMip;
+    texture.residentMip = desc.mipLevels;
+    texture.requestedMip = tailMip;
+    texture.lastUsedFrame = currentFrame;
+
+    // 先只加载低分辨率的mip尾部
+    LoadJob job;
+    job.handle = handle;
+    job.generation = texture.generation;
+    job.firstMip = tailMip;
+    job.lastMip = desc.mipLevels;
+    job.loader = texture.loader;
+    texture.loading = true;
+    {
+        std::lock_guard<std::mutex> lock(loaderMutex);
+        pendingLoads.push_back(std::move(job));
+    }
+    loaderCondition.notify_one();
+    return handle;
+}
+
+void TextureStreamer::DestroyTexture(TextureHandle handle) {
+    if (handle >= textures.size() || !textures[handle]->alive) return;
+
+    Texture& texture = *textures[handle];
+    if (texture.moving) {
+        // 碎片整理完成后再销毁
+        texture.destroyPending = true;
+        return;
+    }
+
+    if (texture.pendingImage != VK_NULL_HANDLE) {
+        RetireImage(texture.pendingImage, texture.pendingView, texture.pendingAllocation, texture.pendingSize);
+    }
+    if (texture.image != VK_NULL_HANDLE) {
+        RetireImage(texture.image, texture.view, texture.allocation, texture.residentSize);
+    }
+
+    uint32_t generation = texture.generation;
+    texture = Texture{};
+    texture.generation = generation;
+    freeHandles.push_back(handle);
+}
+
+void TextureStreamer::RequestResidency(TextureHandle handle, float screenSizePixels) {
+    if (handle >= textures.size()) return;
+    Texture& texture = *textures[handle];
+    if (!texture.alive) return;
+
+    float maxDimension = static_cast<float>(std::max(texture.desc.width, texture.desc.height));
+    float ratio = maxDimension / std::max(screenSizePixels, 1.0f);
+    uint32_t desiredMip = ratio > 1.0f ? static_cast<uint32_t>(std::floor(std::log2(ratio))) : 0;
+    desiredMip = std::min(desiredMip, texture.tailMip);
+
+    texture.requestedMip = std::min(texture.requestedMip, desiredMip);
+    texture.lastUsedFrame = currentFrame;
+}
+
+VkImageView TextureStreamer::GetImageView(TextureHandle handle) const {
+    if (handle >= textures.size()) return VK_NULL_HANDLE;
+    return textures[handle]->view;
+}
+
+uint32_t TextureStreamer::GetResidentMip(TextureHandle handle) const {
+    if (handle >= textures.size()) return 0;
+    return textures[handle]->residentMip;
+}
+
+void TextureStreamer::Update(uint64_t frameIndex, const std::vector<TextureRequest>& requests) {
+    VGE_PROFILE_FUNCTION();
+    currentFrame = frameIndex;
+    // 请求先于ScheduleLoads应用，并把纹理标记为本帧使用，驱逐不会选中它们
+    for (const TextureRequest& request : requests) {
+        RequestResidency(request.texture, request.screenSize);
+    }
+    staging->Update();
+
+    // 完成已上传的纹理，切换到新图像
+    for (auto& texturePtr : textures) {
+        Texture& texture = *texturePtr;
+        if (!texture.uploading || texture.uploadBatch == 0 || !staging->IsComplete(texture.uploadBatch)) continue;
+
+        if (texture.image != VK_NULL_HANDLE) {
+            RetireImage(texture.image, texture.view, texture.allocation, texture.residentSize);
+        }
+        texture.image = texture.pendingImage;
+        texture.view = texture.pendingView;
+        texture.allocation = texture.pendingAllocation;
+        texture.residentMip = texture.pendingResidentMip;
+        texture.residentSize = texture.pendingSize;
+        texture.pendingImage = VK_NULL_HANDLE;
+        texture.pendingView = VK_NULL_HANDLE;
+        texture.pendingAllocation = VK_NULL_HANDLE;
+        texture.pendingSize = 0;
+        texture.uploading = false;
+        texture.uploadBatch = 0;
+    }
+
+    DestroyRetiredImages(false);
+
+    VkDeviceSize uploadBudget = uploadBytesPerFrame;
+    ProcessCompletedLoads(uploadBudget);
+    ScheduleLoads();
+
+    uint64_t batch = staging->Submit();
+    if (batch != 0) {
+        for (auto& texture : textures) {
+            if (texture->uploading && texture->uploadBatch == 0) {
+                texture->uploadBatch = batch;
+            }
+        }
+    }
+}
+
+void TextureStreamer::ProcessCompletedLoads(VkDeviceSize& uploadBudget) {
+    // 没有完成的加载时直接返回：std::deque的构造本身就会分配
+    std::unique_lock<std::mutex> lock(loaderMutex);
+    if (completedLoads.empty()) return;
+    std::deque<LoadJob> ready;
+    ready.swap(completedLoads);
+    lock.unlock();
+
+    std::deque<LoadJob> deferred;
+    while (!ready.empty()) {
+        LoadJob job = std::move(ready.front());
+        ready.pop_front();
+        Texture& texture = *textures[job.handle];
+
+        if (!texture.alive || texture.generation != job.generation) {
+            continue;
+        }
+
+        if (!job.success) {
+            std::cerr << "failed to load texture mips " << job.firstMip << "-" << job.lastMip
+                      << " for texture " << job.handle << std::endl;
+            texture.loading = false;
+            continue;
+        }
+
+        // 上传按整个mip的范围拷贝，加载器返回的字节数必须与mip大小一致，否则拷贝会读出暂存区域
+        bool sizesValid = job.mips.size() == job.lastMip - job.firstMip;
+        for (uint32_t level = job.firstMip; sizesValid && level < job.lastMip; level++) {
+            sizesValid = job.mips[level - job.firstMip].size() ==
+                         ComputeMipSize(texture.desc.format, texture.desc.width, texture.desc.height, level);
+        }
+        if (!sizesValid) {
+            std::cerr << "texture mips " << job.firstMip << "-" << job.lastMip << " for texture " << job.handle
+                      << " do not match the expected mip sizes" << std::endl;
+            texture.loading = false;
+            continue;
+        }
+
+        VkDeviceSize jobBytes = 0;
+        for (const auto& mip : job.mips) {
+            jobBytes += mip.size();
+        }
+
+        // 每帧上传量受限，但至少处理一个任务避免饿死
+        if (texture.uploading || texture.moving || (jobBytes > uploadBudget && uploadBudget != uploadBytesPerFrame)) {
+            deferred.push_back(std::move(job));
+            continue;
+        }
+
+        if (!Reallocate(texture, job.firstMip, &job)) {
+            deferred.push_back(std::move(job));
+            continue;
+        }
+        texture.loading = false;
+        uploadBudget = jobBytes > uploadBudget ? 0 : uploadBudget - jobBytes;
+    }
+
+    if (!deferred.empty()) {
+        lock.lock();
+        while (!deferred.empty()) {
+            completedLoads.push_front(std::move(deferred.back()));
+            deferred.pop_back();
+        }
+    }
+}
+
+void TextureStreamer::ScheduleLoads() {
+    std::pmr::memory_resource* frameMemory = FrameAllocator::GetResource();
+    std::pmr::vector<TextureHandle> candidates(frameMemory);
+    for (TextureHandle handle = 0; handle < textures.size(); handle++) {
+        const Texture& texture = *textures[handle];
+        if (!texture.alive || texture.loading || texture.uploading || texture.moving) continue;
+        if (texture.requestedMip < texture.residentMip) {
+            candidates.push_back(handle);
+        }
+    }
+
+    // 精度差距越大的纹理越优先
+    std::sort(candidates.begin(), candidates.end(), [this](TextureHandle a, TextureHandle b) {
+        const Texture& ta = *textures[a];
+        const Texture& tb = *textures[b];
+        return ta.residentMip - ta.requestedMip > tb.residentMip - tb.requestedMip;
+    });
+
+    std::pmr::vector<LoadJob> jobs(frameMemory);
+    for (TextureHandle handle : candidates) {
+        Texture& texture = *textures[handle];
+        VkDeviceSize extra = ComputeResidentSize(texture, texture.requestedMip) - texture.residentSize;
+
+        // 退役图像的字节在销毁前仍计入residentBytes，驱逐时不再为它们重复腾出空间；
+        // 驱逐释放的内存要等在途帧结束，本帧放不下的纹理留到之后的帧加载
+        VkDeviceSize retained = residentBytes - retiringBytes;
+        if (retained + extra > budget) {
+            EvictLeastRecentlyUsed(retained + extra - budget);
+        }
+        if (residentBytes + extra > budget) continue;
+
+        LoadJob job;
+        job.handle = handle;
+        job.generation = texture.generation;
+        job.firstMip = texture.requestedMip;
+        job.lastMip = texture.residentMip;
+        job.loader = texture.loader;
+        texture.loading = true;
+        jobs.push_back(std::move(job));
+    }
+
+    // 下一帧重新收集请求
+    for (auto& texture : textures) {
+        texture->requestedMip = texture->tailMip;
+    }
+
+    if (!jobs.empty()) {
+        std::lock_guard<std::mutex> lock(loaderMutex);
+        for (auto& job : jobs) {
+            pendingLoads.push_back(std::move(job));
+        }
+    }
+    loaderCondition.notify_one();
+}
+
+VkDeviceSize TextureStreamer::EvictLeastRecentlyUsed(VkDeviceSize bytesToFree) {
+    std::pmr::vector<TextureHandle> candidates(FrameAllocator::GetResource());
+    for (TextureHandle handle = 0; handle < textures.size(); handle++) {
+        const Texture& texture = *textures[handle];
+        if (!texture.alive || texture.loading || texture.uploading || texture.moving) continue;
+        if (texture.residentMip >= texture.tailMip || texture.lastUsedFrame >= currentFrame) continue;
+        candidates.push_back(handle);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](TextureHandle a, TextureHandle b) {
+        return textures[a]->lastUsedFrame < textures[b]->lastUsedFrame;
+    });
+
+    // 内存紧张时不能再分配只含尾部的新图像：整张图像直接退役，尾部由ScheduleLoads在之后的帧重新加载，
+    // 期间GetImageView返回VK_NULL_HANDLE
+    VkDeviceSize freed = 0;
+    for (TextureHandle handle : candidates) {
+        if (freed >= bytesToFree) break;
+        Texture& texture = *textures[handle];
+
+        RetireImage(texture.image, texture.view, texture.allocation, texture.residentSize, true);
+        freed += texture.residentSize;
+        texture.image = VK_NULL_HANDLE;
+        texture.view = VK_NULL_HANDLE;
+        texture.allocation = VK_NULL_HANDLE;
+        texture.residentMip = texture.desc.mipLevels;
+        texture.residentSize = 0;
+    }
+    return freed;
+}
+
+bool TextureStreamer::Reallocate(Texture& texture, uint32_t newResidentMip, LoadJob* job) {
+    const TextureDesc& desc = texture.desc;
+    uint32_t oldResidentMip = texture.residentMip;
+    uint32_t levelCount = desc.mipLevels - newResidentMip;
+
+    // 先准备暂存数据，失败时不录制任何命令
+    std::vector<VkBufferImageCopy> uploads;
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    if (job != nullptr) {
+        for (uint32_t level = job->firstMip; level < job->lastMip; level++) {
+            if (level < newResidentMip || level >= oldResidentMip) continue;
+            const auto& data = job->mips[level - job->firstMip];
+
+            StagingRegion region;
+            if (!staging->Allocate(data.size(), 16, region)) {
+                return false;
+            }
+            std::memcpy(region.mapped, data.data(), data.size());
+            stagingBuffer = region.buffer;
+
+            VkBufferImageCopy copy{};
+            copy.bufferOffset = region.offset;
+            copy.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - newResidentMip, 0, 1};
+            copy.imageExtent.width = std::max(1u, desc.width >> level);
+            copy.imageExtent.height = std::max(1u, desc.height >> level);
+            copy.imageExtent.depth = 1;
+            uploads.push_back(copy);
+        }
+    }
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = desc.format;
+    imageInfo.extent.width = std::max(1u, desc.width >> newResidentMip);
+    imageInfo.extent.height = std::max(1u, desc.height >> newResidentMip);
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = levelCount;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    // 分配失败触发驱逐时不能选中本纹理
+    texture.uploading = true;
+
+    VkImage image;
+    VmaAllocation allocation;
+    if (context->GetMemoryManager()->CreateImage(imageInfo, allocInfo, &image, &allocation) != VK_SUCCESS) {
+        texture.uploading = false;
+        return false;
+    }
+    // MemoryManager把pUserData当作MovableResource*读取，存入转换后的基类指针
+    vmaSetAllocationUserData(context->GetAllocator(), allocation, static_cast<MovableResource*>(&texture));
+
+    VkCommandBuffer commandBuffer = staging->GetCommandBuffer();
+
+    TransitionImage(context->GetMetrics(), commandBuffer, image, levelCount,
+                    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    if (texture.image != VK_NULL_HANDLE) {
+        TransitionImage(context->GetMetrics(), commandBuffer, texture.image, texture.ResidentLevelCount(),
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        CopySharedLevels(commandBuffer, texture.image, oldResidentMip, image, newResidentMip, desc);
+
+        TransitionImage(context->GetMetrics(), commandBuffer, texture.image, texture.ResidentLevelCount(),
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+
+    if (!uploads.empty()) {
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(uploads.size()), uploads.data());
+    }
+
+    TransitionImage(context->GetMetrics(), commandBuffer, image, levelCount,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    texture.pendingImage = image;
+    texture.pendingView = CreateView(image, desc.format, levelCount);
+    texture.pendingAllocation = allocation;
+    texture.pendingResidentMip = newResidentMip;
+    texture.pendingSize = ComputeResidentSize(texture, newResidentMip);
+    texture.uploading = true;
+    texture.uploadBatch = 0;
+    residentBytes += texture.pendingSize;
+    return true;
+}
+
+VkImageView TextureStreamer::CreateView(VkImage image, VkFormat format, uint32_t levelCount) const {
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = levelCount;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    VkImageView view;
+    if (vkCreateImageView(context->GetDevice(), &viewInfo, context->GetAllocationCallbacks(), &view) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture image view!");
+    }
+    return view;
+}
+
+void TextureStreamer::RetireImage(VkImage image, VkImageView view, VmaAllocation allocation, VkDeviceSize size, bool evicted) {
+    // 退役的分配不再参与碎片整理；字节数在销毁时才从residentBytes中扣除
+    vmaSetAllocationUserData(context->GetAllocator(), allocation, nullptr);
+    uint32_t heapIndex = NO_HEAP;
+    if (evicted) {
+        VmaAllocationInfo allocationInfo;
+        vmaGetAllocationInfo(context->GetAllocator(), allocation, &allocationInfo);
+        heapIndex = context->GetMemoryManager()->GetHeapIndex(allocationInfo.memoryType);
+    }
+    retiredImages.push_back({image, view, allocation, size, heapIndex, currentFrame + VulkanContext::MAX_FRAMES_IN_FLIGHT});
+    retiringBytes += size;
+}
+
+void TextureStreamer::DestroyRetiredImages(bool force) {
+    auto it = retiredImages.begin();
+    while (it != retiredImages.end()) {
+        if (force || it->retireFrame <= currentFrame) {
+            vkDestroyImageView(context->GetDevice(), it->view, context->GetAllocationCallbacks());
+            vmaDestroyImage(context->GetAllocator(), it->image, it->allocation);
+            residentBytes -= it->size;
+            retiringBytes -= it->size;
+            // 驱逐的内存此时才真正归还
+            if (it->heapIndex != NO_HEAP) {
+                context->GetMemoryManager()->ReleaseEvictedBytes(it->heapIndex, it->size);
+            }
+            it = retiredImages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TextureStreamer::LoaderThreadMain() {
+    while (true) {
+        LoadJob job;
+        {
+            std::unique_lock<std::mutex> lock(loaderMutex);
+            loaderCondition.wait(lock, [this] { return !loaderRunning || !pendingLoads.empty(); });
+            if (!loaderRunning) return;
+            job = std::move(pendingLoads.front());
+            pendingLoads.pop_front();
+        }
+
+        job.success = true;
+        job.mips.resize(job.lastMip - job.firstMip);
+        for (uint32_t level = job.firstMip; level < job.lastMip; level++) {
+            if (!job.loader(level, job.mips[level - job.firstMip])) {
+                job.success = false;
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(loaderMutex);
+        completedLoads.push_back(std::move(job));
+    }
+}
+
+bool TextureStreamer::Texture::BeginMove(VkCommandBuffer commandBuffer, VmaAllocation dstAllocation) {
+    if (!alive || uploading || image == VK_NULL_HANDLE) return false;
+
+    VulkanContext* context = streamer->context;
+    uint32_t levelCount = ResidentLevelCount();
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = desc.format;
+    imageInfo.extent.width = std::max(1u, desc.width >> residentMip);
+    imageInfo.extent.height = std::max(1u, desc.height >> residentMip);
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = levelCount;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(context->GetDevice(), &imageInfo, context->GetAllocationCallbacks(), &moveImage) != VK_SUCCESS) {
+        return false;
+    }
+    if (vmaBindImageMemory(context->GetAllocator(), dstAllocation, moveImage) != VK_SUCCESS) {
+        vkDestroyImage(context->GetDevice(), moveImage, context->GetAllocationCallbacks());
+        moveImage = VK_NULL_HANDLE;
+        return false;
+    }
+    moveView = streamer->CreateView(moveImage, desc.format, levelCount);
+
+    TransitionImage(context->GetMetrics(), commandBuffer, moveImage, levelCount,
+                    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    TransitionImage(context->GetMetrics(), commandBuffer, image, levelCount,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    CopySharedLevels(commandBuffer, image, residentMip, moveImage, residentMip, desc);
+
+    TransitionImage(context->GetMetrics(), commandBuffer, image, levelCount,
+                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    TransitionImage(context->GetMetrics(), commandBuffer, moveImage, levelCount,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    moving = true;
+    return true;
+}
+
+void TextureStreamer::Texture::CommitMove() {
+    std::swap(image, moveImage);
+    std::swap(view, moveView);
+}
+
+void TextureStreamer::Texture::ReleaseOld() {
+    // 旧图像的内存由VMA在本轮结束时释放，这里只销毁图像对象
+    VulkanContext* context = streamer->context;
+    VkDevice device = context->GetDevice();
+    vkDestroyImageView(device, moveView, context->GetAllocationCallbacks());
+    vkDestroyImage(device, moveImage, context->GetAllocationCallbacks());
+    moveImage = VK_NULL_HANDLE;
+    moveView = VK_NULL_HANDLE;
+    moving = false;
+
+    if (destroyPending) {
+        TextureHandle handle = INVALID_TEXTURE;
+        for (TextureHandle i = 0; i < streamer->textures.size(); i++) {
+            if (streamer->textures[i].get() == this) {
+                handle = i;
+                break;
+            }
+        }
+        destroyPending = false;
+        streamer->DestroyTexture(handle);
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include "vk_mem_alloc.h"
+#include "MemoryManager.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class VulkanContext;
+class StagingManager;
+
+using TextureHandle = uint32_t;
+constexpr TextureHandle INVALID_TEXTURE = 0xFFFFFFFFu;
+
+// 可见性/LOD阶段为可见节点生成的驻留请求，屏幕尺寸为包围盒最大边的投影像素数
+struct TextureRequest {
+    TextureHandle texture = INVALID_TEXTURE;
+    float screenSize = 0.0f;
+};
+
+// 在工作线程上读取指定mip层级的数据
+using MipLoader = std::function<bool(uint32_t mipLevel, std::vector<uint8_t>& data)>;
+
+struct TextureDesc {
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    uint32_t width = 1;
+    uint32_t height = 1;
+    uint32_t mipLevels = 1;
+};
+
+// 压缩/非压缩格式的块信息
+struct TextureFormatInfo {
+    uint32_t blockWidth = 1;
+    uint32_t blockHeight = 1;
+    uint32_t bytesPerBlock = 4;
+};
+
+// 基于屏幕空间尺寸的mip驻留流式系统，驻留总量受显存预算约束（LRU驱逐）
+class TextureStreamer {
+public:
+    TextureStreamer(VulkanContext* context, StagingManager* staging);
+    ~TextureStreamer();
+
+    bool Initialize(VkDeviceSize budgetBytes);
+    void Cleanup();
+
+    // 创建纹理：只异步加载低分辨率的mip尾部
+    TextureHandle CreateTexture(const TextureDesc& desc, MipLoader loader);
+    void DestroyTexture(TextureHandle handle);
+
+    // 渲染时根据屏幕空间尺寸（像素）请求更高精度的mip
+    void RequestResidency(TextureHandle handle, float screenSizePixels);
+
+    // 每帧调用：提交本帧的驻留请求（RenderSnapshot::textureRequests），完成上传、驱逐、发起新的加载和上传
+    void Update(uint64_t frameIndex, const std::vector<TextureRequest>& requests);
+
+    // 纹理被驱逐后到尾部重新上传之前返回VK_NULL_HANDLE
+    VkImageView GetImageView(TextureHandle handle) const;
+    uint32_t GetResidentMip(TextureHandle handle) const;
+    VkSampler GetSampler() const { return sampler; }
+
+    void SetBudget(VkDeviceSize budgetBytes) { budget = budgetBytes; }
+    VkDeviceSize GetBudget() const { return budget; }
+    // 包括已退役、等待在途帧结束后销毁的图像
+    VkDeviceSize GetResidentBytes() const { return residentBytes; }
+    void SetUploadBytesPerFrame(VkDeviceSize bytes) { uploadBytesPerFrame = bytes; }
+
+    // 退役最久未使用的纹理中驻留了高精度mip的图像，不分配新图像；
+    // 返回安排释放的字节数，内存在引用它的帧结束后才释放
+    VkDeviceSize EvictLeastRecentlyUsed(VkDeviceSize bytesToFree);
+
+    static TextureFormatInfo GetFormatInfo(VkFormat format);
+    static VkDeviceSize ComputeMipSize(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevel);
+
+private:
+    struct Texture;
+
+    VulkanContext* context;
+    StagingManager* staging;
+
+    std::vector<std::unique_ptr<Texture>> textures;
+    std::vector<TextureHandle> freeHandles;
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkDeviceSize budget = 0;
+    VkDeviceSize residentBytes = 0;
+    VkDeviceSize retiringBytes = 0;
+    VkDeviceSize uploadBytesPerFrame = 32ull * 1024 * 1024;
+    uint64_t currentFrame = 0;
+    uint32_t evictionHandler = 0;
+    uint32_t tailDimension = 64;   // 尺寸不超过该值的mip常驻（驱逐后在之后的帧重新加载）
+
+    // 延迟销毁的旧图像（等待在途帧结束）
+    struct RetiredImage {
+        VkImage image;
+        VkImageView view;
+        VmaAllocation allocation;
+        VkDeviceSize size;
+        uint32_t heapIndex;     // 驱逐的图像所在的堆，其他原因退役时为NO_HEAP
+        uint64_t retireFrame;
+    };
+    static const uint32_t NO_HEAP = UINT32_MAX;
+    std::vector<RetiredImage> retiredImages;
+
+    // 工作线程加载队列
+    struct LoadJob {
+        TextureHandle handle = INVALID_TEXTURE;
+        uint32_t generation = 0;
+        uint32_t firstMip = 0;
+        uint32_t lastMip = 0;   // 不含
+        MipLoader loader;
+        std::vector<std::vector<uint8_t>> mips;
+        bool success = false;
+    };
+    std::thread loaderThread;
+    std::mutex loaderMutex;
+    std::condition_variable loaderCondition;
+    std::deque<LoadJob> pendingLoads;
+    std::deque<LoadJob> completedLoads;
+    bool loaderRunning = false;
+
+    void LoaderThreadMain();
+    void ProcessCompletedLoads(VkDeviceSize& uploadBudget);
+    void ScheduleLoads();
+    bool Reallocate(Texture& texture, uint32_t newResidentMip, LoadJob* job);
+    void RetireImage(VkImage image, VkImageView view, VmaAllocation allocation, VkDeviceSize size, bool evicted = false);
+    void DestroyRetiredImages(bool force);
+    VkDeviceSize ComputeResidentSize(const Texture& texture, uint32_t residentMip) const;
+    VkImageView CreateView(VkImage image, VkFormat format, uint32_t levelCount) const;
+
+    friend struct Texture;
+};
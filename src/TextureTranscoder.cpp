@@ -0,0 +1,540 @@
+#include "TextureTranscoder.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VGE_TRANSCODER_SSE2 1
+#endif
+
+namespace {
+    struct BlockFormat {
+        uint32_t bytesPerBlock;
+        uint32_t outputPixelBytes;
+    };
+
+    bool GetBlockFormat(VkFormat format, BlockFormat& info) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                info = {8, 4};
+                return true;
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                info = {16, 4};
+                return true;
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+                info = {8, 1};
+                return true;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                info = {16, 2};
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    inline uint32_t Expand5(uint32_t v) { return (v << 3) | (v >> 2); }
+    inline uint32_t Expand6(uint32_t v) { return (v << 2) | (v >> 4); }
+
+    inline uint32_t PackRGBA(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+        return r | (g << 8) | (b << 16) | (a << 24);
+    }
+
+    // BC1调色板（RGBA8打包）
+    void BuildBC1Palette(uint16_t c0, uint16_t c1, bool fourColor, bool punchThroughAlpha, uint32_t palette[4]) {
+        uint32_t r0 = Expand5(c0 >> 11), g0 = Expand6((c0 >> 5) & 0x3F), b0 = Expand5(c0 & 0x1F);
+        uint32_t r1 = Expand5(c1 >> 11), g1 = Expand6((c1 >> 5) & 0x3F), b1 = Expand5(c1 & 0x1F);
+
+        palette[0] = PackRGBA(r0, g0, b0, 255);
+        palette[1] = PackRGBA(r1, g1, b1, 255);
+
+        if (fourColor) {
+#ifdef VGE_TRANSCODER_SSE2
+            // 两个插值色同时计算：(2a+b)/3 与 (a+2b)/3，乘以21846再右移16位代替除3
+            __m128i a = _mm_setr_epi16(static_cast<short>(r0), static_cast<short>(g0), static_cast<short>(b0), 255,
+                                       static_cast<short>(r1), static_cast<short>(g1), static_cast<short>(b1), 255);
+            __m128i b = _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(a, a), b);
+            __m128i third = _mm_mulhi_epu16(sum, _mm_set1_epi16(21846));
+            __m128i packed = _mm_packus_epi16(third, third);
+            uint32_t interpolated[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(interpolated), packed);
+            palette[2] = (interpolated[0] & 0x00FFFFFFu) | 0xFF000000u;
+            palette[3] = (interpolated[1] & 0x00FFFFFFu) | 0xFF000000u;
+#else
+            palette[2] = PackRGBA((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 255);
+            palette[3] = PackRGBA((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 255);
+#endif
+        } else {
+            palette[2] = PackRGBA((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+            palette[3] = punchThroughAlpha ? 0u : PackRGBA(0, 0, 0, 255);
+        }
+    }
+
+    void DecodeColorBlock(const uint8_t* block, uint8_t* out, size_t outStride, bool forceFourColor, bool punchThroughAlpha) {
+        uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+        uint32_t indices = static_cast<uint32_t>(block[4]) | (static_cast<uint32_t>(block[5]) << 8) |
+                           (static_cast<uint32_t>(block[6]) << 16) | (static_cast<uint32_t>(block[7]) << 24);
+
+        uint32_t palette[4];
+        BuildBC1Palette(c0, c1, forceFourColor || c0 > c1, punchThroughAlpha, palette);
+
+        for (int y = 0; y < 4; y++) {
+            uint32_t row = indices >> (y * 8);
+#ifdef VGE_TRANSCODER_SSE2
+            __m128i pixels = _mm_setr_epi32(static_cast<int>(palette[row & 3]), static_cast<int>(palette[(row >> 2) & 3]),
+                                            static_cast<int>(palette[(row >> 4) & 3]), static_cast<int>(palette[(row >> 6) & 3]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + y * outStride), pixels);
+#else
+            uint32_t pixels[4] = {palette[row & 3], palette[(row >> 2) & 3], palette[(row >> 4) & 3], palette[(row >> 6) & 3]};
+            std::memcpy(out + y * outStride, pixels, sizeof(pixels));
+#endif
+        }
+    }
+
+    // BC3/BC4/BC5共用的8值单通道块
+    void DecodeSingleChannel(const uint8_t* block, uint8_t values[16]) {
+        uint32_t e0 = block[0];
+        uint32_t e1 = block[1];
+        uint32_t palette[8];
+        palette[0] = e0;
+        palette[1] = e1;
+        if (e0 > e1) {
+            for (uint32_t i = 1; i < 7; i++) {
+                palette[i + 1] = ((7 - i) * e0 + i * e1) / 7;
+            }
+        } else {
+            for (uint32_t i = 1; i < 5; i++) {
+                palette[i + 1] = ((5 - i) * e0 + i * e1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t indices = 0;
+        for (int i = 0; i < 6; i++) {
+            indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+        }
+        for (int i = 0; i < 16; i++) {
+            values[i] = static_cast<uint8_t>(palette[(indices >> (3 * i)) & 7]);
+        }
+    }
+
+    // ---- BC7 ----
+
+    struct BitReader {
+        const uint8_t* data;
+        uint32_t position = 0;
+
+        uint32_t Read(uint32_t count) {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t bit = (data[position >> 3] >> (position & 7)) & 1;
+                value |= bit << i;
+                position++;
+            }
+            return value;
+        }
+    };
+
+    struct BC7Mode {
+        uint8_t subsets;
+        uint8_t partitionBits;
+        uint8_t rotationBits;
+        uint8_t indexSelectionBits;
+        uint8_t colorBits;
+        uint8_t alphaBits;
+        uint8_t endpointPBits;
+        uint8_t sharedPBits;
+        uint8_t indexBits;
+        uint8_t secondaryIndexBits;
+    };
+
+    const BC7Mode BC7_MODES[8] = {
+        {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+        {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+        {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+        {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+        {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+        {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+        {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+        {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+    };
+
+    // 两分区表：第i位为像素i所属的分区
+    const uint16_t BC7_PARTITIONS_2[64] = {
+        0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+        0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+        0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+        0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+        0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+        0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+        0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+        0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+    };
+
+    const uint8_t BC7_PARTITIONS_3[64][16] = {
+        {0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2}, {0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1},
+        {0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1}, {0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1},
+        {0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2}, {0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2},
+        {0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1}, {0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1},
+        {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2}, {0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2},
+        {0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2}, {0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2},
+        {0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2}, {0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2},
+        {0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2}, {0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0},
+        {0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2}, {0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0},
+        {0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2}, {0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1},
+        {0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2}, {0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1},
+        {0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2}, {0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0},
+        {0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0}, {0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2},
+        {0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0}, {0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1},
+        {0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2}, {0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2},
+        {0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1}, {0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1},
+        {0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2}, {0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1},
+        {0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2}, {0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0},
+        {0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0}, {0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0},
+        {0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0}, {0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1},
+        {0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1}, {0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2},
+        {0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1}, {0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2},
+        {0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1}, {0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1},
+        {0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1}, {0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1},
+        {0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2}, {0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1},
+        {0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2}, {0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2},
+        {0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2}, {0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2},
+        {0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2}, {0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2},
+        {0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2}, {0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2},
+        {0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2}, {0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2},
+        {0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1}, {0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2},
+        {0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2}, {0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0},
+    };
+
+    const uint8_t BC7_ANCHOR_2[64] = {
+        15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+        15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+        15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+         6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15,
+    };
+
+    const uint8_t BC7_ANCHOR_3A[64] = {
+         3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,
+         3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+         8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,
+         3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3,
+    };
+
+    const uint8_t BC7_ANCHOR_3B[64] = {
+        15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8,
+        15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+        15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8,
+        15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8,
+    };
+
+    const uint8_t BC7_WEIGHTS_2[4] = {0, 21, 43, 64};
+    const uint8_t BC7_WEIGHTS_3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+    const uint8_t BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    inline const uint8_t* GetWeights(uint32_t bits) {
+        return bits == 2 ? BC7_WEIGHTS_2 : (bits == 3 ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4);
+    }
+
+    inline uint32_t Interpolate(uint32_t e0, uint32_t e1, uint32_t weight) {
+        return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+    }
+
+    inline uint32_t Unquantize(uint32_t value, uint32_t bits) {
+        value <<= (8 - bits);
+        return value | (value >> bits);
+    }
+
+    inline uint32_t GetSubset(uint32_t subsets, uint32_t partition, uint32_t pixel) {
+        if (subsets == 2) return (BC7_PARTITIONS_2[partition] >> pixel) & 1;
+        if (subsets == 3) return BC7_PARTITIONS_3[partition][pixel];
+        return 0;
+    }
+
+    inline bool IsAnchor(uint32_t subsets, uint32_t partition, uint32_t pixel) {
+        if (pixel == 0) return true;
+        if (subsets == 2) return pixel == BC7_ANCHOR_2[partition];
+        if (subsets == 3) return pixel == BC7_ANCHOR_3A[partition] || pixel == BC7_ANCHOR_3B[partition];
+        return false;
+    }
+
+    void TranscodeRows(VkFormat format, const BlockFormat& info, uint32_t width, uint32_t height,
+                       uint32_t blocksX, uint32_t firstRow, uint32_t lastRow,
+                       const uint8_t* src, uint8_t* dst) {
+        const size_t dstStride = static_cast<size_t>(width) * info.outputPixelBytes;
+        uint8_t scratch[4 * 4 * 4];
+        const size_t scratchStride = 4 * info.outputPixelBytes;
+
+        for (uint32_t by = firstRow; by < lastRow; by++) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                const uint8_t* block = src + (static_cast<size_t>(by) * blocksX + bx) * info.bytesPerBlock;
+
+                switch (format) {
+                    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                        TextureTranscoder::DecodeBC1Block(block, scratch, scratchStride, false);
+                        break;
+                    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                        TextureTranscoder::DecodeBC1Block(block, scratch, scratchStride, true);
+                        break;
+                    case VK_FORMAT_BC2_UNORM_BLOCK:
+                    case VK_FORMAT_BC2_SRGB_BLOCK:
+                        TextureTranscoder::DecodeBC2Block(block, scratch, scratchStride);
+                        break;
+                    case VK_FORMAT_BC3_UNORM_BLOCK:
+                    case VK_FORMAT_BC3_SRGB_BLOCK:
+                        TextureTranscoder::DecodeBC3Block(block, scratch, scratchStride);
+                        break;
+                    case VK_FORMAT_BC4_UNORM_BLOCK:
+                        TextureTranscoder::DecodeBC4Block(block, scratch, scratchStride, 1);
+                        break;
+                    case VK_FORMAT_BC5_UNORM_BLOCK:
+                        TextureTranscoder::DecodeBC5Block(block, scratch, scratchStride);
+                        break;
+                    default:
+                        TextureTranscoder::DecodeBC7Block(block, scratch, scratchStride);
+                        break;
+                }
+
+                // 边缘块裁剪到纹理尺寸
+                uint32_t copyWidth = std::min(4u, width - bx * 4);
+                uint32_t copyHeight = std::min(4u, height - by * 4);
+                for (uint32_t y = 0; y < copyHeight; y++) {
+                    uint8_t* row = dst + (static_cast<size_t>(by) * 4 + y) * dstStride + static_cast<size_t>(bx) * 4 * info.outputPixelBytes;
+                    std::memcpy(row, scratch + y * scratchStride, copyWidth * info.outputPixelBytes);
+                }
+            }
+        }
+    }
+}
+
+namespace TextureTranscoder {
+
+    bool CanTranscode(VkFormat format) {
+        BlockFormat info;
+        return GetBlockFormat(format, info);
+    }
+
+    VkFormat GetTranscodedFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                return VK_FORMAT_R8G8B8A8_SRGB;
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+                return VK_FORMAT_R8_UNORM;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                return VK_FORMAT_R8G8_UNORM;
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+                return VK_FORMAT_R8G8B8A8_UNORM;
+            default:
+                return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    bool Transcode(VkFormat format, uint32_t width, uint32_t height,
+                   const uint8_t* src, size_t srcSize, std::vector<uint8_t>& dst, JobSystem* jobSystem) {
+        BlockFormat info;
+        if (!GetBlockFormat(format, info)) {
+            return false;
+        }
+
+        uint32_t blocksX = (width + 3) / 4;
+        uint32_t blocksY = (height + 3) / 4;
+        if (srcSize < static_cast<size_t>(blocksX) * blocksY * info.bytesPerBlock) {
+            return false;
+        }
+
+        dst.resize(static_cast<size_t>(width) * height * info.outputPixelBytes);
+
+        // 小层级直接在当前线程解码，大层级按块行分段交给任务系统
+        const uint32_t rowsPerTask = 16;
+        uint8_t* output = dst.data();
+        if (jobSystem == nullptr || blocksY <= rowsPerTask) {
+            TranscodeRows(format, info, width, height, blocksX, 0, blocksY, src, output);
+            return true;
+        }
+
+        jobSystem->ParallelFor(blocksY, rowsPerTask, [&](uint32_t firstRow, uint32_t lastRow) {
+            TranscodeRows(format, info, width, height, blocksX, firstRow, lastRow, src, output);
+        });
+        return true;
+    }
+
+    void DecodeBC1Block(const uint8_t* block, uint8_t* out, size_t outStride, bool punchThroughAlpha) {
+        DecodeColorBlock(block, out, outStride, false, punchThroughAlpha);
+    }
+
+    void DecodeBC2Block(const uint8_t* block, uint8_t* out, size_t outStride) {
+        DecodeColorBlock(block + 8, out, outStride, true, false);
+
+        for (int i = 0; i < 16; i++) {
+            uint32_t alpha = (block[i / 2] >> ((i & 1) * 4)) & 0xF;
+            out[(i / 4) * outStride + (i % 4) * 4 + 3] = static_cast<uint8_t>(alpha | (alpha << 4));
+        }
+    }
+
+    void DecodeBC3Block(const uint8_t* block, uint8_t* out, size_t outStride) {
+        DecodeColorBlock(block + 8, out, outStride, true, false);
+
+        uint8_t alpha[16];
+        DecodeSingleChannel(block, alpha);
+        for (int i = 0; i < 16; i++) {
+            out[(i / 4) * outStride + (i % 4) * 4 + 3] = alpha[i];
+        }
+    }
+
+    void DecodeBC4Block(const uint8_t* block, uint8_t* out, size_t outStride, size_t pixelStride) {
+        uint8_t values[16];
+        DecodeSingleChannel(block, values);
+        for (int i = 0; i < 16; i++) {
+            out[(i / 4) * outStride + (i % 4) * pixelStride] = values[i];
+        }
+    }
+
+    void DecodeBC5Block(const uint8_t* block, uint8_t* out, size_t outStride) {
+        DecodeBC4Block(block, out, outStride, 2);
+        DecodeBC4Block(block + 8, out + 1, outStride, 2);
+    }
+
+    void DecodeBC7Block(const uint8_t* block, uint8_t* out, size_t outStride) {
+        uint32_t modeIndex = 0;
+        while (modeIndex < 8 && !(block[0] & (1u << modeIndex))) {
+            modeIndex++;
+        }
+
+        if (modeIndex >= 8) {
+            // 保留模式按规范解码为全零
+            for (int y = 0; y < 4; y++) {
+                std::memset(out + y * outStride, 0, 16);
+            }
+            return;
+        }
+
+        const BC7Mode& mode = BC7_MODES[modeIndex];
+        BitReader reader{block};
+        reader.Read(modeIndex + 1);
+
+        uint32_t partition = reader.Read(mode.partitionBits);
+        uint32_t rotation = reader.Read(mode.rotationBits);
+        uint32_t indexSelection = reader.Read(mode.indexSelectionBits);
+
+        const uint32_t endpointCount = mode.subsets * 2;
+        uint32_t endpoints[6][4];
+
+        for (uint32_t channel = 0; channel < 3; channel++) {
+            for (uint32_t e = 0; e < endpointCount; e++) {
+                endpoints[e][channel] = reader.Read(mode.colorBits);
+            }
+        }
+        for (uint32_t e = 0; e < endpointCount; e++) {
+            endpoints[e][3] = mode.alphaBits > 0 ? reader.Read(mode.alphaBits) : 255;
+        }
+
+        uint32_t colorBits = mode.colorBits;
+        uint32_t alphaBits = mode.alphaBits;
+        if (mode.endpointPBits || mode.sharedPBits) {
+            uint32_t pBits[6];
+            if (mode.endpointPBits) {
+                for (uint32_t e = 0; e < endpointCount; e++) {
+                    pBits[e] = reader.Read(1);
+                }
+            } else {
+                for (uint32_t s = 0; s < mode.subsets; s++) {
+                    uint32_t shared = reader.Read(1);
+                    pBits[s * 2] = shared;
+                    pBits[s * 2 + 1] = shared;
+                }
+            }
+            for (uint32_t e = 0; e < endpointCount; e++) {
+                for (uint32_t channel = 0; channel < 3; channel++) {
+                    endpoints[e][channel] = (endpoints[e][channel] << 1) | pBits[e];
+                }
+                if (mode.alphaBits > 0) {
+                    endpoints[e][3] = (endpoints[e][3] << 1) | pBits[e];
+                }
+            }
+            colorBits++;
+            if (alphaBits > 0) alphaBits++;
+        }
+
+        for (uint32_t e = 0; e < endpointCount; e++) {
+            for (uint32_t channel = 0; channel < 3; channel++) {
+                endpoints[e][channel] = Unquantize(endpoints[e][channel], colorBits);
+            }
+            if (alphaBits > 0) {
+                endpoints[e][3] = Unquantize(endpoints[e][3], alphaBits);
+            }
+        }
+
+        uint32_t primary[16];
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t bits = IsAnchor(mode.subsets, partition, i) ? mode.indexBits - 1 : mode.indexBits;
+            primary[i] = reader.Read(bits);
+        }
+
+        uint32_t secondary[16] = {};
+        if (mode.secondaryIndexBits > 0) {
+            for (uint32_t i = 0; i < 16; i++) {
+                uint32_t bits = i == 0 ? mode.secondaryIndexBits - 1 : mode.secondaryIndexBits;
+                secondary[i] = reader.Read(bits);
+            }
+        }
+
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t subset = GetSubset(mode.subsets, partition, i);
+            const uint32_t* e0 = endpoints[subset * 2];
+            const uint32_t* e1 = endpoints[subset * 2 + 1];
+
+            uint32_t colorIndex = primary[i];
+            uint32_t colorIndexBits = mode.indexBits;
+            uint32_t alphaIndex = primary[i];
+            uint32_t alphaIndexBits = mode.indexBits;
+            if (mode.secondaryIndexBits > 0) {
+                if (indexSelection) {
+                    colorIndex = secondary[i];
+                    colorIndexBits = mode.secondaryIndexBits;
+                } else {
+                    alphaIndex = secondary[i];
+                    alphaIndexBits = mode.secondaryIndexBits;
+                }
+            }
+
+            const uint8_t* colorWeights = GetWeights(colorIndexBits);
+            const uint8_t* alphaWeights = GetWeights(alphaIndexBits);
+
+            uint32_t rgba[4];
+            for (uint32_t channel = 0; channel < 3; channel++) {
+                rgba[channel] = Interpolate(e0[channel], e1[channel], colorWeights[colorIndex]);
+            }
+            rgba[3] = Interpolate(e0[3], e1[3], alphaWeights[alphaIndex]);
+
+            if (rotation > 0) {
+                std::swap(rgba[3], rgba[rotation - 1]);
+            }
+
+            uint8_t* pixel = out + (i / 4) * outStride + (i % 4) * 4;
+            pixel[0] = static_cast<uint8_t>(rgba[0]);
+            pixel[1] = static_cast<uint8_t>(rgba[1]);
+            pixel[2] = static_cast<uint8_t>(rgba[2]);
+            pixel[3] = static_cast<uint8_t>(rgba[3]);
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// 设备不支持的块压缩格式在CPU上解码为未压缩格式
+namespace TextureTranscoder {
+    // 是否有CPU解码路径
+    bool CanTranscode(VkFormat format);
+
+    // 解码后的目标格式（BC1/2/3/7 -> RGBA8，BC4 -> R8，BC5 -> R8G8）
+    VkFormat GetTranscodedFormat(VkFormat format);
+
+    // 解码一个mip层级，大层级按块行经jobSystem的ParallelFor并行处理（调用线程一同解码），
+    // jobSystem为空时在当前线程解码
+    bool Transcode(VkFormat format, uint32_t width, uint32_t height,
+                   const uint8_t* src, size_t srcSize, std::vector<uint8_t>& dst, JobSystem* jobSystem);
+
+    // 单块解码，输出4x4像素，outStride为输出行字节跨度
+    void DecodeBC1Block(const uint8_t* block, uint8_t* out, size_t outStride, bool punchThroughAlpha);
+    void DecodeBC2Block(const uint8_t* block, uint8_t* out, size_t outStride);
+    void DecodeBC3Block(const uint8_t* block, uint8_t* out, size_t outStride);
+    void DecodeBC4Block(const uint8_t* block, uint8_t* out, size_t outStride, size_t pixelStride);
+    void DecodeBC5Block(const uint8_t* block, uint8_t* out, size_t outStride);
+    void DecodeBC7Block(const uint8_t* block, uint8_t* out, size_t outStride);
+}
@@ -0,0 +1,352 @@
+#include "VertexFormat.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VGE_VERTEX_SSE2 1
+#endif
+
+namespace {
+    // 各语义在源数据中的分量数与缺省值
+    const uint32_t SOURCE_COMPONENTS[VERTEX_SEMANTIC_COUNT] = {3, 3, 4, 2};
+    const float SOURCE_DEFAULTS[VERTEX_SEMANTIC_COUNT][4] = {
+        {0.0f, 0.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f, 0.0f},
+        {1.0f, 0.0f, 0.0f, 1.0f},
+        {0.0f, 0.0f, 0.0f, 0.0f}
+    };
+
+    // 16位存储的归一化方式
+    enum Quantization : uint32_t {
+        QUANTIZE_HALF = 0,
+        QUANTIZE_SNORM16 = 1,
+        QUANTIZE_UNORM16 = 2
+    };
+
+    // 一个语义的源数据流，未提供时以步长0重复读取缺省值
+    struct Stream {
+        const uint8_t* data;
+        size_t stride;
+        uint32_t components;
+
+        Stream(const VertexSource& source, VertexSemantic semantic) : components(SOURCE_COMPONENTS[semantic]) {
+            if (source.streams[semantic]) {
+                data = reinterpret_cast<const uint8_t*>(source.streams[semantic]);
+                stride = source.strides[semantic];
+            } else {
+                data = reinterpret_cast<const uint8_t*>(SOURCE_DEFAULTS[semantic]);
+                stride = 0;
+            }
+        }
+
+        // 第i个顶点的分量，不足4个的补0
+        void Load(uint32_t i, float out[4]) const {
+            out[0] = out[1] = out[2] = out[3] = 0.0f;
+            std::memcpy(out, data + i * stride, components * sizeof(float));
+        }
+    };
+
+    // 舍入到最近偶数，与SSE2的cvtps一致
+    inline int32_t Round(float value) {
+        return static_cast<int32_t>(std::nearbyint(value));
+    }
+
+    inline float Clamp(float value, float low, float high) {
+        return std::max(low, std::min(high, value));
+    }
+
+#ifndef VGE_VERTEX_SSE2
+    // 就近舍入（偶数）的半精度转换，溢出为无穷，NaN保持为NaN
+    uint16_t FloatToHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        uint32_t half;
+        if (bits >= 0x47800000u) {
+            // 超出半精度范围、无穷或NaN
+            half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+        } else if (bits < 0x38800000u) {
+            // 结果为非规格化数：加0.5使尾数在浮点加法中按半精度的最小单位舍入
+            float magic;
+            std::memcpy(&magic, &bits, sizeof(magic));
+            magic += 0.5f;
+            std::memcpy(&half, &magic, sizeof(half));
+            half -= 0x3F000000u;
+        } else {
+            uint32_t odd = (bits >> 13) & 1u;
+            bits += 0xC8000FFFu;        // 指数偏移(15 - 127) << 23，加舍入偏置
+            bits += odd;
+            half = bits >> 13;
+        }
+        return static_cast<uint16_t>(half | (sign >> 16));
+    }
+
+    uint16_t Quantize16(float value, Quantization quantization) {
+        switch (quantization) {
+            case QUANTIZE_HALF:
+                return FloatToHalf(value);
+            case QUANTIZE_SNORM16:
+                return static_cast<uint16_t>(static_cast<int16_t>(Round(Clamp(value, -1.0f, 1.0f) * 32767.0f)));
+            default:
+                return static_cast<uint16_t>(Round(Clamp(value, 0.0f, 1.0f) * 65535.0f));
+        }
+    }
+#endif
+
+    // 八面体编码：单位向量投影到|x|+|y|+|z|=1，下半球沿对角线折到外侧，结果在[-1,1]²
+    void OctahedralEncode(const float v[3], float& u, float& w) {
+        float l1 = std::fabs(v[0]) + std::fabs(v[1]) + std::fabs(v[2]);
+        float inverse = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+        u = v[0] * inverse;
+        w = v[1] * inverse;
+        if (v[2] < 0.0f) {
+            float foldedU = (1.0f - std::fabs(w)) * (u < 0.0f ? -1.0f : 1.0f);
+            float foldedW = (1.0f - std::fabs(u)) * (w < 0.0f ? -1.0f : 1.0f);
+            u = foldedU;
+            w = foldedW;
+        }
+    }
+
+    void StoreOctahedral(const float v[4], bool withSign, uint8_t* destination) {
+        float u, w;
+        OctahedralEncode(v, u, w);
+        int16_t packed[2];
+        if (withSign) {
+            // x用15位，最低位为副切线符号（1为负）
+            packed[0] = static_cast<int16_t>(Round(Clamp(u, -1.0f, 1.0f) * 16383.0f) * 2 + (v[3] < 0.0f ? 1 : 0));
+        } else {
+            packed[0] = static_cast<int16_t>(Round(Clamp(u, -1.0f, 1.0f) * 32767.0f));
+        }
+        packed[1] = static_cast<int16_t>(Round(Clamp(w, -1.0f, 1.0f) * 32767.0f));
+        std::memcpy(destination, packed, sizeof(packed));
+    }
+
+#ifdef VGE_VERTEX_SSE2
+    // 4个float转半精度（就近舍入到偶数），结果在各32位通道的低16位，符号扩展以便有符号打包
+    inline __m128i FloatToHalf4(__m128 value) {
+        const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int32_t>(0x80000000u)));
+        __m128 sign = _mm_and_ps(value, signMask);
+        __m128 absolute = _mm_xor_ps(value, sign);
+        __m128i bits = _mm_castps_si128(absolute);
+
+        __m128 isNan = _mm_cmpunord_ps(absolute, absolute);
+        __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32(0x47800000), bits);
+        __m128i special = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNan), _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+        __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32(0x38800000), bits);
+        __m128 subnormalSum = _mm_add_ps(absolute, _mm_set1_ps(0.5f));
+        __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormalSum), _mm_set1_epi32(0x3F000000));
+
+        __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 18), 31);
+        __m128i normal = _mm_add_epi32(bits, _mm_set1_epi32(static_cast<int32_t>(0xC8000FFFu)));
+        normal = _mm_srli_epi32(_mm_sub_epi32(normal, odd), 13);
+
+        __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+        __m128i half = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+        return _mm_or_si128(half, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+    }
+
+    // 4个归一化值量化后打包为4个16位值（低64位）
+    inline __m128i Quantize16x4(__m128 value, Quantization quantization) {
+        switch (quantization) {
+            case QUANTIZE_HALF:
+                return _mm_packs_epi32(FloatToHalf4(value), _mm_setzero_si128());
+            case QUANTIZE_SNORM16: {
+                value = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+                return _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(32767.0f))), _mm_setzero_si128());
+            }
+            default: {
+                // 无符号16位：先偏移到有符号范围打包，再翻转最高位
+                value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+                __m128i integer = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(65535.0f))), _mm_set1_epi32(32768));
+                return _mm_xor_si128(_mm_packs_epi32(integer, _mm_setzero_si128()), _mm_set1_epi16(static_cast<int16_t>(0x8000)));
+            }
+        }
+    }
+#endif
+
+    // 原值拷贝
+    void EncodeFloat(const Stream& stream, uint32_t count, uint32_t size, uint8_t* destination, size_t destinationStride) {
+        for (uint32_t i = 0; i < count; i++) {
+            float values[4];
+            stream.Load(i, values);
+            std::memcpy(destination + i * destinationStride, values, size);
+        }
+    }
+
+    // 位置/UV：归一化 (v - offset) / scale 后按16位存储，size为4（2分量）或8（4分量，多余分量写0）
+    void EncodeScaled16(const Stream& stream, uint32_t count, const float* offset, const float* scale, uint32_t components,
+                        Quantization quantization, uint32_t size, uint8_t* destination, size_t destinationStride) {
+        float offsets[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float inverseScales[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (uint32_t c = 0; c < components; c++) {
+            offsets[c] = offset[c];
+            inverseScales[c] = scale[c] != 0.0f ? 1.0f / scale[c] : 0.0f;
+        }
+
+#ifdef VGE_VERTEX_SSE2
+        __m128 offsetVector = _mm_loadu_ps(offsets);
+        __m128 scaleVector = _mm_loadu_ps(inverseScales);
+        for (uint32_t i = 0; i < count; i++) {
+            float values[4];
+            stream.Load(i, values);
+            __m128 normalized = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values), offsetVector), scaleVector);
+            __m128i packed = Quantize16x4(normalized, quantization);
+            uint8_t* out = destination + i * destinationStride;
+            if (size == 8) {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+            } else {
+                int32_t low = _mm_cvtsi128_si32(packed);
+                std::memcpy(out, &low, sizeof(low));
+            }
+        }
+#else
+        for (uint32_t i = 0; i < count; i++) {
+            float values[4];
+            stream.Load(i, values);
+            uint16_t packed[4];
+            for (uint32_t c = 0; c < 4; c++) {
+                packed[c] = Quantize16((values[c] - offsets[c]) * inverseScales[c], quantization);
+            }
+            std::memcpy(destination + i * destinationStride, packed, size);
+        }
+#endif
+    }
+
+    // 法线/切线xyz直接量化为8位，切线w为副切线符号
+    void EncodeSnorm8(const Stream& stream, uint32_t count, bool withSign, uint8_t* destination, size_t destinationStride) {
+        for (uint32_t i = 0; i < count; i++) {
+            float values[4];
+            stream.Load(i, values);
+            values[3] = withSign ? (values[3] < 0.0f ? -1.0f : 1.0f) : 0.0f;
+#ifdef VGE_VERTEX_SSE2
+            __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+            __m128i integer = _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(127.0f)));
+            integer = _mm_packs_epi16(_mm_packs_epi32(integer, integer), _mm_setzero_si128());
+            int32_t packed = _mm_cvtsi128_si32(integer);
+            std::memcpy(destination + i * destinationStride, &packed, sizeof(packed));
+#else
+            int8_t packed[4];
+            for (uint32_t c = 0; c < 4; c++) {
+                packed[c] = static_cast<int8_t>(Round(Clamp(values[c], -1.0f, 1.0f) * 127.0f));
+            }
+            std::memcpy(destination + i * destinationStride, packed, sizeof(packed));
+#endif
+        }
+    }
+
+    // 八面体编码，SSE2每次4个顶点（分量转置为SoA后计算），余下的逐个处理
+    void EncodeOctahedral(const Stream& stream, uint32_t count, bool withSign, uint8_t* destination, size_t destinationStride) {
+        uint32_t i = 0;
+#ifdef VGE_VERTEX_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (; i + 4 <= count; i += 4) {
+            float values[4][4];
+            for (uint32_t lane = 0; lane < 4; lane++) {
+                stream.Load(i + lane, values[lane]);
+            }
+            __m128 x = _mm_setr_ps(values[0][0], values[1][0], values[2][0], values[3][0]);
+            __m128 y = _mm_setr_ps(values[0][1], values[1][1], values[2][1], values[3][1]);
+            __m128 z = _mm_setr_ps(values[0][2], values[1][2], values[2][2], values[3][2]);
+            __m128 w = _mm_setr_ps(values[0][3], values[1][3], values[2][3], values[3][3]);
+
+            __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(x, absMask), _mm_and_ps(y, absMask)), _mm_and_ps(z, absMask));
+            __m128 nonZero = _mm_cmpgt_ps(l1, zero);
+            __m128 inverse = _mm_and_ps(_mm_div_ps(one, _mm_or_ps(l1, _mm_andnot_ps(nonZero, one))), nonZero);
+            __m128 u = _mm_mul_ps(x, inverse);
+            __m128 v = _mm_mul_ps(y, inverse);
+
+            // 下半球折叠：(1 - |v|, 1 - |u|)，符号取u、v的符号（0视为正）
+            __m128 signU = _mm_sub_ps(one, _mm_and_ps(_mm_cmplt_ps(u, zero), two));
+            __m128 signV = _mm_sub_ps(one, _mm_and_ps(_mm_cmplt_ps(v, zero), two));
+            __m128 foldedU = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(v, absMask)), signU);
+            __m128 foldedV = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(u, absMask)), signV);
+            __m128 lower = _mm_cmplt_ps(z, zero);
+            u = _mm_or_ps(_mm_and_ps(lower, foldedU), _mm_andnot_ps(lower, u));
+            v = _mm_or_ps(_mm_and_ps(lower, foldedV), _mm_andnot_ps(lower, v));
+            u = _mm_min_ps(_mm_max_ps(u, _mm_set1_ps(-1.0f)), one);
+            v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.0f)), one);
+
+            __m128i packedU;
+            if (withSign) {
+                __m128i negative = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(w, zero)), _mm_set1_epi32(1));
+                packedU = _mm_add_epi32(_mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(u, _mm_set1_ps(16383.0f))), 1), negative);
+            } else {
+                packedU = _mm_cvtps_epi32(_mm_mul_ps(u, _mm_set1_ps(32767.0f)));
+            }
+            __m128i packedV = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(32767.0f)));
+            // [u0..u3, v0..v3] -> [u0 v0, u1 v1, u2 v2, u3 v3]
+            __m128i packed = _mm_packs_epi32(packedU, packedV);
+            packed = _mm_unpacklo_epi16(packed, _mm_srli_si128(packed, 8));
+            for (uint32_t lane = 0; lane < 4; lane++) {
+                int32_t pair = _mm_cvtsi128_si32(packed);
+                std::memcpy(destination + (i + lane) * destinationStride, &pair, sizeof(pair));
+                packed = _mm_srli_si128(packed, 4);
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            float values[4];
+            stream.Load(i, values);
+            StoreOctahedral(values, withSign, destination + i * destinationStride);
+        }
+    }
+}
+
+VertexDequantization VertexDequantization::Compute(VertexFormat positionFormat, VertexFormat uvFormat,
+                                                   const float boundsMin[3], const float boundsMax[3],
+                                                   const float uvMin[2], const float uvMax[2]) {
+    VertexDequantization result;
+    if (positionFormat == VERTEX_FORMAT_HALF4 || positionFormat == VERTEX_FORMAT_SNORM16X4) {
+        for (int axis = 0; axis < 3; axis++) {
+            result.positionOffset[axis] = 0.5f * (boundsMin[axis] + boundsMax[axis]);
+            result.positionScale[axis] = 0.5f * (boundsMax[axis] - boundsMin[axis]);
+        }
+    }
+    if (uvFormat == VERTEX_FORMAT_UNORM16X2) {
+        for (int axis = 0; axis < 2; axis++) {
+            result.uvOffset[axis] = uvMin[axis];
+            result.uvScale[axis] = uvMax[axis] - uvMin[axis];
+        }
+    }
+    return result;
+}
+
+void EncodeVertexAttribute(VertexSemantic semantic, VertexFormat format, const VertexSource& source,
+                           const VertexDequantization& dequantization, uint8_t* destination, size_t destinationStride) {
+    Stream stream(source, semantic);
+    uint32_t size = GetVertexFormatSize(format);
+    switch (format) {
+        case VERTEX_FORMAT_FLOAT2:
+        case VERTEX_FORMAT_FLOAT3:
+        case VERTEX_FORMAT_FLOAT4:
+            EncodeFloat(stream, source.count, size, destination, destinationStride);
+            break;
+        case VERTEX_FORMAT_HALF2:
+        case VERTEX_FORMAT_UNORM16X2:
+            EncodeScaled16(stream, source.count, dequantization.uvOffset, dequantization.uvScale, 2,
+                           format == VERTEX_FORMAT_HALF2 ? QUANTIZE_HALF : QUANTIZE_UNORM16, size, destination, destinationStride);
+            break;
+        case VERTEX_FORMAT_HALF4:
+        case VERTEX_FORMAT_SNORM16X4:
+            EncodeScaled16(stream, source.count, dequantization.positionOffset, dequantization.positionScale, 3,
+                           format == VERTEX_FORMAT_HALF4 ? QUANTIZE_HALF : QUANTIZE_SNORM16, size, destination, destinationStride);
+            break;
+        case VERTEX_FORMAT_SNORM8X4:
+            EncodeSnorm8(stream, source.count, semantic == VERTEX_SEMANTIC_TANGENT, destination, destinationStride);
+            break;
+        case VERTEX_FORMAT_OCT16:
+        case VERTEX_FORMAT_OCT16_SIGN:
+            EncodeOctahedral(stream, source.count, format == VERTEX_FORMAT_OCT16_SIGN, destination, destinationStride);
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include "VulkanLoader.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// 顶点属性语义：数值即着色器中的location（shaders/vertex_decode.glsl）
+enum VertexSemantic : uint32_t {
+    VERTEX_SEMANTIC_POSITION = 0,
+    VERTEX_SEMANTIC_NORMAL = 1,
+    VERTEX_SEMANTIC_TANGENT = 2,       // xyz为切线，w为副切线符号
+    VERTEX_SEMANTIC_UV = 3,
+    VERTEX_SEMANTIC_COUNT = 4
+};
+
+// 属性的存储格式与着色器中的解码方式
+enum VertexFormat : uint32_t {
+    VERTEX_FORMAT_FLOAT2 = 0,           // R32G32_SFLOAT        8字节  原值
+    VERTEX_FORMAT_FLOAT3 = 1,           // R32G32B32_SFLOAT     12字节 原值
+    VERTEX_FORMAT_FLOAT4 = 2,           // R32G32B32A32_SFLOAT  16字节 原值
+    VERTEX_FORMAT_HALF2 = 3,            // R16G16_SFLOAT        4字节  UV：DecodeUv
+    VERTEX_FORMAT_HALF4 = 4,            // R16G16B16A16_SFLOAT  8字节  位置：相对网格中心按半尺寸归一化，DecodePosition
+    VERTEX_FORMAT_SNORM16X4 = 5,        // R16G16B16A16_SNORM   8字节  位置：同上
+    VERTEX_FORMAT_UNORM16X2 = 6,        // R16G16_UNORM         4字节  UV：在网格UV范围内归一化，DecodeUv
+    VERTEX_FORMAT_SNORM8X4 = 7,         // R8G8B8A8_SNORM       4字节  法线/切线：xyz直接量化，w为符号
+    VERTEX_FORMAT_OCT16 = 8,            // R16G16_SNORM         4字节  法线：八面体编码，DecodeOctahedral
+    VERTEX_FORMAT_OCT16_SIGN = 9,       // R16G16_SINT          4字节  切线：八面体编码，x最低位为副切线符号，DecodeTangent
+    VERTEX_FORMAT_COUNT = 10
+};
+
+constexpr uint32_t GetVertexFormatSize(VertexFormat format) {
+    switch (format) {
+        case VERTEX_FORMAT_FLOAT2: return 8;
+        case VERTEX_FORMAT_FLOAT3: return 12;
+        case VERTEX_FORMAT_FLOAT4: return 16;
+        case VERTEX_FORMAT_HALF4:
+        case VERTEX_FORMAT_SNORM16X4: return 8;
+        default: return 4;
+    }
+}
+
+constexpr VkFormat GetVertexFormatVkFormat(VertexFormat format) {
+    switch (format) {
+        case VERTEX_FORMAT_FLOAT2: return VK_FORMAT_R32G32_SFLOAT;
+        case VERTEX_FORMAT_FLOAT3: return VK_FORMAT_R32G32B32_SFLOAT;
+        case VERTEX_FORMAT_FLOAT4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case VERTEX_FORMAT_HALF2: return VK_FORMAT_R16G16_SFLOAT;
+        case VERTEX_FORMAT_HALF4: return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case VERTEX_FORMAT_SNORM16X4: return VK_FORMAT_R16G16B16A16_SNORM;
+        case VERTEX_FORMAT_UNORM16X2: return VK_FORMAT_R16G16_UNORM;
+        case VERTEX_FORMAT_SNORM8X4: return VK_FORMAT_R8G8B8A8_SNORM;
+        case VERTEX_FORMAT_OCT16: return VK_FORMAT_R16G16_SNORM;
+        case VERTEX_FORMAT_OCT16_SIGN: return VK_FORMAT_R16G16_SINT;
+        default: return VK_FORMAT_UNDEFINED;
+    }
+}
+
+// 语义可用的格式（着色器只为这些组合提供解码）
+constexpr bool IsVertexFormatSupported(VertexSemantic semantic, VertexFormat format) {
+    switch (semantic) {
+        case VERTEX_SEMANTIC_POSITION:
+            return format == VERTEX_FORMAT_FLOAT3 || format == VERTEX_FORMAT_HALF4 || format == VERTEX_FORMAT_SNORM16X4;
+        case VERTEX_SEMANTIC_NORMAL:
+            return format == VERTEX_FORMAT_FLOAT3 || format == VERTEX_FORMAT_SNORM8X4 || format == VERTEX_FORMAT_OCT16;
+        case VERTEX_SEMANTIC_TANGENT:
+            return format == VERTEX_FORMAT_FLOAT4 || format == VERTEX_FORMAT_SNORM8X4 || format == VERTEX_FORMAT_OCT16_SIGN;
+        case VERTEX_SEMANTIC_UV:
+            return format == VERTEX_FORMAT_FLOAT2 || format == VERTEX_FORMAT_HALF2 || format == VERTEX_FORMAT_UNORM16X2;
+        default:
+            return false;
+    }
+}
+
+// 量化属性的逐网格解码参数：值 = offset + 存储值 * scale（着色器DecodePosition/DecodeUv）
+// 未量化的格式为恒等变换
+struct VertexDequantization {
+    float positionOffset[3] = {0.0f, 0.0f, 0.0f};
+    float positionScale[3] = {1.0f, 1.0f, 1.0f};
+    float uvOffset[2] = {0.0f, 0.0f};
+    float uvScale[2] = {1.0f, 1.0f};
+
+    // 位置按包围盒中心与半尺寸（HALF4/SNORM16X4），UV按UV范围（UNORM16X2）
+    static VertexDequantization Compute(VertexFormat positionFormat, VertexFormat uvFormat,
+                                        const float boundsMin[3], const float boundsMax[3],
+                                        const float uvMin[2], const float uvMax[2]);
+};
+
+// 编码输入：每个语义一个float流（位置3、法线3、切线4、UV2个分量），stride为相邻顶点的字节距离
+// 未提供的语义写入默认值（法线+Z，切线+X且符号为正）
+struct VertexSource {
+    const float* streams[VERTEX_SEMANTIC_COUNT] = {};
+    size_t strides[VERTEX_SEMANTIC_COUNT] = {};
+    uint32_t count = 0;
+
+    void Set(VertexSemantic semantic, const float* stream, size_t stride) {
+        streams[semantic] = stream;
+        strides[semantic] = stride;
+    }
+};
+
+// 把count个顶点的一个属性编码到交错顶点数组：destination指向第一个顶点中该属性的位置
+// x86-64上用SSE2转换（量化、半精度、八面体编码每次4个顶点）
+void EncodeVertexAttribute(VertexSemantic semantic, VertexFormat format, const VertexSource& source,
+                           const VertexDequantization& dequantization, uint8_t* destination, size_t destinationStride);
+
+// 顶点属性：语义与存储格式在编译期确定
+template <VertexSemantic Semantic, VertexFormat Format>
+struct VertexAttribute {
+    static_assert(IsVertexFormatSupported(Semantic, Format), "vertex format cannot store this semantic");
+    static const VertexSemantic SEMANTIC = Semantic;
+    static const VertexFormat FORMAT = Format;
+    static const uint32_t SIZE = GetVertexFormatSize(Format);
+};
+
+// 交错顶点布局描述：属性按声明顺序紧密排列（各格式大小均为4的倍数），
+// 偏移、步长、Vulkan顶点输入描述和编码都由属性列表生成，不再手写。例如：
+//   using CompactVertex = VertexLayoutDesc<VertexAttribute<VERTEX_SEMANTIC_POSITION, VERTEX_FORMAT_SNORM16X4>,
+//                                          VertexAttribute<VERTEX_SEMANTIC_NORMAL, VERTEX_FORMAT_OCT16>,
+//                                          VertexAttribute<VERTEX_SEMANTIC_UV, VERTEX_FORMAT_UNORM16X2>>;
+//   auto attributes = CompactVertex::GetAttributeDescriptions();    // std::array，location为语义
+template <typename... Attributes>
+class VertexLayoutDesc {
+public:
+    static const uint32_t COUNT = sizeof...(Attributes);
+    static_assert(COUNT > 0, "VertexLayoutDesc needs at least one attribute");
+    static const uint32_t STRIDE = (Attributes::SIZE + ...);
+
+    // 语义对应的属性下标，不存在时返回COUNT
+    static constexpr uint32_t IndexOf(VertexSemantic semantic) {
+        constexpr VertexSemantic semantics[] = {Attributes::SEMANTIC...};
+        for (uint32_t i = 0; i < COUNT; i++) {
+            if (semantics[i] == semantic) return i;
+        }
+        return COUNT;
+    }
+
+    static constexpr bool Has(VertexSemantic semantic) { return IndexOf(semantic) != COUNT; }
+
+    // 语义的存储格式，不存在时返回VERTEX_FORMAT_COUNT
+    static constexpr VertexFormat GetFormat(VertexSemantic semantic) {
+        constexpr VertexFormat formats[] = {Attributes::FORMAT...};
+        return Has(semantic) ? formats[IndexOf(semantic)] : VERTEX_FORMAT_COUNT;
+    }
+
+    // 下标为index的属性在顶点中的字节偏移
+    static constexpr uint32_t GetOffset(uint32_t index) {
+        constexpr uint32_t sizes[] = {Attributes::SIZE...};
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < index && i < COUNT; i++) {
+            offset += sizes[i];
+        }
+        return offset;
+    }
+
+    static constexpr bool HasUniqueSemantics() {
+        constexpr VertexSemantic semantics[] = {Attributes::SEMANTIC...};
+        for (uint32_t i = 0; i < COUNT; i++) {
+            if (IndexOf(semantics[i]) != i) return false;
+        }
+        return true;
+    }
+
+    // 语义与格式的签名，写入烘焙文件头，加载时校验布局一致
+    static constexpr uint32_t GetSignature() {
+        constexpr VertexSemantic semantics[] = {Attributes::SEMANTIC...};
+        constexpr VertexFormat formats[] = {Attributes::FORMAT...};
+        uint32_t hash = 2166136261u;
+        for (uint32_t i = 0; i < COUNT; i++) {
+            hash = (hash ^ (static_cast<uint32_t>(semantics[i]) << 8 | static_cast<uint32_t>(formats[i]))) * 16777619u;
+        }
+        return hash;
+    }
+
+    static VkVertexInputBindingDescription GetBindingDescription(uint32_t binding = 0) {
+        VkVertexInputBindingDescription description{};
+        description.binding = binding;
+        description.stride = STRIDE;
+        description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return description;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, COUNT> GetAttributeDescriptions(uint32_t binding = 0) {
+        static_assert(HasUniqueSemantics(), "duplicate vertex semantic");
+        const VertexSemantic semantics[] = {Attributes::SEMANTIC...};
+        const VertexFormat formats[] = {Attributes::FORMAT...};
+        std::array<VkVertexInputAttributeDescription, COUNT> descriptions{};
+        for (uint32_t i = 0; i < COUNT; i++) {
+            descriptions[i].location = semantics[i];
+            descriptions[i].binding = binding;
+            descriptions[i].format = GetVertexFormatVkFormat(formats[i]);
+            descriptions[i].offset = GetOffset(i);
+        }
+        return descriptions;
+    }
+
+    // 只读取部分属性的管线（如仅深度）使用
+    template <VertexSemantic Semantic>
+    static VkVertexInputAttributeDescription GetAttributeDescription(uint32_t binding = 0) {
+        static_assert(Has(Semantic), "vertex layout has no attribute with this semantic");
+        VkVertexInputAttributeDescription description{};
+        description.location = Semantic;
+        description.binding = binding;
+        description.format = GetVertexFormatVkFormat(GetFormat(Semantic));
+        description.offset = GetOffset(IndexOf(Semantic));
+        return description;
+    }
+
+    static VertexDequantization ComputeDequantization(const float boundsMin[3], const float boundsMax[3],
+                                                      const float uvMin[2], const float uvMax[2]) {
+        return VertexDequantization::Compute(GetFormat(VERTEX_SEMANTIC_POSITION), GetFormat(VERTEX_SEMANTIC_UV),
+                                             boundsMin, boundsMax, uvMin, uvMax);
+    }
+
+    // 编码source.count个顶点到destination（至少source.count * STRIDE字节）
+    static void Encode(const VertexSource& source, const VertexDequantization& dequantization, void* destination) {
+        static_assert(HasUniqueSemantics(), "duplicate vertex semantic");
+        const VertexSemantic semantics[] = {Attributes::SEMANTIC...};
+        const VertexFormat formats[] = {Attributes::FORMAT...};
+        uint8_t* bytes = static_cast<uint8_t*>(destination);
+        for (uint32_t i = 0; i < COUNT; i++) {
+            EncodeVertexAttribute(semantics[i], formats[i], source, dequantization, bytes + GetOffset(i), STRIDE);
+        }
+    }
+};
@@ -0,0 +1,6 @@
+// VMA实现只能在一个编译单元中展开
+#define VMA_IMPLEMENTATION
+// 引擎以VK_NO_PROTOTYPES编译，VMA通过InitVMA传入的vkGet*ProcAddr解析函数
+#define VMA_STATIC_VULKAN_FUNCTIONS 0
+#define VMA_DYNAMIC_VULKAN_FUNCTIONS 1
+#include "vk_mem_alloc.h"
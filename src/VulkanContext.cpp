@@ -2,45 +2,203 @@
 #include "Renderer.hpp"
 #include "Swapchain.hpp"
 #include "VulkanUtils.hpp"
+#include "MemoryManager.hpp"
+#include "StagingManager.hpp"
+#include "TextureStreamer.hpp"
+#include "Ktx2Loader.hpp"
+#include "AssetArchive.hpp"
+#include "JobSystem.hpp"
+#include "FrameAllocator.hpp"
+#include "Scene.hpp"
+#include "SceneCuller.hpp"
+#include "OcclusionCuller.hpp"
+#include "GeometryPool.hpp"
+#include "LodSelector.hpp"
+#include "Profiler.hpp"
+#include "Metrics.hpp"
+#include "StartupGraph.hpp"
+#include "PipelineLibrary.hpp"
+#include "FrameCapture.hpp"
+#include "FrameReadback.hpp"
+#include "DynamicResolution.hpp"
+#include "FramePipeline.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
-VulkanContext::VulkanContext() {}
+VulkanContext::VulkanContext() {
+    hostAllocator = std::make_unique<HostAllocator>();
+    framePipeline = std::make_unique<FramePipeline>(this);
+#ifdef VGE_VALIDATION
+    validationEnabled = true;
+#endif
+    if (const char* value = std::getenv("VGE_VALIDATION")) {
+        validationEnabled = std::strcmp(value, "0") != 0;
+    }
+    if (const char* value = std::getenv("VGE_CAPTURE")) {
+        captureEnabled = std::strcmp(value, "0") != 0;
+    }
+    if (const char* value = std::getenv("VGE_CAPTURE_FRAME")) {
+        captureEnabled = true;
+        captureFrame = std::strtoull(value, nullptr, 10);
+    }
+    if (const char* value = std::getenv("VGE_HOST_ALLOCATOR")) {
+        hostAllocatorEnabled = std::strcmp(value, "0") != 0;
+    }
+    if (const char* value = std::getenv("VGE_HOST_ALLOCATION_REPORT")) {
+        hostAllocator->SetReportEnabled(std::strcmp(value, "0") != 0);
+    }
+}
 
 VulkanContext::~VulkanContext() {
     Cleanup();
 }
 
 bool VulkanContext::Initialize() {
-    // 初始化GLFW
-    if (!glfwInit()) {
-        throw std::runtime_error("Failed to initialize GLFW");
+    startupBegin = std::chrono::steady_clock::now();
+    // 实例创建之前确定，之后所有对象的创建与销毁使用同一组回调
+    allocationCallbacks = hostAllocatorEnabled ? hostAllocator->GetCallbacks() : nullptr;
+
+    // 计数器最先创建，后续模块初始化期间的分配和上传也计入第0帧
+    metrics = std::make_unique<Metrics>();
+
+    // 任务系统与场景：启动依赖图在任务系统上执行
+    jobSystem = std::make_unique<JobSystem>();
+    if (!jobSystem->Initialize()) return false;
+    // 每个飞行帧为主线程和各工作线程准备线性区，启动阶段的临时分配也使用它们
+    frameAllocator = std::make_unique<FrameAllocator>();
+    if (!frameAllocator->Initialize(MAX_FRAMES_IN_FLIGHT, jobSystem->GetWorkerCount() + 1)) return false;
+    FrameAllocator::SetCurrent(frameAllocator.get());
+    scene = std::make_unique<Scene>();
+    scene->SetJobSystem(jobSystem.get());
+    sceneCuller = std::make_unique<SceneCuller>(scene.get(), jobSystem.get());
+
+    // 启动依赖图：窗口、交换链（查询帧缓冲大小）须在主线程，其余阶段在依赖满足后并行执行；
+    // 着色器读取与管线缓存加载和设备创建重叠，管线编译和交换链创建重叠
+    // 无窗口模式下GLFW、窗口和表面阶段为空操作
+    StartupGraph graph;
+    StartupGraph::TaskId glfwTask = graph.Add("GlfwInit", [this]() {
+        if (!headless && !glfwInit()) {
+            throw std::runtime_error("Failed to initialize GLFW");
+        }
+        return true;
+    }, {}, true);
+    StartupGraph::TaskId windowTask = graph.Add("Window", [this]() { return InitWindow(); }, {glfwTask}, true);
+
+    // 打包资源档案（不存在时回退到散文件）
+    StartupGraph::TaskId archiveTask = graph.Add("AssetArchive", [this]() {
+        assetArchive = std::make_unique<AssetArchive>();
+        if (assetArchive->Open("assets.vgea")) {
+            std::cout << "Mounted asset archive with " << assetArchive->GetEntryCount() << " entries" << std::endl;
+        }
+        return true;
+    });
+    StartupGraph::TaskId shaderTask = graph.Add("ShaderPrefetch", [this]() {
+        std::vector<const char*> paths = Renderer::GetShaderPaths();
+        std::vector<const char*> cullPaths = OcclusionCuller::GetShaderPaths();
+        paths.insert(paths.end(), cullPaths.begin(), cullPaths.end());
+        std::vector<const char*> upscalePaths = DynamicResolution::GetShaderPaths();
+        paths.insert(paths.end(), upscalePaths.begin(), upscalePaths.end());
+        PrefetchShaderCode(paths);
+        return true;
+    }, {archiveTask});
+
+    // Vulkan初始化流程（加载器动态打开，不链接libvulkan）
+    StartupGraph::TaskId instanceTask = graph.Add("Instance", [this]() {
+        if (!VulkanLoader::Initialize()) {
+            throw std::runtime_error("Failed to load the Vulkan loader!");
+        }
+        return InitInstance() && SetupDebugMessenger();
+    }, {glfwTask});
+    StartupGraph::TaskId surfaceTask = graph.Add("Surface", [this]() { return CreateSurface(); }, {windowTask, instanceTask});
+    StartupGraph::TaskId deviceTask = graph.Add("Device", [this]() {
+        if (!PickPhysicalDevice() || !CreateLogicalDevice() || !InitVMA() || !CreateSyncObjects()) return false;
+        // 模块在设备就绪后构造，由下列阶段分别初始化
+        swapchain = std::make_unique<Swapchain>(this);
+        // 表面格式在分叉前确定，渲染通道与交换链按同一格式并行创建
+        if (!swapchain->SelectSurfaceFormat()) return false;
+        renderer = std::make_unique<Renderer>(this);
+        occlusionCuller = std::make_unique<OcclusionCuller>(this);
+        dynamicResolution = std::make_unique<DynamicResolution>(this);
+        return true;
+    }, {surfaceTask});
+    StartupGraph::TaskId cacheTask = graph.Add("PipelineCache", [this]() {
+        if (!CreatePipelineCache()) return false;
+        pipelineLibrary = std::make_unique<PipelineLibrary>(this);
+        return pipelineLibrary->Initialize();
+    }, {deviceTask});
+    graph.Add("Streaming", [this]() { return InitStreaming(); }, {deviceTask});
+    graph.Add("FrameReadback", [this]() {
+        frameReadback = std::make_unique<FrameReadback>(this);
+        return frameReadback->Initialize();
+    }, {deviceTask});
+
+    // 共享几何池（所有网格与LOD共用顶点/索引缓冲）
+    StartupGraph::TaskId geometryTask = graph.Add("GeometryPool", [this]() {
+        geometryPool = std::make_unique<GeometryPool>(this);
+        geometryPool->SetRetainSourceData(captureEnabled);
+        if (!geometryPool->Initialize()) return false;
+        lodSelector = std::make_unique<LodSelector>(scene.get(), geometryPool.get(), jobSystem.get());
+        return true;
+    }, {deviceTask});
+
+    StartupGraph::TaskId swapchainTask = graph.Add("Swapchain", [this]() { return swapchain->Initialize(); }, {deviceTask}, true);
+    StartupGraph::TaskId rendererTask = graph.Add("Renderer", [this]() { return renderer->Initialize(); },
+                                                  {deviceTask, shaderTask, cacheTask});
+    StartupGraph::TaskId framebufferTask = graph.Add("Framebuffers", [this]() { return swapchain->CreateFramebuffers(); },
+                                                     {swapchainTask, rendererTask});
+
+    // 动态分辨率：放大管线与交换链创建并行，场景目标复用交换链深度缓冲
+    StartupGraph::TaskId resolutionTask = graph.Add("DynamicResolution", [this]() { return dynamicResolution->Initialize(); },
+                                                    {deviceTask, shaderTask, cacheTask});
+    graph.Add("ResolutionTargets", [this]() { return dynamicResolution->CreateTargets(); }, {framebufferTask, resolutionTask});
+
+    // GPU遮挡剔除（设备不支持时退化为不剔除）
+    StartupGraph::TaskId occlusionTask = graph.Add("OcclusionCuller", [this]() { return occlusionCuller->Initialize(); },
+                                                   {deviceTask, shaderTask, cacheTask});
+    graph.Add("DepthPyramid", [this]() { return occlusionCuller->CreateDepthResources(); }, {swapchainTask, occlusionTask, geometryTask});
+
+    bool succeeded = false;
+    try {
+        succeeded = graph.Run(jobSystem.get());
+    } catch (...) {
+        graph.PrintReport();
+        throw;
     }
-    
+    graph.PrintReport();
+
+    // 预读的着色器只在管线创建时使用
+    {
+        std::lock_guard<std::mutex> lock(shaderCodeMutex);
+        shaderCodeCache.clear();
+    }
+    if (!succeeded) return false;
+
+    // 默认60度垂直视场
+    lodCamera.projectionScale = LodCamera::ComputeProjectionScale(1.0472f, static_cast<float>(GetSwapchainExtent().height));
+    lodProjectionHeight = GetSwapchainExtent().height;
+    displayHeight = lodProjectionHeight;
+
+    std::cout << "VulkanContext initialized successfully!" << std::endl;
+    return true;
+}
+
+bool VulkanContext::InitWindow() {
+    if (headless) return true;
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
     window = glfwCreateWindow(800, 600, "Vulkan Engine", nullptr, nullptr);
     if (!window) {
         throw std::runtime_error("Failed to create GLFW window");
     }
-    
-    // Vulkan初始化流程
-    if (!InitInstance()) return false;
-    if (!SetupDebugMessenger()) return false;
-    if (!CreateSurface()) return false;
-    if (!PickPhysicalDevice()) return false;
-    if (!CreateLogicalDevice()) return false;
-    if (!InitVMA()) return false;
-    if (!CreateSyncObjects()) return false;
-    
-    // 创建模块
-    swapchain = std::make_unique<Swapchain>(this);
-    renderer = std::make_unique<Renderer>(this);
-    
-    if (!swapchain->Initialize()) return false;
-    if (!renderer->Initialize()) return false;
-    
-    std::cout << "VulkanContext initialized successfully!" << std::endl;
+    // 之后的尺寸变化由主线程的事件回调经SetFramebufferSize传入
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    framebufferExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
     return true;
 }
 
@@ -51,53 +209,83 @@ bool VulkanContext::InitInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "Vulkan Graph Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // 请求加载器支持的最高版本（至多1.3），设备实际使用的版本由DeviceSelector取两者较低者
+    instanceApiVersion = VK_API_VERSION_1_1;
+    if (vkEnumerateInstanceVersion != nullptr) {
+        vkEnumerateInstanceVersion(&instanceApiVersion);
+    }
+    instanceApiVersion = std::min(std::max(instanceApiVersion, VK_API_VERSION_1_1), VK_API_VERSION_1_3);
+    appInfo.apiVersion = instanceApiVersion;
 
     VkInstanceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-    createInfo.enabledExtensionCount = glfwExtensionCount;
-    createInfo.ppEnabledExtensionNames = glfwExtensions;
+    std::vector<const char*> extensions;
+    if (!headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
-    // 启用调试层
+    // 验证层只在调试模式启用；未安装时给出警告并继续运行
     const std::vector<const char*> validationLayers = {
         "VK_LAYER_KHRONOS_validation"
     };
-    createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
-    createInfo.ppEnabledLayerNames = validationLayers.data();
+    if (validationEnabled && !VulkanUtils::IsInstanceLayerSupported(validationLayers[0])) {
+        std::cerr << "Validation layer " << validationLayers[0] << " not available, running without validation" << std::endl;
+        validationEnabled = false;
+    }
+    if (validationEnabled) {
+        createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
+        createInfo.ppEnabledLayerNames = validationLayers.data();
+        if (VulkanUtils::IsInstanceExtensionSupported(VK_EXT_DEBUG_UTILS_EXTENSION_NAME)) {
+            extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+            debugUtilsSupported = true;
+        }
+    }
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
-    if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS) {
+    if (vkCreateInstance(&createInfo, allocationCallbacks, &instance) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create Vulkan instance!");
     }
+    VulkanLoader::LoadInstance(instance);
     return true;
 }
 
 bool VulkanContext::SetupDebugMessenger() {
+    // 发布模式不创建信使，驱动不会为消息回调付出任何开销
+    if (!validationEnabled || !debugUtilsSupported) return true;
+
+    debugLogger = std::make_unique<DebugLogger>();
+    if (!debugLogger->Initialize(debugLoggerSettings)) return false;
+
     VkDebugUtilsMessengerCreateInfoEXT createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-    createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-    createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-    createInfo.pfnUserCallback = VulkanUtils::DebugCallback;
+    debugLogger->FillMessengerCreateInfo(createInfo);
 
-    if (VulkanUtils::CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
+    if (VulkanUtils::CreateDebugUtilsMessengerEXT(instance, &createInfo, allocationCallbacks, &debugMessenger) != VK_SUCCESS) {
         throw std::runtime_error("Failed to set up debug messenger!");
     }
     return true;
 }
 
 bool VulkanContext::CreateSurface() {
-    if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS) {
+    if (headless) return true;
+    if (glfwCreateWindowSurface(instance, window, allocationCallbacks, &surface) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create window surface!");
     }
     return true;
 }
 
 bool VulkanContext::PickPhysicalDevice() {
-    physicalDevice = VulkanUtils::PickPhysicalDevice(instance, surface);
-    graphicsQueueFamily = VulkanUtils::FindQueueFamily(physicalDevice, surface);
+    deviceSelector = std::make_unique<DeviceSelector>(this);
+    if (!deviceOverride.empty()) {
+        deviceSelector->SetOverride(deviceOverride);
+    }
+    if (!deviceSelector->Select()) return false;
+    physicalDevice = deviceSelector->GetPhysicalDevice();
+    graphicsQueueFamily = deviceSelector->GetQueueFamily();
     return true;
 }
 
@@ -109,24 +297,12 @@ bool VulkanContext::CreateLogicalDevice() {
     queueCreateInfo.queueCount = 1;
     queueCreateInfo.pQueuePriorities = &queuePriority;
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
-    deviceFeatures.samplerAnisotropy = VK_TRUE;
-
-    VkDeviceCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.queueCreateInfoCount = 1;
-    createInfo.pQueueCreateInfos = &queueCreateInfo;
-    createInfo.pEnabledFeatures = &deviceFeatures;
-
-    const std::vector<const char*> deviceExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
-
-    if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS) {
+    // 扩展与特性链由设备选择阶段协商
+    if (deviceSelector->CreateDevice(&queueCreateInfo, 1, &device) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create logical device!");
     }
+    // 之后的设备级调用直接进入驱动
+    VulkanLoader::LoadDevice(device);
 
     vkGetDeviceQueue(device, graphicsQueueFamily, 0, &graphicsQueue);
     return true;
@@ -137,14 +313,133 @@ bool VulkanContext::InitVMA() {
     allocatorInfo.physicalDevice = physicalDevice;
     allocatorInfo.device = device;
     allocatorInfo.instance = instance;
-    allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_0;
+    allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_1;
+    // VK_NO_PROTOTYPES下VMA通过这两个入口自行解析其余函数
+    VmaVulkanFunctions vulkanFunctions = {};
+    vulkanFunctions.vkGetInstanceProcAddr = vkGetInstanceProcAddr;
+    vulkanFunctions.vkGetDeviceProcAddr = vkGetDeviceProcAddr;
+    allocatorInfo.pVulkanFunctions = &vulkanFunctions;
+    // VMA自身的主机分配以及它代为调用的vkAllocateMemory、vkCreateBuffer等也经HostAllocator
+    allocatorInfo.pAllocationCallbacks = allocationCallbacks;
+    if (IsMemoryBudgetSupported()) {
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
 
     if (vmaCreateAllocator(&allocatorInfo, &allocator) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create VMA allocator!");
     }
+
+    memoryManager = std::make_unique<MemoryManager>(this);
+    if (!memoryManager->Initialize()) return false;
+    return true;
+}
+
+bool VulkanContext::InitStreaming() {
+    stagingManager = std::make_unique<StagingManager>(this);
+    if (!stagingManager->Initialize()) return false;
+
+    // 默认纹理预算：最大显存堆预算的一半
+    VkDeviceSize textureBudget = 0;
+    for (const auto& heap : memoryManager->GetStatistics().heaps) {
+        if (heap.deviceLocal) {
+            textureBudget = std::max(textureBudget, heap.budget / 2);
+        }
+    }
+
+    textureStreamer = std::make_unique<TextureStreamer>(this, stagingManager.get());
+    if (!textureStreamer->Initialize(textureBudget)) return false;
+
+    ktx2Loader = std::make_unique<Ktx2Loader>(this);
+    return true;
+}
+
+bool VulkanContext::CreatePipelineCache() {
+    // 缓存头：headerSize、headerVersion、vendorID、deviceID、pipelineCacheUUID
+    // 驱动或设备变化后的旧缓存直接丢弃，避免驱动拒绝或产生无效数据
+    std::vector<char> data;
+    std::ifstream file(pipelineCachePath, std::ios::ate | std::ios::binary);
+    if (file.is_open()) {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), data.size());
+        if (!file) data.clear();
+    }
+
+    const VkPhysicalDeviceProperties& properties = GetCapabilities().properties;
+    if (!data.empty()) {
+        uint32_t header[4] = {};
+        bool valid = data.size() >= sizeof(header) + VK_UUID_SIZE;
+        if (valid) {
+            std::memcpy(header, data.data(), sizeof(header));
+            valid = header[0] >= sizeof(header) + VK_UUID_SIZE &&
+                    header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                    header[2] == properties.vendorID &&
+                    header[3] == properties.deviceID &&
+                    std::memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+        if (!valid) {
+            std::cout << "Discarding stale pipeline cache " << pipelineCachePath << std::endl;
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+    if (vkCreatePipelineCache(device, &cacheInfo, allocationCallbacks, &pipelineCache) != VK_SUCCESS) {
+        // 缓存只影响启动速度，失败时以空缓存继续
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        if (vkCreatePipelineCache(device, &cacheInfo, allocationCallbacks, &pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+    }
     return true;
 }
 
+void VulkanContext::SavePipelineCache() {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) return;
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS) return;
+
+    // 先写临时文件再替换，中途退出不会留下截断的缓存
+    std::string tempPath = pipelineCachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write pipeline cache " << tempPath << std::endl;
+            return;
+        }
+        file.write(data.data(), static_cast<std::streamsize>(size));
+        if (!file) {
+            std::cerr << "Failed to write pipeline cache " << tempPath << std::endl;
+            return;
+        }
+    }
+    std::remove(pipelineCachePath.c_str());
+    if (std::rename(tempPath.c_str(), pipelineCachePath.c_str()) != 0) {
+        std::cerr << "Failed to replace pipeline cache " << pipelineCachePath << std::endl;
+    }
+}
+
+void VulkanContext::PrefetchShaderCode(const std::vector<const char*>& paths) {
+    for (const char* path : paths) {
+        std::vector<char> code;
+        if (assetArchive == nullptr || !assetArchive->IsOpen() || !assetArchive->Read(path, code)) {
+            // 缺失的文件留给使用方在LoadShaderCode中报错
+            try {
+                code = VulkanUtils::ReadFile(path);
+            } catch (const std::exception&) {
+                continue;
+            }
+        }
+        std::lock_guard<std::mutex> lock(shaderCodeMutex);
+        shaderCodeCache[path] = std::move(code);
+    }
+}
+
 bool VulkanContext::CreateSyncObjects() {
     imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -158,9 +453,9 @@ bool VulkanContext::CreateSyncObjects() {
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
+            vkCreateSemaphore(device, &semaphoreInfo, allocationCallbacks, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, allocationCallbacks, &inFlightFences[i]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create synchronization objects!");
         }
     }
@@ -168,46 +463,153 @@ bool VulkanContext::CreateSyncObjects() {
 }
 
 void VulkanContext::DrawFrame() {
-    // 等待上一帧完成
-    vkWaitForFences(device, 1, &GetInFlightFence(), VK_TRUE, UINT64_MAX);
+    VGE_PROFILE_FUNCTION();
+    // 最小化时没有可用的交换链尺寸；尺寸变化合并为一次重建
+    if (IsMinimized()) return;
+    if (swapchainOutOfDate) {
+        OnWindowResize();
+    }
+    // 稳定运行时帧循环不应访问通用堆，以VGE_TRACK_ALLOCATIONS构建时统计本帧的分配
+    AllocationTracker::Begin();
+    // 驱动的主机分配另行统计，CallSite标签把它们归到发起的调用
+    hostAllocator->BeginFrame();
 
-    // 获取下一帧图像
-    uint32_t imageIndex = swapchain->AcquireNextImage(GetImageAvailableSemaphore(), VK_NULL_HANDLE);
+    // 等待上一帧完成
+    {
+        VGE_PROFILE_ZONE("WaitForFrameFence");
+        HostAllocator::CallSite site("vkWaitForFences");
+        VkFence fence = GetInFlightFence();
+        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    }
+    // 该槽位上次的CPU临时数据已不再使用
+    frameAllocator->BeginFrame(static_cast<uint32_t>(currentFrame));
+    {
+        HostAllocator::CallSite site("FrameReadback/DynamicResolution");
+        // 之前帧的回读完成后交给编码线程，不等待GPU
+        frameReadback->CollectCompleted();
+        // 该槽位上一次提交的GPU时间决定本帧的渲染尺寸
+        dynamicResolution->Update();
+    }
 
-    // 重置栅栏
-    vkResetFences(device, 1, &GetInFlightFence());
+    // 内存预算、压力驱逐和增量碎片整理
+    {
+        HostAllocator::CallSite site("MemoryManager");
+        memoryManager->BeginFrame(frameNumber);
+    }
+    // 场景更新、剔除与LOD选择的结果：深度为1时在此同步模拟，否则取模拟线程已生成的快照，
+    // 模拟线程同时已在准备下一帧
+    const RenderSnapshot& snapshot = framePipeline->AcquireSnapshot();
+    {
+        // 快照中可见节点的纹理驻留请求驱动本帧的流式加载
+        HostAllocator::CallSite site("TextureStreamer");
+        textureStreamer->Update(frameNumber, snapshot.textureRequests);
+    }
 
-    // 开始渲染
-    renderer->BeginFrame();
+    // 获取下一帧图像（无窗口模式下轮换离屏图像，不发信号量）
+    uint32_t imageIndex;
+    {
+        HostAllocator::CallSite site("vkAcquireNextImageKHR");
+        imageIndex = swapchain->AcquireNextImage(GetImageAvailableSemaphore(), VK_NULL_HANDLE);
+    }
+    if (imageIndex == Swapchain::INVALID_IMAGE) {
+        // 交换链已过期：重建后跳过本帧，栅栏尚未重置，下一次DrawFrame照常等待
+        OnWindowResize();
+        framePipeline->ReleaseSnapshot(false);
+        frameHostAllocations = hostAllocator->EndFrame();
+        frameAllocations = AllocationTracker::End();
+        return;
+    }
+    currentImageIndex = imageIndex;
+
+    // 重置栅栏并开始录制
+    {
+        HostAllocator::CallSite site("vkBeginCommandBuffer");
+        VkFence fence = GetInFlightFence();
+        vkResetFences(device, 1, &fence);
+        renderer->BeginFrame();
+    }
     
     VkCommandBuffer commandBuffer = renderer->GetCurrentCommandBuffer();
-    renderer->BeginRenderPass(commandBuffer);
-    renderer->DrawTriangle(commandBuffer);
-    renderer->EndRenderPass(commandBuffer);
     
-    renderer->EndFrame();
+    // 启用动态分辨率时场景渲染到内部目标，交换链图像直到放大后的拷贝才被写入
+    bool upscaling = dynamicResolution->IsActive();
+    {
+        HostAllocator::CallSite site("RecordCommands");
+        dynamicResolution->BeginFrame(commandBuffer);
+        RecordFrame(commandBuffer, snapshot);
+        dynamicResolution->EndFrame(commandBuffer, swapchain->GetImage(imageIndex), swapchain->GetExtent());
+        frameReadback->RecordCopy(commandBuffer, swapchain->GetImage(imageIndex), swapchain->GetExtent(), GetInFlightFence());
+    }
+    
+    {
+        HostAllocator::CallSite site("vkEndCommandBuffer");
+        renderer->EndFrame();
+    }
 
     // 提交命令缓冲区
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
     VkSemaphore waitSemaphores[] = {GetImageAvailableSemaphore()};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    VkPipelineStageFlags waitStages[] = {upscaling ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    submitInfo.waitSemaphoreCount = headless ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
     VkSemaphore signalSemaphores[] = {GetRenderFinishedSemaphore()};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, GetInFlightFence()) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to submit draw command buffer!");
+    {
+        VGE_PROFILE_ZONE("vkQueueSubmit");
+        HostAllocator::CallSite site("vkQueueSubmit");
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, GetInFlightFence()) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit draw command buffer!");
+        }
+    }
+    metrics->Add(Metrics::COMMAND_BUFFER_SUBMITS);
+
+    if (!headless) {
+        PresentFrame(imageIndex, signalSemaphores[0]);
+    }
+
+    if (frameNumber == captureFrame) {
+        capturePath = "frame_" + std::to_string(frameNumber) + ".vgef";
     }
+    if (!capturePath.empty()) {
+        // 捕获的是CPU端的帧输入，命令已提交，不需要等待GPU；读取场景期间暂停模拟阶段
+        FrameCapture capture;
+        bool recorded = false;
+        {
+            std::unique_lock<std::mutex> lock = framePipeline->LockSimulation();
+            recorded = capture.Record(this);
+        }
+        if (recorded && capture.Save(capturePath)) {
+            std::cout << "Captured frame " << frameNumber << " to " << capturePath << std::endl;
+        }
+        capturePath.clear();
+    }
+
+    if (frameNumber == 0) {
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+        std::printf("Time to first frame: %.2f ms\n", milliseconds);
+    }
+
+    // 快照的命令已提交，模拟阶段可以重用它
+    framePipeline->ReleaseSnapshot(true);
+
+    frameHostAllocations = hostAllocator->EndFrame();
+    metrics->Add(Metrics::HOST_ALLOCATIONS, frameHostAllocations.allocations);
+    metrics->EndFrame(frameNumber);
+    AdvanceFrame();
+    frameNumber++;
+    frameAllocations = AllocationTracker::End();
+}
 
-    // 呈现图像
+void VulkanContext::PresentFrame(uint32_t imageIndex, VkSemaphore waitSemaphore) {
+    VkSemaphore signalSemaphores[] = {waitSemaphore};
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -218,96 +620,233 @@ void VulkanContext::DrawFrame() {
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &imageIndex;
 
-    VkResult result = vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    VkResult result;
+    {
+        VGE_PROFILE_ZONE("vkQueuePresentKHR");
+        HostAllocator::CallSite site("vkQueuePresentKHR");
+        result = vkQueuePresentKHR(graphicsQueue, &presentInfo);
+    }
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
         OnWindowResize();
     } else if (result != VK_SUCCESS) {
         throw std::runtime_error("Failed to present swap chain image!");
     }
+}
 
-    AdvanceFrame();
+void VulkanContext::RecordFrame(VkCommandBuffer commandBuffer, const RenderSnapshot& snapshot) {
+    VGE_PROFILE_ZONE("RecordCommands");
+    // 第一段：上一帧可见的实例
+    if (framePassEnabled[PASS_CULL_EARLY]) {
+        occlusionCuller->CullEarly(commandBuffer, snapshot);
+    }
+    renderer->BeginRenderPass(commandBuffer);
+    if (framePassEnabled[PASS_MAIN]) {
+        renderer->DrawTriangle(commandBuffer);
+        occlusionCuller->Draw(commandBuffer, OcclusionCuller::PHASE_EARLY);
+    }
+    renderer->EndRenderPass(commandBuffer);
+
+    // 第二段：用当前深度构建Hi-Z，绘制新变为可见的实例
+    if (framePassEnabled[PASS_DEPTH_PYRAMID]) {
+        occlusionCuller->BuildDepthPyramid(commandBuffer);
+    }
+    if (framePassEnabled[PASS_CULL_LATE]) {
+        occlusionCuller->CullLate(commandBuffer);
+    }
+    renderer->BeginResumeRenderPass(commandBuffer);
+    if (framePassEnabled[PASS_RESUME]) {
+        occlusionCuller->Draw(commandBuffer, OcclusionCuller::PHASE_LATE);
+    }
+    renderer->EndRenderPass(commandBuffer);
 }
 
-void VulkanContext::OnWindowResize() {
-    int width = 0, height = 0;
-    glfwGetFramebufferSize(window, &width, &height);
-    while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(window, &width, &height);
-        glfwWaitEvents();
+const std::vector<uint32_t>& VulkanContext::GetVisibleNodes() const {
+    return framePipeline->GetRenderSnapshot().visibleNodes;
+}
+
+const std::vector<uint8_t>& VulkanContext::GetVisibleLods() const {
+    return framePipeline->GetRenderSnapshot().visibleLods;
+}
+
+const char* VulkanContext::GetFramePassName(FramePass pass) {
+    switch (pass) {
+        case PASS_CULL_EARLY: return "cull_early";
+        case PASS_MAIN: return "main";
+        case PASS_DEPTH_PYRAMID: return "depth_pyramid";
+        case PASS_CULL_LATE: return "cull_late";
+        case PASS_RESUME: return "resume";
+        default: return "unknown";
     }
+}
 
+void VulkanContext::OnWindowResize() {
+    if (IsMinimized()) {
+        swapchainOutOfDate = true;
+        return;
+    }
     vkDeviceWaitIdle(device);
-    RecreateSwapchain();
+    swapchain->Recreate();
+    // 依赖交换链尺寸的资源随后按新尺寸重建
+    if (!occlusionCuller->OnResize()) {
+        std::cerr << "Hi-Z pyramid was not rebuilt after resize, occlusion culling disabled" << std::endl;
+    }
+    if (!dynamicResolution->OnResize()) {
+        std::cerr << "Internal render target was not rebuilt after resize, dynamic resolution disabled" << std::endl;
+    }
+    // LOD投影系数在模拟线程中按新高度更新，避免与正在进行的模拟竞争
+    displayHeight = GetSwapchainExtent().height;
+    swapchainOutOfDate = false;
 }
 
-void VulkanContext::RecreateSwapchain() {
-    swapchain->Recreate();
-    renderer->OnWindowResize();
+void VulkanContext::UpdateLodProjection() {
+    uint32_t height = displayHeight.load();
+    if (height == 0 || height == lodProjectionHeight) return;
+    // 按比例缩放而不是按默认视场重算，保留应用设置的视场
+    if (lodProjectionHeight != 0) {
+        lodCamera.projectionScale *= static_cast<float>(height) / static_cast<float>(lodProjectionHeight);
+    }
+    lodProjectionHeight = height;
+}
+
+void VulkanContext::SetFramebufferSize(uint32_t width, uint32_t height) {
+    if (width == framebufferExtent.width && height == framebufferExtent.height) return;
+    framebufferExtent = {width, height};
+    swapchainOutOfDate = true;
 }
 
 void VulkanContext::Cleanup() {
+    // 模拟线程访问场景与剔除模块，先于它们停止
+    framePipeline->Stop();
     if (device != VK_NULL_HANDLE) {
         vkDeviceWaitIdle(device);
     }
 
+    // 写完未完成的截图和流帧
+    frameReadback.reset();
+    dynamicResolution.reset();
+    occlusionCuller.reset();
+    lodSelector.reset();
+    geometryPool.reset();
     renderer.reset();
     swapchain.reset();
+    if (pipelineLibrary) {
+        pipelineLibrary->PrintStatistics();
+        pipelineLibrary.reset();
+    }
+    // 流式系统的加载线程会回调Ktx2Loader并读取档案映射，需先停止
+    textureStreamer.reset();
+    ktx2Loader.reset();
+    assetArchive.reset();
+    sceneCuller.reset();
+    scene.reset();
+    jobSystem.reset();
+    frameAllocator.reset();
+    stagingManager.reset();
+    memoryManager.reset();
+    // 退出时写出剩余的逐帧数据和最终统计
+    if (metrics) {
+        metrics->Flush();
+        metrics.reset();
+    }
 
     if (allocator != VK_NULL_HANDLE) {
         vmaDestroyAllocator(allocator);
         allocator = VK_NULL_HANDLE;
     }
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-        vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(device, inFlightFences[i], nullptr);
+    if (pipelineCache != VK_NULL_HANDLE) {
+        SavePipelineCache();
+        vkDestroyPipelineCache(device, pipelineCache, allocationCallbacks);
+        pipelineCache = VK_NULL_HANDLE;
     }
 
     if (device != VK_NULL_HANDLE) {
-        vkDestroyDevice(device, nullptr);
+        for (size_t i = 0; i < inFlightFences.size(); i++) {
+            vkDestroySemaphore(device, renderFinishedSemaphores[i], allocationCallbacks);
+            vkDestroySemaphore(device, imageAvailableSemaphores[i], allocationCallbacks);
+            vkDestroyFence(device, inFlightFences[i], allocationCallbacks);
+        }
+        vkDestroyDevice(device, allocationCallbacks);
         device = VK_NULL_HANDLE;
     }
+    deviceSelector.reset();
 
     if (debugMessenger != VK_NULL_HANDLE) {
-        VulkanUtils::DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+        VulkanUtils::DestroyDebugUtilsMessengerEXT(instance, debugMessenger, allocationCallbacks);
         debugMessenger = VK_NULL_HANDLE;
     }
+    // 信使销毁后不会再有回调，输出剩余消息并停止日志线程
+    debugLogger.reset();
 
     if (surface != VK_NULL_HANDLE) {
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+        vkDestroySurfaceKHR(instance, surface, allocationCallbacks);
         surface = VK_NULL_HANDLE;
     }
 
     if (instance != VK_NULL_HANDLE) {
-        vkDestroyInstance(instance, nullptr);
+        vkDestroyInstance(instance, allocationCallbacks);
         instance = VK_NULL_HANDLE;
+        if (allocationCallbacks != nullptr && hostAllocator->IsReportEnabled()) {
+            hostAllocator->PrintReport();
+        }
     }
+    VulkanLoader::Shutdown();
 
     if (window != nullptr) {
         glfwDestroyWindow(window);
         window = nullptr;
     }
 
-    glfwTerminate();
+    if (!headless) {
+        glfwTerminate();
+    }
 }
 
 bool VulkanContext::ShouldClose() {
-    return glfwWindowShouldClose(window);
+    return !headless && glfwWindowShouldClose(window);
 }
 
 VkExtent2D VulkanContext::GetSwapchainExtent() const {
     return swapchain->GetExtent();
 }
 
+VkExtent2D VulkanContext::GetRenderExtent() const {
+    return dynamicResolution->GetRenderExtent();
+}
+
 VkFramebuffer VulkanContext::GetCurrentFramebuffer() const {
-    return swapchain->GetFramebuffer(0); // 简化实现
+    if (dynamicResolution->IsActive()) {
+        return dynamicResolution->GetFramebuffer();
+    }
+    return swapchain->GetFramebuffer(currentImageIndex);
 }
 
 GLFWwindow* VulkanContext::GetWindow() const {
     return window;
 }
 
+void VulkanContext::SetShaderOverride(const std::string& path, const std::vector<char>& code) {
+    std::lock_guard<std::mutex> lock(shaderCodeMutex);
+    shaderOverrides[path] = code;
+}
+
+std::vector<char> VulkanContext::LoadShaderCode(const std::string& path) const {
+    {
+        std::lock_guard<std::mutex> lock(shaderCodeMutex);
+        auto it = shaderOverrides.find(path);
+        if (it != shaderOverrides.end()) return it->second;
+        it = shaderCodeCache.find(path);
+        if (it != shaderCodeCache.end()) return it->second;
+    }
+
+    // 其次从已映射的资源档案中读取
+    std::vector<char> code;
+    if (assetArchive != nullptr && assetArchive->IsOpen() && assetArchive->Read(path, code)) {
+        return code;
+    }
+    return VulkanUtils::ReadFile(path);
+}
+
 VkRenderPass VulkanContext::GetRenderPass() const {
     return renderer->GetRenderPass();
 } 
\ No newline at end of file
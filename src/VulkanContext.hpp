@@ -1,29 +1,102 @@
 #pragma once
-#include <vulkan/vulkan.h>
+#include "VulkanLoader.hpp"
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "MathTypes.hpp"
+#include "LodSelector.hpp"
+#include "DebugLogger.hpp"
+#include "DeviceSelector.hpp"
+#include "AllocationTracker.hpp"
+#include "HostAllocator.hpp"
 
-// VMA内存分配器
-#define VMA_IMPLEMENTATION
+// VMA内存分配器（实现位于VmaUsage.cpp）
 #include "vk_mem_alloc.h"
 
 // 前向声明
 class Renderer;
 class Swapchain;
+class MemoryManager;
+class StagingManager;
+class TextureStreamer;
+class Ktx2Loader;
+class AssetArchive;
+class JobSystem;
+class FrameAllocator;
+class Scene;
+class SceneCuller;
+class OcclusionCuller;
+class GeometryPool;
+class LodSelector;
+class Metrics;
+class PipelineLibrary;
+class FrameReadback;
+class DynamicResolution;
+class FramePipeline;
+struct RenderSnapshot;
 
 class VulkanContext {
 public:
+    static const int MAX_FRAMES_IN_FLIGHT = 2;
+
+    // 帧内的引擎级通道，按枚举顺序录制；禁用的通道不录制其内容（渲染通道本身仍开始/结束）
+    enum FramePass : uint32_t {
+        PASS_CULL_EARLY = 0,
+        PASS_MAIN = 1,
+        PASS_DEPTH_PYRAMID = 2,
+        PASS_CULL_LATE = 3,
+        PASS_RESUME = 4,
+        PASS_COUNT
+    };
+    static const char* GetFramePassName(FramePass pass);
+
     VulkanContext();
     ~VulkanContext();
     
+    // 验证层与调试信使：默认值由VGE_ENABLE_VALIDATION决定，环境变量VGE_VALIDATION=0/1可覆盖
+    // 须在Initialize之前设置
+    void SetValidationEnabled(bool enabled) { validationEnabled = enabled; }
+    bool IsValidationEnabled() const { return validationEnabled; }
+    void SetDebugLoggerSettings(const DebugLogger::Settings& settings) { debugLoggerSettings = settings; }
+    DebugLogger* GetDebugLogger() const { return debugLogger.get(); }
+    // 按名称子串或UUID指定物理设备（覆盖环境变量VGE_DEVICE），须在Initialize之前设置
+    void SetDeviceOverride(const std::string& nameOrUuid) { deviceOverride = nameOrUuid; }
+    // 管线缓存文件，启动时加载、退出时写回，须在Initialize之前设置
+    void SetPipelineCachePath(const std::string& path) { pipelineCachePath = path; }
+    // 无窗口模式：不创建窗口和表面，交换链换成离屏图像，DrawFrame不呈现，须在Initialize之前设置
+    void SetHeadless(uint32_t width, uint32_t height) { headless = true; headlessExtent = {width, height}; }
+    bool IsHeadless() const { return headless; }
+    VkExtent2D GetHeadlessExtent() const { return headlessExtent; }
+    // 帧捕获：须在Initialize之前启用（几何池需保留网格源数据），环境变量VGE_CAPTURE=1可启用，
+    // VGE_CAPTURE_FRAME=N在第N帧自动捕获；RequestCapture在当前帧录制提交后写出
+    void SetCaptureEnabled(bool enabled) { captureEnabled = enabled; }
+    bool IsCaptureEnabled() const { return captureEnabled; }
+    void RequestCapture(const std::string& path) { capturePath = path; }
+    // 用给定代码替代着色器文件（回放捕获文件时使用），须在Initialize之前设置
+    void SetShaderOverride(const std::string& path, const std::vector<char>& code);
+    // 驱动主机内存经HostAllocator分配（环境变量VGE_HOST_ALLOCATOR=0时交还驱动默认分配器），
+    // 报告模式（VGE_HOST_ALLOCATION_REPORT=1）按调用点记录帧循环内的分配并在退出时输出，均须在Initialize之前设置
+    void SetHostAllocatorEnabled(bool enabled) { hostAllocatorEnabled = enabled; }
+    void SetHostAllocationReport(bool enabled) { hostAllocator->SetReportEnabled(enabled); }
+
     bool Initialize();
     void Cleanup();
     bool ShouldClose();
+    GLFWwindow* GetWindow() const;
     void DrawFrame();
     
-    // 窗口大小变化处理
+    // 窗口大小变化处理：在渲染线程上调用，最小化时只标记交换链过期，恢复后的下一帧再重建
     void OnWindowResize();
+    // 帧缓冲尺寸（窗口模式由主线程的事件转发，交换链据此选择尺寸），变化后下一帧开始前重建交换链
+    void SetFramebufferSize(uint32_t width, uint32_t height);
+    VkExtent2D GetFramebufferExtent() const { return framebufferExtent; }
+    // 帧缓冲为0（窗口最小化）时交换链无法重建，DrawFrame直接返回，调用方应暂停渲染
+    bool IsMinimized() const { return !headless && (framebufferExtent.width == 0 || framebufferExtent.height == 0); }
     
     // Getter接口
     VkInstance GetInstance() const { return instance; }
@@ -33,17 +106,79 @@ public:
     VkSurfaceKHR GetSurface() const { return surface; }
     uint32_t GetGraphicsQueueFamily() const { return graphicsQueueFamily; }
     VkExtent2D GetSwapchainExtent() const;
+    // 本帧场景通道的渲染尺寸（帧缓冲左上角），启用动态分辨率时小于交换链尺寸；
+    // 场景通道的渲染区域、视口和裁剪须使用此尺寸
+    VkExtent2D GetRenderExtent() const;
     VkFramebuffer GetCurrentFramebuffer() const;
     VkRenderPass GetRenderPass() const;
+    Swapchain* GetSwapchain() const { return swapchain.get(); }
+    
+    // 设备能力
+    uint32_t GetInstanceApiVersion() const { return instanceApiVersion; }
+    const DeviceCapabilities& GetCapabilities() const { return deviceSelector->GetCapabilities(); }
+    const VkPhysicalDeviceFeatures& GetEnabledFeatures() const { return GetCapabilities().features; }
+    bool IsDrawIndirectCountSupported() const { return GetCapabilities().drawIndirectCount; }
+    
+    // 所有vkCreate*/vkDestroy*及VMA使用的主机内存回调，禁用HostAllocator时为nullptr
+    const VkAllocationCallbacks* GetAllocationCallbacks() const { return allocationCallbacks; }
+    HostAllocator* GetHostAllocator() const { return hostAllocator.get(); }
+    
+    // 着色器代码：优先使用启动阶段预读的副本，其次从资源档案读取，回退到散文件（线程安全）
+    std::vector<char> LoadShaderCode(const std::string& path) const;
+    VkPipelineCache GetPipelineCache() const { return pipelineCache; }
+    PipelineLibrary* GetPipelineLibrary() const { return pipelineLibrary.get(); }
     
     // VMA分配器
     VmaAllocator GetAllocator() const { return allocator; }
+    MemoryManager* GetMemoryManager() const { return memoryManager.get(); }
+    StagingManager* GetStagingManager() const { return stagingManager.get(); }
+    TextureStreamer* GetTextureStreamer() const { return textureStreamer.get(); }
+    Ktx2Loader* GetKtx2Loader() const { return ktx2Loader.get(); }
+    const AssetArchive* GetAssetArchive() const { return assetArchive.get(); }
+    JobSystem* GetJobSystem() const { return jobSystem.get(); }
+    // 每帧每线程的线性区，也可经FrameAllocator::GetResource()取得当前线程的资源
+    FrameAllocator* GetFrameAllocator() const { return frameAllocator.get(); }
+    Scene* GetScene() const { return scene.get(); }
+    SceneCuller* GetSceneCuller() const { return sceneCuller.get(); }
+    OcclusionCuller* GetOcclusionCuller() const { return occlusionCuller.get(); }
+    GeometryPool* GetGeometryPool() const { return geometryPool.get(); }
+    LodSelector* GetLodSelector() const { return lodSelector.get(); }
+    Metrics* GetMetrics() const { return metrics.get(); }
+    // 截图与帧流的异步回读
+    FrameReadback* GetFrameReadback() const { return frameReadback.get(); }
+    // 按GPU帧时间预算调整渲染分辨率
+    DynamicResolution* GetDynamicResolution() const { return dynamicResolution.get(); }
+    
+    // 模拟与渲染的帧流水线：场景更新、剔除和LOD选择的结果经快照交给命令录制
+    FramePipeline* GetFramePipeline() const { return framePipeline.get(); }
+    
+    // 相机视图投影矩阵，模拟阶段据此剔除场景并写入快照；流水线深度大于1时只应在模拟回调中设置
+    void SetCameraViewProjection(const Mat4& viewProjection) { cameraViewProjection = viewProjection; }
+    const Mat4& GetCameraViewProjection() const { return cameraViewProjection; }
+    // 正在录制的快照中可见节点的密集索引（渲染线程在帧录制期间读取）
+    const std::vector<uint32_t>& GetVisibleNodes() const;
+    
+    // LOD选择的相机参数（设置规则同相机矩阵），每个可见节点选中的LOD与GetVisibleNodes()一一对应
+    void SetLodCamera(const LodCamera& camera) { lodCamera = camera; }
+    const LodCamera& GetLodCamera() const { return lodCamera; }
+    // 交换链重建后按新的显示高度缩放LOD投影系数，由模拟阶段在模拟回调之前调用
+    void UpdateLodProjection();
+    const std::vector<uint8_t>& GetVisibleLods() const;
+
+    void SetFramePassEnabled(FramePass pass, bool enabled) { framePassEnabled[pass] = enabled; }
+    bool IsFramePassEnabled(FramePass pass) const { return framePassEnabled[pass]; }
+    bool IsMemoryBudgetSupported() const { return GetCapabilities().memoryBudget; }
     
     // 同步对象
     VkSemaphore GetImageAvailableSemaphore() const { return imageAvailableSemaphores[currentFrame]; }
     VkSemaphore GetRenderFinishedSemaphore() const { return renderFinishedSemaphores[currentFrame]; }
     VkFence GetInFlightFence() const { return inFlightFences[currentFrame]; }
     size_t GetCurrentFrame() const { return currentFrame; }
+    uint64_t GetFrameNumber() const { return frameNumber; }
+    // 上一次DrawFrame期间渲染线程与工作线程上的堆分配（需以VGE_TRACK_ALLOCATIONS构建，否则为0）
+    const AllocationTracker::Counters& GetFrameAllocations() const { return frameAllocations; }
+    // 上一次DrawFrame期间驱动经HostAllocator的主机分配
+    const HostAllocator::FrameCounters& GetFrameHostAllocations() const { return frameHostAllocations; }
     void AdvanceFrame() { currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT; }
 
 private:
@@ -54,28 +189,86 @@ private:
     VkQueue graphicsQueue = VK_NULL_HANDLE;
     VkSurfaceKHR surface = VK_NULL_HANDLE;
     uint32_t graphicsQueueFamily = 0;
+    uint32_t instanceApiVersion = VK_API_VERSION_1_1;
+    std::string deviceOverride;
+    std::unique_ptr<DeviceSelector> deviceSelector;
+    
+    // 驱动主机内存，比所有Vulkan对象存活更久
+    std::unique_ptr<HostAllocator> hostAllocator;
+    bool hostAllocatorEnabled = true;
+    const VkAllocationCallbacks* allocationCallbacks = nullptr;
+    
+    // 管线缓存与启动预读的着色器
+    std::string pipelineCachePath = "pipeline_cache.bin";
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    std::unique_ptr<PipelineLibrary> pipelineLibrary;
+    mutable std::mutex shaderCodeMutex;
+    std::unordered_map<std::string, std::vector<char>> shaderCodeCache;
+    std::unordered_map<std::string, std::vector<char>> shaderOverrides;
+    std::chrono::steady_clock::time_point startupBegin;
     
     // VMA内存分配器
     VmaAllocator allocator = VK_NULL_HANDLE;
+    std::unique_ptr<MemoryManager> memoryManager;
     
     // 调试消息
+    bool validationEnabled = false;
+    DebugLogger::Settings debugLoggerSettings;
+    std::unique_ptr<DebugLogger> debugLogger;
+    bool debugUtilsSupported = false;
     VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
     
     // 同步对象
-    static const int MAX_FRAMES_IN_FLIGHT = 2;
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
     size_t currentFrame = 0;
+    uint64_t frameNumber = 0;
+    uint32_t currentImageIndex = 0;
+    AllocationTracker::Counters frameAllocations;
+    HostAllocator::FrameCounters frameHostAllocations;
     
     // 模块
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<Swapchain> swapchain;
+    std::unique_ptr<StagingManager> stagingManager;
+    std::unique_ptr<TextureStreamer> textureStreamer;
+    std::unique_ptr<Ktx2Loader> ktx2Loader;
+    std::unique_ptr<AssetArchive> assetArchive;
+    std::unique_ptr<JobSystem> jobSystem;
+    std::unique_ptr<FrameAllocator> frameAllocator;
+    std::unique_ptr<Scene> scene;
+    std::unique_ptr<SceneCuller> sceneCuller;
+    std::unique_ptr<OcclusionCuller> occlusionCuller;
+    std::unique_ptr<GeometryPool> geometryPool;
+    std::unique_ptr<LodSelector> lodSelector;
+    std::unique_ptr<Metrics> metrics;
+    std::unique_ptr<FrameReadback> frameReadback;
+    std::unique_ptr<DynamicResolution> dynamicResolution;
+    // 在构造时创建，深度与模拟回调可在Initialize之前设置
+    std::unique_ptr<FramePipeline> framePipeline;
+    Mat4 cameraViewProjection = Mat4::Identity();
+    LodCamera lodCamera;
+    // 显示高度由渲染线程在重建交换链后写入，lodCamera的投影系数所对应的高度只在模拟阶段访问
+    std::atomic<uint32_t> displayHeight{0};
+    uint32_t lodProjectionHeight = 0;
     
-    // GLFW窗口
+    bool framePassEnabled[PASS_COUNT] = {true, true, true, true, true};
+    
+    // GLFW窗口（无窗口模式下为空）
     GLFWwindow* window = nullptr;
+    VkExtent2D framebufferExtent = {0, 0};
+    bool swapchainOutOfDate = false;
+    bool headless = false;
+    VkExtent2D headlessExtent = {1280, 720};
+    
+    // 帧捕获
+    bool captureEnabled = false;
+    uint64_t captureFrame = UINT64_MAX;
+    std::string capturePath;
     
-    // 初始化各阶段
+    // 初始化各阶段（Initialize按依赖关系并行调度）
+    bool InitWindow();
     bool InitInstance();
     bool SetupDebugMessenger();
     bool CreateSurface();
@@ -83,8 +276,13 @@ private:
     bool CreateLogicalDevice();
     bool CreateSyncObjects();
     bool InitVMA();
+    bool InitStreaming();
+    bool CreatePipelineCache();
+    void SavePipelineCache();
+    void PrefetchShaderCode(const std::vector<const char*>& paths);
+    void RecordFrame(VkCommandBuffer commandBuffer, const RenderSnapshot& snapshot);
+    void PresentFrame(uint32_t imageIndex, VkSemaphore waitSemaphore);
     
     // 清理
     void CleanupSwapchain();
-    void RecreateSwapchain();
 }; 
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "VulkanLoader.hpp"
+#include <iostream>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#define VGE_VULKAN_DEFINE_FUNCTION(name) PFN_##name name = nullptr;
+PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr = nullptr;
+VGE_VULKAN_GLOBAL_FUNCTIONS(VGE_VULKAN_DEFINE_FUNCTION)
+VGE_VULKAN_INSTANCE_FUNCTIONS(VGE_VULKAN_DEFINE_FUNCTION)
+VGE_VULKAN_DEVICE_FUNCTIONS(VGE_VULKAN_DEFINE_FUNCTION)
+#define VGE_VULKAN_DEFINE_ALIASED_FUNCTION(name, alias) PFN_##name name = nullptr;
+VGE_VULKAN_DEVICE_ALIASED_FUNCTIONS(VGE_VULKAN_DEFINE_ALIASED_FUNCTION)
+
+namespace {
+    void* library = nullptr;
+
+    void* OpenLibrary() {
+#if defined(_WIN32)
+        return reinterpret_cast<void*>(LoadLibraryA("vulkan-1.dll"));
+#elif defined(__APPLE__)
+        void* handle = dlopen("libvulkan.dylib", RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) handle = dlopen("libvulkan.1.dylib", RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) handle = dlopen("libMoltenVK.dylib", RTLD_NOW | RTLD_LOCAL);
+        return handle;
+#else
+        void* handle = dlopen("libvulkan.so.1", RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) handle = dlopen("libvulkan.so", RTLD_NOW | RTLD_LOCAL);
+        return handle;
+#endif
+    }
+
+    void* GetSymbol(void* handle, const char* name) {
+#if defined(_WIN32)
+        return reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(handle), name));
+#else
+        return dlsym(handle, name);
+#endif
+    }
+
+    void CloseLibrary(void* handle) {
+#if defined(_WIN32)
+        FreeLibrary(reinterpret_cast<HMODULE>(handle));
+#else
+        dlclose(handle);
+#endif
+    }
+}
+
+namespace VulkanLoader {
+    bool Initialize() {
+        if (library != nullptr) return true;
+
+        library = OpenLibrary();
+        if (library == nullptr) {
+            std::cerr << "Vulkan loader library not found" << std::endl;
+            return false;
+        }
+        vkGetInstanceProcAddr = reinterpret_cast<PFN_vkGetInstanceProcAddr>(GetSymbol(library, "vkGetInstanceProcAddr"));
+        if (vkGetInstanceProcAddr == nullptr) {
+            std::cerr << "vkGetInstanceProcAddr not exported by the Vulkan loader" << std::endl;
+            CloseLibrary(library);
+            library = nullptr;
+            return false;
+        }
+
+        // 1.0加载器没有vkEnumerateInstanceVersion，调用方需检查空指针
+#define VGE_VULKAN_LOAD_GLOBAL(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(VK_NULL_HANDLE, #name));
+        VGE_VULKAN_GLOBAL_FUNCTIONS(VGE_VULKAN_LOAD_GLOBAL)
+#undef VGE_VULKAN_LOAD_GLOBAL
+        return vkCreateInstance != nullptr;
+    }
+
+    void LoadInstance(VkInstance instance) {
+#define VGE_VULKAN_LOAD_INSTANCE(name) name = reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr(instance, #name));
+        VGE_VULKAN_INSTANCE_FUNCTIONS(VGE_VULKAN_LOAD_INSTANCE)
+#undef VGE_VULKAN_LOAD_INSTANCE
+    }
+
+    void LoadDevice(VkDevice device) {
+#define VGE_VULKAN_LOAD_DEVICE(name) name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name));
+        VGE_VULKAN_DEVICE_FUNCTIONS(VGE_VULKAN_LOAD_DEVICE)
+#undef VGE_VULKAN_LOAD_DEVICE
+#define VGE_VULKAN_LOAD_ALIASED(name, alias) \
+        name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name)); \
+        if (name == nullptr) name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #alias));
+        VGE_VULKAN_DEVICE_ALIASED_FUNCTIONS(VGE_VULKAN_LOAD_ALIASED)
+#undef VGE_VULKAN_LOAD_ALIASED
+    }
+
+    void Shutdown() {
+#define VGE_VULKAN_RESET_FUNCTION(name) name = nullptr;
+        VGE_VULKAN_DEVICE_FUNCTIONS(VGE_VULKAN_RESET_FUNCTION)
+#define VGE_VULKAN_RESET_ALIASED(name, alias) name = nullptr;
+        VGE_VULKAN_DEVICE_ALIASED_FUNCTIONS(VGE_VULKAN_RESET_ALIASED)
+#undef VGE_VULKAN_RESET_ALIASED
+        VGE_VULKAN_INSTANCE_FUNCTIONS(VGE_VULKAN_RESET_FUNCTION)
+        VGE_VULKAN_GLOBAL_FUNCTIONS(VGE_VULKAN_RESET_FUNCTION)
+#undef VGE_VULKAN_RESET_FUNCTION
+        vkGetInstanceProcAddr = nullptr;
+
+        if (library != nullptr) {
+            CloseLibrary(library);
+            library = nullptr;
+        }
+    }
+}
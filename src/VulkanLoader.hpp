@@ -0,0 +1,150 @@
+#pragma once
+// 引擎通过本头文件使用Vulkan：目标定义VK_NO_PROTOTYPES，下列函数是全局函数指针，
+// 运行时动态打开加载器，设备级函数由vkGetDeviceProcAddr直接解析到驱动入口，
+// 调用时不再经过加载器的trampoline分发
+#if defined(VULKAN_H_) && !defined(VK_NO_PROTOTYPES)
+#error "VulkanLoader.hpp must be included before vulkan.h, or VK_NO_PROTOTYPES must be defined for the target"
+#endif
+#ifndef VK_NO_PROTOTYPES
+#define VK_NO_PROTOTYPES
+#endif
+#include <vulkan/vulkan.h>
+
+// 不依赖实例的全局函数
+#define VGE_VULKAN_GLOBAL_FUNCTIONS(X) \
+    X(vkCreateInstance) \
+    X(vkEnumerateInstanceVersion) \
+    X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties)
+
+// 实例级函数（包括物理设备查询和表面）
+#define VGE_VULKAN_INSTANCE_FUNCTIONS(X) \
+    X(vkDestroyInstance) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceProperties2) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceFormatProperties) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceSurfaceSupportKHR) \
+    X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(vkGetPhysicalDeviceSurfaceFormatsKHR) \
+    X(vkGetPhysicalDeviceSurfacePresentModesKHR) \
+    X(vkDestroySurfaceKHR) \
+    X(vkCreateDevice) \
+    X(vkGetDeviceProcAddr)
+
+// 设备级函数：命令录制、提交和资源创建
+#define VGE_VULKAN_DEVICE_FUNCTIONS(X) \
+    X(vkDestroyDevice) \
+    X(vkDeviceWaitIdle) \
+    X(vkGetDeviceQueue) \
+    X(vkQueueSubmit) \
+    X(vkQueueWaitIdle) \
+    X(vkQueuePresentKHR) \
+    X(vkCreateSwapchainKHR) \
+    X(vkDestroySwapchainKHR) \
+    X(vkGetSwapchainImagesKHR) \
+    X(vkAcquireNextImageKHR) \
+    X(vkCreateFence) \
+    X(vkDestroyFence) \
+    X(vkResetFences) \
+    X(vkWaitForFences) \
+    X(vkGetFenceStatus) \
+    X(vkCreateSemaphore) \
+    X(vkDestroySemaphore) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkFreeCommandBuffers) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkResetCommandBuffer) \
+    X(vkCreateImage) \
+    X(vkDestroyImage) \
+    X(vkGetImageMemoryRequirements) \
+    X(vkCreateImageView) \
+    X(vkDestroyImageView) \
+    X(vkCreateSampler) \
+    X(vkDestroySampler) \
+    X(vkCreateRenderPass) \
+    X(vkDestroyRenderPass) \
+    X(vkCreateFramebuffer) \
+    X(vkDestroyFramebuffer) \
+    X(vkCreateShaderModule) \
+    X(vkDestroyShaderModule) \
+    X(vkCreatePipelineCache) \
+    X(vkDestroyPipelineCache) \
+    X(vkGetPipelineCacheData) \
+    X(vkCreatePipelineLayout) \
+    X(vkDestroyPipelineLayout) \
+    X(vkCreateGraphicsPipelines) \
+    X(vkCreateComputePipelines) \
+    X(vkDestroyPipeline) \
+    X(vkCreateDescriptorSetLayout) \
+    X(vkDestroyDescriptorSetLayout) \
+    X(vkCreateDescriptorPool) \
+    X(vkDestroyDescriptorPool) \
+    X(vkAllocateDescriptorSets) \
+    X(vkUpdateDescriptorSets) \
+    X(vkCreateQueryPool) \
+    X(vkDestroyQueryPool) \
+    X(vkGetQueryPoolResults) \
+    X(vkCmdBeginRenderPass) \
+    X(vkCmdEndRenderPass) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdBindDescriptorSets) \
+    X(vkCmdBindVertexBuffers) \
+    X(vkCmdBindIndexBuffer) \
+    X(vkCmdPushConstants) \
+    X(vkCmdSetViewport) \
+    X(vkCmdSetScissor) \
+    X(vkCmdSetDepthBias) \
+    X(vkCmdDraw) \
+    X(vkCmdDrawIndexed) \
+    X(vkCmdDrawIndirect) \
+    X(vkCmdDrawIndexedIndirect) \
+    X(vkCmdDispatch) \
+    X(vkCmdPipelineBarrier) \
+    X(vkCmdCopyBuffer) \
+    X(vkCmdCopyBufferToImage) \
+    X(vkCmdCopyImage) \
+    X(vkCmdCopyImageToBuffer) \
+    X(vkCmdFillBuffer) \
+    X(vkCmdResetQueryPool) \
+    X(vkCmdWriteTimestamp) \
+    X(vkCmdSetColorBlendEnableEXT) \
+    X(vkCmdSetColorBlendEquationEXT) \
+    X(vkCmdSetColorWriteMaskEXT)
+
+// 已提升为1.3核心的设备级函数：优先解析核心名称，低版本设备回退到扩展别名
+#define VGE_VULKAN_DEVICE_ALIASED_FUNCTIONS(X) \
+    X(vkCmdSetCullMode, vkCmdSetCullModeEXT) \
+    X(vkCmdSetFrontFace, vkCmdSetFrontFaceEXT) \
+    X(vkCmdSetPrimitiveTopology, vkCmdSetPrimitiveTopologyEXT) \
+    X(vkCmdSetDepthTestEnable, vkCmdSetDepthTestEnableEXT) \
+    X(vkCmdSetDepthWriteEnable, vkCmdSetDepthWriteEnableEXT) \
+    X(vkCmdSetDepthCompareOp, vkCmdSetDepthCompareOpEXT) \
+    X(vkCmdSetDepthBiasEnable, vkCmdSetDepthBiasEnableEXT) \
+    X(vkCmdSetPrimitiveRestartEnable, vkCmdSetPrimitiveRestartEnableEXT)
+
+#define VGE_VULKAN_DECLARE_FUNCTION(name) extern PFN_##name name;
+extern PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+VGE_VULKAN_GLOBAL_FUNCTIONS(VGE_VULKAN_DECLARE_FUNCTION)
+VGE_VULKAN_INSTANCE_FUNCTIONS(VGE_VULKAN_DECLARE_FUNCTION)
+VGE_VULKAN_DEVICE_FUNCTIONS(VGE_VULKAN_DECLARE_FUNCTION)
+#define VGE_VULKAN_DECLARE_ALIASED_FUNCTION(name, alias) extern PFN_##name name;
+VGE_VULKAN_DEVICE_ALIASED_FUNCTIONS(VGE_VULKAN_DECLARE_ALIASED_FUNCTION)
+
+namespace VulkanLoader {
+    // 打开系统Vulkan加载器并解析全局函数，失败时返回false
+    bool Initialize();
+    // 实例创建后解析实例级函数
+    void LoadInstance(VkInstance instance);
+    // 设备创建后解析设备级函数（引擎只使用一个设备），未启用的扩展函数为空指针
+    void LoadDevice(VkDevice device);
+    // 清空所有函数指针并关闭加载器
+    void Shutdown();
+}
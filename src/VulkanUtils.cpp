@@ -2,67 +2,52 @@
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
-#include <set>
 
 namespace VulkanUtils {
     
-    static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
-        VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-        VkDebugUtilsMessageTypeFlagsEXT messageType,
-        const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-        void* pUserData) {
-        
-        std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
-        return VK_FALSE;
-    }
-    
-    VkPhysicalDevice PickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface) {
-        uint32_t deviceCount = 0;
-        vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
-        if (deviceCount == 0) {
-            throw std::runtime_error("failed to find GPUs with Vulkan support!");
-        }
+    bool IsInstanceLayerSupported(const char* layerName) {
+        uint32_t layerCount = 0;
+        vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
         
-        std::vector<VkPhysicalDevice> devices(deviceCount);
-        vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+        std::vector<VkLayerProperties> availableLayers(layerCount);
+        vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
         
-        for (const auto& device : devices) {
-            if (IsDeviceSuitable(device, surface)) {
-                return device;
+        for (const auto& layer : availableLayers) {
+            if (std::string(layer.layerName) == layerName) {
+                return true;
             }
         }
-        
-        throw std::runtime_error("failed to find a suitable GPU!");
+        return false;
     }
     
-    bool IsDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface) {
-        VkPhysicalDeviceProperties deviceProperties;
-        VkPhysicalDeviceFeatures deviceFeatures;
-        vkGetPhysicalDeviceProperties(device, &deviceProperties);
-        vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
-        
-        return deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU &&
-               deviceFeatures.geometryShader &&
-               CheckDeviceExtensionSupport(device) &&
-               QuerySwapChainSupport(device, surface);
+    bool IsInstanceExtensionSupported(const char* extensionName) {
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+        
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+        
+        for (const auto& extension : availableExtensions) {
+            if (std::string(extension.extensionName) == extensionName) {
+                return true;
+            }
+        }
+        return false;
     }
     
-    bool CheckDeviceExtensionSupport(VkPhysicalDevice device) {
+    bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName) {
         uint32_t extensionCount;
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
         
         std::vector<VkExtensionProperties> availableExtensions(extensionCount);
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
         
-        std::set<std::string> requiredExtensions = {
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME
-        };
-        
         for (const auto& extension : availableExtensions) {
-            requiredExtensions.erase(extension.extensionName);
+            if (std::string(extension.extensionName) == extensionName) {
+                return true;
+            }
         }
-        
-        return requiredExtensions.empty();
+        return false;
     }
     
     uint32_t FindQueueFamily(VkPhysicalDevice device, VkSurfaceKHR surface) {
@@ -132,14 +117,14 @@ namespace VulkanUtils {
         return buffer;
     }
     
-    VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code) {
+    VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code, const VkAllocationCallbacks* allocator) {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         createInfo.codeSize = code.size();
         createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
         
         VkShaderModule shaderModule;
-        if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        if (vkCreateShaderModule(device, &createInfo, allocator, &shaderModule) != VK_SUCCESS) {
             throw std::runtime_error("failed to create shader module!");
         }
         
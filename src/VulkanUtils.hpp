@@ -1,25 +1,21 @@
 #pragma once
-#include <vulkan/vulkan.h>
+#include "VulkanLoader.hpp"
 #include <vector>
 #include <string>
 
 namespace VulkanUtils {
-    // 调试回调
-    VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
-        VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-        VkDebugUtilsMessageTypeFlagsEXT messageType,
-        const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-        void* pUserData);
-    
+    // 调试信使（回调见DebugLogger）
     VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, 
                                          const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger);
     void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, 
                                       const VkAllocationCallbacks* pAllocator);
     
-    // 物理设备选择
-    VkPhysicalDevice PickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface);
-    bool IsDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface);
-    bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+    // 实例层与扩展查询
+    bool IsInstanceLayerSupported(const char* layerName);
+    bool IsInstanceExtensionSupported(const char* extensionName);
+    
+    // 物理设备查询（设备选择见DeviceSelector）
+    bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName);
     
     // 队列族查找
     uint32_t FindQueueFamily(VkPhysicalDevice device, VkSurfaceKHR surface);
@@ -29,5 +25,7 @@ namespace VulkanUtils {
     
     // 工具函数
     std::vector<char> ReadFile(const std::string& filename);
-    VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code);
+    // allocator须与销毁该模块时传入的回调一致
+    VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& code,
+                                      const VkAllocationCallbacks* allocator = nullptr);
 } 
\ No newline at end of file
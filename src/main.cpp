@@ -2,15 +2,97 @@
 #include "Renderer.hpp"
 #include "Swapchain.hpp"
 #include "VulkanUtils.hpp"
+#include "Profiler.hpp"
+#include "Metrics.hpp"
+#include "FrameReadback.hpp"
+#include "DynamicResolution.hpp"
+#include "RenderThread.hpp"
+#include "FramePipeline.hpp"
 #include <iostream>
 #include <stdexcept>
 
+// GLFW回调在主线程上运行，只把事件转发给渲染线程
 static void FramebufferResizeCallback(GLFWwindow* window, int width, int height) {
-    auto context = reinterpret_cast<VulkanContext*>(glfwGetWindowUserPointer(window));
-    context->OnWindowResize();
+    WindowEvent event;
+    event.type = WindowEvent::EVENT_RESIZE;
+    event.width = width;
+    event.height = height;
+    reinterpret_cast<RenderThread*>(glfwGetWindowUserPointer(window))->PostEvent(event);
+}
+
+static void IconifyCallback(GLFWwindow* window, int iconified) {
+    WindowEvent event;
+    event.type = WindowEvent::EVENT_ICONIFY;
+    event.action = iconified;
+    reinterpret_cast<RenderThread*>(glfwGetWindowUserPointer(window))->PostEvent(event);
+}
+
+static void KeyCallback(GLFWwindow* window, int key, int, int action, int mods) {
+    WindowEvent event;
+    event.type = WindowEvent::EVENT_KEY;
+    event.key = key;
+    event.action = action;
+    event.mods = mods;
+    reinterpret_cast<RenderThread*>(glfwGetWindowUserPointer(window))->PostEvent(event);
+}
+
+static void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    WindowEvent event;
+    event.type = WindowEvent::EVENT_MOUSE_BUTTON;
+    event.key = button;
+    event.action = action;
+    event.mods = mods;
+    reinterpret_cast<RenderThread*>(glfwGetWindowUserPointer(window))->PostEvent(event);
+}
+
+static void CursorPositionCallback(GLFWwindow* window, double x, double y) {
+    WindowEvent event;
+    event.type = WindowEvent::EVENT_CURSOR;
+    event.x = x;
+    event.y = y;
+    reinterpret_cast<RenderThread*>(glfwGetWindowUserPointer(window))->PostEvent(event);
+}
+
+// 在渲染线程上处理输入：F7轮换模拟/渲染流水线深度，F8切换动态分辨率，F9截图，F11捕获当前帧（需VGE_CAPTURE=1启动），F12导出CPU区段trace
+static void HandleEvent(VulkanContext* context, const WindowEvent& event) {
+    if (event.type != WindowEvent::EVENT_KEY) return;
+    int key = event.key;
+    int action = event.action;
+    if (key == GLFW_KEY_F7 && action == GLFW_PRESS) {
+        FramePipeline* pipeline = context->GetFramePipeline();
+        FramePipeline::Statistics statistics = pipeline->GetStatistics();
+        std::cout << "Pipeline depth " << pipeline->GetDepth() << ": latency " << statistics.averageLatencyMilliseconds
+                  << " ms (max " << statistics.maxLatencyMilliseconds << " ms)" << std::endl;
+        pipeline->SetDepth(pipeline->GetDepth() % FramePipeline::MAX_DEPTH + 1);
+        std::cout << "Pipeline depth " << pipeline->GetDepth() << std::endl;
+    }
+    if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
+        DynamicResolution* resolution = context->GetDynamicResolution();
+        DynamicResolution::Settings settings = resolution->GetSettings();
+        settings.enabled = !settings.enabled;
+        resolution->SetSettings(settings);
+        std::cout << "Dynamic resolution " << (resolution->IsActive() ? "on" : "off")
+                  << ", GPU frame " << resolution->GetGpuMilliseconds() << " ms" << std::endl;
+    }
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+        context->GetFrameReadback()->RequestScreenshot("screenshot_" + std::to_string(context->GetFrameNumber()) + ".png");
+    }
+    if (key == GLFW_KEY_F11 && action == GLFW_PRESS) {
+        if (context->IsCaptureEnabled()) {
+            context->RequestCapture("capture.vgef");
+        } else {
+            std::cerr << "Frame capture is disabled, restart with VGE_CAPTURE=1" << std::endl;
+        }
+    }
+#ifdef VGE_PROFILER
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS && Profiler::ExportChromeTrace("trace.json")) {
+        std::cout << "Exported CPU trace to trace.json" << std::endl;
+    }
+#endif
 }
 
 int main() {
+    VGE_PROFILE_THREAD("Main");
     try {
         VulkanContext context;
         
@@ -19,16 +101,48 @@ int main() {
             return -1;
         }
         
-        // 设置窗口大小变化回调
-        glfwSetFramebufferSizeCallback(context.GetWindow(), FramebufferResizeCallback);
-        glfwSetWindowUserPointer(context.GetWindow(), &context);
+        // 每300帧写出一次计数器，便于对比回归
+        context.GetMetrics()->SetOutput("metrics", 300);
+        // GPU帧时间保持在60Hz预算内，渲染缩放在0.5到1之间自动调整
+        DynamicResolution::Settings resolutionSettings;
+        resolutionSettings.enabled = true;
+        resolutionSettings.controller.targetMilliseconds = 16.0f;
+        context.GetDynamicResolution()->SetSettings(resolutionSettings);
         
         std::cout << "Vulkan engine initialized successfully!" << std::endl;
         
-        // 主渲染循环
-        while (!context.ShouldClose()) {
-            glfwPollEvents();
-            context.DrawFrame();
+        // 渲染线程独占队列与交换链，窗口回调只向它转发事件
+        RenderThread renderThread(&context);
+        renderThread.SetEventHandler([&context](const WindowEvent& event) { HandleEvent(&context, event); });
+        GLFWwindow* window = context.GetWindow();
+        glfwSetWindowUserPointer(window, &renderThread);
+        glfwSetFramebufferSizeCallback(window, FramebufferResizeCallback);
+        glfwSetWindowIconifyCallback(window, IconifyCallback);
+        glfwSetKeyCallback(window, KeyCallback);
+        glfwSetMouseButtonCallback(window, MouseButtonCallback);
+        glfwSetCursorPosCallback(window, CursorPositionCallback);
+        renderThread.Start();
+        
+        // 主线程只处理系统事件；渲染线程异常退出时会发送空事件唤醒这里
+        while (!context.ShouldClose() && renderThread.IsRunning()) {
+            if (renderThread.HasPendingEvents()) {
+                glfwWaitEventsTimeout(0.005);
+            } else {
+                glfwWaitEvents();
+            }
+            renderThread.FlushPendingEvents();
+        }
+        
+        // 先解除回调再停止渲染线程，之后的事件不再进入队列
+        glfwSetWindowUserPointer(window, nullptr);
+        glfwSetFramebufferSizeCallback(window, nullptr);
+        glfwSetWindowIconifyCallback(window, nullptr);
+        glfwSetKeyCallback(window, nullptr);
+        glfwSetMouseButtonCallback(window, nullptr);
+        glfwSetCursorPosCallback(window, nullptr);
+        renderThread.Stop();
+        if (renderThread.GetDroppedEventCount() > 0) {
+            std::cout << "Render thread dropped " << renderThread.GetDroppedEventCount() << " input events" << std::endl;
         }
         
         context.Cleanup();
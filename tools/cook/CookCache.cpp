@@ -0,0 +1,121 @@
+#include "CookCache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace {
+    const char CACHE_MAGIC[4] = {'V', 'G', 'E', 'C'};
+    const uint32_t CACHE_VERSION = 1;
+
+    template<typename T>
+    void WriteValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool ReadValue(std::ifstream& file, T& value) {
+        file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return static_cast<bool>(file);
+    }
+}
+
+CookCache::CookCache(const std::string& directory) : directory(directory) {}
+
+bool CookCache::Initialize() {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "failed to create cache directory " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint64_t CookCache::HashBytes(const void* data, size_t size, uint64_t seed) {
+    // FNV-1a 64
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t CookCache::ComputeKey(const std::vector<uint8_t>& content, const std::string& cookerTag) {
+    uint64_t hash = HashBytes(cookerTag.data(), cookerTag.size());
+    return HashBytes(content.data(), content.size(), hash);
+}
+
+std::string CookCache::GetEntryPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool CookCache::Load(uint64_t key, std::vector<CookOutput>& outputs) const {
+    std::ifstream file(GetEntryPath(key), std::ios::binary);
+    if (!file.is_open()) return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    file.read(magic, sizeof(magic));
+    if (!file || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) return false;
+    if (!ReadValue(file, version) || version != CACHE_VERSION) return false;
+    if (!ReadValue(file, count)) return false;
+
+    std::vector<CookOutput> loaded(count);
+    for (auto& output : loaded) {
+        uint32_t nameLength = 0;
+        uint8_t type = 0;
+        uint8_t compression = 0;
+        uint64_t size = 0;
+        if (!ReadValue(file, nameLength)) return false;
+        output.name.resize(nameLength);
+        file.read(&output.name[0], nameLength);
+        if (!ReadValue(file, type) || !ReadValue(file, compression) || !ReadValue(file, size)) return false;
+        output.type = static_cast<AssetType>(type);
+        output.compression = static_cast<AssetCompression>(compression);
+        output.data.resize(static_cast<size_t>(size));
+        file.read(reinterpret_cast<char*>(output.data.data()), static_cast<std::streamsize>(size));
+        if (!file) return false;
+    }
+
+    outputs = std::move(loaded);
+    return true;
+}
+
+bool CookCache::Store(uint64_t key, const std::vector<CookOutput>& outputs) const {
+    // 先写临时文件再重命名，避免中断时留下不完整的缓存项
+    std::string path = GetEntryPath(key);
+    std::string tempPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        WriteValue(file, CACHE_VERSION);
+        WriteValue(file, static_cast<uint32_t>(outputs.size()));
+        for (const auto& output : outputs) {
+            WriteValue(file, static_cast<uint32_t>(output.name.size()));
+            file.write(output.name.data(), static_cast<std::streamsize>(output.name.size()));
+            WriteValue(file, static_cast<uint8_t>(output.type));
+            WriteValue(file, static_cast<uint8_t>(output.compression));
+            WriteValue(file, static_cast<uint64_t>(output.data.size()));
+            file.write(reinterpret_cast<const char*>(output.data.data()), static_cast<std::streamsize>(output.data.size()));
+        }
+        if (!file) return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
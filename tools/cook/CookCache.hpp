@@ -0,0 +1,25 @@
+#pragma once
+#include "CookTypes.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 按内容哈希缓存烘焙结果：键由输入内容、烘焙器版本和设置共同决定，
+// 输入未变化时直接复用上次的输出
+class CookCache {
+public:
+    explicit CookCache(const std::string& directory);
+
+    bool Initialize();
+
+    static uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+    static uint64_t ComputeKey(const std::vector<uint8_t>& content, const std::string& cookerTag);
+
+    bool Load(uint64_t key, std::vector<CookOutput>& outputs) const;
+    bool Store(uint64_t key, const std::vector<CookOutput>& outputs) const;
+
+private:
+    std::string GetEntryPath(uint64_t key) const;
+
+    std::string directory;
+};
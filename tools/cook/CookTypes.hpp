@@ -0,0 +1,31 @@
+#pragma once
+#include "AssetArchive.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 一个输入文件烘焙出的一个档案条目
+struct CookOutput {
+    std::string name;                                   // 档案内名称（相对根目录）
+    AssetType type = AssetType::Raw;
+    AssetCompression compression = AssetCompression::None;
+    std::vector<uint8_t> data;
+};
+
+struct CookSettings {
+    std::string glslc = "glslc";
+    std::string tempDirectory;
+    AssetCompression compression = AssetCompression::LZ4;
+    uint32_t vertexCacheSize = 32;
+    uint32_t lodCount = 5;                              // 包括LOD 0，1表示不生成LOD
+    float lodReduction = 0.5f;                          // 每级相对上一级的三角形比例
+};
+
+// 单个烘焙任务
+struct CookJob {
+    std::string sourcePath;                             // 磁盘路径
+    std::string assetName;                              // 相对根目录的名称
+    std::vector<CookOutput> outputs;
+    std::string error;
+    bool cached = false;
+};
@@ -0,0 +1,840 @@
+#include "MeshCooker.hpp"
+#include "CookedMesh.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+    const uint32_t MAX_CACHE_SIZE = 32;
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+    const size_t MIN_LOD_TRIANGLES = 32;
+    const float MIN_LOD_REDUCTION = 0.85f;     // 简化后仍超过上一级该比例时停止生成LOD
+
+    struct ObjIndex {
+        int position;
+        int uv;
+        int normal;
+
+        bool operator==(const ObjIndex& other) const {
+            return position == other.position && uv == other.uv && normal == other.normal;
+        }
+    };
+
+    struct ObjIndexHash {
+        size_t operator()(const ObjIndex& index) const {
+            size_t hash = static_cast<size_t>(index.position) * 73856093u;
+            hash ^= static_cast<size_t>(index.uv) * 19349663u;
+            hash ^= static_cast<size_t>(index.normal) * 83492791u;
+            return hash;
+        }
+    };
+
+    // OBJ索引从1开始，负数表示相对末尾
+    int ResolveObjIndex(int index, size_t count) {
+        if (index > 0) return index - 1;
+        if (index < 0) return static_cast<int>(count) + index;
+        return -1;
+    }
+
+    bool ParseFaceVertex(const std::string& token, size_t positionCount, size_t uvCount, size_t normalCount, ObjIndex& result) {
+        int values[3] = {0, 0, 0};
+        size_t start = 0;
+        for (int component = 0; component < 3 && start <= token.size(); component++) {
+            size_t end = token.find('/', start);
+            std::string part = token.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if (!part.empty()) {
+                values[component] = std::atoi(part.c_str());
+            }
+            if (end == std::string::npos) break;
+            start = end + 1;
+        }
+
+        result.position = ResolveObjIndex(values[0], positionCount);
+        result.uv = ResolveObjIndex(values[1], uvCount);
+        result.normal = ResolveObjIndex(values[2], normalCount);
+        if (result.position < 0 || result.position >= static_cast<int>(positionCount)) return false;
+        if (result.uv >= static_cast<int>(uvCount)) return false;
+        if (result.normal >= static_cast<int>(normalCount)) return false;
+        return true;
+    }
+
+    float ComputeVertexScore(int32_t cachePosition, uint32_t activeTriangles, uint32_t cacheSize) {
+        if (activeTriangles == 0) {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                // 刚使用过的三角形的顶点，固定分数避免过度偏向单一方向
+                score = LAST_TRIANGLE_SCORE;
+            } else {
+                float scaler = 1.0f / static_cast<float>(cacheSize - 3);
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+            }
+        }
+
+        // 剩余三角形越少越优先，尽快完成该顶点
+        score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(activeTriangles), -VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    void Cross(const float a[3], const float b[3], float out[3]) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    void TriangleNormal(const float* p0, const float* p1, const float* p2, float out[3]) {
+        float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        Cross(e1, e2, out);
+    }
+
+    // 对称4x4二次误差矩阵，误差为点到累加平面距离平方的加权和，除以总权重得到均方距离
+    struct Quadric {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+        double weight = 0.0;
+
+        void AddPlane(double nx, double ny, double nz, double d, double weight) {
+            a00 += weight * nx * nx; a01 += weight * nx * ny; a02 += weight * nx * nz;
+            a11 += weight * ny * ny; a12 += weight * ny * nz; a22 += weight * nz * nz;
+            b0 += weight * nx * d; b1 += weight * ny * d; b2 += weight * nz * d;
+            c += weight * d * d;
+            this->weight += weight;
+        }
+
+        void Add(const Quadric& other) {
+            a00 += other.a00; a01 += other.a01; a02 += other.a02;
+            a11 += other.a11; a12 += other.a12; a22 += other.a22;
+            b0 += other.b0; b1 += other.b1; b2 += other.b2;
+            c += other.c;
+            weight += other.weight;
+        }
+
+        double Evaluate(const float* p) const {
+            double x = p[0], y = p[1], z = p[2];
+            double result = a00 * x * x + a11 * y * y + a22 * z * z +
+                            2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                            2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return weight > 0.0 ? std::max(result, 0.0) / weight : 0.0;
+        }
+    };
+
+    struct PositionKey {
+        uint32_t bits[3];
+
+        bool operator==(const PositionKey& other) const {
+            return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+        }
+    };
+
+    struct PositionKeyHash {
+        size_t operator()(const PositionKey& key) const {
+            return (static_cast<size_t>(key.bits[0]) * 73856093u) ^ (static_cast<size_t>(key.bits[1]) * 19349663u) ^
+                   (static_cast<size_t>(key.bits[2]) * 83492791u);
+        }
+    };
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b) {
+        return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+    }
+
+    template<typename T>
+    void AppendBytes(std::vector<uint8_t>& data, const T* values, size_t count) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+        data.insert(data.end(), bytes, bytes + count * sizeof(T));
+    }
+}
+
+namespace MeshCooker {
+
+bool IsMeshFile(const std::string& path) {
+    std::string lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower.size() > 4 && lower.compare(lower.size() - 4, 4, ".obj") == 0;
+}
+
+std::string GetOutputName(const std::string& assetName) {
+    return assetName.substr(0, assetName.size() - 4) + ".mesh";
+}
+
+std::string GetCookerTag(const CookSettings& settings) {
+    return "mesh-v" + std::to_string(COOKED_MESH_VERSION) + "-cache" + std::to_string(settings.vertexCacheSize) +
+           "-lod" + std::to_string(settings.lodCount) + "x" + std::to_string(settings.lodReduction);
+}
+
+bool ParseObj(const std::vector<uint8_t>& source, std::vector<SourceVertex>& vertices,
+              std::vector<uint32_t>& indices, std::string& error) {
+    std::vector<float> positions;
+    std::vector<float> uvs;
+    std::vector<float> normals;
+    std::vector<int> vertexPositionIndex;
+    std::unordered_map<ObjIndex, uint32_t, ObjIndexHash> vertexMap;
+    bool missingNormals = false;
+
+    std::istringstream stream(std::string(source.begin(), source.end()));
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(stream, line)) {
+        lineNumber++;
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+
+        if (keyword == "v") {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            tokens >> x >> y >> z;
+            positions.insert(positions.end(), {x, y, z});
+        } else if (keyword == "vt") {
+            float u = 0.0f, v = 0.0f;
+            tokens >> u >> v;
+            // OBJ的v轴向上，Vulkan纹理坐标向下
+            uvs.insert(uvs.end(), {u, 1.0f - v});
+        } else if (keyword == "vn") {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            tokens >> x >> y >> z;
+            normals.insert(normals.end(), {x, y, z});
+        } else if (keyword == "f") {
+            std::vector<uint32_t> polygon;
+            std::string token;
+            while (tokens >> token) {
+                ObjIndex index;
+                if (!ParseFaceVertex(token, positions.size() / 3, uvs.size() / 2, normals.size() / 3, index)) {
+                    error = "invalid face index on line " + std::to_string(lineNumber);
+                    return false;
+                }
+
+                auto it = vertexMap.find(index);
+                if (it == vertexMap.end()) {
+                    SourceVertex vertex{};
+                    std::memcpy(vertex.position, &positions[index.position * 3], sizeof(vertex.position));
+                    if (index.uv >= 0) {
+                        std::memcpy(vertex.uv, &uvs[index.uv * 2], sizeof(vertex.uv));
+                    }
+                    if (index.normal >= 0) {
+                        std::memcpy(vertex.normal, &normals[index.normal * 3], sizeof(vertex.normal));
+                    } else {
+                        missingNormals = true;
+                    }
+                    it = vertexMap.emplace(index, static_cast<uint32_t>(vertices.size())).first;
+                    vertices.push_back(vertex);
+                    vertexPositionIndex.push_back(index.normal >= 0 ? -1 : index.position);
+                }
+                polygon.push_back(it->second);
+            }
+
+            // 多边形按扇形三角化
+            for (size_t i = 2; i < polygon.size(); i++) {
+                indices.insert(indices.end(), {polygon[0], polygon[i - 1], polygon[i]});
+            }
+        }
+    }
+
+    if (indices.empty()) {
+        error = "mesh has no faces";
+        return false;
+    }
+
+    // 缺少法线的顶点按共享位置累加面积加权面法线
+    if (missingNormals) {
+        std::vector<float> accumulated(positions.size(), 0.0f);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            float normal[3];
+            TriangleNormal(vertices[indices[i]].position, vertices[indices[i + 1]].position,
+                           vertices[indices[i + 2]].position, normal);
+            for (int corner = 0; corner < 3; corner++) {
+                int position = vertexPositionIndex[indices[i + corner]];
+                if (position < 0) continue;
+                for (int axis = 0; axis < 3; axis++) {
+                    accumulated[position * 3 + axis] += normal[axis];
+                }
+            }
+        }
+        for (size_t v = 0; v < vertices.size(); v++) {
+            int position = vertexPositionIndex[v];
+            if (position < 0) continue;
+            std::memcpy(vertices[v].normal, &accumulated[position * 3], sizeof(vertices[v].normal));
+        }
+    }
+
+    for (auto& vertex : vertices) {
+        float length = std::sqrt(vertex.normal[0] * vertex.normal[0] + vertex.normal[1] * vertex.normal[1] +
+                                 vertex.normal[2] * vertex.normal[2]);
+        if (length > 0.0f) {
+            for (float& component : vertex.normal) component /= length;
+        } else {
+            vertex.normal[0] = 0.0f;
+            vertex.normal[1] = 1.0f;
+            vertex.normal[2] = 0.0f;
+        }
+    }
+
+    GenerateTangents(vertices, indices);
+    return true;
+}
+
+void GenerateTangents(std::vector<SourceVertex>& vertices, const std::vector<uint32_t>& indices) {
+    // 每个三角形的dP/du与dP/dv按面积加权累加到顶点
+    std::vector<float> tangents(vertices.size() * 3, 0.0f);
+    std::vector<float> bitangents(vertices.size() * 3, 0.0f);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const SourceVertex& v0 = vertices[indices[i]];
+        const SourceVertex& v1 = vertices[indices[i + 1]];
+        const SourceVertex& v2 = vertices[indices[i + 2]];
+        float e1[3] = {v1.position[0] - v0.position[0], v1.position[1] - v0.position[1], v1.position[2] - v0.position[2]};
+        float e2[3] = {v2.position[0] - v0.position[0], v2.position[1] - v0.position[1], v2.position[2] - v0.position[2]};
+        float du1 = v1.uv[0] - v0.uv[0], dv1 = v1.uv[1] - v0.uv[1];
+        float du2 = v2.uv[0] - v0.uv[0], dv2 = v2.uv[1] - v0.uv[1];
+        float determinant = du1 * dv2 - du2 * dv1;
+        if (std::fabs(determinant) < 1e-12f) continue;
+        float inverse = 1.0f / determinant;
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = indices[i + corner];
+            for (int axis = 0; axis < 3; axis++) {
+                tangents[v * 3 + axis] += (e1[axis] * dv2 - e2[axis] * dv1) * inverse;
+                bitangents[v * 3 + axis] += (e2[axis] * du1 - e1[axis] * du2) * inverse;
+            }
+        }
+    }
+
+    for (size_t v = 0; v < vertices.size(); v++) {
+        SourceVertex& vertex = vertices[v];
+        const float* n = vertex.normal;
+        float* t = &tangents[v * 3];
+        // Gram-Schmidt：去掉沿法线的分量
+        float along = n[0] * t[0] + n[1] * t[1] + n[2] * t[2];
+        for (int axis = 0; axis < 3; axis++) t[axis] -= n[axis] * along;
+        float length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+        if (length < 1e-6f) {
+            // 没有UV或UV退化：取与法线垂直的任意方向
+            float axis[3] = {std::fabs(n[0]) < 0.9f ? 1.0f : 0.0f, std::fabs(n[0]) < 0.9f ? 0.0f : 1.0f, 0.0f};
+            float bitangent[3];
+            Cross(n, axis, bitangent);
+            Cross(bitangent, n, t);
+            length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+        }
+        for (int axis = 0; axis < 3; axis++) vertex.tangent[axis] = t[axis] / length;
+
+        float crossNT[3];
+        Cross(n, vertex.tangent, crossNT);
+        const float* b = &bitangents[v * 3];
+        vertex.tangent[3] = crossNT[0] * b[0] + crossNT[1] * b[1] + crossNT[2] * b[2] < 0.0f ? -1.0f : 1.0f;
+    }
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+    cacheSize = std::max(4u, std::min(cacheSize, MAX_CACHE_SIZE));
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0) return;
+
+    // 顶点到三角形的邻接表
+    std::vector<uint32_t> activeTriangles(vertexCount, 0);
+    for (uint32_t index : indices) {
+        activeTriangles[index]++;
+    }
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + activeTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = indices[t * 3 + corner];
+            adjacency[fill[v]++] = t;
+        }
+    }
+
+    std::vector<int32_t> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        vertexScore[v] = ComputeVertexScore(-1, activeTriangles[v], cacheSize);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(cacheSize + 3);
+    newCache.reserve(cacheSize + 3);
+
+    int64_t bestTriangle = 0;
+    uint32_t scanCursor = 0;
+    while (true) {
+        if (bestTriangle < 0) {
+            // 缓存中没有候选，顺序找下一个未输出的三角形
+            while (scanCursor < triangleCount && emitted[scanCursor]) {
+                scanCursor++;
+            }
+            if (scanCursor == triangleCount) break;
+            bestTriangle = scanCursor;
+        }
+
+        uint32_t triangle = static_cast<uint32_t>(bestTriangle);
+        emitted[triangle] = true;
+        const uint32_t* corners = &indices[triangle * 3];
+
+        newCache.clear();
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = corners[corner];
+            result.push_back(v);
+            newCache.push_back(v);
+
+            // 从顶点的活动三角形列表中移除
+            uint32_t begin = adjacencyOffset[v];
+            uint32_t end = begin + activeTriangles[v];
+            for (uint32_t i = begin; i < end; i++) {
+                if (adjacency[i] == triangle) {
+                    adjacency[i] = adjacency[end - 1];
+                    break;
+                }
+            }
+            activeTriangles[v]--;
+        }
+        for (uint32_t v : cache) {
+            if (v != corners[0] && v != corners[1] && v != corners[2]) {
+                newCache.push_back(v);
+            }
+        }
+
+        // 更新缓存位置和顶点分数，被挤出缓存的顶点也要更新
+        for (size_t i = 0; i < newCache.size(); i++) {
+            uint32_t v = newCache[i];
+            cachePosition[v] = i < cacheSize ? static_cast<int32_t>(i) : -1;
+            vertexScore[v] = ComputeVertexScore(cachePosition[v], activeTriangles[v], cacheSize);
+        }
+
+        // 只在缓存内顶点的三角形中选择下一个
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (uint32_t v : newCache) {
+            uint32_t begin = adjacencyOffset[v];
+            uint32_t end = begin + activeTriangles[v];
+            for (uint32_t i = begin; i < end; i++) {
+                uint32_t t = adjacency[i];
+                float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                triangleScore[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (newCache.size() > cacheSize) {
+            newCache.resize(cacheSize);
+        }
+        cache.swap(newCache);
+    }
+
+    indices.swap(result);
+}
+
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<SourceVertex>& vertices, uint32_t cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) return;
+
+    // 在缓存模拟中三个顶点全部未命中的位置切分簇，簇边界处缓存本就是冷的，
+    // 重排簇顺序几乎不影响顶点缓存效率
+    std::vector<size_t> clusterStart;
+    std::vector<uint32_t> fifo(std::max(3u, cacheSize), UINT32_MAX);
+    size_t fifoHead = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t v = indices[t * 3 + corner];
+            if (std::find(fifo.begin(), fifo.end(), v) == fifo.end()) {
+                fifo[fifoHead] = v;
+                fifoHead = (fifoHead + 1) % fifo.size();
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3) {
+            clusterStart.push_back(t);
+        }
+    }
+    clusterStart.push_back(triangleCount);
+    size_t clusterCount = clusterStart.size() - 1;
+    if (clusterCount < 2) return;
+
+    // 网格面积加权中心
+    float meshCenter[3] = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    std::vector<float> clusterKey(clusterCount);
+    std::vector<float> clusterCenters(clusterCount * 3);
+    std::vector<float> clusterNormals(clusterCount * 3);
+    for (size_t c = 0; c < clusterCount; c++) {
+        float center[3] = {0.0f, 0.0f, 0.0f};
+        float normal[3] = {0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
+        for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+            const float* p0 = vertices[indices[t * 3]].position;
+            const float* p1 = vertices[indices[t * 3 + 1]].position;
+            const float* p2 = vertices[indices[t * 3 + 2]].position;
+            float faceNormal[3];
+            TriangleNormal(p0, p1, p2, faceNormal);
+            float faceArea = std::sqrt(faceNormal[0] * faceNormal[0] + faceNormal[1] * faceNormal[1] + faceNormal[2] * faceNormal[2]);
+            for (int axis = 0; axis < 3; axis++) {
+                center[axis] += (p0[axis] + p1[axis] + p2[axis]) / 3.0f * faceArea;
+                normal[axis] += faceNormal[axis];
+            }
+            area += faceArea;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            meshCenter[axis] += center[axis];
+            clusterCenters[c * 3 + axis] = area > 0.0f ? center[axis] / area : 0.0f;
+            clusterNormals[c * 3 + axis] = normal[axis];
+        }
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) {
+        for (float& component : meshCenter) component /= meshArea;
+    }
+
+    // 簇越靠外且越朝外越先绘制，使其更可能遮挡后面的簇
+    for (size_t c = 0; c < clusterCount; c++) {
+        const float* normal = &clusterNormals[c * 3];
+        float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float key = 0.0f;
+        if (length > 0.0f) {
+            for (int axis = 0; axis < 3; axis++) {
+                key += (clusterCenters[c * 3 + axis] - meshCenter[axis]) * normal[axis] / length;
+            }
+        }
+        clusterKey[c] = key;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return clusterKey[a] > clusterKey[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (size_t c : order) {
+        result.insert(result.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+    }
+    indices.swap(result);
+}
+
+void OptimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<SourceVertex>& vertices) {
+    std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<SourceVertex> reordered;
+    reordered.reserve(vertices.size());
+    for (uint32_t& index : indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    // 未被引用的顶点直接丢弃
+    vertices.swap(reordered);
+}
+
+std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<SourceVertex>& vertices,
+                               size_t targetIndexCount, float& error) {
+    error = 0.0f;
+    uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+    std::vector<uint32_t> result(indices);
+    if (result.size() <= targetIndexCount) return result;
+
+    // 按位置焊接属性顶点，折叠与边界判断都在位置上进行
+    std::vector<uint32_t> positionOf(vertexCount);
+    std::vector<uint32_t> positionVertices;
+    std::unordered_map<PositionKey, uint32_t, PositionKeyHash> positionMap;
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        PositionKey key;
+        std::memcpy(key.bits, vertices[v].position, sizeof(key.bits));
+        auto it = positionMap.emplace(key, static_cast<uint32_t>(positionVertices.size())).first;
+        if (it->second == positionVertices.size()) positionVertices.push_back(0);
+        positionOf[v] = it->second;
+        positionVertices[it->second]++;
+    }
+
+    size_t positionCount = positionVertices.size();
+    std::vector<Quadric> quadrics(positionCount);
+    std::unordered_map<uint64_t, uint32_t> edgeUse;
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const float* p0 = vertices[result[i]].position;
+        float normal[3];
+        TriangleNormal(p0, vertices[result[i + 1]].position, vertices[result[i + 2]].position, normal);
+        double length = std::sqrt(static_cast<double>(normal[0]) * normal[0] + static_cast<double>(normal[1]) * normal[1] +
+                                  static_cast<double>(normal[2]) * normal[2]);
+        if (length > 0.0) {
+            // 面积加权，小三角形对误差的贡献较小
+            double nx = normal[0] / length, ny = normal[1] / length, nz = normal[2] / length;
+            double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+            for (int corner = 0; corner < 3; corner++) {
+                quadrics[positionOf[result[i + corner]]].AddPlane(nx, ny, nz, d, length * 0.5);
+            }
+        }
+        for (int corner = 0; corner < 3; corner++) {
+            uint32_t a = positionOf[result[i + corner]];
+            uint32_t b = positionOf[result[i + (corner + 1) % 3]];
+            if (a != b) edgeUse[EdgeKey(a, b)]++;
+        }
+    }
+
+    // 边界边（只被一个三角形使用）、非流形边和属性接缝上的位置保持不动，
+    // 否则折叠会在轮廓上开洞或拉扯UV
+    std::vector<uint8_t> locked(positionCount, 0);
+    for (const auto& edge : edgeUse) {
+        if (edge.second != 2) {
+            locked[edge.first >> 32] = 1;
+            locked[edge.first & 0xFFFFFFFFu] = 1;
+        }
+    }
+    for (size_t p = 0; p < positionCount; p++) {
+        if (positionVertices[p] > 1) locked[p] = 1;
+    }
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<uint32_t> remap(vertexCount);
+    double maxCost = 0.0;
+
+    while (result.size() > targetIndexCount) {
+        uint32_t triangleCount = static_cast<uint32_t>(result.size() / 3);
+
+        // 每轮重建顶点到三角形的邻接表
+        std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+        for (uint32_t index : result) adjacencyOffset[index + 1]++;
+        for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffset[v + 1] += adjacencyOffset[v];
+        adjacency.resize(result.size());
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (uint32_t t = 0; t < triangleCount; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t v = result[t * 3 + corner];
+                adjacency[fill[v]++] = t;
+            }
+        }
+
+        // 每个可移动顶点选代价最小且不翻转相邻三角形的折叠目标
+        collapses.clear();
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            if (adjacencyOffset[v] == adjacencyOffset[v + 1] || locked[positionOf[v]]) continue;
+
+            Collapse best{v, UINT32_MAX, 0.0};
+            for (uint32_t i = adjacencyOffset[v]; i < adjacencyOffset[v + 1]; i++) {
+                const uint32_t* triangle = &result[adjacency[i] * 3];
+                for (int corner = 0; corner < 3; corner++) {
+                    uint32_t target = triangle[corner];
+                    if (target == v || target == best.to) continue;
+                    double cost = quadrics[positionOf[v]].Evaluate(vertices[target].position);
+                    if (best.to != UINT32_MAX && cost >= best.cost) continue;
+
+                    bool flips = false;
+                    for (uint32_t j = adjacencyOffset[v]; j < adjacencyOffset[v + 1] && !flips; j++) {
+                        const uint32_t* other = &result[adjacency[j] * 3];
+                        const float* before[3];
+                        const float* after[3];
+                        bool collapsing = false;
+                        for (int k = 0; k < 3; k++) {
+                            before[k] = vertices[other[k]].position;
+                            after[k] = other[k] == v ? vertices[target].position : before[k];
+                            if (positionOf[other[k]] == positionOf[target]) collapsing = true;
+                        }
+                        if (collapsing) continue;     // 折叠后退化，会被移除
+
+                        float normalBefore[3], normalAfter[3];
+                        TriangleNormal(before[0], before[1], before[2], normalBefore);
+                        TriangleNormal(after[0], after[1], after[2], normalAfter);
+                        flips = normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] +
+                                normalBefore[2] * normalAfter[2] <= 0.0f;
+                    }
+                    if (!flips) {
+                        best.to = target;
+                        best.cost = cost;
+                    }
+                }
+            }
+            if (best.to != UINT32_MAX) collapses.push_back(best);
+        }
+        if (collapses.empty()) break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        // 一轮内只执行互不相邻的折叠，被折叠顶点的一环邻域本轮不再参与
+        std::fill(touched.begin(), touched.end(), 0);
+        std::iota(remap.begin(), remap.end(), 0);
+        size_t removeTriangles = (result.size() - targetIndexCount + 2) / 3;
+        size_t removed = 0;
+        size_t applied = 0;
+        for (const Collapse& collapse : collapses) {
+            if (removed >= removeTriangles) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            for (uint32_t i = adjacencyOffset[collapse.from]; i < adjacencyOffset[collapse.from + 1]; i++) {
+                const uint32_t* triangle = &result[adjacency[i] * 3];
+                bool collapsing = false;
+                for (int corner = 0; corner < 3; corner++) {
+                    touched[triangle[corner]] = 1;
+                    if (positionOf[triangle[corner]] == positionOf[collapse.to]) collapsing = true;
+                }
+                if (collapsing) removed++;
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[positionOf[collapse.to]].Add(quadrics[positionOf[collapse.from]]);
+            maxCost = std::max(maxCost, collapse.cost);
+            applied++;
+        }
+        if (applied == 0) break;
+
+        // 应用折叠并移除退化三角形
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (positionOf[a] == positionOf[b] || positionOf[b] == positionOf[c] || positionOf[a] == positionOf[c]) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    error = static_cast<float>(std::sqrt(maxCost));
+    return result;
+}
+
+float ComputeAcmr(const std::vector<uint32_t>& indices, uint32_t cacheSize) {
+    if (indices.size() < 3) return 0.0f;
+    std::vector<uint32_t> fifo(std::max(1u, cacheSize), UINT32_MAX);
+    size_t head = 0;
+    size_t misses = 0;
+    for (uint32_t v : indices) {
+        if (std::find(fifo.begin(), fifo.end(), v) == fifo.end()) {
+            fifo[head] = v;
+            head = (head + 1) % fifo.size();
+            misses++;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+bool Cook(const std::string& assetName, const std::vector<uint8_t>& source,
+          const CookSettings& settings, std::vector<CookOutput>& outputs, std::string& error) {
+    std::vector<SourceVertex> vertices;
+    std::vector<uint32_t> indices;
+    if (!ParseObj(source, vertices, indices, error)) {
+        return false;
+    }
+
+    uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+    OptimizeVertexCache(indices, vertexCount, settings.vertexCacheSize);
+    OptimizeOverdraw(indices, vertices, settings.vertexCacheSize);
+
+    // 每级都从LOD 0简化，误差不会逐级累积
+    std::vector<std::vector<uint32_t>> lodIndices;
+    std::vector<float> lodErrors;
+    lodIndices.push_back(std::move(indices));
+    lodErrors.push_back(0.0f);
+    uint32_t lodCount = std::max(1u, std::min(settings.lodCount, COOKED_MESH_MAX_LODS));
+    float reduction = std::max(0.05f, std::min(settings.lodReduction, 0.95f));
+    float targetScale = 1.0f;
+    while (lodIndices.size() < lodCount) {
+        targetScale *= reduction;
+        size_t target = static_cast<size_t>(static_cast<float>(lodIndices[0].size() / 3) * targetScale) * 3;
+        if (target < MIN_LOD_TRIANGLES * 3) break;
+
+        float lodError = 0.0f;
+        std::vector<uint32_t> simplified = Simplify(lodIndices[0], vertices, target, lodError);
+        if (simplified.empty() || simplified.size() > lodIndices.back().size() * MIN_LOD_REDUCTION) break;
+
+        OptimizeVertexCache(simplified, vertexCount, settings.vertexCacheSize);
+        lodIndices.push_back(std::move(simplified));
+        lodErrors.push_back(std::max(lodError, lodErrors.back()));
+    }
+
+    std::vector<CookedMeshLod> lods(lodIndices.size());
+    indices.clear();
+    for (size_t l = 0; l < lodIndices.size(); l++) {
+        lods[l] = CookedMeshLod{static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices[l].size()), lodErrors[l], 0};
+        indices.insert(indices.end(), lodIndices[l].begin(), lodIndices[l].end());
+    }
+    // 所有LOD共享顶点数组，按LOD 0优先的首次使用顺序重排
+    OptimizeVertexFetch(indices, vertices);
+
+    CookedMeshHeader header{};
+    std::memcpy(header.magic, "VGEM", 4);
+    header.version = COOKED_MESH_VERSION;
+    header.vertexCount = static_cast<uint32_t>(vertices.size());
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.vertexStride = CookedVertexLayout::STRIDE;
+    header.vertexLayout = CookedVertexLayout::GetSignature();
+    header.indexSize = vertices.size() <= 0xFFFF ? 2 : 4;
+    header.lodCount = static_cast<uint32_t>(lods.size());
+
+    for (int axis = 0; axis < 3; axis++) {
+        header.boundsMin[axis] = vertices[0].position[axis];
+        header.boundsMax[axis] = vertices[0].position[axis];
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        header.uvMin[axis] = vertices[0].uv[axis];
+        header.uvMax[axis] = vertices[0].uv[axis];
+    }
+    for (const auto& vertex : vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], vertex.position[axis]);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], vertex.position[axis]);
+        }
+        for (int axis = 0; axis < 2; axis++) {
+            header.uvMin[axis] = std::min(header.uvMin[axis], vertex.uv[axis]);
+            header.uvMax[axis] = std::max(header.uvMax[axis], vertex.uv[axis]);
+        }
+    }
+
+    // 位置在包围盒内量化为16位，法线与切线八面体编码，UV在UV范围内量化为16位
+    VertexSource vertexSource;
+    vertexSource.count = header.vertexCount;
+    vertexSource.Set(VERTEX_SEMANTIC_POSITION, vertices[0].position, sizeof(SourceVertex));
+    vertexSource.Set(VERTEX_SEMANTIC_NORMAL, vertices[0].normal, sizeof(SourceVertex));
+    vertexSource.Set(VERTEX_SEMANTIC_TANGENT, vertices[0].tangent, sizeof(SourceVertex));
+    vertexSource.Set(VERTEX_SEMANTIC_UV, vertices[0].uv, sizeof(SourceVertex));
+    VertexDequantization dequantization =
+        CookedVertexLayout::ComputeDequantization(header.boundsMin, header.boundsMax, header.uvMin, header.uvMax);
+    std::vector<uint8_t> quantized(static_cast<size_t>(header.vertexCount) * CookedVertexLayout::STRIDE);
+    CookedVertexLayout::Encode(vertexSource, dequantization, quantized.data());
+
+    CookOutput output;
+    output.name = GetOutputName(assetName);
+    output.type = AssetType::Mesh;
+    output.compression = settings.compression;
+    AppendBytes(output.data, &header, 1);
+    AppendBytes(output.data, lods.data(), lods.size());
+    AppendBytes(output.data, quantized.data(), quantized.size());
+    if (header.indexSize == 2) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        AppendBytes(output.data, shortIndices.data(), shortIndices.size());
+    } else {
+        AppendBytes(output.data, indices.data(), indices.size());
+    }
+    outputs.push_back(std::move(output));
+    return true;
+}
+
+}
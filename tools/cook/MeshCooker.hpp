@@ -0,0 +1,45 @@
+#pragma once
+#include "CookTypes.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 网格烘焙：读取OBJ，去重顶点，生成LOD链，优化顶点缓存与过度绘制顺序，量化顶点属性
+namespace MeshCooker {
+    struct SourceVertex {
+        float position[3];
+        float normal[3];
+        float tangent[4];       // w为副切线符号
+        float uv[2];
+    };
+
+    bool IsMeshFile(const std::string& path);
+    std::string GetOutputName(const std::string& assetName);
+    std::string GetCookerTag(const CookSettings& settings);
+
+    bool Cook(const std::string& assetName, const std::vector<uint8_t>& source,
+              const CookSettings& settings, std::vector<CookOutput>& outputs, std::string& error);
+
+    bool ParseObj(const std::vector<uint8_t>& source, std::vector<SourceVertex>& vertices,
+                  std::vector<uint32_t>& indices, std::string& error);
+
+    // 由UV导数生成对法线正交化的切线（ParseObj调用），镜像UV的顶点副切线符号为负
+    void GenerateTangents(std::vector<SourceVertex>& vertices, const std::vector<uint32_t>& indices);
+
+    // Forsyth线性时间顶点缓存优化
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize);
+
+    // 在缓存友好的顺序上按簇重排，外侧朝外的簇优先以减少过度绘制
+    void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<SourceVertex>& vertices, uint32_t cacheSize);
+
+    // 按首次使用顺序重排顶点，提高顶点获取局部性
+    void OptimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<SourceVertex>& vertices);
+
+    // 二次误差度量的半边折叠简化，边界与UV/法线接缝上的顶点不会被移动
+    // error输出对象空间的几何误差（距离）
+    std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<SourceVertex>& vertices,
+                                   size_t targetIndexCount, float& error);
+
+    // 平均缓存未命中率（每三角形的顶点变换次数），用于报告优化效果
+    float ComputeAcmr(const std::vector<uint32_t>& indices, uint32_t cacheSize);
+}
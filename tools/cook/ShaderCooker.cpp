@@ -0,0 +1,556 @@
+#include "ShaderCooker.hpp"
+#include "CookCache.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    const uint32_t SPIRV_MAGIC = 0x07230203;
+
+    // 用到的SPIR-V操作码
+    enum : uint32_t {
+        OpName = 5,
+        OpEntryPoint = 15,
+        OpExecutionMode = 16,
+        OpTypeBool = 20,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpTypeAccelerationStructureKHR = 5341,
+    };
+
+    enum : uint32_t {
+        DecorationBlock = 2,
+        DecorationBufferBlock = 3,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBuiltIn = 11,
+        DecorationLocation = 30,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35,
+    };
+
+    enum : uint32_t {
+        StorageClassUniformConstant = 0,
+        StorageClassInput = 1,
+        StorageClassUniform = 2,
+        StorageClassOutput = 3,
+        StorageClassPushConstant = 9,
+        StorageClassStorageBuffer = 12,
+    };
+
+    const uint32_t EXECUTION_MODE_LOCAL_SIZE = 17;
+    const uint32_t DIM_BUFFER = 5;
+    const uint32_t DIM_SUBPASS_DATA = 6;
+
+    struct SpirvType {
+        uint32_t opcode = 0;
+        std::vector<uint32_t> operands;     // 去掉结果id后的操作数
+    };
+
+    struct SpirvId {
+        std::string name;
+        uint32_t set = UINT32_MAX;
+        uint32_t binding = UINT32_MAX;
+        uint32_t location = UINT32_MAX;
+        uint32_t arrayStride = 0;
+        bool block = false;
+        bool bufferBlock = false;
+        bool builtIn = false;
+        uint32_t constantValue = 0;
+    };
+
+    struct SpirvMember {
+        uint32_t offset = 0;
+        uint32_t matrixStride = 0;
+    };
+
+    struct SpirvModule {
+        std::unordered_map<uint32_t, SpirvType> types;
+        std::unordered_map<uint32_t, SpirvId> ids;
+        std::map<std::pair<uint32_t, uint32_t>, SpirvMember> members;
+        std::vector<std::pair<uint32_t, uint32_t>> variables;   // (id, 指针类型)
+    };
+
+    std::string ReadString(const uint32_t* words, size_t count) {
+        std::string result;
+        const char* chars = reinterpret_cast<const char*>(words);
+        for (size_t i = 0; i < count * 4 && chars[i] != '\0'; i++) {
+            result += chars[i];
+        }
+        return result;
+    }
+
+    const char* StageName(uint32_t executionModel) {
+        switch (executionModel) {
+            case 0: return "vertex";
+            case 1: return "tessellation_control";
+            case 2: return "tessellation_evaluation";
+            case 3: return "geometry";
+            case 4: return "fragment";
+            case 5: return "compute";
+            default: return "unknown";
+        }
+    }
+
+    const SpirvType* FindType(const SpirvModule& module, uint32_t id) {
+        auto it = module.types.find(id);
+        return it != module.types.end() ? &it->second : nullptr;
+    }
+
+    // 剥去数组，返回元素类型并累计元素数量（运行时数组计为0）
+    uint32_t StripArrays(const SpirvModule& module, uint32_t typeId, uint32_t& count) {
+        count = 1;
+        const SpirvType* type = FindType(module, typeId);
+        while (type != nullptr && (type->opcode == OpTypeArray || type->opcode == OpTypeRuntimeArray)) {
+            if (type->opcode == OpTypeArray) {
+                auto length = module.ids.find(type->operands[1]);
+                count *= length != module.ids.end() ? length->second.constantValue : 1;
+            } else {
+                count = 0;
+            }
+            typeId = type->operands[0];
+            type = FindType(module, typeId);
+        }
+        return typeId;
+    }
+
+    std::string DescriptorTypeName(const SpirvModule& module, uint32_t storageClass, uint32_t typeId) {
+        const SpirvType* type = FindType(module, typeId);
+        if (type == nullptr) return "unknown";
+
+        if (storageClass == StorageClassStorageBuffer) return "storage_buffer";
+        if (storageClass == StorageClassUniform) {
+            auto decorations = module.ids.find(typeId);
+            bool bufferBlock = decorations != module.ids.end() && decorations->second.bufferBlock;
+            return bufferBlock ? "storage_buffer" : "uniform_buffer";
+        }
+
+        switch (type->opcode) {
+            case OpTypeSampledImage: return "combined_image_sampler";
+            case OpTypeSampler: return "sampler";
+            case OpTypeAccelerationStructureKHR: return "acceleration_structure";
+            case OpTypeImage: {
+                uint32_t dim = type->operands[1];
+                uint32_t sampled = type->operands[5];
+                if (dim == DIM_BUFFER) return sampled == 2 ? "storage_texel_buffer" : "uniform_texel_buffer";
+                if (dim == DIM_SUBPASS_DATA) return "input_attachment";
+                return sampled == 2 ? "storage_image" : "sampled_image";
+            }
+            default: return "unknown";
+        }
+    }
+
+    std::string ScalarName(const SpirvType& type) {
+        if (type.opcode == OpTypeFloat) return type.operands[0] == 64 ? "double" : "float";
+        if (type.opcode == OpTypeInt) return type.operands[1] ? "int" : "uint";
+        if (type.opcode == OpTypeBool) return "bool";
+        return "unknown";
+    }
+
+    std::string InterfaceTypeName(const SpirvModule& module, uint32_t typeId) {
+        const SpirvType* type = FindType(module, typeId);
+        if (type == nullptr) return "unknown";
+        if (type->opcode == OpTypeVector) {
+            const SpirvType* component = FindType(module, type->operands[0]);
+            std::string prefix;
+            if (component != nullptr && component->opcode == OpTypeInt) prefix = component->operands[1] ? "i" : "u";
+            if (component != nullptr && component->opcode == OpTypeFloat && component->operands[0] == 64) prefix = "d";
+            return prefix + "vec" + std::to_string(type->operands[1]);
+        }
+        if (type->opcode == OpTypeMatrix) {
+            return "mat" + std::to_string(type->operands[1]);
+        }
+        if (type->opcode == OpTypeArray) {
+            uint32_t count = 0;
+            uint32_t element = StripArrays(module, typeId, count);
+            return InterfaceTypeName(module, element) + "[" + std::to_string(count) + "]";
+        }
+        return ScalarName(*type);
+    }
+
+    // 按Offset/ArrayStride/MatrixStride装饰计算推送常量块大小
+    uint32_t TypeSize(const SpirvModule& module, uint32_t typeId, uint32_t matrixStride) {
+        const SpirvType* type = FindType(module, typeId);
+        if (type == nullptr) return 0;
+
+        switch (type->opcode) {
+            case OpTypeBool:
+                return 4;
+            case OpTypeInt:
+            case OpTypeFloat:
+                return type->operands[0] / 8;
+            case OpTypeVector:
+                return TypeSize(module, type->operands[0], 0) * type->operands[1];
+            case OpTypeMatrix:
+                if (matrixStride != 0) return matrixStride * type->operands[1];
+                return TypeSize(module, type->operands[0], 0) * type->operands[1];
+            case OpTypeArray: {
+                auto decorations = module.ids.find(typeId);
+                auto length = module.ids.find(type->operands[1]);
+                uint32_t count = length != module.ids.end() ? length->second.constantValue : 1;
+                uint32_t stride = decorations != module.ids.end() ? decorations->second.arrayStride : 0;
+                if (stride == 0) stride = TypeSize(module, type->operands[0], matrixStride);
+                return stride * count;
+            }
+            case OpTypeStruct: {
+                uint32_t size = 0;
+                for (uint32_t member = 0; member < type->operands.size(); member++) {
+                    auto layout = module.members.find({typeId, member});
+                    uint32_t offset = layout != module.members.end() ? layout->second.offset : size;
+                    uint32_t stride = layout != module.members.end() ? layout->second.matrixStride : 0;
+                    size = std::max(size, offset + TypeSize(module, type->operands[member], stride));
+                }
+                return size;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    void AppendJsonString(std::ostringstream& out, const std::string& text) {
+        out << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+
+    std::string ToLower(const std::string& text) {
+        std::string lower = text;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower;
+    }
+
+    bool ReadBinaryFile(const std::string& path, std::vector<uint8_t>& data) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        size_t size = static_cast<size_t>(file.tellg());
+        data.resize(size);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    }
+
+    // 把源码中#include "..."引用的文件内容（递归）并入哈希，被包含的文件改变时缓存失效
+    void HashIncludes(const std::filesystem::path& directory, const std::vector<uint8_t>& source,
+                      std::unordered_set<std::string>& visited, uint64_t& hash) {
+        std::istringstream stream(std::string(source.begin(), source.end()));
+        std::string line;
+        while (std::getline(stream, line)) {
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line.compare(start, 8, "#include") != 0) continue;
+            size_t open = line.find('"', start + 8);
+            size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+            if (close == std::string::npos) continue;
+
+            std::filesystem::path path = (directory / line.substr(open + 1, close - open - 1)).lexically_normal();
+            std::string key = path.generic_string();
+            hash = CookCache::HashBytes(key.data(), key.size(), hash);
+            if (!visited.insert(key).second) continue;
+            std::vector<uint8_t> included;
+            if (ReadBinaryFile(key, included)) {
+                hash = CookCache::HashBytes(included.data(), included.size(), hash);
+                HashIncludes(path.parent_path(), included, visited, hash);
+            }
+        }
+    }
+}
+
+namespace ShaderCooker {
+
+bool IsShaderFile(const std::string& path) {
+    static const char* extensions[] = {".vert", ".frag", ".comp", ".geom", ".tesc", ".tese"};
+    std::string lower = ToLower(path);
+    for (const char* extension : extensions) {
+        std::string suffix = extension;
+        if (lower.size() > suffix.size() && lower.compare(lower.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string GetOutputName(const std::string& assetName) {
+    // 与运行时的着色器路径一致，例如shaders/triangle.vert.spv
+    return assetName + ".spv";
+}
+
+std::string GetReflectionName(const std::string& assetName) {
+    return assetName + ".spv.json";
+}
+
+std::string GetCookerTag(const CookSettings& settings) {
+    return "shader-v1-" + settings.glslc;
+}
+
+std::string GetIncludeTag(const std::string& sourcePath, const std::vector<uint8_t>& source) {
+    std::unordered_set<std::string> visited;
+    uint64_t hash = CookCache::HashBytes(nullptr, 0);
+    HashIncludes(std::filesystem::path(sourcePath).parent_path(), source, visited, hash);
+    if (visited.empty()) return std::string();
+    char text[32];
+    std::snprintf(text, sizeof(text), "-inc%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+bool Reflect(const std::vector<uint32_t>& spirv, Reflection& reflection, std::string& error) {
+    if (spirv.size() < 5 || spirv[0] != SPIRV_MAGIC) {
+        error = "invalid SPIR-V module";
+        return false;
+    }
+
+    SpirvModule module;
+    uint32_t entryPointId = 0;
+    size_t cursor = 5;
+    while (cursor < spirv.size()) {
+        uint32_t opcode = spirv[cursor] & 0xFFFF;
+        uint32_t wordCount = spirv[cursor] >> 16;
+        if (wordCount == 0 || cursor + wordCount > spirv.size()) {
+            error = "malformed SPIR-V instruction";
+            return false;
+        }
+        const uint32_t* operands = &spirv[cursor + 1];
+        uint32_t operandCount = wordCount - 1;
+
+        switch (opcode) {
+            case OpName:
+                module.ids[operands[0]].name = ReadString(operands + 1, operandCount - 1);
+                break;
+            case OpEntryPoint:
+                // 只反射第一个入口点
+                if (reflection.entryPoint.empty()) {
+                    reflection.stage = StageName(operands[0]);
+                    entryPointId = operands[1];
+                    reflection.entryPoint = ReadString(operands + 2, operandCount - 2);
+                }
+                break;
+            case OpExecutionMode:
+                if (operands[0] == entryPointId && operands[1] == EXECUTION_MODE_LOCAL_SIZE && operandCount >= 5) {
+                    reflection.localSize[0] = operands[2];
+                    reflection.localSize[1] = operands[3];
+                    reflection.localSize[2] = operands[4];
+                }
+                break;
+            case OpDecorate: {
+                SpirvId& id = module.ids[operands[0]];
+                uint32_t value = operandCount > 2 ? operands[2] : 0;
+                switch (operands[1]) {
+                    case DecorationBlock: id.block = true; break;
+                    case DecorationBufferBlock: id.bufferBlock = true; break;
+                    case DecorationArrayStride: id.arrayStride = value; break;
+                    case DecorationBuiltIn: id.builtIn = true; break;
+                    case DecorationLocation: id.location = value; break;
+                    case DecorationBinding: id.binding = value; break;
+                    case DecorationDescriptorSet: id.set = value; break;
+                    default: break;
+                }
+                break;
+            }
+            case OpMemberDecorate: {
+                SpirvMember& member = module.members[{operands[0], operands[1]}];
+                if (operands[2] == DecorationOffset) member.offset = operands[3];
+                if (operands[2] == DecorationMatrixStride) member.matrixStride = operands[3];
+                if (operands[2] == DecorationBuiltIn) module.ids[operands[0]].builtIn = true;
+                break;
+            }
+            case OpTypeBool:
+            case OpTypeInt:
+            case OpTypeFloat:
+            case OpTypeVector:
+            case OpTypeMatrix:
+            case OpTypeImage:
+            case OpTypeSampler:
+            case OpTypeSampledImage:
+            case OpTypeArray:
+            case OpTypeRuntimeArray:
+            case OpTypeStruct:
+            case OpTypePointer:
+            case OpTypeAccelerationStructureKHR: {
+                SpirvType& type = module.types[operands[0]];
+                type.opcode = opcode;
+                type.operands.assign(operands + 1, operands + operandCount);
+                break;
+            }
+            case OpConstant:
+                module.ids[operands[1]].constantValue = operandCount > 2 ? operands[2] : 0;
+                break;
+            case OpVariable:
+                module.variables.emplace_back(operands[1], operands[0]);
+                break;
+            default:
+                break;
+        }
+        cursor += wordCount;
+    }
+
+    for (const auto& variable : module.variables) {
+        const SpirvType* pointer = FindType(module, variable.second);
+        if (pointer == nullptr || pointer->opcode != OpTypePointer) continue;
+        uint32_t storageClass = pointer->operands[0];
+        uint32_t pointee = pointer->operands[1];
+        const SpirvId& decorations = module.ids[variable.first];
+
+        switch (storageClass) {
+            case StorageClassUniformConstant:
+            case StorageClassUniform:
+            case StorageClassStorageBuffer: {
+                if (decorations.set == UINT32_MAX || decorations.binding == UINT32_MAX) break;
+                DescriptorBinding binding;
+                binding.set = decorations.set;
+                binding.binding = decorations.binding;
+                uint32_t element = StripArrays(module, pointee, binding.count);
+                binding.type = DescriptorTypeName(module, storageClass, element);
+                binding.name = decorations.name.empty() ? module.ids[element].name : decorations.name;
+                reflection.bindings.push_back(binding);
+                break;
+            }
+            case StorageClassInput:
+            case StorageClassOutput: {
+                if (decorations.builtIn || module.ids[pointee].builtIn || decorations.location == UINT32_MAX) break;
+                InterfaceVariable interfaceVariable;
+                interfaceVariable.location = decorations.location;
+                interfaceVariable.type = InterfaceTypeName(module, pointee);
+                interfaceVariable.name = decorations.name;
+                (storageClass == StorageClassInput ? reflection.inputs : reflection.outputs).push_back(interfaceVariable);
+                break;
+            }
+            case StorageClassPushConstant:
+                reflection.pushConstantSize = std::max(reflection.pushConstantSize, TypeSize(module, pointee, 0));
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const DescriptorBinding& a, const DescriptorBinding& b) {
+        return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+    });
+    auto byLocation = [](const InterfaceVariable& a, const InterfaceVariable& b) { return a.location < b.location; };
+    std::sort(reflection.inputs.begin(), reflection.inputs.end(), byLocation);
+    std::sort(reflection.outputs.begin(), reflection.outputs.end(), byLocation);
+    return true;
+}
+
+std::string ToJson(const Reflection& reflection) {
+    std::ostringstream out;
+    out << "{\n  \"stage\": ";
+    AppendJsonString(out, reflection.stage);
+    out << ",\n  \"entryPoint\": ";
+    AppendJsonString(out, reflection.entryPoint);
+    out << ",\n  \"pushConstantSize\": " << reflection.pushConstantSize;
+    if (reflection.stage == "compute") {
+        out << ",\n  \"localSize\": [" << reflection.localSize[0] << ", " << reflection.localSize[1]
+            << ", " << reflection.localSize[2] << "]";
+    }
+
+    out << ",\n  \"descriptorBindings\": [";
+    for (size_t i = 0; i < reflection.bindings.size(); i++) {
+        const auto& binding = reflection.bindings[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"set\": " << binding.set << ", \"binding\": " << binding.binding
+            << ", \"type\": ";
+        AppendJsonString(out, binding.type);
+        out << ", \"count\": " << binding.count << ", \"name\": ";
+        AppendJsonString(out, binding.name);
+        out << "}";
+    }
+    out << (reflection.bindings.empty() ? "]" : "\n  ]");
+
+    auto writeInterface = [&out](const char* key, const std::vector<InterfaceVariable>& variables) {
+        out << ",\n  \"" << key << "\": [";
+        for (size_t i = 0; i < variables.size(); i++) {
+            out << (i == 0 ? "\n" : ",\n") << "    {\"location\": " << variables[i].location << ", \"type\": ";
+            AppendJsonString(out, variables[i].type);
+            out << ", \"name\": ";
+            AppendJsonString(out, variables[i].name);
+            out << "}";
+        }
+        out << (variables.empty() ? "]" : "\n  ]");
+    };
+    writeInterface("inputs", reflection.inputs);
+    writeInterface("outputs", reflection.outputs);
+    out << "\n}\n";
+    return out.str();
+}
+
+bool Cook(const std::string& assetName, const std::string& sourcePath,
+          const CookSettings& settings, std::vector<CookOutput>& outputs, std::string& error) {
+    // 每个任务使用独立的临时文件，避免并行编译时互相覆盖
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "%016llx",
+                  static_cast<unsigned long long>(CookCache::HashBytes(assetName.data(), assetName.size())));
+    std::filesystem::path tempBase = std::filesystem::path(settings.tempDirectory) / suffix;
+    std::string spirvPath = tempBase.string() + ".spv";
+    std::string logPath = tempBase.string() + ".log";
+
+    std::string command = "\"" + settings.glslc + "\" -O -o \"" + spirvPath + "\" \"" + sourcePath + "\" 2> \"" + logPath + "\"";
+    int result = std::system(command.c_str());
+
+    std::vector<uint8_t> log;
+    ReadBinaryFile(logPath, log);
+    std::error_code removeError;
+    std::filesystem::remove(logPath, removeError);
+    if (result != 0) {
+        error = "glslc failed";
+        if (!log.empty()) {
+            error += ":\n" + std::string(log.begin(), log.end());
+        }
+        std::filesystem::remove(spirvPath, removeError);
+        return false;
+    }
+
+    std::vector<uint8_t> spirvBytes;
+    bool loaded = ReadBinaryFile(spirvPath, spirvBytes);
+    std::filesystem::remove(spirvPath, removeError);
+    if (!loaded || spirvBytes.size() % 4 != 0) {
+        error = "failed to read glslc output";
+        return false;
+    }
+
+    std::vector<uint32_t> spirv(spirvBytes.size() / 4);
+    std::memcpy(spirv.data(), spirvBytes.data(), spirvBytes.size());
+    Reflection reflection;
+    if (!Reflect(spirv, reflection, error)) {
+        return false;
+    }
+    std::string json = ToJson(reflection);
+
+    CookOutput module;
+    module.name = GetOutputName(assetName);
+    module.type = AssetType::Shader;
+    module.compression = settings.compression;
+    module.data = std::move(spirvBytes);
+    outputs.push_back(std::move(module));
+
+    CookOutput reflectionOutput;
+    reflectionOutput.name = GetReflectionName(assetName);
+    reflectionOutput.type = AssetType::Raw;
+    reflectionOutput.compression = settings.compression;
+    reflectionOutput.data.assign(json.begin(), json.end());
+    outputs.push_back(std::move(reflectionOutput));
+    return true;
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "CookTypes.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 着色器烘焙：调用glslc编译为SPIR-V，并从SPIR-V中提取描述符绑定、
+// 推送常量大小和输入输出位置等反射信息（JSON）
+namespace ShaderCooker {
+    struct DescriptorBinding {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        uint32_t count = 1;
+        std::string type;
+        std::string name;
+    };
+
+    struct InterfaceVariable {
+        uint32_t location = 0;
+        std::string type;
+        std::string name;
+    };
+
+    struct Reflection {
+        std::string stage;
+        std::string entryPoint;
+        std::vector<DescriptorBinding> bindings;
+        std::vector<InterfaceVariable> inputs;
+        std::vector<InterfaceVariable> outputs;
+        uint32_t pushConstantSize = 0;
+        uint32_t localSize[3] = {0, 0, 0};
+    };
+
+    bool IsShaderFile(const std::string& path);
+    std::string GetOutputName(const std::string& assetName);
+    std::string GetReflectionName(const std::string& assetName);
+    std::string GetCookerTag(const CookSettings& settings);
+    // 源码包含的文件（#include "..."，相对源文件目录）的内容哈希，加入缓存键；没有包含时为空
+    std::string GetIncludeTag(const std::string& sourcePath, const std::vector<uint8_t>& source);
+
+    bool Cook(const std::string& assetName, const std::string& sourcePath,
+              const CookSettings& settings, std::vector<CookOutput>& outputs, std::string& error);
+
+    bool Reflect(const std::vector<uint32_t>& spirv, Reflection& reflection, std::string& error);
+    std::string ToJson(const Reflection& reflection);
+}
@@ -0,0 +1,590 @@
+#include "TextureCooker.hpp"
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    const uint8_t KTX2_IDENTIFIER[12] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+
+    // Khronos Data Format中用到的常量
+    const uint32_t KHR_DF_MODEL_BC1A = 128;
+    const uint32_t KHR_DF_MODEL_BC3 = 130;
+    const uint32_t KHR_DF_CHANNEL_COLOR = 0;
+    const uint32_t KHR_DF_CHANNEL_BC3_ALPHA = 15;
+    const uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+    const uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+    const uint32_t KHR_DF_TRANSFER_SRGB = 2;
+
+    std::string ToLower(const std::string& text) {
+        std::string lower = text;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower;
+    }
+
+    bool EndsWith(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // 法线贴图等数据纹理按命名约定识别，不做sRGB处理
+    bool IsLinearTexture(const std::string& assetName) {
+        std::string lower = ToLower(assetName);
+        size_t dot = lower.find_last_of('.');
+        std::string stem = lower.substr(0, dot);
+        return EndsWith(stem, "_n") || EndsWith(stem, "_normal") || EndsWith(stem, "_linear");
+    }
+
+    float SrgbToLinear(float value) {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSrgb(float value) {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    uint8_t ToByte(float value) {
+        return static_cast<uint8_t>(std::lround(std::max(0.0f, std::min(1.0f, value)) * 255.0f));
+    }
+
+    uint16_t To565(const float color[3]) {
+        uint32_t r = static_cast<uint32_t>(std::lround(std::max(0.0f, std::min(255.0f, color[0])) * 31.0f / 255.0f));
+        uint32_t g = static_cast<uint32_t>(std::lround(std::max(0.0f, std::min(255.0f, color[1])) * 63.0f / 255.0f));
+        uint32_t b = static_cast<uint32_t>(std::lround(std::max(0.0f, std::min(255.0f, color[2])) * 31.0f / 255.0f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void Expand565(uint16_t color, int out[3]) {
+        int r = (color >> 11) & 31;
+        int g = (color >> 5) & 63;
+        int b = color & 31;
+        out[0] = (r << 3) | (r >> 2);
+        out[1] = (g << 2) | (g >> 4);
+        out[2] = (b << 3) | (b >> 2);
+    }
+
+    // 颜色部分：主轴方向上取端点并内缩，总是使用四色模式
+    void EncodeColorBlock(const uint8_t* pixels, uint8_t* block) {
+        float mean[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 3; c++) mean[c] += pixels[i * 4 + c];
+        }
+        for (float& component : mean) component /= 16.0f;
+
+        float covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; i++) {
+            float r = pixels[i * 4 + 0] - mean[0];
+            float g = pixels[i * 4 + 1] - mean[1];
+            float b = pixels[i * 4 + 2] - mean[2];
+            covariance[0] += r * r;
+            covariance[1] += r * g;
+            covariance[2] += r * b;
+            covariance[3] += g * g;
+            covariance[4] += g * b;
+            covariance[5] += b * b;
+        }
+
+        // 幂迭代求主轴
+        float axis[3] = {1.0f, 1.0f, 1.0f};
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[3] = {
+                covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+            };
+            float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+            if (length <= 0.0f) break;
+            for (int c = 0; c < 3; c++) axis[c] = next[c] / length;
+        }
+
+        float minProjection = 1e30f;
+        float maxProjection = -1e30f;
+        int minIndex = 0;
+        int maxIndex = 0;
+        for (int i = 0; i < 16; i++) {
+            float projection = pixels[i * 4 + 0] * axis[0] + pixels[i * 4 + 1] * axis[1] + pixels[i * 4 + 2] * axis[2];
+            if (projection < minProjection) {
+                minProjection = projection;
+                minIndex = i;
+            }
+            if (projection > maxProjection) {
+                maxProjection = projection;
+                maxIndex = i;
+            }
+        }
+
+        float maxColor[3];
+        float minColor[3];
+        for (int c = 0; c < 3; c++) {
+            maxColor[c] = pixels[maxIndex * 4 + c];
+            minColor[c] = pixels[minIndex * 4 + c];
+            float inset = (maxColor[c] - minColor[c]) / 16.0f;
+            maxColor[c] -= inset;
+            minColor[c] += inset;
+        }
+
+        uint16_t color0 = To565(maxColor);
+        uint16_t color1 = To565(minColor);
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        uint32_t indices = 0;
+        if (color0 != color1) {
+            int palette[4][3];
+            Expand565(color0, palette[0]);
+            Expand565(color1, palette[1]);
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+            for (int i = 0; i < 16; i++) {
+                int bestIndex = 0;
+                int bestDistance = 1 << 30;
+                for (int p = 0; p < 4; p++) {
+                    int dr = pixels[i * 4 + 0] - palette[p][0];
+                    int dg = pixels[i * 4 + 1] - palette[p][1];
+                    int db = pixels[i * 4 + 2] - palette[p][2];
+                    int distance = dr * dr + dg * dg + db * db;
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        bestIndex = p;
+                    }
+                }
+                indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+            }
+        }
+
+        block[0] = static_cast<uint8_t>(color0 & 0xFF);
+        block[1] = static_cast<uint8_t>(color0 >> 8);
+        block[2] = static_cast<uint8_t>(color1 & 0xFF);
+        block[3] = static_cast<uint8_t>(color1 >> 8);
+        for (int i = 0; i < 4; i++) {
+            block[4 + i] = static_cast<uint8_t>(indices >> (i * 8));
+        }
+    }
+
+    // alpha部分：最大/最小值为端点，使用八级插值模式
+    void EncodeAlphaBlock(const uint8_t* pixels, uint8_t* block) {
+        int alphaMin = 255;
+        int alphaMax = 0;
+        for (int i = 0; i < 16; i++) {
+            alphaMin = std::min<int>(alphaMin, pixels[i * 4 + 3]);
+            alphaMax = std::max<int>(alphaMax, pixels[i * 4 + 3]);
+        }
+
+        block[0] = static_cast<uint8_t>(alphaMax);
+        block[1] = static_cast<uint8_t>(alphaMin);
+
+        uint64_t indices = 0;
+        if (alphaMax != alphaMin) {
+            int palette[8];
+            palette[0] = alphaMax;
+            palette[1] = alphaMin;
+            for (int p = 1; p < 7; p++) {
+                palette[p + 1] = ((7 - p) * alphaMax + p * alphaMin) / 7;
+            }
+            for (int i = 0; i < 16; i++) {
+                int bestIndex = 0;
+                int bestDistance = 256;
+                for (int p = 0; p < 8; p++) {
+                    int distance = std::abs(pixels[i * 4 + 3] - palette[p]);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        bestIndex = p;
+                    }
+                }
+                indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+            }
+        }
+
+        for (int i = 0; i < 6; i++) {
+            block[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+        }
+    }
+
+    void CompressLevel(const TextureCooker::Image& image, bool hasAlpha, std::vector<uint8_t>& data) {
+        uint32_t blocksX = (image.width + 3) / 4;
+        uint32_t blocksY = (image.height + 3) / 4;
+        size_t blockSize = hasAlpha ? 16 : 8;
+        data.resize(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+        uint8_t pixels[64];
+        for (uint32_t by = 0; by < blocksY; by++) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                // 边缘不足4x4的块复制边界像素
+                for (uint32_t y = 0; y < 4; y++) {
+                    uint32_t sy = std::min(by * 4 + y, image.height - 1);
+                    for (uint32_t x = 0; x < 4; x++) {
+                        uint32_t sx = std::min(bx * 4 + x, image.width - 1);
+                        std::memcpy(&pixels[(y * 4 + x) * 4], &image.pixels[(static_cast<size_t>(sy) * image.width + sx) * 4], 4);
+                    }
+                }
+
+                uint8_t* block = &data[(static_cast<size_t>(by) * blocksX + bx) * blockSize];
+                if (hasAlpha) {
+                    TextureCooker::EncodeBC3Block(pixels, block);
+                } else {
+                    TextureCooker::EncodeBC1Block(pixels, block);
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    void AppendValue(std::vector<uint8_t>& data, const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteAt(std::vector<uint8_t>& data, size_t offset, uint64_t value) {
+        std::memcpy(&data[offset], &value, sizeof(value));
+    }
+
+    // 基本数据格式描述符（KTX2要求必须存在）
+    std::vector<uint8_t> BuildDataFormatDescriptor(bool hasAlpha, bool srgb) {
+        uint32_t sampleCount = hasAlpha ? 2 : 1;
+        uint32_t blockSize = 24 + 16 * sampleCount;
+
+        std::vector<uint8_t> dfd;
+        AppendValue<uint32_t>(dfd, 4 + blockSize);
+        AppendValue<uint32_t>(dfd, 0);                                          // vendorId = Khronos, descriptorType = basic
+        AppendValue<uint32_t>(dfd, 2 | (blockSize << 16));                      // versionNumber = 2
+        uint32_t model = hasAlpha ? KHR_DF_MODEL_BC3 : KHR_DF_MODEL_BC1A;
+        uint32_t transfer = srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR;
+        AppendValue<uint32_t>(dfd, model | (KHR_DF_PRIMARIES_BT709 << 8) | (transfer << 16));
+        AppendValue<uint32_t>(dfd, 3 | (3 << 8));                               // 4x4x1x1纹素块
+        AppendValue<uint32_t>(dfd, hasAlpha ? 16 : 8);                          // bytesPlane0
+        AppendValue<uint32_t>(dfd, 0);
+
+        auto appendSample = [&dfd](uint32_t bitOffset, uint32_t channel) {
+            AppendValue<uint32_t>(dfd, bitOffset | (63u << 16) | (channel << 24));
+            AppendValue<uint32_t>(dfd, 0);
+            AppendValue<uint32_t>(dfd, 0);
+            AppendValue<uint32_t>(dfd, UINT32_MAX);
+        };
+        if (hasAlpha) {
+            appendSample(0, KHR_DF_CHANNEL_BC3_ALPHA);
+            appendSample(64, KHR_DF_CHANNEL_COLOR);
+        } else {
+            appendSample(0, KHR_DF_CHANNEL_COLOR);
+        }
+        return dfd;
+    }
+}
+
+namespace TextureCooker {
+
+bool IsTextureFile(const std::string& path) {
+    std::string lower = ToLower(path);
+    return EndsWith(lower, ".tga") || EndsWith(lower, ".ppm") || EndsWith(lower, ".pgm");
+}
+
+std::string GetOutputName(const std::string& assetName) {
+    return assetName.substr(0, assetName.find_last_of('.')) + ".ktx2";
+}
+
+std::string GetCookerTag(const CookSettings& settings) {
+    (void)settings;
+    return "texture-v1-bc13";
+}
+
+bool LoadTga(const std::vector<uint8_t>& source, Image& image, std::string& error) {
+    if (source.size() < 18) {
+        error = "truncated TGA header";
+        return false;
+    }
+
+    uint8_t idLength = source[0];
+    uint8_t colorMapType = source[1];
+    uint8_t imageType = source[2];
+    uint32_t width = source[12] | (source[13] << 8);
+    uint32_t height = source[14] | (source[15] << 8);
+    uint32_t bitsPerPixel = source[16];
+    bool topLeft = (source[17] & 0x20) != 0;
+
+    bool rle = imageType == 10 || imageType == 11;
+    bool grayscale = imageType == 3 || imageType == 11;
+    if (colorMapType != 0 || !(imageType == 2 || imageType == 3 || imageType == 10 || imageType == 11)) {
+        error = "unsupported TGA image type " + std::to_string(imageType);
+        return false;
+    }
+    if (grayscale ? bitsPerPixel != 8 : (bitsPerPixel != 24 && bitsPerPixel != 32)) {
+        error = "unsupported TGA pixel depth " + std::to_string(bitsPerPixel);
+        return false;
+    }
+    if (width == 0 || height == 0) {
+        error = "empty TGA image";
+        return false;
+    }
+
+    uint32_t bytesPerPixel = bitsPerPixel / 8;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    size_t cursor = 18 + idLength;
+    std::vector<uint8_t> raw(pixelCount * bytesPerPixel);
+
+    if (rle) {
+        size_t written = 0;
+        while (written < pixelCount) {
+            if (cursor >= source.size()) {
+                error = "truncated TGA RLE data";
+                return false;
+            }
+            uint8_t packet = source[cursor++];
+            size_t count = (packet & 0x7F) + 1u;
+            if (written + count > pixelCount) {
+                error = "TGA RLE packet overflows image";
+                return false;
+            }
+            if (packet & 0x80) {
+                if (cursor + bytesPerPixel > source.size()) {
+                    error = "truncated TGA RLE data";
+                    return false;
+                }
+                for (size_t i = 0; i < count; i++) {
+                    std::memcpy(&raw[(written + i) * bytesPerPixel], &source[cursor], bytesPerPixel);
+                }
+                cursor += bytesPerPixel;
+            } else {
+                size_t bytes = count * bytesPerPixel;
+                if (cursor + bytes > source.size()) {
+                    error = "truncated TGA RLE data";
+                    return false;
+                }
+                std::memcpy(&raw[written * bytesPerPixel], &source[cursor], bytes);
+                cursor += bytes;
+            }
+            written += count;
+        }
+    } else {
+        if (cursor + raw.size() > source.size()) {
+            error = "truncated TGA pixel data";
+            return false;
+        }
+        std::memcpy(raw.data(), &source[cursor], raw.size());
+    }
+
+    // BGR(A)转RGBA，并统一为自上而下的行序
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(pixelCount * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        uint32_t sourceRow = topLeft ? y : height - 1 - y;
+        for (uint32_t x = 0; x < width; x++) {
+            const uint8_t* in = &raw[(static_cast<size_t>(sourceRow) * width + x) * bytesPerPixel];
+            uint8_t* out = &image.pixels[(static_cast<size_t>(y) * width + x) * 4];
+            if (grayscale) {
+                out[0] = out[1] = out[2] = in[0];
+                out[3] = 255;
+            } else {
+                out[0] = in[2];
+                out[1] = in[1];
+                out[2] = in[0];
+                out[3] = bytesPerPixel == 4 ? in[3] : 255;
+            }
+        }
+    }
+    return true;
+}
+
+bool LoadPpm(const std::vector<uint8_t>& source, Image& image, std::string& error) {
+    size_t cursor = 0;
+    auto nextToken = [&]() {
+        std::string token;
+        while (cursor < source.size()) {
+            char c = static_cast<char>(source[cursor]);
+            if (c == '#') {
+                while (cursor < source.size() && source[cursor] != '\n') cursor++;
+            } else if (std::isspace(static_cast<unsigned char>(c))) {
+                if (!token.empty()) break;
+                cursor++;
+            } else {
+                token += c;
+                cursor++;
+            }
+        }
+        return token;
+    };
+
+    std::string magic = nextToken();
+    bool grayscale = magic == "P5";
+    if (magic != "P6" && !grayscale) {
+        error = "only binary PPM (P6) and PGM (P5) are supported";
+        return false;
+    }
+
+    uint32_t width = static_cast<uint32_t>(std::atoi(nextToken().c_str()));
+    uint32_t height = static_cast<uint32_t>(std::atoi(nextToken().c_str()));
+    int maxValue = std::atoi(nextToken().c_str());
+    cursor++;   // 头部与数据之间的单个空白字符
+    if (width == 0 || height == 0 || maxValue <= 0 || maxValue > 255) {
+        error = "unsupported PPM header";
+        return false;
+    }
+
+    size_t channels = grayscale ? 1 : 3;
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    if (cursor + pixelCount * channels > source.size()) {
+        error = "truncated PPM pixel data";
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(pixelCount * 4);
+    for (size_t i = 0; i < pixelCount; i++) {
+        const uint8_t* in = &source[cursor + i * channels];
+        uint8_t* out = &image.pixels[i * 4];
+        for (int c = 0; c < 3; c++) {
+            int value = grayscale ? in[0] : in[c];
+            out[c] = static_cast<uint8_t>(value * 255 / maxValue);
+        }
+        out[3] = 255;
+    }
+    return true;
+}
+
+Image Downsample(const Image& image, bool srgb) {
+    Image result;
+    result.width = std::max(1u, image.width / 2);
+    result.height = std::max(1u, image.height / 2);
+    result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+
+    float toLinear[256];
+    for (int i = 0; i < 256; i++) {
+        toLinear[i] = srgb ? SrgbToLinear(i / 255.0f) : i / 255.0f;
+    }
+
+    for (uint32_t y = 0; y < result.height; y++) {
+        for (uint32_t x = 0; x < result.width; x++) {
+            // 奇数尺寸时最后一行/列与自身平均
+            uint32_t x0 = std::min(x * 2, image.width - 1);
+            uint32_t x1 = std::min(x * 2 + 1, image.width - 1);
+            uint32_t y0 = std::min(y * 2, image.height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, image.height - 1);
+            const uint8_t* samples[4] = {
+                &image.pixels[(static_cast<size_t>(y0) * image.width + x0) * 4],
+                &image.pixels[(static_cast<size_t>(y0) * image.width + x1) * 4],
+                &image.pixels[(static_cast<size_t>(y1) * image.width + x0) * 4],
+                &image.pixels[(static_cast<size_t>(y1) * image.width + x1) * 4],
+            };
+
+            uint8_t* out = &result.pixels[(static_cast<size_t>(y) * result.width + x) * 4];
+            for (int c = 0; c < 3; c++) {
+                float sum = 0.0f;
+                for (const uint8_t* sample : samples) sum += toLinear[sample[c]];
+                float average = sum * 0.25f;
+                out[c] = ToByte(srgb ? LinearToSrgb(average) : average);
+            }
+            int alpha = samples[0][3] + samples[1][3] + samples[2][3] + samples[3][3];
+            out[3] = static_cast<uint8_t>((alpha + 2) / 4);
+        }
+    }
+    return result;
+}
+
+void EncodeBC1Block(const uint8_t* pixels, uint8_t* block) {
+    EncodeColorBlock(pixels, block);
+}
+
+void EncodeBC3Block(const uint8_t* pixels, uint8_t* block) {
+    EncodeAlphaBlock(pixels, block);
+    EncodeColorBlock(pixels, block + 8);
+}
+
+bool Cook(const std::string& assetName, const std::vector<uint8_t>& source,
+          const CookSettings& settings, std::vector<CookOutput>& outputs, std::string& error) {
+    (void)settings;
+
+    Image image;
+    std::string lower = ToLower(assetName);
+    bool loaded = EndsWith(lower, ".tga") ? LoadTga(source, image, error) : LoadPpm(source, image, error);
+    if (!loaded) {
+        return false;
+    }
+
+    bool hasAlpha = false;
+    for (size_t i = 3; i < image.pixels.size(); i += 4) {
+        if (image.pixels[i] != 255) {
+            hasAlpha = true;
+            break;
+        }
+    }
+    bool srgb = !IsLinearTexture(assetName);
+
+    VkFormat format;
+    if (hasAlpha) {
+        format = srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+    } else {
+        format = srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    }
+
+    // 完整mip链
+    std::vector<std::vector<uint8_t>> levels;
+    Image current = image;
+    while (true) {
+        levels.emplace_back();
+        CompressLevel(current, hasAlpha, levels.back());
+        if (current.width == 1 && current.height == 1) break;
+        current = Downsample(current, srgb);
+    }
+
+    uint32_t levelCount = static_cast<uint32_t>(levels.size());
+    uint32_t blockSize = hasAlpha ? 16 : 8;
+    std::vector<uint8_t> dfd = BuildDataFormatDescriptor(hasAlpha, srgb);
+
+    // 头部80字节 + 层级索引 + DFD + 层级数据（KTX2规定从最小mip开始存放）
+    std::vector<uint8_t> file;
+    file.insert(file.end(), KTX2_IDENTIFIER, KTX2_IDENTIFIER + sizeof(KTX2_IDENTIFIER));
+    AppendValue<uint32_t>(file, static_cast<uint32_t>(format));
+    AppendValue<uint32_t>(file, 1);                     // typeSize
+    AppendValue<uint32_t>(file, image.width);
+    AppendValue<uint32_t>(file, image.height);
+    AppendValue<uint32_t>(file, 0);                     // pixelDepth
+    AppendValue<uint32_t>(file, 0);                     // layerCount
+    AppendValue<uint32_t>(file, 1);                     // faceCount
+    AppendValue<uint32_t>(file, levelCount);
+    AppendValue<uint32_t>(file, 0);                     // supercompressionScheme
+    size_t dfdFieldOffset = file.size();
+    AppendValue<uint32_t>(file, 0);
+    AppendValue<uint32_t>(file, 0);
+    AppendValue<uint32_t>(file, 0);                     // kvdByteOffset
+    AppendValue<uint32_t>(file, 0);                     // kvdByteLength
+    AppendValue<uint64_t>(file, 0);                     // sgdByteOffset
+    AppendValue<uint64_t>(file, 0);                     // sgdByteLength
+
+    size_t levelIndexOffset = file.size();
+    file.resize(file.size() + levelCount * 3 * sizeof(uint64_t), 0);
+
+    uint32_t dfdOffset = static_cast<uint32_t>(file.size());
+    uint32_t dfdLength = static_cast<uint32_t>(dfd.size());
+    std::memcpy(&file[dfdFieldOffset], &dfdOffset, sizeof(dfdOffset));
+    std::memcpy(&file[dfdFieldOffset + 4], &dfdLength, sizeof(dfdLength));
+    file.insert(file.end(), dfd.begin(), dfd.end());
+
+    for (uint32_t level = levelCount; level-- > 0;) {
+        size_t padding = (blockSize - file.size() % blockSize) % blockSize;
+        file.resize(file.size() + padding, 0);
+
+        size_t entry = levelIndexOffset + level * 3 * sizeof(uint64_t);
+        WriteAt(file, entry, file.size());
+        WriteAt(file, entry + 8, levels[level].size());
+        WriteAt(file, entry + 16, levels[level].size());
+        file.insert(file.end(), levels[level].begin(), levels[level].end());
+    }
+
+    CookOutput output;
+    output.name = GetOutputName(assetName);
+    output.type = AssetType::Texture;
+    // 不压缩存放，运行时可直接从档案映射中按mip层级读取
+    output.compression = AssetCompression::None;
+    output.data = std::move(file);
+    outputs.push_back(std::move(output));
+    return true;
+}
+
+}
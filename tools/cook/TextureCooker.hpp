@@ -0,0 +1,31 @@
+#pragma once
+#include "CookTypes.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 纹理烘焙：读取TGA/PPM，生成mip链，压缩为BC1（不透明）或BC3（带alpha），输出KTX2
+namespace TextureCooker {
+    struct Image {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;    // RGBA8
+    };
+
+    bool IsTextureFile(const std::string& path);
+    std::string GetOutputName(const std::string& assetName);
+    std::string GetCookerTag(const CookSettings& settings);
+
+    bool Cook(const std::string& assetName, const std::vector<uint8_t>& source,
+              const CookSettings& settings, std::vector<CookOutput>& outputs, std::string& error);
+
+    bool LoadTga(const std::vector<uint8_t>& source, Image& image, std::string& error);
+    bool LoadPpm(const std::vector<uint8_t>& source, Image& image, std::string& error);
+
+    // 2x2盒式滤波降采样，sRGB纹理在线性空间平均
+    Image Downsample(const Image& image, bool srgb);
+
+    // 单块编码，输入4x4 RGBA8像素（行优先）
+    void EncodeBC1Block(const uint8_t* pixels, uint8_t* block);
+    void EncodeBC3Block(const uint8_t* pixels, uint8_t* block);
+}
@@ -0,0 +1,295 @@
+#include "AssetArchive.hpp"
+#include "CookCache.hpp"
+#include "CookTypes.hpp"
+#include "MeshCooker.hpp"
+#include "ShaderCooker.hpp"
+#include "TextureCooker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    struct Options {
+        std::vector<std::string> inputs;
+        std::string output = "assets.vgea";
+        std::string root = ".";
+        std::string cacheDirectory = ".vge_cook_cache";
+        uint32_t threadCount = 0;
+        bool verbose = false;
+        bool noCache = false;
+        CookSettings settings;
+    };
+
+    void PrintUsage() {
+        std::cout << "usage: vge_cook [options] <file|directory>...\n"
+                  << "  -o <archive>          output archive (default assets.vgea)\n"
+                  << "  --root <dir>          asset names are relative to this directory (default .)\n"
+                  << "  --cache <dir>         content-hash cache directory (default .vge_cook_cache)\n"
+                  << "  --no-cache            ignore and do not update the cache\n"
+                  << "  -j <n>                worker threads (default: hardware concurrency)\n"
+                  << "  --glslc <path>        glslc executable (default glslc)\n"
+                  << "  --compression <c>     none | lz4 | zstd for meshes and shaders (default lz4)\n"
+                  << "  --vertex-cache <n>    simulated post-transform cache size (default 32)\n"
+                  << "  --lods <n>            mesh LOD levels including LOD 0, 1 disables LODs (default 5)\n"
+                  << "  --lod-reduction <f>   triangle ratio between consecutive LODs (default 0.5)\n"
+                  << "  -v                    list every cooked asset\n"
+                  << "inputs: .obj meshes, .tga/.ppm/.pgm textures, .vert/.frag/.comp/.geom/.tesc/.tese shaders"
+                  << std::endl;
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string argument = argv[i];
+            auto value = [&](std::string& out) {
+                if (i + 1 >= argc) {
+                    std::cerr << "missing value for " << argument << std::endl;
+                    return false;
+                }
+                out = argv[++i];
+                return true;
+            };
+
+            std::string text;
+            if (argument == "-h" || argument == "--help") {
+                PrintUsage();
+                std::exit(0);
+            } else if (argument == "-o") {
+                if (!value(options.output)) return false;
+            } else if (argument == "--root") {
+                if (!value(options.root)) return false;
+            } else if (argument == "--cache") {
+                if (!value(options.cacheDirectory)) return false;
+            } else if (argument == "--no-cache") {
+                options.noCache = true;
+            } else if (argument == "-j") {
+                if (!value(text)) return false;
+                options.threadCount = static_cast<uint32_t>(std::max(1, std::atoi(text.c_str())));
+            } else if (argument == "--glslc") {
+                if (!value(options.settings.glslc)) return false;
+            } else if (argument == "--compression") {
+                if (!value(text)) return false;
+                if (text == "none") {
+                    options.settings.compression = AssetCompression::None;
+                } else if (text == "lz4") {
+                    options.settings.compression = AssetCompression::LZ4;
+                } else if (text == "zstd") {
+                    options.settings.compression = AssetCompression::Zstd;
+                } else {
+                    std::cerr << "unknown compression: " << text << std::endl;
+                    return false;
+                }
+            } else if (argument == "--vertex-cache") {
+                if (!value(text)) return false;
+                options.settings.vertexCacheSize = static_cast<uint32_t>(std::max(4, std::atoi(text.c_str())));
+            } else if (argument == "--lods") {
+                if (!value(text)) return false;
+                options.settings.lodCount = static_cast<uint32_t>(std::max(1, std::atoi(text.c_str())));
+            } else if (argument == "--lod-reduction") {
+                if (!value(text)) return false;
+                options.settings.lodReduction = static_cast<float>(std::atof(text.c_str()));
+                if (options.settings.lodReduction <= 0.0f || options.settings.lodReduction >= 1.0f) {
+                    std::cerr << "--lod-reduction must be between 0 and 1" << std::endl;
+                    return false;
+                }
+            } else if (argument == "-v") {
+                options.verbose = true;
+            } else if (!argument.empty() && argument[0] == '-') {
+                std::cerr << "unknown option: " << argument << std::endl;
+                return false;
+            } else {
+                options.inputs.push_back(argument);
+            }
+        }
+
+        if (options.inputs.empty()) {
+            PrintUsage();
+            return false;
+        }
+        if (!AssetCompressionCodec::IsAvailable(options.settings.compression)) {
+            std::cerr << "requested compression is not available in this build" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool IsCookable(const std::string& path) {
+        return MeshCooker::IsMeshFile(path) || TextureCooker::IsTextureFile(path) || ShaderCooker::IsShaderFile(path);
+    }
+
+    void CollectJobs(const Options& options, std::vector<CookJob>& jobs) {
+        fs::path root = fs::absolute(options.root).lexically_normal();
+        std::set<std::string> seen;
+        auto addFile = [&](const fs::path& path) {
+            fs::path absolute = fs::absolute(path).lexically_normal();
+            if (!IsCookable(absolute.string()) || !seen.insert(absolute.string()).second) return;
+
+            CookJob job;
+            job.sourcePath = absolute.string();
+            job.assetName = absolute.lexically_relative(root).generic_string();
+            if (job.assetName.empty() || job.assetName.compare(0, 2, "..") == 0) {
+                // 根目录之外的文件只用文件名
+                job.assetName = absolute.filename().generic_string();
+            }
+            jobs.push_back(std::move(job));
+        };
+
+        for (const auto& input : options.inputs) {
+            std::error_code error;
+            if (fs::is_directory(input, error)) {
+                for (const auto& entry : fs::recursive_directory_iterator(input, error)) {
+                    if (entry.is_regular_file()) addFile(entry.path());
+                }
+            } else if (fs::is_regular_file(input, error)) {
+                addFile(input);
+            } else {
+                std::cerr << "input not found: " << input << std::endl;
+            }
+        }
+
+        std::sort(jobs.begin(), jobs.end(), [](const CookJob& a, const CookJob& b) { return a.assetName < b.assetName; });
+    }
+
+    bool ReadFile(const std::string& path, std::vector<uint8_t>& data) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        size_t size = static_cast<size_t>(file.tellg());
+        data.resize(size);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    }
+
+    void RunJob(CookJob& job, const Options& options, const CookCache& cache) {
+        std::vector<uint8_t> source;
+        if (!ReadFile(job.sourcePath, source)) {
+            job.error = "failed to read file";
+            return;
+        }
+
+        std::string tag;
+        if (MeshCooker::IsMeshFile(job.sourcePath)) {
+            tag = MeshCooker::GetCookerTag(options.settings);
+        } else if (TextureCooker::IsTextureFile(job.sourcePath)) {
+            tag = TextureCooker::GetCookerTag(options.settings);
+        } else {
+            tag = ShaderCooker::GetCookerTag(options.settings) + ShaderCooker::GetIncludeTag(job.sourcePath, source);
+        }
+        // 名称参与哈希，内容相同的两个文件输出名称不同
+        tag += "|" + job.assetName + "|" + std::to_string(static_cast<int>(options.settings.compression));
+        uint64_t key = CookCache::ComputeKey(source, tag);
+
+        if (!options.noCache && cache.Load(key, job.outputs)) {
+            job.cached = true;
+            return;
+        }
+
+        bool cooked;
+        if (MeshCooker::IsMeshFile(job.sourcePath)) {
+            cooked = MeshCooker::Cook(job.assetName, source, options.settings, job.outputs, job.error);
+        } else if (TextureCooker::IsTextureFile(job.sourcePath)) {
+            cooked = TextureCooker::Cook(job.assetName, source, options.settings, job.outputs, job.error);
+        } else {
+            // 被#include的文件内容经GetIncludeTag计入缓存键，修改后会重新编译
+            cooked = ShaderCooker::Cook(job.assetName, job.sourcePath, options.settings, job.outputs, job.error);
+        }
+
+        if (cooked && !options.noCache && !cache.Store(key, job.outputs)) {
+            std::cerr << "warning: failed to store cache entry for " << job.assetName << std::endl;
+        }
+        if (!cooked) {
+            job.outputs.clear();
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<CookJob> jobs;
+    CollectJobs(options, jobs);
+    if (jobs.empty()) {
+        std::cerr << "no cookable inputs found" << std::endl;
+        return 1;
+    }
+
+    CookCache cache(options.cacheDirectory);
+    if (!cache.Initialize()) {
+        return 1;
+    }
+    options.settings.tempDirectory = (fs::path(options.cacheDirectory) / "tmp").string();
+    std::error_code error;
+    fs::create_directories(options.settings.tempDirectory, error);
+
+    // 工作线程按原子计数领取任务
+    uint32_t threadCount = options.threadCount != 0 ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<uint32_t>(threadCount, static_cast<uint32_t>(jobs.size()));
+    std::atomic<size_t> nextJob{0};
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threadCount; t++) {
+        workers.emplace_back([&]() {
+            for (size_t index = nextJob++; index < jobs.size(); index = nextJob++) {
+                RunJob(jobs[index], options, cache);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    size_t cookedCount = 0;
+    size_t cachedCount = 0;
+    size_t failedCount = 0;
+    std::set<std::string> names;
+    AssetArchiveWriter writer;
+    for (const auto& job : jobs) {
+        if (!job.error.empty()) {
+            std::cerr << job.assetName << ": " << job.error << std::endl;
+            failedCount++;
+            continue;
+        }
+        job.cached ? cachedCount++ : cookedCount++;
+        if (options.verbose) {
+            std::cout << (job.cached ? "cached  " : "cooked  ") << job.assetName << std::endl;
+        }
+
+        for (const auto& output : job.outputs) {
+            if (!names.insert(output.name).second) {
+                std::cerr << "duplicate asset name: " << output.name << std::endl;
+                failedCount++;
+                continue;
+            }
+            writer.AddEntry(output.name, output.type, output.data.data(), output.data.size(), output.compression);
+        }
+    }
+
+    if (failedCount > 0) {
+        std::cerr << failedCount << " asset(s) failed, archive not written" << std::endl;
+        return 1;
+    }
+
+    if (!writer.Write(options.output)) {
+        std::cerr << "failed to write archive: " << options.output << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "vge_cook: " << cookedCount << " cooked, " << cachedCount << " cached, "
+              << writer.GetEntryCount() << " entries -> " << options.output
+              << " (" << threadCount << " threads, " << seconds << "s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,347 @@
+#include "FrameCapture.hpp"
+#include "FrameReadback.hpp"
+#include "DynamicResolution.hpp"
+#include "FrameAllocator.hpp"
+#include "AllocationTracker.hpp"
+#include "FramePipeline.hpp"
+#include "VulkanContext.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 帧回放：在无窗口上下文中加载捕获文件并重复绘制同一帧，输出帧时间分布
+// 每次DrawFrame等待同一飞行帧槽位的上次提交，稳定后CPU侧帧时间即反映GPU吞吐
+
+namespace {
+    struct Options {
+        std::string capturePath;
+        uint32_t iterations = 500;
+        uint32_t warmup = 50;
+        uint32_t width = 0;             // 0为捕获时的分辨率
+        uint32_t height = 0;
+        std::string device;
+        float renderScale = 0.0f;       // 0为不缩放
+        float gpuBudget = 0.0f;         // 大于0时启用动态分辨率
+        std::string screenshot;
+        std::string stream;
+        FrameReadback::StreamFormat streamFormat = FrameReadback::STREAM_RGBA;
+        bool checkAllocations = false;  // 预热后的帧有堆分配时以非0退出
+        bool hostAllocationReport = false;
+        uint32_t pipelineDepth = 0;     // 0为引擎默认
+        std::vector<VulkanContext::FramePass> disabledPasses;
+    };
+
+    void PrintUsage() {
+        std::cout << "usage: vge_replay [options] <capture.vgef>\n"
+                  << "  --iterations <n>      measured frames (default 500)\n"
+                  << "  --warmup <n>          frames before measuring (default 50)\n"
+                  << "  --disable <pass>      skip a frame pass, may be repeated:\n"
+                  << "                        cull_early | main | depth_pyramid | cull_late | resume\n"
+                  << "  --resolution <WxH>    render at another resolution (default: as captured)\n"
+                  << "  --device <name|uuid>  physical device override\n"
+                  << "  --render-scale <s>    render the scene at a fixed scale (0.1-1) and upscale\n"
+                  << "  --gpu-budget <ms>     enable dynamic resolution with this GPU frame budget\n"
+                  << "  --screenshot <png>    save the last measured frame\n"
+                  << "  --stream <target>     write every measured frame to a file or |command\n"
+                  << "  --stream-format <f>   rgba | i420 (default rgba)\n"
+                  << "  --check-allocations   fail if a measured frame allocates from the heap\n"
+                  << "                        (requires a VGE_TRACK_ALLOCATIONS build)\n"
+                  << "  --host-allocations    list driver host allocations per frame-loop call site\n"
+                  << "                        at exit (warmup frames included)\n"
+                  << "  --pipeline-depth <n>  snapshots in flight between simulation and rendering\n"
+                  << "                        (1 = lockstep, default 3)"
+                  << std::endl;
+    }
+
+    bool ParsePass(const std::string& name, VulkanContext::FramePass& pass) {
+        for (uint32_t i = 0; i < VulkanContext::PASS_COUNT; i++) {
+            if (name == VulkanContext::GetFramePassName(static_cast<VulkanContext::FramePass>(i))) {
+                pass = static_cast<VulkanContext::FramePass>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string argument = argv[i];
+            auto value = [&](std::string& out) {
+                if (i + 1 >= argc) {
+                    std::cerr << "missing value for " << argument << std::endl;
+                    return false;
+                }
+                out = argv[++i];
+                return true;
+            };
+
+            std::string text;
+            if (argument == "-h" || argument == "--help") {
+                PrintUsage();
+                std::exit(0);
+            } else if (argument == "--iterations") {
+                if (!value(text)) return false;
+                options.iterations = static_cast<uint32_t>(std::max(1, std::atoi(text.c_str())));
+            } else if (argument == "--warmup") {
+                if (!value(text)) return false;
+                options.warmup = static_cast<uint32_t>(std::max(0, std::atoi(text.c_str())));
+            } else if (argument == "--disable") {
+                if (!value(text)) return false;
+                VulkanContext::FramePass pass;
+                if (!ParsePass(text, pass)) {
+                    std::cerr << "unknown frame pass: " << text << std::endl;
+                    return false;
+                }
+                options.disabledPasses.push_back(pass);
+            } else if (argument == "--resolution") {
+                if (!value(text)) return false;
+                unsigned width = 0, height = 0;
+                if (std::sscanf(text.c_str(), "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                    std::cerr << "invalid resolution: " << text << std::endl;
+                    return false;
+                }
+                options.width = width;
+                options.height = height;
+            } else if (argument == "--device") {
+                if (!value(options.device)) return false;
+            } else if (argument == "--render-scale") {
+                if (!value(text)) return false;
+                options.renderScale = static_cast<float>(std::atof(text.c_str()));
+                if (options.renderScale <= 0.0f || options.renderScale > 1.0f) {
+                    std::cerr << "invalid render scale: " << text << std::endl;
+                    return false;
+                }
+            } else if (argument == "--gpu-budget") {
+                if (!value(text)) return false;
+                options.gpuBudget = static_cast<float>(std::atof(text.c_str()));
+                if (options.gpuBudget <= 0.0f) {
+                    std::cerr << "invalid GPU budget: " << text << std::endl;
+                    return false;
+                }
+            } else if (argument == "--check-allocations") {
+                options.checkAllocations = true;
+            } else if (argument == "--host-allocations") {
+                options.hostAllocationReport = true;
+            } else if (argument == "--pipeline-depth") {
+                if (!value(text)) return false;
+                int depth = std::atoi(text.c_str());
+                if (depth < 1 || depth > static_cast<int>(FramePipeline::MAX_DEPTH)) {
+                    std::cerr << "invalid pipeline depth: " << text << std::endl;
+                    return false;
+                }
+                options.pipelineDepth = static_cast<uint32_t>(depth);
+            } else if (argument == "--screenshot") {
+                if (!value(options.screenshot)) return false;
+            } else if (argument == "--stream") {
+                if (!value(options.stream)) return false;
+            } else if (argument == "--stream-format") {
+                if (!value(text)) return false;
+                if (text == "rgba") {
+                    options.streamFormat = FrameReadback::STREAM_RGBA;
+                } else if (text == "i420") {
+                    options.streamFormat = FrameReadback::STREAM_I420;
+                } else {
+                    std::cerr << "unknown stream format: " << text << std::endl;
+                    return false;
+                }
+            } else if (!argument.empty() && argument[0] == '-') {
+                std::cerr << "unknown option: " << argument << std::endl;
+                return false;
+            } else {
+                options.capturePath = argument;
+            }
+        }
+
+        if (options.capturePath.empty()) {
+            PrintUsage();
+            return false;
+        }
+        return true;
+    }
+
+    double Percentile(const std::vector<double>& sorted, double fraction) {
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        return 1;
+    }
+    if (options.checkAllocations && !AllocationTracker::IsEnabled()) {
+        std::cerr << "--check-allocations requires a build with -DVGE_TRACK_ALLOCATIONS=ON" << std::endl;
+        return 1;
+    }
+
+    FrameCapture capture;
+    if (!capture.Load(options.capturePath)) {
+        return 1;
+    }
+
+    try {
+        VulkanContext context;
+        uint32_t width = options.width != 0 ? options.width : capture.GetWidth();
+        uint32_t height = options.height != 0 ? options.height : capture.GetHeight();
+        context.SetHeadless(width, height);
+        if (!options.device.empty()) {
+            context.SetDeviceOverride(options.device);
+        }
+        capture.ApplyShaders(&context);
+        if (options.hostAllocationReport) {
+            context.SetHostAllocationReport(true);
+        }
+        if (options.pipelineDepth != 0) {
+            context.GetFramePipeline()->SetDepth(options.pipelineDepth);
+        }
+
+        if (!context.Initialize()) {
+            std::cerr << "Failed to initialize Vulkan context!" << std::endl;
+            return 1;
+        }
+        if (!capture.Restore(&context)) {
+            context.Cleanup();
+            return 1;
+        }
+        for (VulkanContext::FramePass pass : options.disabledPasses) {
+            context.SetFramePassEnabled(pass, false);
+        }
+        DynamicResolution* resolution = context.GetDynamicResolution();
+        if (options.renderScale > 0.0f || options.gpuBudget > 0.0f) {
+            // 固定缩放即最小与最大缩放相同
+            DynamicResolution::Settings settings;
+            settings.enabled = true;
+            settings.controller.targetMilliseconds = options.gpuBudget;
+            if (options.renderScale > 0.0f) {
+                settings.controller.maxScale = options.renderScale;
+                settings.controller.minScale = options.gpuBudget > 0.0f ? std::min(settings.controller.minScale, options.renderScale)
+                                                                        : options.renderScale;
+            }
+            resolution->SetSettings(settings);
+        }
+
+        std::cout << "replaying frame " << capture.GetFrameNumber() << " of " << options.capturePath
+                  << " at " << width << "x" << height << " (" << capture.GetMeshes().size() << " meshes, "
+                  << capture.GetNodes().size() << " nodes, " << capture.GetDrawItems().size() << " draw items)"
+                  << std::endl;
+        std::cout << "passes:";
+        for (uint32_t i = 0; i < VulkanContext::PASS_COUNT; i++) {
+            VulkanContext::FramePass pass = static_cast<VulkanContext::FramePass>(i);
+            std::cout << " " << VulkanContext::GetFramePassName(pass) << (context.IsFramePassEnabled(pass) ? "" : "(off)");
+        }
+        std::cout << std::endl;
+
+        for (uint32_t i = 0; i < options.warmup; i++) {
+            context.DrawFrame();
+        }
+
+        // 回读在编码线程进行，帧时间中只包含拷贝命令的GPU开销
+        FrameReadback* readback = context.GetFrameReadback();
+        if (!options.stream.empty() && !readback->StartStream(options.stream, options.streamFormat)) {
+            context.Cleanup();
+            return 1;
+        }
+
+        std::vector<double> frameTimes;
+        frameTimes.reserve(options.iterations);
+        uint32_t allocatingFrames = 0;
+        AllocationTracker::Counters allocations;
+        uint32_t hostAllocatingFrames = 0;
+        HostAllocator::FrameCounters hostAllocations;
+        auto begin = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < options.iterations; i++) {
+            if (i + 1 == options.iterations && !options.screenshot.empty()) {
+                readback->RequestScreenshot(options.screenshot);
+            }
+            auto frameBegin = std::chrono::steady_clock::now();
+            context.DrawFrame();
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameBegin).count());
+
+            const AllocationTracker::Counters& frameAllocations = context.GetFrameAllocations();
+            if (frameAllocations.allocations > 0) {
+                if (options.checkAllocations && allocatingFrames == 0) {
+                    std::printf("frame %u allocated %llu times (%llu bytes)\n", i,
+                                static_cast<unsigned long long>(frameAllocations.allocations),
+                                static_cast<unsigned long long>(frameAllocations.bytes));
+                }
+                allocatingFrames++;
+                allocations.allocations += frameAllocations.allocations;
+                allocations.bytes += frameAllocations.bytes;
+            }
+
+            const HostAllocator::FrameCounters& frameHostAllocations = context.GetFrameHostAllocations();
+            if (frameHostAllocations.allocations > 0) {
+                hostAllocatingFrames++;
+                hostAllocations.allocations += frameHostAllocations.allocations;
+                hostAllocations.bytes += frameHostAllocations.bytes;
+            }
+        }
+        vkDeviceWaitIdle(context.GetDevice());
+        double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        std::vector<double> sorted = frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        std::printf("frames %u  total %.2f ms  %.1f fps\n", options.iterations, total,
+                    1000.0 * options.iterations / total);
+        std::printf("frame ms  min %.3f  mean %.3f  p50 %.3f  p95 %.3f  max %.3f\n",
+                    sorted.front(), total / options.iterations, Percentile(sorted, 0.5),
+                    Percentile(sorted, 0.95), sorted.back());
+
+        if (resolution->IsActive()) {
+            VkExtent2D renderExtent = context.GetRenderExtent();
+            std::printf("render scale %.3f (%ux%u)  gpu ms %.3f (smoothed %.3f)\n", resolution->GetScale(),
+                        renderExtent.width, renderExtent.height, resolution->GetGpuMilliseconds(),
+                        resolution->GetSmoothedGpuMilliseconds());
+        } else if (resolution->GetGpuMilliseconds() > 0.0f) {
+            std::printf("gpu ms %.3f\n", resolution->GetGpuMilliseconds());
+        }
+
+        // 捕获的场景是静态的，模拟阶段只有世界矩阵、剔除和LOD选择
+        FramePipeline::Statistics pipelineStatistics = context.GetFramePipeline()->GetStatistics();
+        std::printf("pipeline depth %u  latency ms  last %.3f  mean %.3f  max %.3f  simulation %.3f  render wait %.1f\n",
+                    context.GetFramePipeline()->GetDepth(), pipelineStatistics.latencyMilliseconds,
+                    pipelineStatistics.averageLatencyMilliseconds, pipelineStatistics.maxLatencyMilliseconds,
+                    pipelineStatistics.simulationMilliseconds, pipelineStatistics.renderWaitMilliseconds);
+
+        readback->StopStream();
+        FrameReadback::Statistics readbackStatistics = readback->GetStatistics();
+        if (readbackStatistics.copies > 0) {
+            std::printf("readback  copies %llu  streamed %llu  dropped %llu\n",
+                        static_cast<unsigned long long>(readbackStatistics.copies),
+                        static_cast<unsigned long long>(readbackStatistics.streamedFrames),
+                        static_cast<unsigned long long>(readbackStatistics.dropped));
+        }
+
+        if (context.GetAllocationCallbacks() != nullptr) {
+            std::printf("driver host allocations  frames %u  total %llu (%llu bytes)\n", hostAllocatingFrames,
+                        static_cast<unsigned long long>(hostAllocations.allocations),
+                        static_cast<unsigned long long>(hostAllocations.bytes));
+        }
+
+        bool allocationCheckFailed = false;
+        if (AllocationTracker::IsEnabled()) {
+            FrameAllocator::Statistics arenaStatistics = context.GetFrameAllocator()->GetStatistics();
+            std::printf("heap allocations  frames %u  total %llu (%llu bytes)  arenas %zu KB (peak %zu KB, %llu overflows)\n",
+                        allocatingFrames, static_cast<unsigned long long>(allocations.allocations),
+                        static_cast<unsigned long long>(allocations.bytes), arenaStatistics.capacity / 1024,
+                        arenaStatistics.peak / 1024, static_cast<unsigned long long>(arenaStatistics.overflows));
+            allocationCheckFailed = options.checkAllocations && allocatingFrames > 0;
+        }
+
+        context.Cleanup();
+        if (allocationCheckFailed) {
+            std::cerr << "allocation check failed: " << allocatingFrames << " measured frames allocated from the heap" << std::endl;
+            return 2;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}